@@ -0,0 +1,159 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include "elina_nn_model.h"
+
+
+elina_nn_model_t* elina_nn_model_alloc(size_t num_pixels){
+	elina_nn_model_t *model = (elina_nn_model_t *)malloc(sizeof(elina_nn_model_t));
+	model->num_pixels = num_pixels;
+	model->num_layers = 0;
+	model->layers = NULL;
+	return model;
+}
+
+
+void elina_nn_model_free(elina_nn_model_t* model){
+	size_t i;
+	for(i=0; i < model->num_layers; i++){
+		elina_nn_layer_t *layer = model->layers + i;
+		free(layer->row_start);
+		free(layer->weights);
+		free(layer->dim);
+		free(layer->bias);
+	}
+	free(model->layers);
+	free(model);
+}
+
+
+static elina_nn_layer_t* elina_nn_model_add_layer(elina_nn_model_t* model, elina_nn_layer_type_t type, elina_nn_activation_t activation,
+						  size_t num_out_neurons, size_t num_in_neurons){
+	elina_nn_layer_t *layer;
+	model->layers = (elina_nn_layer_t *)realloc(model->layers, (model->num_layers+1)*sizeof(elina_nn_layer_t));
+	layer = model->layers + model->num_layers;
+	model->num_layers++;
+	memset(layer, 0, sizeof(elina_nn_layer_t));
+	layer->type = type;
+	layer->activation = activation;
+	layer->num_in = num_in_neurons;
+	layer->num_out = num_out_neurons;
+	layer->row_start = (size_t *)malloc((num_out_neurons+1)*sizeof(size_t));
+	layer->bias = (double *)malloc(num_out_neurons*sizeof(double));
+	return layer;
+}
+
+
+void elina_nn_model_add_ffn_layer(elina_nn_model_t* model, double **weights, double *bias,
+				  size_t num_out_neurons, size_t num_in_neurons, elina_nn_activation_t activation){
+	elina_nn_layer_t *layer = elina_nn_model_add_layer(model, ELINA_NN_FFN, activation, num_out_neurons, num_in_neurons);
+	size_t i;
+	layer->weights = (double *)malloc(num_out_neurons*num_in_neurons*sizeof(double));
+	for(i=0; i < num_out_neurons; i++){
+		layer->row_start[i] = i*num_in_neurons;
+		memcpy(layer->weights + i*num_in_neurons, weights[i], num_in_neurons*sizeof(double));
+		layer->bias[i] = bias[i];
+	}
+	layer->row_start[num_out_neurons] = num_out_neurons*num_in_neurons;
+}
+
+
+void elina_nn_conv_geometry(size_t *output_size, long int *pad_top, long int *pad_left, size_t *input_size,
+			    size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding){
+	long int pad_along_height = 0, pad_along_width = 0;
+	if(is_valid_padding){
+		output_size[0] = ceil((double)(input_size[0] - filter_size[0]+1) / (double)strides[0]);
+		output_size[1] = ceil((double)(input_size[1] - filter_size[1]+1) / (double)strides[1]);
+	}
+	else{
+		output_size[0] = ceil((double)input_size[0] / (double)strides[0]);
+		output_size[1] = ceil((double)input_size[1] / (double)strides[1]);
+		if(input_size[0] % strides[0] == 0){
+			pad_along_height = (long int)filter_size[0] - (long int)strides[0];
+		}
+		else{
+			pad_along_height = (long int)filter_size[0] - (long int)(input_size[0] % strides[0]);
+		}
+		if(input_size[1] % strides[1] == 0){
+			pad_along_width = (long int)filter_size[1] - (long int)strides[1];
+		}
+		else{
+			pad_along_width = (long int)filter_size[1] - (long int)(input_size[1] % strides[1]);
+		}
+	}
+	output_size[2] = num_filters;
+	if(pad_top!=NULL){
+		*pad_top = pad_along_height > 0 ? pad_along_height / 2 : 0;
+	}
+	if(pad_left!=NULL){
+		*pad_left = pad_along_width > 0 ? pad_along_width / 2 : 0;
+	}
+}
+
+
+void elina_nn_model_add_conv_layer(elina_nn_model_t* model, double *filter_weights, double *filter_bias,
+				   size_t *input_size, size_t *filter_size, size_t num_filters, size_t *strides,
+				   bool is_valid_padding, bool has_bias){
+	size_t output_size[3];
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, filter_size, num_filters, strides, is_valid_padding);
+	size_t num_in_neurons = input_size[0]*input_size[1]*input_size[2];
+	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
+	elina_nn_layer_t *layer = elina_nn_model_add_layer(model, ELINA_NN_CONV, ELINA_NN_RELU, num_out_neurons, num_in_neurons);
+	memcpy(layer->input_size, input_size, 3*sizeof(size_t));
+	memcpy(layer->output_size, output_size, 3*sizeof(size_t));
+	size_t max_coeffs = num_out_neurons*filter_size[0]*filter_size[1]*input_size[2];
+	layer->weights = (double *)malloc(max_coeffs*sizeof(double));
+	layer->dim = (uint32_t *)malloc(max_coeffs*sizeof(uint32_t));
+
+	size_t out_x, out_y, out_z, inp_z, x_shift, y_shift;
+	size_t n = 0;
+	for(out_x=0; out_x < output_size[0]; out_x++){
+		for(out_y=0; out_y < output_size[1]; out_y++){
+			for(out_z=0; out_z < output_size[2]; out_z++){
+				size_t mat_x = out_x*output_size[1]*output_size[2] + out_y*output_size[2] + out_z;
+				layer->row_start[mat_x] = n;
+				layer->bias[mat_x] = has_bias ? filter_bias[out_z] : 0;
+				/* the input index grows with x_shift, then y_shift, then inp_z */
+				for(x_shift=0; x_shift < filter_size[0]; x_shift++){
+					long int x_val = (long int)(out_x*strides[0] + x_shift) - pad_top;
+					if(x_val < 0 || x_val >= (long int)input_size[0]){
+						continue;
+					}
+					for(y_shift=0; y_shift < filter_size[1]; y_shift++){
+						long int y_val = (long int)(out_y*strides[1] + y_shift) - pad_left;
+						if(y_val < 0 || y_val >= (long int)input_size[1]){
+							continue;
+						}
+						for(inp_z=0; inp_z < input_size[2]; inp_z++){
+							size_t filter_index = x_shift*filter_size[1]*input_size[2]*output_size[2] + y_shift*input_size[2]*output_size[2] + inp_z*output_size[2] + out_z;
+							layer->weights[n] = filter_weights[filter_index];
+							layer->dim[n] = (uint32_t)(x_val*input_size[1]*input_size[2] + y_val*input_size[2] + inp_z);
+							n++;
+						}
+					}
+				}
+			}
+		}
+	}
+	layer->row_start[num_out_neurons] = n;
+}
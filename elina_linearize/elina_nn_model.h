@@ -0,0 +1,112 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* ************************************************************************* */
+/* elina_nn_model: layers of a neural network shared by the analyses */
+/* ************************************************************************* */
+
+#ifndef _ELINA_NN_MODEL_H_
+#define _ELINA_NN_MODEL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#if defined (HAS_APRON)
+#include "apron_wrapper.h"
+#else
+#include "elina_config.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A model is built once from the weights of a network and is then read by
+   any number of analyses, with fppoly or zonoml, without being modified:
+   the weights of every layer are stored as one matrix whose rows are the
+   affine expressions of the output neurons. The rows of convolutional
+   layers only hold the inputs in the receptive field of the neuron, sorted
+   by increasing input. */
+
+typedef enum elina_nn_layer_type_t{
+	ELINA_NN_FFN,
+	ELINA_NN_CONV,
+}elina_nn_layer_type_t;
+
+typedef enum elina_nn_activation_t{
+	ELINA_NN_RELU,
+	ELINA_NN_SIGMOID,
+	ELINA_NN_TANH,
+	ELINA_NN_PARABOLA,
+	ELINA_NN_LOG,
+	ELINA_NN_NONE,
+}elina_nn_activation_t;
+
+typedef struct elina_nn_layer_t{
+	elina_nn_layer_type_t type;
+	elina_nn_activation_t activation;
+	size_t num_in;
+	size_t num_out;
+	/* the coefficients of row i are weights[row_start[i]] to weights[row_start[i+1]-1] */
+	size_t *row_start;
+	double *weights;
+	/* input of each coefficient, NULL if every row has the num_in inputs in order */
+	uint32_t *dim;
+	double *bias;
+	/* shapes (height, width, channels) of the input and output of a CONV layer */
+	size_t input_size[3];
+	size_t output_size[3];
+}elina_nn_layer_t;
+
+typedef struct elina_nn_model_t{
+	size_t num_pixels;
+	size_t num_layers;
+	elina_nn_layer_t *layers;
+}elina_nn_model_t;
+
+elina_nn_model_t* elina_nn_model_alloc(size_t num_pixels);
+  /* Create a model without layers for an input layer of num_pixels neurons. */
+
+void elina_nn_model_free(elina_nn_model_t* model);
+
+void elina_nn_model_add_ffn_layer(elina_nn_model_t* model, double **weights, double *bias,
+				  size_t num_out_neurons, size_t num_in_neurons, elina_nn_activation_t activation);
+  /* Append a fully connected layer, weights[i] are the num_in_neurons
+     weights of output neuron i. */
+
+void elina_nn_model_add_conv_layer(elina_nn_model_t* model, double *filter_weights, double *filter_bias,
+				   size_t *input_size, size_t *filter_size, size_t num_filters, size_t *strides,
+				   bool is_valid_padding, bool has_bias);
+  /* Append a convolutional ReLU layer, with the same arguments as
+     conv_handle_intermediate_relu_layer of fppoly. */
+
+void elina_nn_conv_geometry(size_t *output_size, long int *pad_top, long int *pad_left, size_t *input_size,
+			    size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding);
+  /* Set output_size to the shape of the output of a convolution, or of a
+     pooling with num_filters the number of channels, with windows of size
+     filter_size, and pad_top and pad_left to the padding above and left of
+     its input: TensorFlow's SAME padding, 0 for VALID padding. pad_top and
+     pad_left may be NULL. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* ************************************************************************* */
+/* elina_thread_pool: long-lived worker threads owned by a manager */
+/* ************************************************************************* */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <fenv.h>
+#include <stdbool.h>
+#include "elina_thread_pool.h"
+
+/* range of items still owned by a thread during elina_thread_pool_for,
+   other threads steal from its end once their own range is exhausted */
+typedef struct elina_thread_pool_slot_t{
+	pthread_mutex_t mutex;
+	size_t start;
+	size_t end;
+	double busy_time;	/* seconds spent running jobs */
+	elina_thread_pool_t *pool;
+	size_t id;
+}elina_thread_pool_slot_t;
+
+struct elina_thread_pool_t{
+	pthread_t *threads;
+	size_t num_workers;
+	elina_thread_pool_slot_t *slots;	/* num_workers+1 slots, slot 0 is the caller */
+	pthread_mutex_t mutex;
+	pthread_cond_t work_cond;	/* signaled when a new job is posted */
+	pthread_cond_t done_cond;	/* signaled when the last worker finishes a job */
+	/* current job */
+	void (*job)(elina_thread_pool_t *, size_t);
+	void *(*function)(void *);
+	void (*range_function)(void *, size_t, size_t);
+	char *args;
+	size_t arg_size;
+	size_t num_tasks;
+	size_t next_task;		/* next task index, taken atomically */
+	size_t chunk_size;
+	size_t active;			/* workers still working on the current job */
+	unsigned long generation;	/* incremented for every job */
+	fenv_t env;
+	bool busy;
+	bool shutdown;
+};
+
+
+static double elina_thread_pool_time(void){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1e-9*(double)ts.tv_nsec;
+}
+
+
+static void elina_thread_pool_run_job(elina_thread_pool_t *pool, size_t id){
+	size_t i;
+	(void)id;
+	while((i = __sync_fetch_and_add(&pool->next_task,1)) < pool->num_tasks){
+		pool->function((void*)(pool->args + i*pool->arg_size));
+	}
+}
+
+
+/* take the next chunk of the own range, or steal the second half of the
+   range of another thread; returns false once no work is left anywhere */
+static bool elina_thread_pool_next_chunk(elina_thread_pool_t *pool, size_t id, size_t *start, size_t *end){
+	size_t num_slots = pool->num_workers + 1;
+	elina_thread_pool_slot_t *own = &pool->slots[id];
+	size_t k;
+	pthread_mutex_lock(&own->mutex);
+	if(own->start < own->end){
+		*start = own->start;
+		*end = own->end - own->start > pool->chunk_size ? own->start + pool->chunk_size : own->end;
+		own->start = *end;
+		pthread_mutex_unlock(&own->mutex);
+		return true;
+	}
+	pthread_mutex_unlock(&own->mutex);
+	for(k=1; k < num_slots; k++){
+		elina_thread_pool_slot_t *victim = &pool->slots[(id+k)%num_slots];
+		size_t lo, hi;
+		pthread_mutex_lock(&victim->mutex);
+		if(victim->start >= victim->end){
+			pthread_mutex_unlock(&victim->mutex);
+			continue;
+		}
+		hi = victim->end;
+		lo = victim->start + (victim->end - victim->start)/2;
+		victim->end = lo;
+		pthread_mutex_unlock(&victim->mutex);
+		*start = lo;
+		*end = hi - lo > pool->chunk_size ? lo + pool->chunk_size : hi;
+		pthread_mutex_lock(&own->mutex);
+		own->start = *end;
+		own->end = hi;
+		pthread_mutex_unlock(&own->mutex);
+		return true;
+	}
+	return false;
+}
+
+
+static void elina_thread_pool_for_job(elina_thread_pool_t *pool, size_t id){
+	size_t start, end;
+	while(elina_thread_pool_next_chunk(pool, id, &start, &end)){
+		pool->range_function((void*)pool->args, start, end);
+	}
+}
+
+
+static void *elina_thread_pool_worker(void *arg){
+	elina_thread_pool_slot_t *slot = (elina_thread_pool_slot_t *)arg;
+	elina_thread_pool_t *pool = slot->pool;
+	unsigned long seen = 0;
+	double time;
+	pthread_mutex_lock(&pool->mutex);
+	while(true){
+		while(!pool->shutdown && pool->generation==seen){
+			pthread_cond_wait(&pool->work_cond, &pool->mutex);
+		}
+		if(pool->shutdown){
+			break;
+		}
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+		fesetenv(&pool->env);
+		time = elina_thread_pool_time();
+		pool->job(pool, slot->id);
+		slot->busy_time += elina_thread_pool_time() - time;
+		pthread_mutex_lock(&pool->mutex);
+		pool->active--;
+		if(pool->active==0){
+			pthread_cond_signal(&pool->done_cond);
+		}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+
+elina_thread_pool_t* elina_thread_pool_alloc(size_t num_threads){
+	elina_thread_pool_t *pool;
+	size_t i;
+	if(num_threads==0){
+		long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		num_threads = nprocs < 1 ? 1 : (size_t)nprocs;
+	}
+	/* on failure the callers run sequentially with a NULL pool */
+	pool = (elina_thread_pool_t *)malloc(sizeof(elina_thread_pool_t));
+	if(pool==NULL){
+		return NULL;
+	}
+	pool->slots = (elina_thread_pool_slot_t *)malloc(num_threads*sizeof(elina_thread_pool_slot_t));
+	pool->threads = (pthread_t *)malloc(num_threads*sizeof(pthread_t));
+	if(pool->slots==NULL || pool->threads==NULL){
+		free(pool->slots);
+		free(pool->threads);
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+	pool->job = NULL;
+	pool->function = NULL;
+	pool->range_function = NULL;
+	pool->args = NULL;
+	pool->arg_size = 0;
+	pool->num_tasks = 0;
+	pool->next_task = 0;
+	pool->chunk_size = 1;
+	pool->active = 0;
+	pool->generation = 0;
+	pool->busy = false;
+	pool->shutdown = false;
+	pool->num_workers = 0;
+	for(i=0; i < num_threads; i++){
+		pthread_mutex_init(&pool->slots[i].mutex, NULL);
+		pool->slots[i].start = 0;
+		pool->slots[i].end = 0;
+		pool->slots[i].busy_time = 0;
+		pool->slots[i].pool = pool;
+		pool->slots[i].id = i;
+	}
+	/* a worker that cannot be created leaves the pool with fewer threads */
+	for(i=0; i < num_threads-1; i++){
+		if(pthread_create(&pool->threads[i], NULL, elina_thread_pool_worker, (void*)&pool->slots[i+1])){
+			break;
+		}
+		pool->num_workers++;
+	}
+	for(i=pool->num_workers+1; i < num_threads; i++){
+		pthread_mutex_destroy(&pool->slots[i].mutex);
+	}
+	return pool;
+}
+
+
+void elina_thread_pool_free(elina_thread_pool_t* pool){
+	size_t i;
+	if(pool==NULL){
+		return;
+	}
+	pthread_mutex_lock(&pool->mutex);
+	pool->shutdown = true;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+	for(i=0; i < pool->num_workers; i++){
+		pthread_join(pool->threads[i], NULL);
+	}
+	for(i=0; i <= pool->num_workers; i++){
+		pthread_mutex_destroy(&pool->slots[i].mutex);
+	}
+	pthread_cond_destroy(&pool->work_cond);
+	pthread_cond_destroy(&pool->done_cond);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->threads);
+	free(pool->slots);
+	free(pool);
+}
+
+
+size_t elina_thread_pool_get_num_threads(elina_thread_pool_t* pool){
+	return pool==NULL ? 1 : pool->num_workers + 1;
+}
+
+
+void elina_thread_pool_get_busy_time(elina_thread_pool_t* pool, double *busy_time){
+	size_t i;
+	if(pool==NULL){
+		busy_time[0] = 0;
+		return;
+	}
+	for(i=0; i <= pool->num_workers; i++){
+		busy_time[i] = pool->slots[i].busy_time;
+	}
+}
+
+
+void elina_thread_pool_reset_busy_time(elina_thread_pool_t* pool){
+	size_t i;
+	if(pool==NULL){
+		return;
+	}
+	for(i=0; i <= pool->num_workers; i++){
+		pool->slots[i].busy_time = 0;
+	}
+}
+
+
+/* reserve the pool for a job; false if the job has to run sequentially */
+static bool elina_thread_pool_acquire(elina_thread_pool_t *pool){
+	bool busy;
+	pthread_mutex_lock(&pool->mutex);
+	busy = pool->busy;
+	pool->busy = true;
+	pthread_mutex_unlock(&pool->mutex);
+	return !busy;
+}
+
+
+/* run the job posted in pool on the caller and all workers */
+static void elina_thread_pool_execute(elina_thread_pool_t *pool){
+	double time;
+	pthread_mutex_lock(&pool->mutex);
+	pool->active = pool->num_workers;
+	fegetenv(&pool->env);
+	pool->generation++;
+	pthread_cond_broadcast(&pool->work_cond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	time = elina_thread_pool_time();
+	pool->job(pool, 0);
+	pool->slots[0].busy_time += elina_thread_pool_time() - time;
+
+	pthread_mutex_lock(&pool->mutex);
+	while(pool->active > 0){
+		pthread_cond_wait(&pool->done_cond, &pool->mutex);
+	}
+	pool->busy = false;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+
+void elina_thread_pool_run(elina_thread_pool_t* pool, void *(*function)(void *),
+			   void* args, size_t arg_size, size_t num_tasks){
+	size_t i;
+	if((pool==NULL) || (pool->num_workers==0) || (num_tasks < 2) || !elina_thread_pool_acquire(pool)){
+		for(i=0; i < num_tasks; i++){
+			function((void*)((char*)args + i*arg_size));
+		}
+		return;
+	}
+	pool->job = elina_thread_pool_run_job;
+	pool->function = function;
+	pool->args = (char*)args;
+	pool->arg_size = arg_size;
+	pool->num_tasks = num_tasks;
+	pool->next_task = 0;
+	elina_thread_pool_execute(pool);
+}
+
+
+void elina_thread_pool_for(elina_thread_pool_t* pool, void (*function)(void *, size_t, size_t),
+			   void* arg, size_t num_items, size_t chunk_size){
+	size_t i, num_slots, start, n;
+	if(chunk_size==0){
+		chunk_size = 1;
+	}
+	if((pool==NULL) || (pool->num_workers==0) || (num_items < 2) || !elina_thread_pool_acquire(pool)){
+		for(start=0; start < num_items; start += chunk_size){
+			function(arg, start, num_items - start > chunk_size ? start + chunk_size : num_items);
+		}
+		return;
+	}
+	num_slots = pool->num_workers + 1;
+	start = 0;
+	for(i=0; i < num_slots; i++){
+		n = num_items/num_slots + (i < num_items%num_slots ? 1 : 0);
+		pool->slots[i].start = start;
+		pool->slots[i].end = start + n;
+		start += n;
+	}
+	pool->job = elina_thread_pool_for_job;
+	pool->range_function = function;
+	pool->args = (char*)arg;
+	pool->chunk_size = chunk_size;
+	elina_thread_pool_execute(pool);
+}
@@ -0,0 +1,83 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* ************************************************************************* */
+/* elina_thread_pool: long-lived worker threads owned by a manager */
+/* ************************************************************************* */
+
+#ifndef _ELINA_THREAD_POOL_H_
+#define _ELINA_THREAD_POOL_H_
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A pool is created once per manager and reused by every parallel loop of
+   the domain, so that threads are not created and joined for each layer.
+
+   The calling thread takes part in the computation: a pool of num_threads
+   threads runs num_threads-1 workers. A call to elina_thread_pool_run made
+   while the pool is already running tasks (from a task, or from another
+   thread sharing the manager) executes its tasks sequentially in the
+   caller. */
+
+typedef struct elina_thread_pool_t elina_thread_pool_t;
+
+elina_thread_pool_t* elina_thread_pool_alloc(size_t num_threads);
+  /* Create a pool of num_threads threads. 0 selects the number of online
+     processors. Returns NULL if the pool cannot be allocated; every function
+     accepts a NULL pool and then runs the tasks sequentially in the caller. */
+
+void elina_thread_pool_free(elina_thread_pool_t* pool);
+  /* Stop and join the workers, and free the pool. */
+
+size_t elina_thread_pool_get_num_threads(elina_thread_pool_t* pool);
+  /* Number of threads taking part in elina_thread_pool_run, including the
+     caller. */
+
+void elina_thread_pool_run(elina_thread_pool_t* pool, void *(*function)(void *),
+			   void* args, size_t arg_size, size_t num_tasks);
+  /* Call function on (char*)args + i*arg_size for every i in [0,num_tasks)
+     and return once all calls have completed. The floating point environment
+     (in particular the rounding mode) of the caller is installed in the
+     workers before they run the tasks. */
+
+void elina_thread_pool_for(elina_thread_pool_t* pool, void (*function)(void *, size_t, size_t),
+			   void* arg, size_t num_items, size_t chunk_size);
+  /* Call function(arg, start, end) on disjoint chunks of at most chunk_size
+     items covering [0,num_items), and return once all chunks are done.
+     Every thread starts on a contiguous share of the items and, once it is
+     exhausted, steals the second half of the remaining share of another
+     thread, so that uneven item costs do not leave threads idle. */
+
+void elina_thread_pool_get_busy_time(elina_thread_pool_t* pool, double *busy_time);
+  /* Store in busy_time[i] the wall-clock seconds thread i spent running
+     jobs since the pool was created or last reset; thread 0 is the caller.
+     busy_time has elina_thread_pool_get_num_threads(pool) entries. */
+
+void elina_thread_pool_reset_busy_time(elina_thread_pool_t* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <pthread.h>
 
 
 #include "zonotope_internal.h"
@@ -55,6 +56,230 @@ double zonotope_is_top_time=0;
 double zonotope_is_bottom_time=0;
 double zonotope_assign_linexpr_time=0;
 
+/* The terms of an affine form are held in one array, see zonotope_aff_t. The arrays hold a power
+   of two of terms, at least ZONOTOPE_AATERM_MIN: those of up to ZONOTOPE_AATERM_SLAB terms are
+   carved from slabs of ZONOTOPE_AATERM_SLAB terms and recycled through a free list of arrays of
+   their size owned by each thread, so that allocating and freeing an array takes no lock, the
+   larger ones are allocated with malloc. A thread holding more than ZONOTOPE_AATERM_MAX_FREE free
+   terms in arrays of a size, or exiting, hands its list over to a shared stack of lists of this
+   size from which the threads refill before carving a new slab. The slabs are freed with the last
+   zonotope manager, which also bumps the generation of the pool so that the threads drop the lists
+   they still hold into the freed slabs. */
+#define ZONOTOPE_AATERM_MIN 4
+#define ZONOTOPE_AATERM_SLAB 1024
+#define ZONOTOPE_AATERM_NUM_CLASSES 9	/* arrays of ZONOTOPE_AATERM_MIN to ZONOTOPE_AATERM_SLAB terms */
+#define ZONOTOPE_AATERM_MAX_FREE (16*ZONOTOPE_AATERM_SLAB)
+
+/* a free array, linked through its first bytes */
+typedef struct zonotope_aaterm_chunk_t{
+	struct zonotope_aaterm_chunk_t *n;
+}zonotope_aaterm_chunk_t;
+
+typedef struct zonotope_aaterm_list_t{
+	zonotope_aaterm_chunk_t *head;
+	size_t num;	/* number of terms in the arrays of the list */
+	unsigned long generation;	/* generation of the pool the arrays belong to */
+}zonotope_aaterm_list_t;
+
+typedef struct zonotope_aaterm_shared_t{
+	zonotope_aaterm_list_t *lists;
+	size_t num;
+	size_t size;
+}zonotope_aaterm_shared_t;
+
+static __thread zonotope_aaterm_list_t zonotope_aaterm_free_list[ZONOTOPE_AATERM_NUM_CLASSES];
+static __thread bool zonotope_aaterm_thread_registered = false;
+
+static pthread_mutex_t zonotope_aaterm_lock = PTHREAD_MUTEX_INITIALIZER;
+static zonotope_aaterm_shared_t zonotope_aaterm_shared[ZONOTOPE_AATERM_NUM_CLASSES];
+static zonotope_aaterm_t **zonotope_aaterm_slabs = NULL;
+static size_t zonotope_aaterm_num_slabs = 0;
+static size_t zonotope_aaterm_num_users = 0;
+static unsigned long zonotope_aaterm_generation = 0;
+
+static pthread_key_t zonotope_aaterm_key;
+static pthread_once_t zonotope_aaterm_key_once = PTHREAD_ONCE_INIT;
+
+
+/* called with zonotope_aaterm_lock held */
+static void zonotope_aaterm_push_shared(zonotope_aaterm_list_t *list, size_t c){
+	zonotope_aaterm_shared_t *shared = zonotope_aaterm_shared + c;
+	if(shared->num==shared->size){
+		shared->size = 2*shared->size + 16;
+		shared->lists = (zonotope_aaterm_list_t *)realloc(shared->lists, shared->size*sizeof(zonotope_aaterm_list_t));
+	}
+	shared->lists[shared->num++] = *list;
+	list->head = NULL;
+	list->num = 0;
+}
+
+static void zonotope_aaterm_thread_exit(void *arg){
+	zonotope_aaterm_list_t *lists = (zonotope_aaterm_list_t *)arg;
+	size_t c;
+	pthread_mutex_lock(&zonotope_aaterm_lock);
+	for(c=0; c < ZONOTOPE_AATERM_NUM_CLASSES; c++){
+		if(lists[c].head && lists[c].generation==zonotope_aaterm_generation){
+			zonotope_aaterm_push_shared(lists + c, c);
+		}
+	}
+	pthread_mutex_unlock(&zonotope_aaterm_lock);
+}
+
+/* drop the list of the thread if its slabs have been freed */
+static inline void zonotope_aaterm_check_generation(zonotope_aaterm_list_t *list){
+	if(list->generation != __atomic_load_n(&zonotope_aaterm_generation, __ATOMIC_ACQUIRE)){
+		list->head = NULL;
+		list->num = 0;
+		list->generation = __atomic_load_n(&zonotope_aaterm_generation, __ATOMIC_ACQUIRE);
+	}
+}
+
+static void zonotope_aaterm_key_alloc(void){
+	pthread_key_create(&zonotope_aaterm_key, zonotope_aaterm_thread_exit);
+}
+
+static void zonotope_aaterm_register_thread(void){
+	pthread_once(&zonotope_aaterm_key_once, zonotope_aaterm_key_alloc);
+	pthread_setspecific(zonotope_aaterm_key, zonotope_aaterm_free_list);
+	zonotope_aaterm_thread_registered = true;
+}
+
+/* refills the list of the arrays of size terms of class c */
+static void zonotope_aaterm_refill(size_t c, size_t size){
+	zonotope_aaterm_list_t *list = zonotope_aaterm_free_list + c;
+	zonotope_aaterm_shared_t *shared = zonotope_aaterm_shared + c;
+	zonotope_aaterm_t *slab = NULL;
+	size_t i;
+	if(!zonotope_aaterm_thread_registered){
+		zonotope_aaterm_register_thread();
+	}
+	pthread_mutex_lock(&zonotope_aaterm_lock);
+	list->generation = zonotope_aaterm_generation;
+	if(shared->num){
+		*list = shared->lists[--shared->num];
+	}
+	else{
+		slab = (zonotope_aaterm_t *)malloc(ZONOTOPE_AATERM_SLAB*sizeof(zonotope_aaterm_t));
+		if((zonotope_aaterm_num_slabs & (zonotope_aaterm_num_slabs - 1))==0){
+			zonotope_aaterm_slabs = (zonotope_aaterm_t **)realloc(zonotope_aaterm_slabs, (2*zonotope_aaterm_num_slabs + 1)*sizeof(zonotope_aaterm_t *));
+		}
+		zonotope_aaterm_slabs[zonotope_aaterm_num_slabs++] = slab;
+	}
+	pthread_mutex_unlock(&zonotope_aaterm_lock);
+	if(slab){
+		zonotope_aaterm_chunk_t *head = NULL;
+		for(i=ZONOTOPE_AATERM_SLAB; i >= size; i-=size){
+			zonotope_aaterm_chunk_t *chunk = (zonotope_aaterm_chunk_t *)(slab + i - size);
+			chunk->n = head;
+			head = chunk;
+		}
+		list->head = head;
+		list->num = ZONOTOPE_AATERM_SLAB;
+	}
+}
+
+/* the class of the arrays of size terms, ZONOTOPE_AATERM_NUM_CLASSES for those allocated with malloc */
+static inline size_t zonotope_aaterm_class(size_t size){
+	size_t c = 0;
+	while(c < ZONOTOPE_AATERM_NUM_CLASSES && ((size_t)ZONOTOPE_AATERM_MIN << c) < size){
+		c++;
+	}
+	return c;
+}
+
+
+zonotope_aaterm_t* zonotope_aaterm_array_alloc(size_t num, size_t *size)
+{
+    size_t c;
+    *size = ZONOTOPE_AATERM_MIN;
+    while (*size < num) {
+	*size *= 2;
+    }
+    c = zonotope_aaterm_class(*size);
+    if (c==ZONOTOPE_AATERM_NUM_CLASSES) {
+	return (zonotope_aaterm_t *)malloc(*size*sizeof(zonotope_aaterm_t));
+    }
+    zonotope_aaterm_list_t *list = zonotope_aaterm_free_list + c;
+    zonotope_aaterm_check_generation(list);
+    if (list->head==NULL) {
+	zonotope_aaterm_refill(c, *size);
+    }
+    zonotope_aaterm_chunk_t *res = list->head;
+    list->head = res->n;
+    list->num -= *size;
+    return (zonotope_aaterm_t *)res;
+}
+
+
+void zonotope_aaterm_array_free(zonotope_aaterm_t* terms, size_t size)
+{
+    size_t c = zonotope_aaterm_class(size);
+    if (c==ZONOTOPE_AATERM_NUM_CLASSES) {
+	free(terms);
+	return;
+    }
+    zonotope_aaterm_list_t *list = zonotope_aaterm_free_list + c;
+    zonotope_aaterm_chunk_t *chunk = (zonotope_aaterm_chunk_t *)terms;
+    if (!zonotope_aaterm_thread_registered) {
+	zonotope_aaterm_register_thread();
+    }
+    zonotope_aaterm_check_generation(list);
+    chunk->n = list->head;
+    list->head = chunk;
+    list->num += size;
+    if (list->num > ZONOTOPE_AATERM_MAX_FREE) {
+	pthread_mutex_lock(&zonotope_aaterm_lock);
+	zonotope_aaterm_push_shared(list, c);
+	pthread_mutex_unlock(&zonotope_aaterm_lock);
+    }
+}
+
+
+void zonotope_aaterm_pool_acquire(void)
+{
+    pthread_mutex_lock(&zonotope_aaterm_lock);
+    zonotope_aaterm_num_users++;
+    pthread_mutex_unlock(&zonotope_aaterm_lock);
+}
+
+
+void zonotope_aaterm_pool_release(void)
+{
+    size_t i;
+    pthread_mutex_lock(&zonotope_aaterm_lock);
+    zonotope_aaterm_num_users--;
+    if (zonotope_aaterm_num_users==0) {
+	for (i=0; i < zonotope_aaterm_num_slabs; i++) {
+	    free(zonotope_aaterm_slabs[i]);
+	}
+	free(zonotope_aaterm_slabs);
+	zonotope_aaterm_slabs = NULL;
+	zonotope_aaterm_num_slabs = 0;
+	for (i=0; i < ZONOTOPE_AATERM_NUM_CLASSES; i++) {
+	    free(zonotope_aaterm_shared[i].lists);
+	    zonotope_aaterm_shared[i].lists = NULL;
+	    zonotope_aaterm_shared[i].num = 0;
+	    zonotope_aaterm_shared[i].size = 0;
+	}
+	__atomic_store_n(&zonotope_aaterm_generation, zonotope_aaterm_generation + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&zonotope_aaterm_lock);
+}
+
+
+static pthread_mutex_t zonotope_noise_symbol_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void zonotope_noise_symbol_block_alloc(zonotope_internal_t *pr, uint_t b)
+{
+    pthread_mutex_lock(&zonotope_noise_symbol_lock);
+    if (pr->epsilon[b] == NULL) {
+	zonotope_noise_symbol_t* block = (zonotope_noise_symbol_t*)calloc((size_t)ZONOTOPE_NSYM_BLOCK << b, sizeof(zonotope_noise_symbol_t));
+	__atomic_store_n(&pr->epsilon[b], block, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&zonotope_noise_symbol_lock);
+}
+
+
 elina_manager_t* zonotope_manager_alloc(void)
 {
 	//CALL();
@@ -191,64 +416,34 @@ zonotope_aff_t* zonotope_aff_add(zonotope_internal_t* pr, zonotope_aff_t* exprA,
     
     zonotope_aff_t* res = zonotope_aff_alloc_init(pr);
     zonotope_aaterm_t *p, *q, *ptr;
+    zonotope_aaterm_t *p_end = exprA->q + exprA->l;
+    zonotope_aaterm_t *q_end = exprB->q + exprB->l;
     res->c_inf = exprA->c_inf + exprB->c_inf;
     res->c_sup = exprA->c_sup + exprB->c_sup;
 	
     box_inf = res->c_inf;
     box_sup = res->c_sup;
-    //size_t count = 0;
-    if (exprA->q || exprB->q) {
-        
-        ptr = zonotope_aaterm_alloc_init();
-        for(p = exprA->q, q = exprB->q; p || q;) {
-            //count++;
-            if (p && q) {
-                
-                if (p->pnsym->index == q->pnsym->index) {
-		    ptr->inf = p->inf + q->inf;
-		    ptr->sup = p->sup + q->sup;
-                    ptr->pnsym = p->pnsym;
-                    p = p->n ;
-                    q = q->n ;
-			
-                } else if (p->pnsym->index < q->pnsym->index) {
-		    ptr->inf = p->inf;
-		    ptr->sup = p->sup;
-                    ptr->pnsym = p->pnsym;
-                    p = p->n ;
-                } else {
-			
-		    ptr->inf = q->inf;
-		    ptr->sup = q->sup;
-                    ptr->pnsym = q->pnsym;
-                    q = q->n ;
-                }
-                
-            } else if (p) {
-		ptr->inf = p->inf;
-		ptr->sup = p->sup;
+    if (exprA->l || exprB->l) {
+        /* merge the terms of both forms, sorted by index */
+        zonotope_aff_reserve(res, exprA->l + exprB->l);
+        ptr = res->q;
+        for(p = exprA->q, q = exprB->q; p < p_end || q < q_end;) {
+            if (p < p_end && q < q_end && p->pnsym->index == q->pnsym->index) {
+		ptr->inf = p->inf + q->inf;
+		ptr->sup = p->sup + q->sup;
                 ptr->pnsym = p->pnsym;
-                p = p->n ;
+                p++;
+                q++;
+            } else if (q==q_end || (p < p_end && p->pnsym->index < q->pnsym->index)) {
+		*ptr = *p;
+                p++;
             } else {
-		ptr->inf = q->inf;
-		ptr->sup = q->sup;
-                ptr->pnsym = q->pnsym;
-                q = q->n ;
+		*ptr = *q;
+                q++;
             }
             
-            if (!ptr->inf && !ptr->sup) {
-                if (!(p||q)) {
-                    /* the last iteration */
-                    zonotope_aaterm_free(pr, ptr);
-                    if (res->end) res->end->n = NULL;
-                }
-            } else {
+            if (ptr->inf || ptr->sup) {
                 /* keep this term */
-               
-                if (!res->q) res->q = ptr;
-                res->end = ptr;
-                res->l++;
-               
                 zonotope_noise_symbol_cons_get_gamma(pr, &tmp_inf, &tmp_sup, ptr->pnsym->index, abs);
 		
 		double inf = 0.0;
@@ -257,32 +452,18 @@ zonotope_aff_t* zonotope_aff_add(zonotope_internal_t* pr, zonotope_aff_t* exprA,
 		
                 box_inf =  box_inf + inf;
                 box_sup =  box_sup + sup;
-		//printf("%g %g %g %g %g %g %d\n",-inf,sup,-tmp_inf ,tmp_sup,-box_inf,box_sup,abs->hypercube);
-                 //start_timing();
-                if (p||q) {
-                    /* continuing */
-                    ptr->n = zonotope_aaterm_alloc_init();
-                    ptr=ptr->n;
-                }
-                 //record_timing(zonotope_assign_linexpr_time);
+                ptr++;
             }
-            
         }
-        
+        res->l = ptr - res->q;
     }
     
-    //elina_interval_add(box, box, tmp, ELINA_SCALAR_DOUBLE);
-    //elina_interval_add(res->itv, exprA->itv, exprB->itv, ELINA_SCALAR_DOUBLE);
     res->itv_inf =  exprA->itv_inf + exprB->itv_inf;
     res->itv_sup =  exprA->itv_sup + exprB->itv_sup;
 	
-	//printf("Box %g %g\n",-box_inf,box_sup);
     res->itv_inf = fmin(res->itv_inf,box_inf);
     res->itv_sup = fmin(res->itv_sup,box_sup);
 
-    //printf("Output %g %g\n",res->itv_inf,res->itv_sup);
-   //zonotope_aff_fprint(pr,stdout,res);
-	
     return res;
 }
 
@@ -379,27 +560,10 @@ zonotope_aff_t* zonotope_aff_mul_itv(zonotope_internal_t* pr, zonotope_aff_t* sr
         elina_double_interval_mul(&dst->c_inf,&dst->c_sup, -lambda->inf->val.dbl, lambda->sup->val.dbl, src->c_inf,src->c_sup);
         //printf("coming here %g %g %g %g %g %g\n",dst->c_inf,dst->c_sup,-lambda->inf->val.dbl, lambda->sup->val.dbl, src->c_inf,src->c_sup);
 	//fflush(stdout);
-        if (src->q) {
-            
-            dst->q = q = zonotope_aaterm_alloc_init();
-            for (p=src->q; p; p=p->n) {
-		
-                double tmp_inf = 0.0;
-		double tmp_sup = 0.0;
-                elina_double_interval_mul(&tmp_inf, &tmp_sup, -lambda->inf->val.dbl, lambda->sup->val.dbl, p->inf, p->sup);
-		q->inf = tmp_inf;
-		q->sup = tmp_sup;
-                q->pnsym = p->pnsym;
-                if (p->n) {
-                    /* continue */
-                    q->n = zonotope_aaterm_alloc_init();
-                    q = q->n;
-                } else {
-                    /* the last iteration */
-                    dst->end = q; 
-                }
-            }
-            
+        zonotope_aff_reserve(dst, src->l);
+        for (p=src->q, q=dst->q; p < src->q + src->l; p++, q++) {
+	    elina_double_interval_mul(&q->inf, &q->sup, -lambda->inf->val.dbl, lambda->sup->val.dbl, p->inf, p->sup);
+            q->pnsym = p->pnsym;
         }
         
         dst->l = src->l;
@@ -31,6 +31,7 @@
 #include "zonotope.h"
 #include "rdtsc.h"
 #include "elina_box_meetjoin.h"
+#include "elina_thread_pool.h"
 
 
 
@@ -105,7 +106,6 @@ typedef struct zonotope_noise_symbol_t {
 
 /* Zonotope affine arithmetic term */
 typedef struct _zonotope_aaterm_t {
-    struct _zonotope_aaterm_t*	n;	/* next element */
     zonotope_noise_symbol_t*	pnsym;	/* index of the noise symbol */
     //elina_interval_t*	coeff;	/* coeff, encoded as interval */
    double sup;
@@ -118,8 +118,8 @@ typedef struct _zonotope_aaterm_t {
 struct _zonotope_aff_t {
     double c_inf;	/* center */
     double c_sup;
-    zonotope_aaterm_t*	q;	/* first center term (epsilons) aaterm */
-    zonotope_aaterm_t*	end;	/* quick jump to the last center term : to add a new term for instance */
+    zonotope_aaterm_t*	q;	/* the l center terms (epsilons), sorted by increasing index of noise symbol */
+    size_t		size;	/* number of terms q can hold */
     unsigned long long int		l;	/* number of noise symbols */
     unsigned long long int		pby;	/* # pointers to this affine form */
     double 	itv_inf;	/* best known interval concretisation */
@@ -127,22 +127,16 @@ struct _zonotope_aff_t {
 };
 typedef struct _zonotope_aff_t zonotope_aff_t;
 
-    static inline zonotope_aff_t * zonotope_aff_copy(zonotope_aff_t *src){
-        zonotope_aff_t *res = (zonotope_aff_t *)malloc(sizeof(zonotope_aff_t));
-	res->c_inf = src->c_inf;
-        res->c_sup = src->c_sup;
-        res->q = src->q==NULL? NULL: (zonotope_aaterm_t *)malloc(sizeof(zonotope_aaterm_t *));
-        res->end = src->end==NULL? NULL:(zonotope_aaterm_t *)malloc(sizeof(zonotope_aaterm_t *));
-        res->l = src->l;
-        res->itv_inf = src->itv_inf; 
-	res->itv_sup = src->itv_sup; 
-        return res;
-    }
+/* The noise symbols are stored in blocks of 1024, 2048, 4096, ... symbols which never move,
+   block b holding the indices 1024*(2^b-1) to 1024*(2^(b+1)-1)-1. The indices are reserved
+   with an atomic increment of dim, so that several threads can add noise symbols at once. */
+#define ZONOTOPE_NSYM_BLOCK 1024
+#define ZONOTOPE_NSYM_NUM_BLOCKS 23
 
 typedef struct _zonotope_internal_t {
     //zonotope_internal_t* itv;		/* interval internal representation */
-    uint_t		dim;		/* nb of noise symbol used */
-    zonotope_noise_symbol_t**	epsilon;	/* array of size index of epsilons */
+    uint_t		dim;		/* nb of noise symbol indices reserved */
+    zonotope_noise_symbol_t*	epsilon[ZONOTOPE_NSYM_NUM_BLOCKS];	/* blocks of noise symbols, NULL if not allocated yet */
     elina_funid_t	funid;		/* current function */
     elina_manager_t *	man;		/* back-pointer */
     elina_manager_t *	manNS;		/* abstract domain of noise symbols */
@@ -155,9 +149,9 @@ typedef struct _zonotope_internal_t {
     elina_dim_t	*dimtoremove;	/* array to store dimensions to remove after a join */
     elina_dimchange_t*	dimchange;
     elina_abstract0_t*	nsymhypercube;
-    uint_t* inputns;
-    uint_t epssize;
     uint_t it;	
+    elina_thread_pool_t* pool;	/* worker threads of the parallel transformers, NULL if sequential */
+    uint_t max_gen;	/* zonoml reduces the layers with more noise symbols to max_gen, 0 if unbounded */
 } zonotope_internal_t;
 
 /***********/
@@ -185,21 +179,52 @@ typedef struct _obj {
     elina_interval_t* coeff;
 } obj;
 
-static inline void zonotope_aaterm_free(zonotope_internal_t* pr, zonotope_aaterm_t* term);
+static inline void zonotope_aff_free(zonotope_internal_t *pr, zonotope_aff_t *a);
 
-static inline void zonotope_aaterm_list_free(zonotope_internal_t *pr, zonotope_aaterm_t* head);
+/* The terms of a form are one array carved from slabs and recycled through free lists per thread,
+   see zonotope_internal.c, so that adding, scaling and bounding forms stream through their terms.
+   Returns an array of at least num terms, *size receives the number of terms it holds */
+zonotope_aaterm_t* zonotope_aaterm_array_alloc(size_t num, size_t *size);
 
-static inline void zonotope_aff_free(zonotope_internal_t *pr, zonotope_aff_t *a);
+/* give back an array of size terms */
+void zonotope_aaterm_array_free(zonotope_aaterm_t* terms, size_t size);
 
-/* memory allocation of affine form term: \alpha_i^x\epsilon_i */
-static inline zonotope_aaterm_t* zonotope_aaterm_alloc_init(void)
+/* every zonotope manager holds the pool, the slabs are freed with the last one */
+void zonotope_aaterm_pool_acquire(void);
+void zonotope_aaterm_pool_release(void);
+
+/* makes room for num terms in a, keeping its l terms */
+static inline void zonotope_aff_reserve(zonotope_aff_t *a, size_t num)
 {
-    zonotope_aaterm_t* res = (zonotope_aaterm_t*)malloc(sizeof(zonotope_aaterm_t));
-    res->n = NULL;
-    res->pnsym = NULL;
-    res->inf = 0;
-    res->sup = 0;
-    return res;
+    if (num > a->size) {
+	size_t size;
+	zonotope_aaterm_t *q = zonotope_aaterm_array_alloc(num, &size);
+	if (a->l) memcpy(q, a->q, a->l*sizeof(zonotope_aaterm_t));
+	if (a->q) zonotope_aaterm_array_free(a->q, a->size);
+	a->q = q;
+	a->size = size;
+    }
+}
+
+/* adds the term [-inf,sup].pnsym after the terms of a, pnsym has the largest index */
+static inline void zonotope_aff_push_term(zonotope_aff_t *a, zonotope_noise_symbol_t *pnsym, double inf, double sup)
+{
+    zonotope_aaterm_t *ptr;
+    zonotope_aff_reserve(a, a->l + 1);
+    ptr = a->q + a->l;
+    ptr->pnsym = pnsym;
+    ptr->inf = inf;
+    ptr->sup = sup;
+    a->l++;
+}
+
+/* frees the terms of a */
+static inline void zonotope_aff_clear_terms(zonotope_aff_t *a)
+{
+    if (a->q) zonotope_aaterm_array_free(a->q, a->size);
+    a->q = NULL;
+    a->size = 0;
+    a->l = 0;
 }
 
 static zonotope_aff_t* zonotope_aff_alloc_init(zonotope_internal_t *pr)
@@ -208,7 +233,7 @@ static zonotope_aff_t* zonotope_aff_alloc_init(zonotope_internal_t *pr)
     a->c_inf = 0.0;
     a->c_sup = 0.0;
     a->q = NULL;
-    a->end = NULL;
+    a->size = 0;
     a->l = 0;
     a->pby = 0;
     a->itv_inf = INFINITY;
@@ -216,6 +241,22 @@ static zonotope_aff_t* zonotope_aff_alloc_init(zonotope_internal_t *pr)
     return a;
 }
 
+static inline zonotope_aff_t * zonotope_aff_copy(zonotope_aff_t *src){
+        zonotope_aff_t *res = (zonotope_aff_t *)malloc(sizeof(zonotope_aff_t));
+	res->c_inf = src->c_inf;
+        res->c_sup = src->c_sup;
+        res->q = NULL;
+        res->size = 0;
+        res->l = 0;
+        zonotope_aff_reserve(res, src->l);
+        if (src->l) memcpy(res->q, src->q, src->l*sizeof(zonotope_aaterm_t));
+        res->l = src->l;
+        res->pby = 0;
+        res->itv_inf = src->itv_inf; 
+	res->itv_sup = src->itv_sup; 
+        return res;
+}
+
 static inline zonotope_aff_t * zonotope_aff_top(zonotope_internal_t* pr)
 {
     zonotope_aff_t* res = zonotope_aff_alloc_init(pr);
@@ -235,26 +276,51 @@ static inline zonotope_aff_t * zonotope_aff_bottom(zonotope_internal_t* pr)
     return res;
 }
 
-static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add(zonotope_internal_t *pr, noise_symbol_t type)
-    /* increment the global index of used noise symbols and add the noise symbol in pr->eps */
+/* allocates block b of the noise symbols if no other thread did */
+void zonotope_noise_symbol_block_alloc(zonotope_internal_t *pr, uint_t b);
+
+static inline uint_t zonotope_noise_symbol_block(uint_t index)
 {
-    uint_t dim = pr->dim;
-    zonotope_noise_symbol_t* res;
-	
-    /* resize epsilon array */
-    if (dim % 1024 == 0){ pr->epsilon = (zonotope_noise_symbol_t**)realloc(pr->epsilon, (dim+1024)*sizeof(zonotope_noise_symbol_t*));
+    return 31 - __builtin_clz(index/ZONOTOPE_NSYM_BLOCK + 1);
+}
+
+static inline zonotope_noise_symbol_t* zonotope_noise_symbol_get(zonotope_internal_t *pr, uint_t index)
+    /* the noise symbol of a reserved index */
+{
+    uint_t b = zonotope_noise_symbol_block(index);
+    zonotope_noise_symbol_t* block = __atomic_load_n(&pr->epsilon[b], __ATOMIC_ACQUIRE);
+    return block + (index - ZONOTOPE_NSYM_BLOCK*((1u << b) - 1));
 }
-    res = pr->epsilon[dim] = (zonotope_noise_symbol_t*)malloc(sizeof(zonotope_noise_symbol_t));
-    if (type == IN) {
-	if (pr->epssize % 1024 == 0) pr->inputns = (uint_t*)realloc(pr->inputns, (pr->epssize+1024)*sizeof(uint_t));
-	pr->inputns[pr->epssize] = dim; pr->epssize++;
+
+static inline uint_t zonotope_noise_symbol_reserve(zonotope_internal_t *pr, uint_t num)
+    /* reserve num consecutive indices of noise symbols and return the first one, thread-safe.
+       The symbols are added by zonotope_noise_symbol_add_with_index, the indices not used are lost. */
+{
+    uint_t first = __atomic_fetch_add(&pr->dim, num, __ATOMIC_RELAXED);
+    uint_t b;
+    if (num) {
+	for (b = zonotope_noise_symbol_block(first); b <= zonotope_noise_symbol_block(first + num - 1); b++) {
+	    if (__atomic_load_n(&pr->epsilon[b], __ATOMIC_ACQUIRE) == NULL) zonotope_noise_symbol_block_alloc(pr, b);
+	}
     }
-    res->index = dim;
+    return first;
+}
+
+static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add_with_index(zonotope_internal_t *pr, noise_symbol_t type, uint_t index)
+    /* add the noise symbol of an index reserved by zonotope_noise_symbol_reserve, thread-safe */
+{
+    zonotope_noise_symbol_t* res = zonotope_noise_symbol_get(pr, index);
+    res->index = index;
     res->type = type;
-    pr->dim++;
     return res;
 }
 
+static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add(zonotope_internal_t *pr, noise_symbol_t type)
+    /* increment the global index of used noise symbols and add the noise symbol in pr->eps, thread-safe */
+{
+    return zonotope_noise_symbol_add_with_index(pr, type, zonotope_noise_symbol_reserve(pr, 1));
+}
+
     
     static inline void zonotope_noise_symbol_fprint(FILE* stream, zonotope_noise_symbol_t *eps)
     {
@@ -296,7 +362,7 @@ static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add(zonotope_intern
           fprintf(stream,"[%.20f,%.20f]",-expr->c_inf,expr->c_sup);
         }
         /* Print values */
-        for (p=expr->q; p; p=p->n) {
+        for (p=expr->q; p < expr->q + expr->l; p++) {
             fprintf(stream," + ");
             zonotope_aaterm_fprint(pr, stream, p);
         }
@@ -322,25 +388,6 @@ elina_manager_t* zonotope_manager_alloc(void);
 
 zonotope_aff_t * zonotope_aff_from_linexpr0(zonotope_internal_t* pr, elina_linexpr0_t * expr, zonotope_t *z);
 
-/* Free memory used by one aaterm */
-static inline void zonotope_aaterm_free(zonotope_internal_t* pr, zonotope_aaterm_t* term)
-{
-   // arg_assert(term, abort(););
-    term->n = NULL;
-    term->pnsym = NULL;
-    free(term);
-}
-/* free memory used by a chained list starting from one term */
-static inline void zonotope_aaterm_list_free(zonotope_internal_t *pr, zonotope_aaterm_t* head)
-{
-    zonotope_aaterm_t *p,*q;
-    p = q = NULL;
-    for (p = head; p; p = q) {
-	q = p->n;
-	zonotope_aaterm_free(pr, p);
-    }
-}
-
 static inline void zonotope_aff_free(zonotope_internal_t *pr, zonotope_aff_t *a)
 {
     if (a->pby) {
@@ -350,10 +397,7 @@ static inline void zonotope_aff_free(zonotope_internal_t *pr, zonotope_aff_t *a)
 	a->pby = 0;
 	a->c_inf = 0.0;
 	a->c_sup = 0.0;
-	if (a->q) zonotope_aaterm_list_free(pr, a->q);
-	a->q = NULL;
-	a->end = NULL;
-	a->l = (uint_t)0;
+	zonotope_aff_clear_terms(a);
 	a->itv_inf = 0;
 	a->itv_sup = 0;
 	//elina_interval_free(a->itv);
@@ -378,14 +422,7 @@ static inline void zonotope_aff_noise_symbol_create(zonotope_internal_t *pr, zon
     elina_interval_t * coeff = elina_interval_alloc();
     elina_interval_set_double(coeff,coeff_inf,coeff_sup);
     if (elina_interval_cmp(coeff,zero)>=0) {
-	zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-	ptr->inf = coeff_inf;
-	ptr->sup = coeff_sup;
-	ptr->pnsym = zonotope_noise_symbol_add(pr, type);
-	if (expr->end) expr->end->n = ptr;
-	else expr->q = ptr;
-	expr->end = ptr;
-	expr->l++;
+	zonotope_aff_push_term(expr, zonotope_noise_symbol_add(pr, type), coeff_inf, coeff_sup);
     }
     elina_interval_free(zero);
     elina_interval_free(coeff);
@@ -525,6 +562,8 @@ static inline double max_double(double a, double b){
 }
 
 
+/* on a hypercube the bound only reads expr and pr->muu, it allocates nothing and can be
+   computed for several expressions in parallel */
 static inline void zonotope_aff_bound(zonotope_internal_t* pr, double *res_inf, double *res_sup, zonotope_aff_t *expr, zonotope_t* z)
 {
     if ((expr->c_inf==INFINITY) && (expr->c_sup==INFINITY)) {
@@ -535,12 +574,11 @@ static inline void zonotope_aff_bound(zonotope_internal_t* pr, double *res_inf,
 	elina_dim_t dim;
 	double tmp_inf = 0.0;
 	double tmp_sup = 0.0;
-	elina_interval_t *eps_itv = elina_interval_alloc();
 	zonotope_aaterm_t* p;
 	*res_inf = expr->c_inf;
         *res_sup = expr->c_sup;
 	if (z->hypercube) {
-	    for (p=expr->q; p; p=p->n) {
+	    for (p=expr->q; p < expr->q + expr->l; p++) {
 		elina_double_interval_mul(&tmp_inf, &tmp_sup,p->inf, p->sup, pr->muu->inf->val.dbl,pr->muu->sup->val.dbl);
 		*res_inf = *res_inf + tmp_inf;
 		*res_sup = *res_sup + tmp_sup;
@@ -553,7 +591,7 @@ static inline void zonotope_aff_bound(zonotope_internal_t* pr, double *res_inf,
 	    linexpr0->p.linterm = (elina_linterm_t*)malloc(expr->l*sizeof(elina_linterm_t));
 	    uint_t k = 0;
 	    elina_dim_t dim = 0;
-	    for (p=expr->q; p; p=p->n) {
+	    for (p=expr->q; p < expr->q + expr->l; p++) {
 		if (zonotope_noise_symbol_cons_get_dimpos(pr, &dim, p->pnsym->index, z)) {
 		    elina_coeff_init(&linexpr0->p.linterm[k].coeff, ELINA_COEFF_INTERVAL);
 		    elina_coeff_set_interval_double(&linexpr0->p.linterm[k].coeff, -p->inf,p->sup);
@@ -577,7 +615,6 @@ static inline void zonotope_aff_bound(zonotope_internal_t* pr, double *res_inf,
 	    elina_linexpr0_free(linexpr0);
 	    elina_interval_free(elina_itv);
 	}
-	elina_interval_free (eps_itv);
     }
 }
 
@@ -592,7 +629,7 @@ static inline bool zonotope_aff_is_top(zonotope_internal_t* pr, zonotope_aff_t *
     if (a == pr->top) return true;
     else if ((a->c_inf!=INFINITY) || (a->c_sup!=INFINITY)) return false;
     else if ((a->itv_inf!=INFINITY)||(a->itv_sup!=INFINITY)) return false;
-    else if (a->q != NULL) return false;
+    else if (a->l) return false;
     else return true;
 }
 static inline bool zonotope_aff_is_bottom(zonotope_internal_t* pr, zonotope_aff_t *a)
@@ -600,7 +637,7 @@ static inline bool zonotope_aff_is_bottom(zonotope_internal_t* pr, zonotope_aff_
     if (a == pr->bot) return true;
     else if ((-a->c_inf<=a->c_sup)) return false;
     else if (-a->itv_inf<=a->itv_sup) return false;
-    else if (a->q != NULL) return false;
+    else if (a->l) return false;
     else return true;
 }
 
@@ -624,7 +661,6 @@ static inline zonotope_aff_t* zonotope_aff_mul_scalar(zonotope_internal_t* pr, z
             int sgn = elina_scalar_sgn(lambda);
             zonotope_aff_t* dst = NULL;
             zonotope_aaterm_t *p,*q;
-            q = NULL;
             dst = zonotope_aff_alloc_init(pr);
             if(sgn>=0){
 		dst->c_inf = src->c_inf*lambda->val.dbl;
@@ -637,35 +673,17 @@ static inline zonotope_aff_t* zonotope_aff_mul_scalar(zonotope_internal_t* pr, z
                 //elina_scalar_free(add);
             }
             
-            if (src->q) {
-                dst->q = q = zonotope_aaterm_alloc_init();
-                for (p=src->q; p; p=p->n) {
-                    if(sgn>=0){
-			q->inf = p->inf * lambda->val.dbl;
-			q->sup = p->sup * lambda->val.dbl;
-                        //elina_scalar_mul(q->inf,p->inf,lambda,ELINA_SCALAR_DOUBLE);
-                        //elina_scalar_mul(q->sup,p->sup,lambda,ELINA_SCALAR_DOUBLE);
-                    }
-                    else{
-			q->sup = p->inf * -lambda->val.dbl;
-			q->inf = p->sup * -lambda->val.dbl;
-                        //elina_scalar_t * add = elina_scalar_alloc_set(tmp->sup);
-                        //elina_scalar_mul(q->sup,p->inf,lambda,ELINA_SCALAR_DOUBLE);
-                        //elina_scalar_mul(q->inf,p->sup,lambda,ELINA_SCALAR_DOUBLE);
-                        //elina_scalar_free(add);
-                    }
-                    
-                    q->pnsym = p->pnsym;
-                    if (p->n) {
-                        /* continue */
-                        q->n = zonotope_aaterm_alloc_init();
-                        q = q->n;
-                    } else {
-                        /* the last iteration */
-                        dst->end = q; 
-                    }
+            zonotope_aff_reserve(dst, src->l);
+            for (p=src->q, q=dst->q; p < src->q + src->l; p++, q++) {
+                if(sgn>=0){
+		    q->inf = p->inf * lambda->val.dbl;
+		    q->sup = p->sup * lambda->val.dbl;
                 }
-                
+                else{
+		    q->sup = p->inf * -lambda->val.dbl;
+		    q->inf = p->sup * -lambda->val.dbl;
+                }
+                q->pnsym = p->pnsym;
             }
             
             dst->l = src->l;
@@ -709,7 +727,8 @@ static inline void elina_interval_abs_double(elina_interval_t *a, double inf, do
 static inline void zonotope_aff_cons_eq_lambda(zonotope_internal_t* pr, elina_interval_t** res, zonotope_aff_t* x, zonotope_aff_t* cons, zonotope_t *z)
 {
     zonotope_aaterm_t *p, *q;
-    p = q = NULL;
+    zonotope_aaterm_t *p_end = cons->q + cons->l;
+    zonotope_aaterm_t *q_end = x->q + x->l;
    
     obj** array = NULL;
     if (cons->l + x->l > pr->dim)  array = (obj**)calloc(pr->dim,sizeof(obj*)); 
@@ -726,8 +745,8 @@ static inline void zonotope_aff_cons_eq_lambda(zonotope_internal_t* pr, elina_in
     elina_interval_t *dim_itv = elina_interval_alloc();
     elina_dim_t dim;
     
-    for (p=cons->q, q=x->q; p || q;) {
-	if (p && q) {
+    for (p=cons->q, q=x->q; p < p_end || q < q_end;) {
+	if (p < p_end && q < q_end) {
 	    if (p->pnsym->index == q->pnsym->index) {
 		
 		if((p->inf!=0) || (p->sup!=0)) {
@@ -763,8 +782,8 @@ static inline void zonotope_aff_cons_eq_lambda(zonotope_internal_t* pr, elina_in
 		    //}
 		    i++;
 		}
-		p = p->n ;
-		q = q->n ;
+		p++;
+		q++;
 	    } else if (p->pnsym->index < q->pnsym->index) {
 		
 		array[i] = (obj*)calloc(1,sizeof(obj));
@@ -787,11 +806,11 @@ static inline void zonotope_aff_cons_eq_lambda(zonotope_internal_t* pr, elina_in
 		}
 		elina_interval_set_double(array[i]->itv,0,0);
 		i++;
-		p = p->n ;
+		p++;
 	    } else {
-		q = q->n ;
+		q++;
 	    }
-	} else if (p) {
+	} else if (p < p_end) {
 	    
 	    array[i] = (obj*)calloc(1,sizeof(obj));
 	    array[i]->coeff = elina_interval_alloc();
@@ -813,7 +832,7 @@ static inline void zonotope_aff_cons_eq_lambda(zonotope_internal_t* pr, elina_in
 	    }
 	    elina_interval_set_double(array[i]->itv,0,0);
 	    i++;
-	    p = p->n ;
+	    p++;
 	} else {
 	    
 	    break;
@@ -969,7 +988,7 @@ static inline elina_linexpr0_t * elina_linexpr0_from_zonotope(zonotope_internal_
 	uint_t k = 0;
 	elina_dim_t dim;
 	zonotope_aaterm_t *p;
-	for(p=aff->q; p; p=p->n){
+	for(p=aff->q; p < aff->q + aff->l; p++){
 		elina_coeff_init(&res->p.linterm[k].coeff, ELINA_COEFF_SCALAR);
 		elina_coeff_set_interval_double(&res->p.linterm[k].coeff, -p->inf,p->sup);
 		/* update a->abs with new constrained noise symbols */
@@ -986,7 +1005,7 @@ static inline elina_linexpr0_t * elina_linexpr0_from_zonotope(zonotope_internal_
 /* reduce the center and coefficients of the central part (C) to smaller intervals and add a new noise symbol */
 static inline bool zonotope_aff_reduce(zonotope_internal_t* pr, zonotope_aff_t *expr)
 {
-    zonotope_aaterm_t *p,*t;
+    zonotope_aaterm_t *p;
     double eps = 0.0;
     double err = 0.0;
     //elina_scalar_t *eps = elina_scalar_alloc();
@@ -1020,14 +1039,11 @@ static inline bool zonotope_aff_reduce(zonotope_internal_t* pr, zonotope_aff_t *
 	    sum_inf = sum_inf + dev_inf;
 	    sum_sup = sum_sup + dev_sup;
 	}
-	for(p = expr->q; p; p=p->n) {
+	for(p = expr->q; p < expr->q + expr->l; p++) {
 	    if ((p->inf==INFINITY) || (p->sup==INFINITY)) {
 		if ((p->inf==INFINITY) && (p->sup==INFINITY)) {
 		    /* reduce to top */
-		    if (expr->q) zonotope_aaterm_list_free(pr, expr->q);
-		    expr->q = NULL;
-		    expr->end = NULL;
-		    expr->l = 0;
+		    zonotope_aff_clear_terms(expr);
 		    expr->c_inf = INFINITY;
 		    expr->c_sup = INFINITY;
 		    expr->itv_inf = INFINITY;
@@ -1071,13 +1087,9 @@ static inline bool zonotope_aff_is_eq(zonotope_internal_t* pr, zonotope_aff_t *z
     else if ((z1->c_inf!= z2->c_inf) || (z1->c_sup!=z2->c_sup)) return false;
     else {
 	zonotope_aaterm_t *p, *q;
-	for (p=z1->q, q=z2->q; p && q;) {
+	for (p=z1->q, q=z2->q; p < z1->q + z1->l; p++, q++) {
 	    if (p->pnsym != q->pnsym) return false;
 	    else if ((p->inf!=q->inf) || (p->sup!=q->sup)) return false;
-	    else {
-		p = p->n;
-		q = q->n;
-	    }
 	}
 	return true;
     }
@@ -1207,6 +1219,8 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
     elina_interval_t *argminpq = elina_interval_alloc();
 
     zonotope_aaterm_t *p, *q, *ptr;
+    zonotope_aaterm_t *p_end = exp1->q + exp1->l;
+    zonotope_aaterm_t *q_end = exp2->q + exp2->l;
     res->itv_inf = fmax(exp1->itv_inf,exp2->itv_inf);
     res->itv_sup = fmax(exp1->itv_sup,exp2->itv_sup);
     //elina_scalar_min(res->itv->inf,exp1->itv->inf,exp2->itv->inf);
@@ -1214,12 +1228,17 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
     ptr = NULL;
     int s = 0;
 
-    if (exp1->q || exp2->q) {
+    if (exp1->l || exp2->l) {
 	elina_interval_set_double(c1, -exp1->c_inf,exp1->c_sup);
 	elina_interval_set_double(c2, -exp2->c_inf, exp2->c_sup);
-	ptr = zonotope_aaterm_alloc_init();
-	for(p = exp1->q, q = exp2->q; p || q;) {
-	    if (p && q) {
+	/* the terms of res are written in place, at most one per term of exp1 or exp2 */
+	zonotope_aff_reserve(res, exp1->l + exp2->l);
+	ptr = res->q;
+	ptr->pnsym = NULL;
+	ptr->inf = 0;
+	ptr->sup = 0;
+	for(p = exp1->q, q = exp2->q; p < p_end || q < q_end;) {
+	    if (p < p_end && q < q_end) {
 		if (p->pnsym->index == q->pnsym->index) {
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv1->inf->val.dbl, &nsymItv1->sup->val.dbl, p->pnsym->index, z1);
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv2->inf->val.dbl, &nsymItv2->sup->val.dbl, p->pnsym->index, z2);
@@ -1253,8 +1272,8 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 			    elina_interval_set_double(pmptr,p->inf, p->sup);
 			}
 		    }
-		    p = p->n ;
-		    q = q->n ;
+		    p++;
+		    q++;
 		} else if (p->pnsym->index < q->pnsym->index) {
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv1->inf->val.dbl, &nsymItv1->sup->val.dbl, p->pnsym->index, z1);
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv2->inf->val.dbl, &nsymItv2->sup->val.dbl, p->pnsym->index, z2);
@@ -1266,7 +1285,7 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 			elina_interval_set_double(qmptr,0,0);
 		    }
 		    zonotope_delete_constrained_noise_symbol(pr, p->pnsym->index, z3);
-		    p = p->n;
+		    p++;
 		} else {
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv1->inf->val.dbl, &nsymItv1->sup->val.dbl, q->pnsym->index, z1);
 		    zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv2->inf->val.dbl, &nsymItv2->sup->val.dbl, q->pnsym->index, z2);
@@ -1278,9 +1297,9 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 			elina_interval_set_double(pmptr,0,0);
 		    }
 		    zonotope_delete_constrained_noise_symbol(pr, q->pnsym->index, z3);
-		    q = q->n;
+		    q++;
 		}
-	    } else if (p) {
+	    } else if (p < p_end) {
 		zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv1->inf->val.dbl, &nsymItv1->sup->val.dbl, p->pnsym->index, z1);
 		zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv2->inf->val.dbl, &nsymItv2->sup->val.dbl, p->pnsym->index, z2);
 		if (p->pnsym->type == UN) {
@@ -1296,7 +1315,7 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 		    elina_interval_set_double(qmptr,0,0);
 		}
 		zonotope_delete_constrained_noise_symbol(pr, p->pnsym->index, z3);
-		p = p->n;
+		p++;
 	    } else {
 		zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv1->inf->val.dbl, &nsymItv1->sup->val.dbl, q->pnsym->index, z1);
 		zonotope_noise_symbol_cons_get_gamma(pr, &nsymItv2->inf->val.dbl, &nsymItv2->sup->val.dbl, q->pnsym->index, z2);
@@ -1308,7 +1327,7 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 		    elina_interval_set_double(pmptr,0,0);
 		}
 		zonotope_delete_constrained_noise_symbol(pr, q->pnsym->index, z3);
-		q = q->n;
+		q++;
 	    }
 	    elina_double_interval_mul(&tmp1->inf->val.dbl, &tmp1->sup->val.dbl, nsymItv1->inf->val.dbl, nsymItv1->sup->val.dbl, pmptr->inf->val.dbl, pmptr->sup->val.dbl);
 	    elina_interval_add(c1, c1, tmp1, ELINA_SCALAR_DOUBLE);
@@ -1316,23 +1335,15 @@ static inline zonotope_aff_t * zonotope_aff_join_constrained6(zonotope_internal_
 	    elina_interval_add(c2, c2, tmp2, ELINA_SCALAR_DOUBLE);
 	    elina_interval_set_double(pmptr,0,0);
 	    elina_interval_set_double(qmptr,0,0);
-	    if ((ptr->inf==0) && (ptr->sup==0)) {
-		if (!(p||q)) {
-		    /* the last iteration */
-		    zonotope_aaterm_free(pr, ptr);
-		    if (res->end) res->end->n = NULL;
-		}
-	    } else {
+	    if ((ptr->inf!=0) || (ptr->sup!=0)) {
 		/* keep this term */
-		if (!res->q) res->q = ptr;
-		res->end = ptr;
 		res->l++;
-		if (p||q) {
+		if (p < p_end || q < q_end) {
 		    /* continuing */
-		    ptr->n = zonotope_aaterm_alloc_init();
-		    ptr=ptr->n;
-		} else {
-		    /* the last iteration */
+		    ptr++;
+		    ptr->pnsym = NULL;
+		    ptr->inf = 0;
+		    ptr->sup = 0;
 		}
 	    }
 	}
@@ -1530,10 +1541,11 @@ static inline void zonotope_internal_free(zonotope_internal_t* pr)
 	zonotope_aff_free(pr, pr->top);
 	zonotope_aff_free(pr, pr->bot);
 	
-	for (i=0;i<pr->dim;i++) free(pr->epsilon[i]);
+	for (i=0;i<ZONOTOPE_NSYM_NUM_BLOCKS;i++) {
+	    free(pr->epsilon[i]);
+	    pr->epsilon[i] = NULL;
+	}
 	pr->dim = (uint_t)0;
-	free(pr->epsilon);
-	pr->epsilon= NULL;
 	pr->funid = ELINA_FUNID_UNKNOWN;
 	pr->man = NULL;
 	elina_abstract0_free(pr->manNS, pr->nsymhypercube);
@@ -1550,8 +1562,10 @@ static inline void zonotope_internal_free(zonotope_internal_t* pr)
 	elina_dimchange_free(pr->dimchange);
 	pr->dimchange = NULL;
 	pr->it = 0;
-	free(pr->inputns);
+	elina_thread_pool_free(pr->pool);
+	pr->pool = NULL;
 	free(pr);
+	zonotope_aaterm_pool_release();
     }
 }
 
@@ -1560,6 +1574,7 @@ static inline zonotope_internal_t* zonotope_internal_alloc(elina_manager_t* manN
 {
     //CALL();
     zonotope_internal_t* pr = (zonotope_internal_t*)malloc(sizeof(zonotope_internal_t));
+    zonotope_aaterm_pool_acquire();
     //pr->itv = elina_internal_alloc();
     pr->dim = 0;
     pr->funid = ELINA_FUNID_UNKNOWN;
@@ -1574,7 +1589,7 @@ static inline zonotope_internal_t* zonotope_internal_alloc(elina_manager_t* manN
     elina_scalar_set_double(pr->ap_muu->sup, (double)1.0);
     //ap_interval_set_itv(pr->itv, pr->ap_muu, pr->muu);
     pr->moo = elina_lincons0_array_make(2);
-    pr->epsilon = (zonotope_noise_symbol_t**)calloc(1024, sizeof(zonotope_noise_symbol_t*));	/* starts with a limit of 1024 noise symbols */
+    memset(pr->epsilon, 0, sizeof(pr->epsilon));	/* the blocks are allocated when their first index is reserved */
     pr->top = zonotope_aff_top(pr);
     pr->bot = zonotope_aff_bottom(pr);
     pr->nsymhypercube = elina_abstract0_top(pr->manNS, 0,0);
@@ -1594,9 +1609,9 @@ static inline zonotope_internal_t* zonotope_internal_alloc(elina_manager_t* manN
     /* 0 <= eps + 1 */
     pr->moo.p[1] = elina_lincons0_make(ELINA_CONS_SUPEQ, nspone, NULL);
 
-    pr->inputns = (uint_t*)calloc(1024, sizeof(uint_t));	/* starts with a limit of 1024 noise symbols */
-    pr->epssize = 0;
     pr->it = 0;
+    pr->pool = NULL;
+    pr->max_gen = 0;
     return pr;
 }
 
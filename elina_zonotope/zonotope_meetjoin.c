@@ -64,7 +64,7 @@ zonotope_t* zonotope_meet_lincons_array(elina_manager_t* man, bool destructive,
 			
 			is_bottom = true;
 			break;
-		    } else if (res->paf[i]->q == NULL) {
+		    } else if (res->paf[i]->l == 0) {
 			
 			zonotope_aff_check_free(pr, res->paf[i]);
 			res->paf[i] = zonotope_aff_alloc_init(pr);
@@ -123,7 +123,7 @@ zonotope_t* zonotope_meet_lincons_array(elina_manager_t* man, bool destructive,
         //printf("dimension2: %d %d\n",dimension2.intdim,dimension2.realdim);
         //fflush(stdout);
         
-	    if (aff[i]->q != NULL) {
+	    if (aff[i]->l != 0) {
 		/* only the centers are involved in this constraint, already treated while updating res->box */
 		
 		
@@ -167,7 +167,7 @@ zonotope_t* zonotope_meet_lincons_array(elina_manager_t* man, bool destructive,
 		zonotope_aff_t* tmp, *tmp1;
 		size_t j = 0;
 		for (j=0; j<res->dims; j++) {
-		    if (res->paf[j]->q) {
+		    if (res->paf[j]->l) {
 			
 			zonotope_aff_cons_eq_lambda(pr, &dummy, res->paf[j], aff[i], res);
 			tmp = zonotope_aff_mul_itv(pr, aff[i], dummy);
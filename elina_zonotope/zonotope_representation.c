@@ -216,7 +216,7 @@ void zonotope_fprint(FILE* stream,
     elina_dim_t dim = 0;
     for (i=0; i<size; i++) {
 	name_of_ns[i] = (char*)malloc(10*sizeof(char));
-	pr->epsilon[z->nsymcons[i]]->type == IN ? sprintf(name_of_ns[i], "eps%d", z->nsymcons[i]) : sprintf(name_of_ns[i], "eta%d", z->nsymcons[i]);
+	zonotope_noise_symbol_get(pr, z->nsymcons[i])->type == IN ? sprintf(name_of_ns[i], "eps%d", z->nsymcons[i]) : sprintf(name_of_ns[i], "eta%d", z->nsymcons[i]);
     }
     elina_abstract0_fprint(stream, pr->manNS, z->abs, name_of_ns);
     for (i=0; i<size; i++) free(name_of_ns[i]);
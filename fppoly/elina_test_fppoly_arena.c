@@ -0,0 +1,105 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Peak memory of the back-substitution arenas against the depth of the network:
+   analyses random ReLU networks of the same width and increasing depth, as a
+   chain and with residual blocks, and checks that the largest number of bytes
+   an arena held does not grow with the number of layers back-substituted
+   through. */
+
+#include <stdio.h>
+#include "fppoly_arena.h"
+#include "elina_test_fppoly_network.h"
+
+#define NUM_PIXELS 64
+#define NUM_HIDDEN 64
+#define NUM_OUTPUTS 10
+/* the peak of the deepest networks may exceed the one of the shallowest by this factor */
+#define MAX_GROWTH 1.5
+
+static void add_relu_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_in, bool first){
+	double **weights = random_weights(NUM_HIDDEN, num_in);
+	double *bias = random_bias(NUM_HIDDEN);
+	if(first){
+		ffn_handle_first_relu_layer(man, element, weights, bias, NUM_HIDDEN, num_in);
+	}
+	else{
+		ffn_handle_intermediate_relu_layer(man, element, weights, bias, NUM_HIDDEN, num_in);
+	}
+	free_weights(weights, bias, NUM_HIDDEN);
+}
+
+/* largest number of bytes an arena held while analysing a network with num_layers hidden layers, with residual,
+   every two of them after the first are summed with the output of the layer before them */
+static size_t network_arena_peak(size_t num_layers, bool residual){
+	elina_manager_t *man = fppoly_manager_alloc();
+	double inf[NUM_PIXELS], sup[NUM_PIXELS];
+	size_t i, k;
+	random_input_box(inf, sup, NUM_PIXELS, 0.01);
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, NUM_PIXELS, inf, sup);
+	fppoly_arena_reset_peak();
+	add_relu_layer(man, element, NUM_PIXELS, true);
+	/* number of layers added so far, the output of the last one is predecessor k */
+	k = 1;
+	while(k < num_layers){
+		if(residual && k + 3 <= num_layers){
+			size_t predecessors[2] = {k, k + 2};
+			add_relu_layer(man, element, NUM_HIDDEN, false);
+			add_relu_layer(man, element, NUM_HIDDEN, false);
+			handle_residual_relu_layer(man, element, NUM_HIDDEN, predecessors, 2);
+			k += 3;
+		}
+		else{
+			add_relu_layer(man, element, NUM_HIDDEN, false);
+			k++;
+		}
+	}
+	double **weights = random_weights(NUM_OUTPUTS, NUM_HIDDEN);
+	double *bias = random_bias(NUM_OUTPUTS);
+	ffn_handle_last_relu_layer(man, element, weights, bias, NUM_OUTPUTS, NUM_HIDDEN, false);
+	free_weights(weights, bias, NUM_OUTPUTS);
+	for(i=1; i < NUM_OUTPUTS; i++){
+		is_greater(man, element, 0, (elina_dim_t)i);
+	}
+	size_t res = fppoly_arena_get_peak();
+	elina_abstract0_free(man, element);
+	elina_manager_free(man);
+	return res;
+}
+
+
+int main(void){
+	size_t depths[4] = {2, 4, 8, 16};
+	size_t peak_chain[4], peak_residual[4];
+	size_t d;
+	int res = 0;
+	srand(0);
+	printf("%8s %14s %14s\n", "layers", "peak chain", "peak residual");
+	for(d=0; d < 4; d++){
+		peak_chain[d] = network_arena_peak(depths[d], false);
+		peak_residual[d] = network_arena_peak(depths[d], true);
+		printf("%8zu %14zu %14zu\n", depths[d], peak_chain[d], peak_residual[d]);
+		if(peak_chain[d] > MAX_GROWTH*peak_chain[0] || peak_residual[d] > MAX_GROWTH*peak_residual[0]){
+			printf("%8zu the peak of the arenas grows with the number of layers\n", depths[d]);
+			res = 1;
+		}
+	}
+	return res;
+}
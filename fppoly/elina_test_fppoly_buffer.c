@@ -0,0 +1,115 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* The ffn entry points reading weight buffers in place against the ones taking double **: a random
+   ReLU network read from row-major buffers with padded rows and from column-major buffers must give
+   the same bounds for every neuron and prove the same outputs with is_greater as read from rows of
+   doubles, and read from float32 buffers the same as from rows of its weights rounded to float. */
+
+#include <stdio.h>
+#include "elina_test_fppoly_network.h"
+
+#define NUM_LAYERS 5
+#define NUM_OUTPUTS 10
+#define NUM_THREADS 3
+/* the rows of the row-major buffers and the columns of the column-major ones are padded by this many entries */
+#define PADDING 3
+
+/* the weights of layer l of net in a buffer of dtype with leading dimension *ld, and its bias in *bias */
+static void * layer_buffer(network_t *net, size_t l, fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype,
+			   size_t *ld, void **bias){
+	size_t num_out = net->dims[l+1], num_in = net->dims[l];
+	size_t size = dtype==FPPOLY_WEIGHTS_FLOAT32 ? sizeof(float) : sizeof(double);
+	size_t i, j;
+	*ld = (layout==FPPOLY_ROW_MAJOR ? num_in : num_out) + PADDING;
+	char *res = (char *)calloc(num_in*num_out + PADDING*(layout==FPPOLY_ROW_MAJOR ? num_out : num_in), size);
+	*bias = malloc(num_out*size);
+	for(i=0; i < num_out; i++){
+		for(j=0; j < num_in; j++){
+			size_t k = layout==FPPOLY_ROW_MAJOR ? i*(*ld) + j : j*(*ld) + i;
+			if(dtype==FPPOLY_WEIGHTS_FLOAT32){
+				((float *)res)[k] = (float)net->weights[l][i][j];
+			}
+			else{
+				((double *)res)[k] = net->weights[l][i][j];
+			}
+		}
+		if(dtype==FPPOLY_WEIGHTS_FLOAT32){
+			((float *)*bias)[i] = (float)net->bias[l][i];
+		}
+		else{
+			((double *)*bias)[i] = net->bias[l][i];
+		}
+	}
+	return res;
+}
+
+/* number of differences between the analyses of net from rows of doubles and from buffers */
+static size_t compare_buffers(elina_manager_t *man, network_t *net, fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype){
+	void *weights[NUM_LAYERS], *bias[NUM_LAYERS];
+	size_t l, ld;
+	elina_abstract0_t *rows = network_analyze(man, net);
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, net->dims[0], net->inf, net->sup);
+	for(l=0; l < NUM_LAYERS; l++){
+		weights[l] = layer_buffer(net, l, layout, dtype, &ld, &bias[l]);
+		if(l==0){
+			ffn_handle_first_layer_buffer(man, element, weights[l], bias[l], ld, layout, dtype, net->dims[l+1], net->dims[l], RELU);
+		}
+		else if(l + 1 < NUM_LAYERS){
+			ffn_handle_intermediate_layer_buffer(man, element, weights[l], bias[l], ld, layout, dtype, net->dims[l+1], net->dims[l], RELU);
+		}
+		else{
+			ffn_handle_last_layer_buffer(man, element, weights[l], bias[l], ld, layout, dtype, net->dims[l+1], net->dims[l], false, RELU);
+		}
+	}
+	size_t res = element_num_differences(man, rows, element, NUM_OUTPUTS);
+	elina_abstract0_free(man, rows);
+	elina_abstract0_free(man, element);
+	for(l=0; l < NUM_LAYERS; l++){
+		free(weights[l]);
+		free(bias[l]);
+	}
+	return res;
+}
+
+int main(void){
+	size_t dims[NUM_LAYERS+1] = {30, 40, 40, 40, 40, NUM_OUTPUTS};
+	size_t l, i, j, res = 0;
+	srand(0);
+	network_t *net = network_alloc(NUM_LAYERS, dims, 0.02);
+	elina_manager_t *man = fppoly_manager_alloc();
+	fppoly_manager_set_num_threads(man, NUM_THREADS);
+	size_t row_major = compare_buffers(man, net, FPPOLY_ROW_MAJOR, FPPOLY_WEIGHTS_FLOAT64);
+	size_t column_major = compare_buffers(man, net, FPPOLY_COLUMN_MAJOR, FPPOLY_WEIGHTS_FLOAT64);
+	for(l=0; l < NUM_LAYERS; l++){
+		for(i=0; i < dims[l+1]; i++){
+			for(j=0; j < dims[l]; j++){
+				net->weights[l][i][j] = (float)net->weights[l][i][j];
+			}
+			net->bias[l][i] = (float)net->bias[l][i];
+		}
+	}
+	size_t single = compare_buffers(man, net, FPPOLY_ROW_MAJOR, FPPOLY_WEIGHTS_FLOAT32);
+	printf("differences with the rows: %zu row-major, %zu column-major, %zu float32\n", row_major, column_major, single);
+	res = row_major + column_major + single;
+	elina_manager_free(man);
+	network_free(net);
+	return res!=0;
+}
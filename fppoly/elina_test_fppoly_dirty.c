@@ -0,0 +1,346 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* fppoly_propagate_dirty_neurons against a new analysis of the network with the same updated bounds.
+   Updating neurons of a hidden layer with their own bounds must leave the analysis unchanged. Once
+   they are tightened, every neuron after them must get the bounds of the new analysis intersected
+   with its previous ones, except the ReLU neurons already decided to output 0, which keep theirs,
+   and is_greater must prove the same outputs. This is checked on a random ReLU network and on a
+   network of a convolutional layer followed by a strided maxpool with SAME padding, whose implicit
+   and explicit convolutions must give the same analysis, sound on samples of its input box. */
+
+#include <stdio.h>
+#include <math.h>
+#include "elina_test_fppoly_network.h"
+
+#define NUM_OUTPUTS 10
+#define NUM_SAMPLES 5000
+/* the tightened bounds of a neuron drop this fraction of its interval on each side */
+#define SHRINK 0.3
+#define MAX_UPDATES 64
+#define TOLERANCE 1e-9
+
+/* a 9x9x2 image, a 3x3 convolution of 4 filters with VALID padding and a ReLU, a 3x3 maxpool of
+   strides 2 with SAME padding and an affine layer of NUM_OUTPUTS neurons */
+typedef struct conv_network_t{
+	size_t input_size[3];
+	size_t filter_size[2];
+	size_t num_filters;
+	size_t conv_strides[2];
+	size_t conv_size[3];
+	size_t pool_size[3];
+	size_t pool_strides[2];
+	size_t pool_output_size[3];
+	long int pad_top;
+	long int pad_left;
+	double *filter_weights;
+	double *filter_bias;
+	double **weights;
+	double *bias;
+	double *inf;
+	double *sup;
+}conv_network_t;
+
+/* adds layer l of the network net to element */
+typedef void (*add_layer_t)(elina_manager_t *man, elina_abstract0_t *element, void *net, size_t l);
+
+typedef struct update_t{
+	size_t layerno;
+	size_t num;
+	size_t neurons[MAX_UPDATES];
+	double lb[MAX_UPDATES];
+	double ub[MAX_UPDATES];
+}update_t;
+
+static void add_ffn_layer(elina_manager_t *man, elina_abstract0_t *element, void *net, size_t l){
+	network_add_layer(man, element, (network_t *)net, l);
+}
+
+static conv_network_t * conv_network_alloc(void){
+	conv_network_t *net = (conv_network_t *)malloc(sizeof(conv_network_t));
+	size_t num_pixels, num_weights, i;
+	net->input_size[0] = 9;
+	net->input_size[1] = 9;
+	net->input_size[2] = 2;
+	net->filter_size[0] = 3;
+	net->filter_size[1] = 3;
+	net->num_filters = 4;
+	net->conv_strides[0] = 1;
+	net->conv_strides[1] = 1;
+	elina_nn_conv_geometry(net->conv_size, NULL, NULL, net->input_size, net->filter_size, net->num_filters, net->conv_strides, true);
+	net->pool_size[0] = 3;
+	net->pool_size[1] = 3;
+	net->pool_size[2] = 1;
+	net->pool_strides[0] = 2;
+	net->pool_strides[1] = 2;
+	elina_nn_conv_geometry(net->pool_output_size, &net->pad_top, &net->pad_left, net->conv_size, net->pool_size,
+			       net->conv_size[2], net->pool_strides, false);
+	num_pixels = net->input_size[0]*net->input_size[1]*net->input_size[2];
+	num_weights = net->filter_size[0]*net->filter_size[1]*net->input_size[2]*net->num_filters;
+	net->filter_weights = (double *)malloc(num_weights*sizeof(double));
+	for(i=0; i < num_weights; i++){
+		net->filter_weights[i] = random_double()/sqrt((double)(num_weights/net->num_filters));
+	}
+	net->filter_bias = random_bias(net->num_filters);
+	net->weights = random_weights(NUM_OUTPUTS, net->pool_output_size[0]*net->pool_output_size[1]*net->pool_output_size[2]);
+	net->bias = random_bias(NUM_OUTPUTS);
+	net->inf = (double *)malloc(num_pixels*sizeof(double));
+	net->sup = (double *)malloc(num_pixels*sizeof(double));
+	random_input_box(net->inf, net->sup, num_pixels, 0.05);
+	return net;
+}
+
+static void conv_network_free(conv_network_t *net){
+	free(net->filter_weights);
+	free(net->filter_bias);
+	free_weights(net->weights, net->bias, NUM_OUTPUTS);
+	free(net->inf);
+	free(net->sup);
+	free(net);
+}
+
+static void add_conv_layer(elina_manager_t *man, elina_abstract0_t *element, void *net, size_t l){
+	conv_network_t *cn = (conv_network_t *)net;
+	if(l==0){
+		conv_handle_first_layer(man, element, cn->filter_weights, cn->filter_bias, cn->input_size, cn->filter_size,
+					cn->num_filters, cn->conv_strides, true, true);
+	}
+	else if(l==1){
+		handle_maxpool_layer_strided(man, element, cn->pool_size, cn->conv_size, cn->pool_strides, 3, false);
+	}
+	else{
+		ffn_handle_last_relu_layer(man, element, cn->weights, cn->bias, NUM_OUTPUTS,
+					   cn->pool_output_size[0]*cn->pool_output_size[1]*cn->pool_output_size[2], false);
+	}
+}
+
+/* conv[i], pool[i] and out[i] receive the neurons of the layers of net for the input x, before their activation */
+static void conv_network_eval(conv_network_t *net, double *x, double *conv, double *pool, double *out){
+	size_t *in = net->input_size, *cs = net->conv_size, *ps = net->pool_output_size;
+	size_t num_pool = ps[0]*ps[1]*ps[2];
+	size_t out_x, out_y, out_z, x_shift, y_shift, inp_z, i, j;
+	for(out_x=0; out_x < cs[0]; out_x++){
+		for(out_y=0; out_y < cs[1]; out_y++){
+			for(out_z=0; out_z < cs[2]; out_z++){
+				double sum = net->filter_bias[out_z];
+				for(x_shift=0; x_shift < net->filter_size[0]; x_shift++){
+					for(y_shift=0; y_shift < net->filter_size[1]; y_shift++){
+						for(inp_z=0; inp_z < in[2]; inp_z++){
+							size_t w = ((x_shift*net->filter_size[1] + y_shift)*in[2] + inp_z)*net->num_filters + out_z;
+							size_t p = (out_x + x_shift)*in[1]*in[2] + (out_y + y_shift)*in[2] + inp_z;
+							sum += net->filter_weights[w]*x[p];
+						}
+					}
+				}
+				conv[(out_x*cs[1] + out_y)*cs[2] + out_z] = sum;
+			}
+		}
+	}
+	for(out_x=0; out_x < ps[0]; out_x++){
+		for(out_y=0; out_y < ps[1]; out_y++){
+			for(out_z=0; out_z < ps[2]; out_z++){
+				double max = -INFINITY;
+				for(x_shift=0; x_shift < net->pool_size[0]; x_shift++){
+					long int x_val = out_x*net->pool_strides[0] + x_shift - net->pad_top;
+					for(y_shift=0; y_shift < net->pool_size[1]; y_shift++){
+						long int y_val = out_y*net->pool_strides[1] + y_shift - net->pad_left;
+						if(x_val >= 0 && x_val < (long int)cs[0] && y_val >= 0 && y_val < (long int)cs[1]){
+							max = fmax(max, fmax(conv[(x_val*cs[1] + y_val)*cs[2] + out_z], 0));
+						}
+					}
+				}
+				pool[(out_x*ps[1] + out_y)*ps[2] + out_z] = max;
+			}
+		}
+	}
+	for(i=0; i < NUM_OUTPUTS; i++){
+		out[i] = net->bias[i];
+		for(j=0; j < num_pool; j++){
+			out[i] += net->weights[i][j]*pool[j];
+		}
+	}
+}
+
+/* element analysing the num_layers layers of net for the input box inf, sup, the bounds of update are set
+   once its layer is added */
+static elina_abstract0_t * analyze(elina_manager_t *man, add_layer_t add_layer, void *net, size_t num_layers,
+				   size_t num_pixels, double *inf, double *sup, update_t *update){
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, num_pixels, inf, sup);
+	size_t l, u;
+	for(l=0; l < num_layers; l++){
+		add_layer(man, element, net, l);
+		if(update!=NULL && l==update->layerno){
+			for(u=0; u < update->num; u++){
+				update_bounds_for_neuron(man, element, l, update->neurons[u], update->lb[u], update->ub[u]);
+			}
+		}
+	}
+	return element;
+}
+
+/* the neurons of layer layerno of element with both signs, at most max_num of them, with their bounds */
+static void unstable_neurons(elina_abstract0_t *element, size_t layerno, size_t max_num, update_t *update){
+	layer_t *layer = ((fppoly_t *)element->value)->layers[layerno];
+	size_t i;
+	update->layerno = layerno;
+	update->num = 0;
+	for(i=0; i < layer->dims && update->num < max_num; i++){
+		neuron_t *neuron = layer->neurons[i];
+		if(neuron->lb > 0 && neuron->ub > 0){
+			update->neurons[update->num] = i;
+			update->lb[update->num] = -neuron->lb;
+			update->ub[update->num] = neuron->ub;
+			update->num++;
+		}
+	}
+}
+
+/* number of neurons of element, updated by update and propagated, whose bounds are not those of reference,
+   analysed with update, intersected with the ones of original, analysed without it, and of the pairs of the
+   num_outputs outputs on which is_greater differs between element and reference */
+static size_t num_propagation_errors(elina_manager_t *man, elina_abstract0_t *element, elina_abstract0_t *reference,
+				     elina_abstract0_t *original, size_t num_outputs){
+	fppoly_t *fp = (fppoly_t *)element->value;
+	fppoly_t *fr = (fppoly_t *)reference->value;
+	fppoly_t *fo = (fppoly_t *)original->value;
+	size_t res = 0, k, i;
+	elina_dim_t y, x;
+	for(k=0; k < fp->numlayers; k++){
+		for(i=0; i < fp->layers[k]->dims; i++){
+			neuron_t *n = fp->layers[k]->neurons[i];
+			neuron_t *r = fr->layers[k]->neurons[i];
+			neuron_t *o = fo->layers[k]->neurons[i];
+			bool dead = fp->layers[k]->activation==RELU && o->ub<=0 && n->ub==o->ub;
+			if(dead ? n->lb!=o->lb : n->lb!=fmin(r->lb, o->lb) || n->ub!=fmin(r->ub, o->ub)){
+				res++;
+			}
+		}
+	}
+	for(y=0; y < num_outputs; y++){
+		for(x=0; x < num_outputs; x++){
+			if(x!=y && is_greater(man, element, y, x)!=is_greater(man, reference, y, x)){
+				res++;
+			}
+		}
+	}
+	return res;
+}
+
+/* number of errors of the propagation of updates of at most max_num unstable neurons of layer layerno of net */
+static size_t test_propagation(elina_manager_t *man, add_layer_t add_layer, void *net, size_t num_layers, size_t num_pixels,
+			       double *inf, double *sup, size_t layerno, size_t max_num){
+	elina_abstract0_t *original = analyze(man, add_layer, net, num_layers, num_pixels, inf, sup, NULL);
+	elina_abstract0_t *element = analyze(man, add_layer, net, num_layers, num_pixels, inf, sup, NULL);
+	update_t update;
+	size_t u, res;
+	unstable_neurons(original, layerno, max_num, &update);
+	for(u=0; u < update.num; u++){
+		update_bounds_for_neuron(man, element, layerno, update.neurons[u], update.lb[u], update.ub[u]);
+	}
+	fppoly_propagate_dirty_neurons(man, element);
+	res = element_num_differences(man, element, original, NUM_OUTPUTS);
+	for(u=0; u < update.num; u++){
+		double width = update.ub[u] - update.lb[u];
+		update.lb[u] += SHRINK*width;
+		update.ub[u] -= SHRINK*width;
+		update_bounds_for_neuron(man, element, layerno, update.neurons[u], update.lb[u], update.ub[u]);
+	}
+	size_t num_recomputed = fppoly_propagate_dirty_neurons(man, element);
+	elina_abstract0_t *reference = analyze(man, add_layer, net, num_layers, num_pixels, inf, sup, &update);
+	res += num_propagation_errors(man, element, reference, original, NUM_OUTPUTS);
+	res += update.num==0 || num_recomputed==0;
+	elina_abstract0_free(man, original);
+	elina_abstract0_free(man, element);
+	elina_abstract0_free(man, reference);
+	return res;
+}
+
+/* number of differences between the implicit and explicit convolutions and of neurons of samples outside of their bounds */
+static size_t test_conv_network(elina_manager_t *man, conv_network_t *net){
+	size_t num_pixels = net->input_size[0]*net->input_size[1]*net->input_size[2];
+	size_t num_conv = net->conv_size[0]*net->conv_size[1]*net->conv_size[2];
+	size_t num_pool = net->pool_output_size[0]*net->pool_output_size[1]*net->pool_output_size[2];
+	double *x = (double *)malloc(num_pixels*sizeof(double));
+	double *conv = (double *)malloc(num_conv*sizeof(double));
+	double *pool = (double *)malloc(num_pool*sizeof(double));
+	double out[NUM_OUTPUTS];
+	size_t s, i, k, res;
+	fppoly_manager_set_implicit_conv(man, true);
+	elina_abstract0_t *implicit = analyze(man, add_conv_layer, net, 3, num_pixels, net->inf, net->sup, NULL);
+	fppoly_manager_set_implicit_conv(man, false);
+	elina_abstract0_t *element = analyze(man, add_conv_layer, net, 3, num_pixels, net->inf, net->sup, NULL);
+	res = element_num_differences(man, implicit, element, NUM_OUTPUTS);
+	fppoly_t *fp = (fppoly_t *)element->value;
+	for(s=0; s < NUM_SAMPLES; s++){
+		for(i=0; i < num_pixels; i++){
+			double t = random_unit();
+			if(s%2){
+				t = t < 0.5 ? 0 : 1;
+			}
+			x[i] = net->inf[i] + t*(net->sup[i] - net->inf[i]);
+		}
+		conv_network_eval(net, x, conv, pool, out);
+		double *values[3] = {conv, pool, out};
+		for(k=0; k < 3; k++){
+			for(i=0; i < fp->layers[k]->dims; i++){
+				neuron_t *neuron = fp->layers[k]->neurons[i];
+				if(values[k][i] < -neuron->lb - TOLERANCE || values[k][i] > neuron->ub + TOLERANCE){
+					res++;
+				}
+			}
+		}
+	}
+	elina_abstract0_free(man, implicit);
+	elina_abstract0_free(man, element);
+	free(x);
+	free(conv);
+	free(pool);
+	return res;
+}
+
+int main(void){
+	size_t dims[7] = {30, 40, 40, 40, 40, 40, NUM_OUTPUTS};
+	size_t layers[3] = {0, 1, 3};
+	size_t threads[2] = {1, 3};
+	size_t t, l, res = 0;
+	srand(0);
+	network_t *net = network_alloc(6, dims, 0.03);
+	conv_network_t *conv_net = conv_network_alloc();
+	size_t num_pixels = conv_net->input_size[0]*conv_net->input_size[1]*conv_net->input_size[2];
+	for(t=0; t < 2; t++){
+		elina_manager_t *man = fppoly_manager_alloc();
+		fppoly_manager_set_num_threads(man, threads[t]);
+		for(l=0; l < 3; l++){
+			size_t errors = test_propagation(man, add_ffn_layer, net, 6, dims[0], net->inf, net->sup, layers[l], 3);
+			printf("%zu threads, ReLU network, updates of layer %zu: %zu errors\n", threads[t], layers[l], errors);
+			res += errors;
+		}
+		size_t errors = test_conv_network(man, conv_net);
+		printf("%zu threads, convolutional network: %zu errors\n", threads[t], errors);
+		res += errors;
+		errors = test_propagation(man, add_conv_layer, conv_net, 3, num_pixels, conv_net->inf, conv_net->sup, 0, MAX_UPDATES);
+		printf("%zu threads, convolutional network, updates of the convolution: %zu errors\n", threads[t], errors);
+		res += errors;
+		elina_manager_free(man);
+	}
+	network_free(net);
+	conv_network_free(conv_net);
+	return res!=0;
+}
@@ -0,0 +1,357 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Compares the float32 mode of fppoly with the double one: analyses the same
+   random networks in both modes and reports the memory held by the layers and
+   the time, what the float32 mode costs in the widths of the bounds of the
+   outputs and in the properties y > x proved, then checks that the bounds of
+   both modes contain the outputs of the networks on random points of the input
+   box. In float32, back-substitution reads the rows of the layers in place with
+   the float32 kernels. The relaxations of sigmoid and
+   tanh are not monotone in the bounds of their inputs: on such networks the
+   tiny changes of the bounds in float32 can widen or narrow the outputs by a
+   few percent, as the same changes of the input box would. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "fppoly.h"
+
+#define NUM_SAMPLES 1000
+#define NUM_OUTPUTS 10
+
+typedef struct test_layer_t{
+	bool is_conv;
+	activation_type_t activation;
+	size_t num_out;
+	size_t num_in;
+	/* FFN layers */
+	double **weights;
+	/* CONV layers, valid padding and strides 1 */
+	double *filter_weights;
+	size_t input_size[3];
+	size_t filter_size[2];
+	size_t num_filters;
+	double *bias;
+}test_layer_t;
+
+typedef struct test_network_t{
+	const char *name;
+	size_t num_pixels;
+	size_t num_layers;
+	test_layer_t layers[16];
+}test_network_t;
+
+typedef struct test_result_t{
+	double width;
+	size_t proved;
+	size_t bytes;
+	double time;
+	double *inf;
+	double *sup;
+}test_result_t;
+
+
+static double elapsed(struct timespec *start, struct timespec *end){
+	return (double)(end->tv_sec - start->tv_sec) + 1e-9*(double)(end->tv_nsec - start->tv_nsec);
+}
+
+static double random_double(void){
+	double r = rand();
+	return 2.0*(r/RAND_MAX) - 1.0;
+}
+
+static void add_ffn_layer(test_network_t *net, size_t num_out, activation_type_t activation){
+	test_layer_t *layer = net->layers + net->num_layers;
+	size_t num_in = net->num_layers==0 ? net->num_pixels : net->layers[net->num_layers-1].num_out;
+	double scale = 2.0/sqrt((double)num_in);
+	size_t i, j;
+	memset(layer, 0, sizeof(test_layer_t));
+	layer->activation = activation;
+	layer->num_out = num_out;
+	layer->num_in = num_in;
+	layer->weights = (double **)malloc(num_out*sizeof(double *));
+	layer->bias = (double *)malloc(num_out*sizeof(double));
+	for(i=0; i < num_out; i++){
+		layer->weights[i] = (double *)malloc(num_in*sizeof(double));
+		for(j=0; j < num_in; j++){
+			layer->weights[i][j] = scale*random_double();
+		}
+		layer->bias[i] = 0.1*random_double();
+	}
+	net->num_layers++;
+}
+
+static void add_conv_layer(test_network_t *net, size_t *input_size, size_t filter_size, size_t num_filters){
+	test_layer_t *layer = net->layers + net->num_layers;
+	size_t i, size = filter_size*filter_size*input_size[2]*num_filters;
+	double scale = 2.0/sqrt((double)(filter_size*filter_size*input_size[2]));
+	memset(layer, 0, sizeof(test_layer_t));
+	layer->is_conv = true;
+	layer->activation = RELU;
+	memcpy(layer->input_size, input_size, 3*sizeof(size_t));
+	layer->filter_size[0] = filter_size;
+	layer->filter_size[1] = filter_size;
+	layer->num_filters = num_filters;
+	layer->num_in = input_size[0]*input_size[1]*input_size[2];
+	layer->num_out = (input_size[0] - filter_size + 1)*(input_size[1] - filter_size + 1)*num_filters;
+	layer->filter_weights = (double *)malloc(size*sizeof(double));
+	layer->bias = (double *)malloc(num_filters*sizeof(double));
+	for(i=0; i < size; i++){
+		layer->filter_weights[i] = scale*random_double();
+	}
+	for(i=0; i < num_filters; i++){
+		layer->bias[i] = 0.1*random_double();
+	}
+	net->num_layers++;
+}
+
+static void network_free(test_network_t *net){
+	size_t k, i;
+	for(k=0; k < net->num_layers; k++){
+		test_layer_t *layer = net->layers + k;
+		if(layer->weights!=NULL){
+			for(i=0; i < layer->num_out; i++){
+				free(layer->weights[i]);
+			}
+			free(layer->weights);
+		}
+		free(layer->filter_weights);
+		free(layer->bias);
+	}
+}
+
+static double activation(activation_type_t activation, double x){
+	switch(activation){
+		case RELU:
+			return fmax(0, x);
+		case SIGMOID:
+			return 1/(1 + exp(-x));
+		case TANH:
+			return tanh(x);
+		default:
+			return x;
+	}
+}
+
+/* the outputs of the last layer of net, before its activation, on the input x */
+static void network_eval(test_network_t *net, double *x, double *res){
+	double *in = (double *)malloc(net->num_pixels*sizeof(double));
+	size_t k, i, j;
+	memcpy(in, x, net->num_pixels*sizeof(double));
+	for(k=0; k < net->num_layers; k++){
+		test_layer_t *layer = net->layers + k;
+		double *out = (double *)malloc(layer->num_out*sizeof(double));
+		if(layer->is_conv){
+			size_t out_w = layer->input_size[1] - layer->filter_size[1] + 1;
+			size_t iz = layer->input_size[2], nf = layer->num_filters;
+			for(i=0; i < layer->num_out; i++){
+				size_t f = i % nf, y = (i / nf) % out_w, row = i / (nf*out_w);
+				size_t dx, dy, z;
+				double sum = layer->bias[f];
+				for(dx=0; dx < layer->filter_size[0]; dx++){
+					for(dy=0; dy < layer->filter_size[1]; dy++){
+						for(z=0; z < iz; z++){
+							double w = layer->filter_weights[((dx*layer->filter_size[1] + dy)*iz + z)*nf + f];
+							sum += w*in[((row + dx)*layer->input_size[1] + y + dy)*iz + z];
+						}
+					}
+				}
+				out[i] = sum;
+			}
+		}
+		else{
+			for(i=0; i < layer->num_out; i++){
+				double sum = layer->bias[i];
+				for(j=0; j < layer->num_in; j++){
+					sum += layer->weights[i][j]*in[j];
+				}
+				out[i] = sum;
+			}
+		}
+		if(k + 1 < net->num_layers){
+			for(i=0; i < layer->num_out; i++){
+				out[i] = activation(layer->activation, out[i]);
+			}
+		}
+		free(in);
+		in = out;
+	}
+	memcpy(res, in, NUM_OUTPUTS*sizeof(double));
+	free(in);
+}
+
+static void network_analyze(elina_manager_t *man, test_network_t *net, double *inf, double *sup, test_result_t *res){
+	struct timespec start, end;
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, net->num_pixels, inf, sup);
+	size_t k, i, j;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(k=0; k < net->num_layers; k++){
+		test_layer_t *layer = net->layers + k;
+		if(layer->is_conv){
+			size_t strides[2] = {1, 1};
+			if(k==0){
+				conv_handle_first_layer(man, element, layer->filter_weights, layer->bias, layer->input_size, layer->filter_size,
+							layer->num_filters, strides, true, true);
+			}
+			else{
+				conv_handle_intermediate_relu_layer(man, element, layer->filter_weights, layer->bias, layer->input_size,
+								    layer->filter_size, layer->num_filters, strides, true, true);
+			}
+		}
+		else if(k + 1==net->num_layers){
+			ffn_handle_last_relu_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in, false);
+		}
+		else if(k==0){
+			if(layer->activation==RELU){
+				ffn_handle_first_relu_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+			}
+			else if(layer->activation==SIGMOID){
+				ffn_handle_first_sigmoid_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+			}
+			else{
+				ffn_handle_first_tanh_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+			}
+		}
+		else if(layer->activation==RELU){
+			ffn_handle_intermediate_relu_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+		}
+		else if(layer->activation==SIGMOID){
+			ffn_handle_intermediate_sigmoid_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+		}
+		else{
+			ffn_handle_intermediate_tanh_layer(man, element, layer->weights, layer->bias, layer->num_out, layer->num_in);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	res->time = elapsed(&start, &end);
+	res->proved = 0;
+	for(i=0; i < NUM_OUTPUTS; i++){
+		for(j=0; j < NUM_OUTPUTS; j++){
+			if(i!=j && is_greater(man, element, (elina_dim_t)i, (elina_dim_t)j)){
+				res->proved++;
+			}
+		}
+	}
+	res->bytes = fppoly_resident_bytes(man, element);
+	elina_interval_t **box = box_for_layer(man, element, net->num_layers - 1);
+	res->width = 0;
+	for(i=0; i < NUM_OUTPUTS; i++){
+		res->inf[i] = box[i]->inf->val.dbl;
+		res->sup[i] = box[i]->sup->val.dbl;
+		res->width += (res->sup[i] - res->inf[i])/NUM_OUTPUTS;
+		elina_interval_free(box[i]);
+	}
+	free(box);
+	elina_abstract0_free(man, element);
+}
+
+/* true if the outputs of net on NUM_SAMPLES random points of the box are within the bounds of res */
+static bool network_check_samples(test_network_t *net, double *inf, double *sup, test_result_t *res){
+	double *x = (double *)malloc(net->num_pixels*sizeof(double));
+	double y[NUM_OUTPUTS];
+	size_t s, i;
+	bool sound = true;
+	for(s=0; s < NUM_SAMPLES; s++){
+		for(i=0; i < net->num_pixels; i++){
+			/* half of the coordinates at a vertex of the box */
+			double t = rand()%2 ? (double)(rand()%2) : (random_double() + 1)/2;
+			x[i] = inf[i] + t*(sup[i] - inf[i]);
+		}
+		network_eval(net, x, y);
+		for(i=0; i < NUM_OUTPUTS; i++){
+			/* the evaluation itself is rounded */
+			double tol = 1e-9*(1 + fabs(y[i]));
+			if(y[i] < res->inf[i] - tol || y[i] > res->sup[i] + tol){
+				sound = false;
+			}
+		}
+	}
+	free(x);
+	return sound;
+}
+
+
+int main(int argc, char **argv){
+	double eps = argc > 1 ? atof(argv[1]) : 0.01;
+	test_network_t nets[3];
+	size_t input_size[3] = {16, 16, 1}, input_size2[3] = {14, 14, 8};
+	size_t n, i, k, num_nets = 3;
+	int res = 0;
+	srand(0);
+	nets[0].name = "ffn relu 6x256";
+	nets[0].num_pixels = 784;
+	nets[0].num_layers = 0;
+	for(k=0; k < 6; k++){
+		add_ffn_layer(&nets[0], 256, RELU);
+	}
+	add_ffn_layer(&nets[0], NUM_OUTPUTS, NONE);
+	nets[1].name = "ffn sigmoid/tanh 4x128";
+	nets[1].num_pixels = 784;
+	nets[1].num_layers = 0;
+	for(k=0; k < 4; k++){
+		add_ffn_layer(&nets[1], 128, k%2 ? TANH : SIGMOID);
+	}
+	add_ffn_layer(&nets[1], NUM_OUTPUTS, NONE);
+	nets[2].name = "conv 2x8 ffn 100";
+	nets[2].num_pixels = 256;
+	nets[2].num_layers = 0;
+	add_conv_layer(&nets[2], input_size, 3, 8);
+	add_conv_layer(&nets[2], input_size2, 3, 8);
+	add_ffn_layer(&nets[2], 100, RELU);
+	add_ffn_layer(&nets[2], NUM_OUTPUTS, NONE);
+	printf("%-24s %10s %10s %8s %8s %8s %12s %12s %10s %8s %8s\n", "network", "bytes f64", "bytes f32", "saved",
+	       "time f64", "time f32", "width f64", "width f32", "loss", "proved64", "proved32");
+	for(n=0; n < num_nets; n++){
+		test_network_t *net = nets + n;
+		double *inf = (double *)malloc(net->num_pixels*sizeof(double));
+		double *sup = (double *)malloc(net->num_pixels*sizeof(double));
+		double inf64[NUM_OUTPUTS], sup64[NUM_OUTPUTS], inf32[NUM_OUTPUTS], sup32[NUM_OUTPUTS];
+		test_result_t res64 = {0, 0, 0, 0, inf64, sup64}, res32 = {0, 0, 0, 0, inf32, sup32};
+		double loss = 0;
+		for(i=0; i < net->num_pixels; i++){
+			double c = (random_double() + 1)/2;
+			inf[i] = c - eps;
+			sup[i] = c + eps;
+		}
+		elina_manager_t *man = fppoly_manager_alloc();
+		network_analyze(man, net, inf, sup, &res64);
+		fppoly_manager_set_float32(man, true);
+		network_analyze(man, net, inf, sup, &res32);
+		elina_manager_free(man);
+		/* largest relative increase of the width of an output */
+		for(i=0; i < NUM_OUTPUTS; i++){
+			double w64 = sup64[i] - inf64[i], w32 = sup32[i] - inf32[i];
+			loss = fmax(loss, (w32 - w64)/w64);
+		}
+		printf("%-24s %10zu %10zu %7.1f%% %8.3f %8.3f %12.6g %12.6g %10.3g %8zu %8zu\n", net->name, res64.bytes, res32.bytes,
+		       100.0*(1.0 - (double)res32.bytes/(double)res64.bytes), res64.time, res32.time, res64.width, res32.width, loss,
+		       res64.proved, res32.proved);
+		if(!network_check_samples(net, inf, sup, &res64) || !network_check_samples(net, inf, sup, &res32)){
+			printf("%-24s UNSOUND: an output on a point of the input box is out of its bounds\n", net->name);
+			res = 1;
+		}
+		free(inf);
+		free(sup);
+		network_free(net);
+	}
+	return res;
+}
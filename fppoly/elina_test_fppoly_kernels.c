@@ -0,0 +1,257 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Micro-benchmark of the fppoly interval kernels: times the scalar, AVX2 and
+   AVX-512 versions on the layer sizes of the MNIST and CIFAR networks and
+   checks that they give bit-identical results, and that the float32 kernels
+   give the results of the double ones on the widened rows when their
+   coefficients have no rounding error. */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fenv.h>
+#include <math.h>
+#include "fppoly_kernels.h"
+
+#define NUM_ISA 3
+
+static const char *isa_name[NUM_ISA] = {"scalar", "avx2", "avx512"};
+
+typedef struct bench_data_t{
+	size_t size;
+	double *inf;
+	double *sup;
+	double *res_inf;
+	double *res_sup;
+	double *res2_inf;
+	double *res2_sup;
+	double *x_inf;
+	double *x_sup;
+	/* x_sup rounded to float32 */
+	float *w32;
+	uint32_t *dim;
+	uint32_t *pos;
+}bench_data_t;
+
+static double elapsed(struct timespec *start, struct timespec *end){
+	return (double)(end->tv_sec - start->tv_sec) + 1e-9*(double)(end->tv_nsec - start->tv_nsec);
+}
+
+static double random_double(void){
+	double r = rand();
+	return 2.0*(r/RAND_MAX) - 1.0;
+}
+
+static bench_data_t * bench_data_alloc(size_t size){
+	bench_data_t *data = (bench_data_t *)malloc(sizeof(bench_data_t));
+	size_t i;
+	data->size = size;
+	data->inf = (double *)malloc(size*sizeof(double));
+	data->sup = (double *)malloc(size*sizeof(double));
+	data->res_inf = (double *)malloc(size*sizeof(double));
+	data->res_sup = (double *)malloc(size*sizeof(double));
+	data->res2_inf = (double *)malloc(size*sizeof(double));
+	data->res2_sup = (double *)malloc(size*sizeof(double));
+	data->x_inf = (double *)malloc(size*sizeof(double));
+	data->x_sup = (double *)malloc(size*sizeof(double));
+	data->w32 = (float *)malloc(size*sizeof(float));
+	data->dim = (uint32_t *)malloc(size*sizeof(uint32_t));
+	data->pos = (uint32_t *)malloc(size*sizeof(uint32_t));
+	for(i=0; i < size; i++){
+		/* coefficients of a back-substituted expression, some of them zero or a point */
+		double a = random_double(), b = random_double();
+		if(rand()%8==0){
+			a = b = 0;
+		}
+		else if(rand()%4==0){
+			b = a;
+		}
+		data->inf[i] = -fmin(a,b);
+		data->sup[i] = fmax(a,b);
+		/* bounds of the neurons of the previous layer, as after a ReLU */
+		a = random_double();
+		b = random_double();
+		data->x_inf[i] = -fmax(0, fmin(a,b));
+		data->x_sup[i] = fmax(0, fmax(a,b));
+		data->w32[i] = (float)data->x_sup[i];
+		/* the support of a sparse expression, every second neuron */
+		data->dim[i] = (uint32_t)(i/2);
+		/* distinct positions of the coefficients of a sparse expression in a dense one */
+		data->pos[i] = (uint32_t)(2*i);
+	}
+	return data;
+}
+
+static void bench_data_free(bench_data_t *data){
+	free(data->inf);
+	free(data->sup);
+	free(data->res_inf);
+	free(data->res_sup);
+	free(data->res2_inf);
+	free(data->res2_sup);
+	free(data->x_inf);
+	free(data->x_sup);
+	free(data->w32);
+	free(data->dim);
+	free(data->pos);
+	free(data);
+}
+
+/* runs kernel k of the benchmark once, returns a value depending on its result */
+static double run_kernel(int k, bench_data_t *data, double ulp){
+	size_t size = data->size;
+	switch(k){
+		case 0:
+			fppoly_kernel_scale(data->res_inf, data->res_sup, data->inf, data->sup, 0.25, 0.5, ulp, size);
+			return data->res_inf[size-1] + data->res_sup[0];
+		case 1:
+			memcpy(data->res_inf, data->inf, size*sizeof(double));
+			memcpy(data->res_sup, data->sup, size*sizeof(double));
+			fppoly_kernel_add(data->res_inf, data->res_sup, data->x_inf, data->x_sup, ulp, size);
+			return data->res_inf[size-1] + data->res_sup[0];
+		case 2:
+			return fppoly_kernel_concretize_inf(0, data->inf, data->sup, NULL, data->x_inf, data->x_sup, size) +
+			       fppoly_kernel_concretize_sup(0, data->inf, data->sup, NULL, data->x_inf, data->x_sup, size);
+		case 3:
+			return fppoly_kernel_concretize_inf(0, data->inf, data->sup, data->dim, data->x_inf, data->x_sup, size) +
+			       fppoly_kernel_concretize_sup(0, data->inf, data->sup, data->dim, data->x_inf, data->x_sup, size);
+		case 4:
+			memcpy(data->res_inf, data->inf, size*sizeof(double));
+			memcpy(data->res_sup, data->sup, size*sizeof(double));
+			fppoly_kernel_add_mul_point(data->res_inf, data->res_sup, 0.25, 0.5, data->x_sup, ulp, size);
+			return data->res_inf[size-1] + data->res_sup[0];
+		case 5:
+			memcpy(data->res_inf, data->inf, size*sizeof(double));
+			memcpy(data->res_sup, data->sup, size*sizeof(double));
+			memcpy(data->res2_inf, data->inf, size*sizeof(double));
+			memcpy(data->res2_sup, data->sup, size*sizeof(double));
+			fppoly_kernel_add_scale_pair(data->res_inf, data->res_sup, data->res2_inf, data->res2_sup, data->x_inf, data->x_sup, NULL,
+						     0.25, 0.5, -0.125, 0.75, ulp, size);
+			return data->res_inf[size-1] + data->res2_sup[0];
+		case 6:
+			memcpy(data->res_inf, data->inf, size*sizeof(double));
+			memcpy(data->res_sup, data->sup, size*sizeof(double));
+			memcpy(data->res2_inf, data->inf, size*sizeof(double));
+			memcpy(data->res2_sup, data->sup, size*sizeof(double));
+			fppoly_kernel_add_scale_pair(data->res_inf, data->res_sup, data->res2_inf, data->res2_sup, data->x_inf, data->x_sup, data->pos,
+						     0.25, 0.5, -0.125, 0.75, ulp, size/2);
+			return data->res_inf[size-2] + data->res2_sup[0];
+		default:
+			memcpy(data->res_inf, data->inf, size*sizeof(double));
+			memcpy(data->res_sup, data->sup, size*sizeof(double));
+			fppoly_kernel_add_mul_point_f32(data->res_inf, data->res_sup, 0.25, 0.5, data->w32, ulp, ldexp(1.0,-23), ldexp(1.0,-149), size);
+			return data->res_inf[size-1] + data->res_sup[0];
+	}
+}
+
+#define NUM_KERNELS 8
+
+static const char *kernel_name[NUM_KERNELS] = {"scale", "add", "concretize dense", "concretize sparse", "add_mul_point",
+					       "add_scale_pair", "add_scale_pair sp", "add_mul_point f32"};
+
+/* true if the float32 kernels with no rounding error on their coefficients give the results of the double ones */
+static bool check_f32_exact(bench_data_t *data, double ulp){
+	size_t size = data->size, j;
+	double *w = (double *)malloc(size*sizeof(double));
+	bool res;
+	for(j=0; j < size; j++){
+		w[j] = (double)data->w32[j];
+	}
+	fppoly_kernel_mul_point(data->res_inf, data->res_sup, 0.25, 0.5, w, ulp, size);
+	fppoly_kernel_add_mul_point(data->res_inf, data->res_sup, -0.125, 0.75, w, ulp, size);
+	fppoly_kernel_mul_point_f32(data->res2_inf, data->res2_sup, 0.25, 0.5, data->w32, ulp, 0, 0, size);
+	fppoly_kernel_add_mul_point_f32(data->res2_inf, data->res2_sup, -0.125, 0.75, data->w32, ulp, 0, 0, size);
+	res = !memcmp(data->res_inf, data->res2_inf, size*sizeof(double)) && !memcmp(data->res_sup, data->res2_sup, size*sizeof(double));
+	free(w);
+	return res;
+}
+
+
+int main(int argc, char **argv){
+	/* input and hidden layer sizes of the MNIST and CIFAR networks */
+	size_t sizes[] = {100, 784, 1024, 3072};
+	size_t num_sizes = sizeof(sizes)/sizeof(sizes[0]);
+	size_t reps = argc > 1 ? (size_t)atol(argv[1]) : 20000;
+	double ulp = ldexp(1.0,-52);
+	int s, k, isa, res = 0;
+	fppoly_kernel_isa_t best = fppoly_kernel_get_isa();
+	fesetround(FE_UPWARD);
+	srand(0);
+	printf("kernels selected at runtime: %s\n", isa_name[best]);
+	printf("%-18s %6s", "kernel", "size");
+	for(isa=0; isa < NUM_ISA; isa++){
+		printf(" %10s", isa_name[isa]);
+	}
+	printf("   (ns per call)\n");
+	for(s=0; s < (int)num_sizes; s++){
+		bench_data_t *data = bench_data_alloc(sizes[s]);
+		for(k=0; k < NUM_KERNELS; k++){
+			double ref_val = 0;
+			double *ref_inf = (double *)malloc(sizes[s]*sizeof(double));
+			double *ref_sup = (double *)malloc(sizes[s]*sizeof(double));
+			double *ref2_inf = (double *)malloc(sizes[s]*sizeof(double));
+			double *ref2_sup = (double *)malloc(sizes[s]*sizeof(double));
+			printf("%-18s %6zu", kernel_name[k], sizes[s]);
+			for(isa=0; isa < NUM_ISA; isa++){
+				struct timespec start, end;
+				double val = 0;
+				size_t r;
+				if(!fppoly_kernel_set_isa((fppoly_kernel_isa_t)isa)){
+					printf(" %10s", "-");
+					continue;
+				}
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				for(r=0; r < reps; r++){
+					val += run_kernel(k, data, ulp);
+				}
+				clock_gettime(CLOCK_MONOTONIC, &end);
+				printf(" %10.1f", 1e9*elapsed(&start, &end)/reps);
+				if(k==NUM_KERNELS-1 && !check_f32_exact(data, ulp)){
+					printf(" INEXACT");
+					res = 1;
+				}
+				/* the vector kernels must agree with the scalar ones bit for bit */
+				val = run_kernel(k, data, ulp);
+				if(isa==FPPOLY_KERNEL_SCALAR){
+					ref_val = val;
+					memcpy(ref_inf, data->res_inf, sizes[s]*sizeof(double));
+					memcpy(ref_sup, data->res_sup, sizes[s]*sizeof(double));
+					memcpy(ref2_inf, data->res2_inf, sizes[s]*sizeof(double));
+					memcpy(ref2_sup, data->res2_sup, sizes[s]*sizeof(double));
+				}
+				else if(memcmp(&val, &ref_val, sizeof(double)) ||
+					(k!=2 && k!=3 && (memcmp(ref_inf, data->res_inf, sizes[s]*sizeof(double)) || memcmp(ref_sup, data->res_sup, sizes[s]*sizeof(double)))) ||
+					((k==5 || k==6) && (memcmp(ref2_inf, data->res2_inf, sizes[s]*sizeof(double)) || memcmp(ref2_sup, data->res2_sup, sizes[s]*sizeof(double))))){
+					printf(" MISMATCH");
+					res = 1;
+				}
+			}
+			printf("\n");
+			free(ref_inf);
+			free(ref_sup);
+			free(ref2_inf);
+			free(ref2_sup);
+		}
+		bench_data_free(data);
+	}
+	fppoly_kernel_set_isa(best);
+	return res;
+}
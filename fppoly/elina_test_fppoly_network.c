@@ -0,0 +1,173 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include "elina_test_fppoly_network.h"
+
+double random_unit(void){
+	double r = rand();
+	return r/RAND_MAX;
+}
+
+double random_double(void){
+	return 2.0*random_unit() - 1.0;
+}
+
+double ** random_weights(size_t num_out, size_t num_in){
+	double **res = (double **)malloc(num_out*sizeof(double *));
+	double scale = 2.0/sqrt((double)num_in);
+	size_t i, j;
+	for(i=0; i < num_out; i++){
+		res[i] = (double *)malloc(num_in*sizeof(double));
+		for(j=0; j < num_in; j++){
+			res[i][j] = scale*random_double();
+		}
+	}
+	return res;
+}
+
+double * random_bias(size_t num_out){
+	double *res = (double *)malloc(num_out*sizeof(double));
+	size_t i;
+	for(i=0; i < num_out; i++){
+		res[i] = 0.1*random_double();
+	}
+	return res;
+}
+
+void free_weights(double **weights, double *bias, size_t num_out){
+	size_t i;
+	for(i=0; i < num_out; i++){
+		free(weights[i]);
+	}
+	free(weights);
+	free(bias);
+}
+
+void random_input_box(double *inf, double *sup, size_t num_pixels, double eps){
+	size_t i;
+	for(i=0; i < num_pixels; i++){
+		double c = random_unit();
+		inf[i] = c - eps;
+		sup[i] = c + eps;
+	}
+}
+
+network_t * network_alloc(size_t num_layers, size_t *dims, double eps){
+	network_t *net = (network_t *)malloc(sizeof(network_t));
+	size_t l;
+	net->num_layers = num_layers;
+	net->dims = (size_t *)malloc((num_layers+1)*sizeof(size_t));
+	memcpy(net->dims, dims, (num_layers+1)*sizeof(size_t));
+	net->weights = (double ***)malloc(num_layers*sizeof(double **));
+	net->bias = (double **)malloc(num_layers*sizeof(double *));
+	for(l=0; l < num_layers; l++){
+		net->weights[l] = random_weights(dims[l+1], dims[l]);
+		net->bias[l] = random_bias(dims[l+1]);
+	}
+	net->inf = (double *)malloc(dims[0]*sizeof(double));
+	net->sup = (double *)malloc(dims[0]*sizeof(double));
+	random_input_box(net->inf, net->sup, dims[0], eps);
+	return net;
+}
+
+void network_free(network_t *net){
+	size_t l;
+	for(l=0; l < net->num_layers; l++){
+		free_weights(net->weights[l], net->bias[l], net->dims[l+1]);
+	}
+	free(net->weights);
+	free(net->bias);
+	free(net->dims);
+	free(net->inf);
+	free(net->sup);
+	free(net);
+}
+
+void network_add_layer(elina_manager_t *man, elina_abstract0_t *element, network_t *net, size_t l){
+	if(l==0){
+		ffn_handle_first_relu_layer(man, element, net->weights[l], net->bias[l], net->dims[l+1], net->dims[l]);
+	}
+	else if(l + 1 < net->num_layers){
+		ffn_handle_intermediate_relu_layer(man, element, net->weights[l], net->bias[l], net->dims[l+1], net->dims[l]);
+	}
+	else{
+		ffn_handle_last_relu_layer(man, element, net->weights[l], net->bias[l], net->dims[l+1], net->dims[l], false);
+	}
+}
+
+elina_abstract0_t * network_analyze(elina_manager_t *man, network_t *net){
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, net->dims[0], net->inf, net->sup);
+	size_t l;
+	for(l=0; l < net->num_layers; l++){
+		network_add_layer(man, element, net, l);
+	}
+	return element;
+}
+
+void network_sample_input(network_t *net, size_t s, double *x){
+	size_t i;
+	for(i=0; i < net->dims[0]; i++){
+		double t = random_unit();
+		if(s%2){
+			t = t < 0.5 ? 0 : 1;
+		}
+		x[i] = net->inf[i] + t*(net->sup[i] - net->inf[i]);
+	}
+}
+
+void network_eval(network_t *net, double *x, double **pre){
+	size_t l, i, j;
+	for(l=0; l < net->num_layers; l++){
+		for(i=0; i < net->dims[l+1]; i++){
+			double sum = net->bias[l][i];
+			for(j=0; j < net->dims[l]; j++){
+				double in = l==0 ? x[j] : fmax(pre[l-1][j], 0);
+				sum += net->weights[l][i][j]*in;
+			}
+			pre[l][i] = sum;
+		}
+	}
+}
+
+size_t element_num_differences(elina_manager_t *man, elina_abstract0_t *a, elina_abstract0_t *b, size_t num_outputs){
+	fppoly_t *fa = (fppoly_t *)a->value;
+	fppoly_t *fb = (fppoly_t *)b->value;
+	size_t res = 0, k, i;
+	elina_dim_t y, x;
+	for(k=0; k < fa->numlayers; k++){
+		for(i=0; i < fa->layers[k]->dims; i++){
+			neuron_t *na = fa->layers[k]->neurons[i];
+			neuron_t *nb = fb->layers[k]->neurons[i];
+			if(na->lb!=nb->lb || na->ub!=nb->ub){
+				res++;
+			}
+		}
+	}
+	for(y=0; y < num_outputs; y++){
+		for(x=0; x < num_outputs; x++){
+			if(x!=y && is_greater(man, a, y, x)!=is_greater(man, b, y, x)){
+				res++;
+			}
+		}
+	}
+	return res;
+}
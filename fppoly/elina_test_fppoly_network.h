@@ -0,0 +1,76 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Random ReLU networks and the comparison of their analyses, shared by the fppoly tests. */
+
+#ifndef _ELINA_TEST_FPPOLY_NETWORK_H_
+#define _ELINA_TEST_FPPOLY_NETWORK_H_
+
+#include <stdlib.h>
+#include "fppoly.h"
+
+typedef struct network_t{
+	/* layer l maps the dims[l] outputs of the layer before it to dims[l+1] neurons */
+	size_t num_layers;
+	size_t *dims;
+	double ***weights;
+	double **bias;
+	double *inf;
+	double *sup;
+}network_t;
+
+/* uniform in [0,1] */
+double random_unit(void);
+
+/* uniform in [-1,1] */
+double random_double(void);
+
+/* num_out rows of num_in weights uniform in [-2/sqrt(num_in),2/sqrt(num_in)] */
+double ** random_weights(size_t num_out, size_t num_in);
+
+double * random_bias(size_t num_out);
+
+void free_weights(double **weights, double *bias, size_t num_out);
+
+/* an L_oo ball of radius eps around a random point of [0,1]^num_pixels */
+void random_input_box(double *inf, double *sup, size_t num_pixels, double eps);
+
+/* num_layers affine layers of sizes dims, all but the last followed by a ReLU, and an input box of radius eps */
+network_t * network_alloc(size_t num_layers, size_t *dims, double eps);
+
+void network_free(network_t *net);
+
+/* adds layer l of net to element, which holds the layers before it */
+void network_add_layer(elina_manager_t *man, elina_abstract0_t *element, network_t *net, size_t l);
+
+/* element holding all the layers of net for its input box */
+elina_abstract0_t * network_analyze(elina_manager_t *man, network_t *net);
+
+/* sets x to a random input of the box of net, the odd samples s are corners of the box */
+void network_sample_input(network_t *net, size_t s, double *x);
+
+/* pre[l] receives the neurons of layer l of net before their ReLU for the input x */
+void network_eval(network_t *net, double *x, double **pre);
+
+/* number of neurons whose bounds differ in a and b and of the pairs of the num_outputs outputs
+   on which is_greater differs, a and b have layers of the same sizes */
+size_t element_num_differences(elina_manager_t *man, elina_abstract0_t *a, elina_abstract0_t *b, size_t num_outputs);
+
+#endif
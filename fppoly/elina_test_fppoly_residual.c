@@ -0,0 +1,228 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Residual networks against the chains of layers they compute: a block summing two affine branches
+   read from the same layer must bound its neurons as the affine layer of the summed weights, the
+   back-substitution merging the branches where they meet instead of going through each of them,
+   and the bounds of a network with nested skip connections must hold for samples of its input box
+   and prove the same outputs with get_lb_for_output_specs as with is_greater. */
+
+#include <stdio.h>
+#include <math.h>
+#include "elina_test_fppoly_network.h"
+
+#define NUM_PIXELS 16
+#define NUM_HIDDEN 24
+#define NUM_OUTPUTS 5
+#define NUM_SAMPLES 20000
+/* bounds computed through the branches may differ from the ones of the chain by the rounding of the sum */
+#define TOLERANCE 1e-9
+
+static void affine(double **weights, double *bias, double *x, double *y, size_t num_out, size_t num_in){
+	size_t i, j;
+	for(i=0; i < num_out; i++){
+		double sum = bias[i];
+		for(j=0; j < num_in; j++){
+			sum += weights[i][j]*x[j];
+		}
+		y[i] = sum;
+	}
+}
+
+static void relu(double *x, double *y, size_t n){
+	size_t i;
+	for(i=0; i < n; i++){
+		y[i] = fmax(x[i], 0);
+	}
+}
+
+static bool bounds_close(neuron_t *a, neuron_t *b){
+	return fabs(a->lb - b->lb) <= TOLERANCE*(1 + fabs(a->lb)) && fabs(a->ub - b->ub) <= TOLERANCE*(1 + fabs(a->ub));
+}
+
+/* number of neurons and pairs of outputs on which the block of two branches differs from the chain */
+static size_t test_merged_branches(elina_manager_t *man){
+	double inf[NUM_PIXELS], sup[NUM_PIXELS];
+	random_input_box(inf, sup, NUM_PIXELS, 0.05);
+	double **weights0 = random_weights(NUM_HIDDEN, NUM_PIXELS), *bias0 = random_bias(NUM_HIDDEN);
+	double **weights_a = random_weights(NUM_HIDDEN, NUM_HIDDEN), *bias_a = random_bias(NUM_HIDDEN);
+	double **weights_b = random_weights(NUM_HIDDEN, NUM_HIDDEN), *bias_b = random_bias(NUM_HIDDEN);
+	double **weights_out = random_weights(NUM_OUTPUTS, NUM_HIDDEN), *bias_out = random_bias(NUM_OUTPUTS);
+	double **weights_sum = random_weights(NUM_HIDDEN, NUM_HIDDEN), *bias_sum = random_bias(NUM_HIDDEN);
+	size_t i, j, res = 0;
+	for(i=0; i < NUM_HIDDEN; i++){
+		for(j=0; j < NUM_HIDDEN; j++){
+			weights_sum[i][j] = weights_a[i][j] + weights_b[i][j];
+		}
+		bias_sum[i] = bias_a[i] + bias_b[i];
+	}
+
+	elina_abstract0_t *chain = fppoly_from_network_input(man, 0, NUM_PIXELS, inf, sup);
+	ffn_handle_first_relu_layer(man, chain, weights0, bias0, NUM_HIDDEN, NUM_PIXELS);
+	ffn_handle_intermediate_relu_layer(man, chain, weights_sum, bias_sum, NUM_HIDDEN, NUM_HIDDEN);
+	ffn_handle_last_relu_layer(man, chain, weights_out, bias_out, NUM_OUTPUTS, NUM_HIDDEN, false);
+
+	size_t predecessors[2] = {2, 3};
+	elina_abstract0_t *branches = fppoly_from_network_input(man, 0, NUM_PIXELS, inf, sup);
+	ffn_handle_first_relu_layer(man, branches, weights0, bias0, NUM_HIDDEN, NUM_PIXELS);
+	ffn_handle_intermediate_affine_layer(man, branches, weights_a, bias_a, NUM_HIDDEN, NUM_HIDDEN);
+	fppoly_set_next_layer_input(man, branches, 1);
+	ffn_handle_intermediate_affine_layer(man, branches, weights_b, bias_b, NUM_HIDDEN, NUM_HIDDEN);
+	handle_residual_relu_layer(man, branches, NUM_HIDDEN, predecessors, 2);
+	ffn_handle_last_relu_layer(man, branches, weights_out, bias_out, NUM_OUTPUTS, NUM_HIDDEN, false);
+
+	fppoly_t *fc = (fppoly_t *)chain->value;
+	fppoly_t *fb = (fppoly_t *)branches->value;
+	for(i=0; i < NUM_HIDDEN; i++){
+		res += !bounds_close(fc->layers[1]->neurons[i], fb->layers[3]->neurons[i]);
+	}
+	for(i=0; i < NUM_OUTPUTS; i++){
+		res += !bounds_close(fc->layers[2]->neurons[i], fb->layers[4]->neurons[i]);
+		for(j=0; j < NUM_OUTPUTS; j++){
+			if(i!=j && is_greater(man, chain, i, j)!=is_greater(man, branches, i, j)){
+				res++;
+			}
+		}
+	}
+	elina_abstract0_free(man, chain);
+	elina_abstract0_free(man, branches);
+	free_weights(weights0, bias0, NUM_HIDDEN);
+	free_weights(weights_a, bias_a, NUM_HIDDEN);
+	free_weights(weights_b, bias_b, NUM_HIDDEN);
+	free_weights(weights_sum, bias_sum, NUM_HIDDEN);
+	free_weights(weights_out, bias_out, NUM_OUTPUTS);
+	return res;
+}
+
+/* number of neurons of a sample outside of their bounds and of specifications violated by a sample or
+   proved differently than by is_greater, for the network
+       0: relu(W0 x)           1: relu(W1 z0)          2: W2 z1
+       3: relu(z0 + z2)        4: relu(W4 z0)          5: W5 z3
+       6: relu(z5 + z4)        7: W7 z6
+   where zk is the output of layer k */
+static size_t test_skip_connections(elina_manager_t *man){
+	double inf[NUM_PIXELS], sup[NUM_PIXELS], x[NUM_PIXELS];
+	double pre[8][NUM_HIDDEN], out[8][NUM_HIDDEN];
+	double **w[8] = {NULL}, *b[8] = {NULL};
+	size_t layers[5] = {0, 1, 2, 4, 5};
+	size_t p3[2] = {1, 3}, p6[2] = {6, 5};
+	size_t i, k, s, res = 0;
+	random_input_box(inf, sup, NUM_PIXELS, 0.1);
+	for(k=0; k < 5; k++){
+		w[layers[k]] = random_weights(NUM_HIDDEN, k==0 ? NUM_PIXELS : NUM_HIDDEN);
+		b[layers[k]] = random_bias(NUM_HIDDEN);
+	}
+	w[7] = random_weights(NUM_OUTPUTS, NUM_HIDDEN);
+	b[7] = random_bias(NUM_OUTPUTS);
+
+	elina_abstract0_t *element = fppoly_from_network_input(man, 0, NUM_PIXELS, inf, sup);
+	ffn_handle_first_relu_layer(man, element, w[0], b[0], NUM_HIDDEN, NUM_PIXELS);
+	ffn_handle_intermediate_relu_layer(man, element, w[1], b[1], NUM_HIDDEN, NUM_HIDDEN);
+	ffn_handle_intermediate_affine_layer(man, element, w[2], b[2], NUM_HIDDEN, NUM_HIDDEN);
+	handle_residual_relu_layer(man, element, NUM_HIDDEN, p3, 2);
+	fppoly_set_next_layer_input(man, element, 1);
+	ffn_handle_intermediate_relu_layer(man, element, w[4], b[4], NUM_HIDDEN, NUM_HIDDEN);
+	fppoly_set_next_layer_input(man, element, 4);
+	ffn_handle_intermediate_affine_layer(man, element, w[5], b[5], NUM_HIDDEN, NUM_HIDDEN);
+	handle_residual_relu_layer(man, element, NUM_HIDDEN, p6, 2);
+	ffn_handle_last_relu_layer(man, element, w[7], b[7], NUM_OUTPUTS, NUM_HIDDEN, false);
+	fppoly_t *fp = (fppoly_t *)element->value;
+
+	/* specification y*NUM_OUTPUTS+x is y_y - y_x */
+	double coeffs[NUM_OUTPUTS*NUM_OUTPUTS*NUM_OUTPUTS], lb[NUM_OUTPUTS*NUM_OUTPUTS];
+	for(s=0; s < NUM_OUTPUTS*NUM_OUTPUTS; s++){
+		for(i=0; i < NUM_OUTPUTS; i++){
+			coeffs[s*NUM_OUTPUTS+i] = (i==s/NUM_OUTPUTS) - (double)(i==s%NUM_OUTPUTS);
+		}
+	}
+	get_lb_for_output_specs(man, element, NUM_OUTPUTS*NUM_OUTPUTS, coeffs, NULL, lb);
+	for(s=0; s < NUM_OUTPUTS*NUM_OUTPUTS; s++){
+		elina_dim_t y = s/NUM_OUTPUTS, x = s%NUM_OUTPUTS;
+		if(y!=x && is_greater(man, element, y, x)!=(lb[s] > 0)){
+			res++;
+		}
+	}
+
+	for(s=0; s < NUM_SAMPLES; s++){
+		for(i=0; i < NUM_PIXELS; i++){
+			double t = random_unit();
+			if(s%2){
+				t = t < 0.5 ? 0 : 1;
+			}
+			x[i] = inf[i] + t*(sup[i] - inf[i]);
+		}
+		affine(w[0], b[0], x, pre[0], NUM_HIDDEN, NUM_PIXELS);
+		relu(pre[0], out[0], NUM_HIDDEN);
+		affine(w[1], b[1], out[0], pre[1], NUM_HIDDEN, NUM_HIDDEN);
+		relu(pre[1], out[1], NUM_HIDDEN);
+		affine(w[2], b[2], out[1], pre[2], NUM_HIDDEN, NUM_HIDDEN);
+		for(i=0; i < NUM_HIDDEN; i++){
+			out[2][i] = pre[2][i];
+			pre[3][i] = out[0][i] + out[2][i];
+		}
+		relu(pre[3], out[3], NUM_HIDDEN);
+		affine(w[4], b[4], out[0], pre[4], NUM_HIDDEN, NUM_HIDDEN);
+		relu(pre[4], out[4], NUM_HIDDEN);
+		affine(w[5], b[5], out[3], pre[5], NUM_HIDDEN, NUM_HIDDEN);
+		for(i=0; i < NUM_HIDDEN; i++){
+			out[5][i] = pre[5][i];
+			pre[6][i] = out[5][i] + out[4][i];
+		}
+		relu(pre[6], out[6], NUM_HIDDEN);
+		affine(w[7], b[7], out[6], pre[7], NUM_OUTPUTS, NUM_HIDDEN);
+		for(k=0; k < 8; k++){
+			for(i=0; i < fp->layers[k]->dims; i++){
+				neuron_t *n = fp->layers[k]->neurons[i];
+				/* lb holds the opposite of the lower bound */
+				if(pre[k][i] < -n->lb - TOLERANCE || pre[k][i] > n->ub + TOLERANCE){
+					res++;
+				}
+			}
+		}
+		for(k=0; k < NUM_OUTPUTS*NUM_OUTPUTS; k++){
+			double v = pre[7][k/NUM_OUTPUTS] - pre[7][k%NUM_OUTPUTS];
+			if(k/NUM_OUTPUTS!=k%NUM_OUTPUTS && v < lb[k] - TOLERANCE){
+				res++;
+			}
+		}
+	}
+	elina_abstract0_free(man, element);
+	for(k=0; k < 5; k++){
+		free_weights(w[layers[k]], b[layers[k]], NUM_HIDDEN);
+	}
+	free_weights(w[7], b[7], NUM_OUTPUTS);
+	return res;
+}
+
+int main(void){
+	size_t threads[2] = {1, 3};
+	size_t t, res = 0;
+	srand(0);
+	for(t=0; t < 2; t++){
+		elina_manager_t *man = fppoly_manager_alloc();
+		fppoly_manager_set_num_threads(man, threads[t]);
+		size_t merged = test_merged_branches(man);
+		size_t skip = test_skip_connections(man);
+		printf("%zu threads: %zu differences with the chain, %zu violations\n", threads[t], merged, skip);
+		res += merged + skip;
+		elina_manager_free(man);
+	}
+	return res!=0;
+}
@@ -0,0 +1,79 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Analyses with a memory budget against the ones without: a random 60-50-50-50-10 ReLU network
+   analysed on 3 threads with a budget of one byte, which spills the expressions of its layers
+   to a mapped file, must give the same bounds for every neuron, prove the same
+   outputs with is_greater and get_lb_for_output_specs, and hold less memory. */
+
+#include <stdio.h>
+#include <string.h>
+#include "elina_test_fppoly_network.h"
+
+#define NUM_LAYERS 4
+#define NUM_OUTPUTS 10
+#define NUM_THREADS 3
+
+static elina_abstract0_t * analyze(network_t *net, elina_manager_t **man, size_t budget, double *lb){
+	double coeffs[NUM_OUTPUTS*NUM_OUTPUTS*NUM_OUTPUTS];
+	size_t s, i;
+	*man = fppoly_manager_alloc();
+	fppoly_manager_set_num_threads(*man, NUM_THREADS);
+	fppoly_manager_set_memory_budget(*man, budget);
+	elina_abstract0_t *element = network_analyze(*man, net);
+	/* specification y*NUM_OUTPUTS+x is y_y - y_x */
+	for(s=0; s < NUM_OUTPUTS*NUM_OUTPUTS; s++){
+		for(i=0; i < NUM_OUTPUTS; i++){
+			coeffs[s*NUM_OUTPUTS+i] = (i==s/NUM_OUTPUTS) - (double)(i==s%NUM_OUTPUTS);
+		}
+	}
+	get_lb_for_output_specs(*man, element, NUM_OUTPUTS*NUM_OUTPUTS, coeffs, NULL, lb);
+	return element;
+}
+
+int main(void){
+	size_t dims[NUM_LAYERS+1] = {60, 50, 50, 50, NUM_OUTPUTS};
+	double lb[NUM_OUTPUTS*NUM_OUTPUTS], lb_spilled[NUM_OUTPUTS*NUM_OUTPUTS];
+	elina_manager_t *man, *man_spilled;
+	size_t k, num_spilled = 0;
+	int res = 0;
+	srand(0);
+	network_t *net = network_alloc(NUM_LAYERS, dims, 0.02);
+	elina_abstract0_t *element = analyze(net, &man, 0, lb);
+	elina_abstract0_t *spilled = analyze(net, &man_spilled, 1, lb_spilled);
+	fppoly_t *fp = (fppoly_t *)spilled->value;
+	for(k=0; k < fp->numlayers; k++){
+		num_spilled += fp->layers[k]->spill!=NULL;
+	}
+	size_t num_differences = element_num_differences(man, element, spilled, NUM_OUTPUTS);
+	size_t bytes = fppoly_resident_bytes(man, element);
+	size_t bytes_spilled = fppoly_resident_bytes(man_spilled, spilled);
+	printf("%zu layers spilled, %zu differences, specifications %s, %zu bytes resident instead of %zu\n", num_spilled,
+	       num_differences, memcmp(lb, lb_spilled, sizeof(lb)) ? "differ" : "identical", bytes_spilled, bytes);
+	if(num_spilled!=fp->numlayers || num_differences!=0 || memcmp(lb, lb_spilled, sizeof(lb)) || bytes_spilled >= bytes){
+		res = 1;
+	}
+	elina_abstract0_free(man, element);
+	elina_abstract0_free(man_spilled, spilled);
+	elina_manager_free(man);
+	elina_manager_free(man_spilled);
+	network_free(net);
+	return res;
+}
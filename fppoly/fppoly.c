@@ -19,6 +19,10 @@
  */
 
 #include "fppoly.h"
+#include "fppoly_arena.h"
+#include "fppoly_kernels.h"
+#include "fppoly_spill.h"
+#include <float.h>
 
 
 fppoly_t* fppoly_of_abstract0(elina_abstract0_t* a)
@@ -40,6 +44,8 @@ static inline void fppoly_internal_free(fppoly_internal_t* pr)
 {
     if (pr) {
 	pr->funid = ELINA_FUNID_UNKNOWN;
+	elina_thread_pool_free(pr->pool);
+	pr->pool = NULL;
 	free(pr);
 	pr = NULL;
     }
@@ -54,6 +60,16 @@ static inline fppoly_internal_t* fppoly_internal_alloc(void)
     pr->funopt = NULL; 
     pr->min_denormal = ldexpl(1.0,-1074);
     pr->ulp = ldexpl(1.0,-52);
+    pr->min_denormal_float = ldexp(1.0,-149);
+    pr->ulp_float = ldexp(1.0,-23);
+    pr->pool = elina_thread_pool_alloc(0);
+    pr->backsubst_policy = BACKSUBST_FULL;
+    pr->backsubst_min_depth = 1;
+    pr->concretize_every_layer = false;
+    pr->implicit_conv = false;
+    pr->memory_budget = 0;
+    pr->float32 = false;
+    pr->skipped_layers = 0;
     return pr;
 }
 
@@ -88,6 +104,93 @@ elina_manager_t * fppoly_manager_alloc(void){
 }
 
 
+/* 0 selects the number of online processors */
+void fppoly_manager_set_num_threads(elina_manager_t* man, size_t num_threads){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	elina_thread_pool_free(pr->pool);
+	pr->pool = elina_thread_pool_alloc(num_threads);
+}
+
+
+size_t fppoly_manager_get_num_threads(elina_manager_t* man){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	return elina_thread_pool_get_num_threads(pr->pool);
+}
+
+
+/* seconds each thread spent on back-substitution since the last reset, busy_time has fppoly_manager_get_num_threads entries */
+void fppoly_manager_get_busy_time(elina_manager_t* man, double *busy_time){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	elina_thread_pool_get_busy_time(pr->pool, busy_time);
+}
+
+
+void fppoly_manager_reset_busy_time(elina_manager_t* man){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	elina_thread_pool_reset_busy_time(pr->pool);
+}
+
+
+/* with BACKSUBST_ADAPTIVE the neurons of ReLU layers are concretized over the bounds of every previous
+   layer reached after min_depth layers, the back-substitution stops once they decide the ReLU phase */
+void fppoly_manager_set_backsubst_policy(elina_manager_t* man, backsubst_policy_t policy, size_t min_depth){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->backsubst_policy = policy;
+	pr->backsubst_min_depth = min_depth;
+}
+
+
+/* with enable, get_lb/get_ub_using_previous_layers also bound the expression over the neurons of every
+   FFN or CONV layer it goes through and return the tightest bound instead of the one over the input */
+void fppoly_manager_set_concretize_every_layer(elina_manager_t* man, bool enable){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->concretize_every_layer = enable;
+}
+
+
+/* with enable, the convolutional layers added by conv_handle_first_layer and conv_handle_intermediate_relu_layer
+   keep their filter and the expressions of their neurons are rebuilt from it at each use, instead of being stored */
+void fppoly_manager_set_implicit_conv(elina_manager_t* man, bool enable){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->implicit_conv = enable;
+}
+
+
+/* with a non-zero budget, once the layers of an abstract element hold more than budget bytes after a layer is added,
+   the expressions of the oldest layers are spilled to a temporary file mapped in memory, in $TMPDIR or /tmp, until
+   they fit; the pages of the spilled layers read by back-substitution are dropped from memory again at each layer
+   added. Only layers whose neurons have point expressions of one type, as the affine and convolutional ones, are
+   spilled */
+void fppoly_manager_set_memory_budget(elina_manager_t* man, size_t budget){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->memory_budget = budget;
+}
+
+
+/* with enable, the expressions of the affine and convolutional layers are packed with float32 coefficients once the
+   bounds of their neurons are computed, which halves the memory they hold and the memory back-substitution reads
+   through the dense ones: the float32 kernels multiply their rows in place, widening them in registers. Each
+   coefficient stands for the interval of its rounding error around it, so the bounds remain sound and can be
+   slightly looser */
+void fppoly_manager_set_float32(elina_manager_t* man, bool enable){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->float32 = enable;
+}
+
+
+/* number of layers the back-substitution of a neuron did not go through, summed over all neurons */
+size_t fppoly_manager_get_skipped_layers(elina_manager_t* man){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	return pr->skipped_layers;
+}
+
+
+void fppoly_manager_reset_skipped_layers(elina_manager_t* man){
+	fppoly_internal_t *pr = (fppoly_internal_t*)man->internal;
+	pr->skipped_layers = 0;
+}
+
+
 
 void expr_fprint(FILE * stream, expr_t *expr){
 	if((expr->inf_coeff==NULL) || (expr->sup_coeff==NULL)){
@@ -102,7 +205,7 @@ void expr_fprint(FILE * stream, expr_t *expr){
 				fprintf(stream, "[%.20lf, %.20lf]x0 ", -expr->inf_coeff[0],expr->sup_coeff[0]);
 			}
 			else{
-				fprintf(stream, "[%.20lf, %.20lf]x%zu ", -expr->inf_coeff[0],expr->sup_coeff[0],expr->dim[0]);
+				fprintf(stream, "[%.20lf, %.20lf]x%u ", -expr->inf_coeff[0],expr->sup_coeff[0],expr->dim[0]);
 			}
 		}
 		
@@ -111,7 +214,7 @@ void expr_fprint(FILE * stream, expr_t *expr){
 				fprintf(stream,"+ [%.20lf, %.20lf]x%zu ",-expr->inf_coeff[i],expr->sup_coeff[i],i);
 			}
 			else{
-				fprintf(stream,"+ [%.20lf, %.20lf]x%zu ",-expr->inf_coeff[i],expr->sup_coeff[i],expr->dim[i]);
+				fprintf(stream,"+ [%.20lf, %.20lf]x%u ",-expr->inf_coeff[i],expr->sup_coeff[i],expr->dim[i]);
 			}
 		}
 	}
@@ -142,18 +245,38 @@ void expr_print(expr_t * expr){
 }
 
 expr_t * alloc_expr(void){
-	expr_t *expr = (expr_t *)malloc(sizeof(expr_t));
+	expr_t *expr = (expr_t *)fppoly_arena_alloc(sizeof(expr_t));
 	expr->inf_coeff = NULL;
 	expr->sup_coeff = NULL;
 	expr->dim = NULL;
 	return expr;
 }
 
+/* the coefficients of expr are stored in a single block: inf_coeff and sup_coeff hold size entries each,
+   padded to a multiple of 8 so that both start on a cache line, followed by dim for SPARSE expressions */
+void expr_alloc_coeffs(expr_t *expr, size_t size, exprtype_t type){
+	size_t stride = (size + 7) & ~(size_t)7;
+	size_t bytes = 2*stride*sizeof(double);
+	if(type==SPARSE){
+		bytes += size*sizeof(uint32_t);
+	}
+	expr->inf_coeff = (double *)fppoly_arena_alloc(bytes);
+	expr->sup_coeff = expr->inf_coeff + stride;
+	expr->dim = type==SPARSE ? (uint32_t *)(expr->sup_coeff + stride) : NULL;
+}
+
+void expr_free_coeffs(expr_t *expr){
+	if(expr->inf_coeff){
+		fppoly_arena_free(expr->inf_coeff);
+	}
+	expr->inf_coeff = NULL;
+	expr->sup_coeff = NULL;
+	expr->dim = NULL;
+}
+
 expr_t * create_dense_expr(double *coeff, double cst, size_t size){
-	expr_t *expr = (expr_t *)malloc(sizeof(expr_t));
-	expr->inf_coeff = (double *)malloc(size*sizeof(double));
-	expr->sup_coeff = (double *)malloc(size*sizeof(double));
-	expr->dim= NULL;
+	expr_t *expr = alloc_expr();
+	expr_alloc_coeffs(expr,size,DENSE);
 	size_t i;
 	expr->size = size;
 	expr->inf_cst = -cst;
@@ -168,10 +291,7 @@ expr_t * create_dense_expr(double *coeff, double cst, size_t size){
 
 
 expr_t * create_cst_expr(double l, double u){
-	expr_t *expr = (expr_t*)malloc(sizeof(expr_t));
-	expr->inf_coeff = NULL;
-	expr->sup_coeff = NULL;
-	expr->dim = NULL;
+	expr_t *expr = alloc_expr();
 	expr->type = SPARSE;
 	expr->size = 0;
 	expr->inf_cst = l;
@@ -180,16 +300,9 @@ expr_t * create_cst_expr(double l, double u){
 }
 
 expr_t * create_sparse_expr(double *coeff, double cst, size_t *dim, size_t size){
-	expr_t *expr = (expr_t *)malloc(sizeof(expr_t));
+	expr_t *expr = alloc_expr();
 	if(size>0){
-		expr->inf_coeff = (double *)malloc(size*sizeof(double));
-		expr->sup_coeff = (double *)malloc(size*sizeof(double));
-		expr->dim = (size_t *)malloc(size*sizeof(size_t));
-	}
-	else{
-		expr->inf_coeff = NULL;
-		expr->sup_coeff = NULL;
-		expr->dim = NULL;
+		expr_alloc_coeffs(expr,size,SPARSE);
 	}
 	size_t i;
 	expr->size = size;
@@ -205,31 +318,237 @@ expr_t * create_sparse_expr(double *coeff, double cst, size_t *dim, size_t size)
 }
 
 
-void free_expr(expr_t *expr){
-	if(expr->inf_coeff){
+long int max(long int a, long int b){
+	return a> b? a : b;
+
+}
+
+
+/* sets conv to the filter of a convolution with output of size output_size, weights and bias are not copied */
+static void conv_filter_init(conv_filter_t *conv, double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+			     size_t *output_size, size_t *strides, bool is_valid_padding, bool has_bias){
+	size_t i;
+	conv->weights = filter_weights;
+	conv->bias = has_bias ? filter_bias : NULL;
+	for(i=0; i < 3; i++){
+		conv->input_size[i] = input_size[i];
+	}
+	for(i=0; i < 2; i++){
+		conv->filter_size[i] = filter_size[i];
+		conv->strides[i] = strides[i];
+	}
+	elina_nn_conv_geometry(conv->output_size, &conv->pad_top, &conv->pad_left, input_size, filter_size, output_size[2], strides, is_valid_padding);
+}
+
+
+/* a filter owning a copy of the weights and bias, for an implicit convolutional layer */
+static conv_filter_t * conv_filter_alloc(double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+					 size_t *output_size, size_t *strides, bool is_valid_padding, bool has_bias){
+	conv_filter_t *conv = (conv_filter_t *)malloc(sizeof(conv_filter_t));
+	size_t num_weights = filter_size[0]*filter_size[1]*input_size[2]*output_size[2];
+	conv_filter_init(conv, filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
+	conv->weights = (double *)malloc(num_weights*sizeof(double));
+	memcpy(conv->weights, filter_weights, num_weights*sizeof(double));
+	if(has_bias){
+		conv->bias = (double *)malloc(output_size[2]*sizeof(double));
+		memcpy(conv->bias, filter_bias, output_size[2]*sizeof(double));
+	}
+	return conv;
+}
+
+
+static void conv_filter_free(conv_filter_t *conv){
+	free(conv->weights);
+	free(conv->bias);
+	free(conv);
+}
+
+
+/* the part of the window of an output position inside the input: rows x_min to x_max-1 and columns
+   y_min to y_max-1 of the filter, whose row and column 0 are at input row x_start and column y_start */
+typedef struct conv_window_t{
+	long int x_start;
+	long int y_start;
+	size_t x_min;
+	size_t x_max;
+	size_t y_min;
+	size_t y_max;
+}conv_window_t;
+
+
+static void conv_window(conv_filter_t *conv, size_t pos, conv_window_t *win){
+	size_t out_x = pos / conv->output_size[1];
+	size_t out_y = pos - out_x*conv->output_size[1];
+	long int x_start = out_x*conv->strides[0] - conv->pad_top;
+	long int y_start = out_y*conv->strides[1] - conv->pad_left;
+	win->x_start = x_start;
+	win->y_start = y_start;
+	win->x_min = x_start < 0 ? -x_start : 0;
+	win->y_min = y_start < 0 ? -y_start : 0;
+	win->x_max = x_start + (long int)conv->filter_size[0] > (long int)conv->input_size[0] ? conv->input_size[0] - x_start : conv->filter_size[0];
+	win->y_max = y_start + (long int)conv->filter_size[1] > (long int)conv->input_size[1] ? conv->input_size[1] - y_start : conv->filter_size[1];
+}
+
+
+static inline size_t conv_window_size(conv_filter_t *conv, conv_window_t *win){
+	return (win->x_max - win->x_min)*(win->y_max - win->y_min)*conv->input_size[2];
+}
+
+
+/* sets expr, with room for conv_window_size coefficients, to the expression of filter out_z over the window win.
+   The window is scanned by input row, column and channel, which gives the input neurons in increasing order */
+static void conv_fill_expr(conv_filter_t *conv, conv_window_t *win, size_t out_z, expr_t *expr){
+	size_t *input_size = conv->input_size;
+	size_t num_filters = conv->output_size[2];
+	size_t i12 = input_size[1]*input_size[2];
+	size_t x_shift, y_shift, inp_z, i = 0;
+	double cst = conv->bias!=NULL ? conv->bias[out_z] : 0;
+	expr->size = conv_window_size(conv, win);
+	expr->type = SPARSE;
+	expr->inf_cst = -cst;
+	expr->sup_cst = cst;
+	for(x_shift = win->x_min; x_shift < win->x_max; x_shift++){
+		for(y_shift = win->y_min; y_shift < win->y_max; y_shift++){
+			size_t mat_y = (win->x_start + x_shift)*i12 + (win->y_start + y_shift)*input_size[2];
+			double *weights = conv->weights + (x_shift*conv->filter_size[1] + y_shift)*input_size[2]*num_filters + out_z;
+			for(inp_z=0; inp_z < input_size[2]; inp_z++){
+				double w = weights[inp_z*num_filters];
+				expr->inf_coeff[i] = -w;
+				expr->sup_coeff[i] = w;
+				expr->dim[i] = mat_y + inp_z;
+				i++;
+			}
+		}
+	}
+}
+
+
+/* the expression rebuilt by neuron_expr, one per thread, its coefficients are freed when the thread exits */
+static __thread expr_t neuron_scratch;
+static __thread size_t neuron_scratch_capacity = 0;
+static pthread_key_t neuron_scratch_key;
+static pthread_once_t neuron_scratch_key_once = PTHREAD_ONCE_INIT;
+
+static void neuron_scratch_key_alloc(void){
+	pthread_key_create(&neuron_scratch_key, free);
+}
+
+
+/* the expression of the thread rebuilt by neuron_expr, with room for capacity coefficients */
+static expr_t * neuron_scratch_expr(size_t capacity){
+	expr_t *expr = &neuron_scratch;
+	if(capacity > neuron_scratch_capacity){
+		size_t stride = (capacity + 7) & ~(size_t)7;
 		free(expr->inf_coeff);
-		expr->inf_coeff = NULL;
+		expr->inf_coeff = (double *)malloc(2*stride*sizeof(double) + stride*sizeof(uint32_t));
+		expr->sup_coeff = expr->inf_coeff + stride;
+		expr->dim = (uint32_t *)(expr->sup_coeff + stride);
+		neuron_scratch_capacity = capacity;
+		pthread_once(&neuron_scratch_key_once, neuron_scratch_key_alloc);
+		pthread_setspecific(neuron_scratch_key, expr->inf_coeff);
+	}
+	return expr;
+}
+
+
+/* the expression of neuron i of an implicit convolutional layer, valid until the next call by the same thread */
+static expr_t * conv_neuron_expr(conv_filter_t *conv, size_t i){
+	conv_window_t win;
+	size_t num_filters = conv->output_size[2];
+	expr_t *expr = neuron_scratch_expr(conv->filter_size[0]*conv->filter_size[1]*conv->input_size[2]);
+	conv_window(conv, i / num_filters, &win);
+	conv_fill_expr(conv, &win, i % num_filters, expr);
+	return expr;
+}
+
+
+/* coefficient k of the expressions of a packed layer */
+static inline double spill_coeff(layer_spill_t *spill, size_t k){
+	return spill->dtype==FPPOLY_WEIGHTS_FLOAT64 ? ((double *)spill->coeffs)[k] : (double)((float *)spill->coeffs)[k];
+}
+
+
+/* the expression of neuron i of a packed layer, valid until the next call by the same thread */
+static expr_t * spill_neuron_expr(layer_spill_t *spill, size_t i){
+	size_t start = spill->start[i];
+	size_t size = spill->start[i+1] - start;
+	size_t j;
+	expr_t *expr = neuron_scratch_expr(size);
+	expr->size = size;
+	expr->type = spill->type;
+	expr->inf_cst = spill->cst[2*i];
+	expr->sup_cst = spill->cst[2*i+1];
+	for(j=0; j < size; j++){
+		double w = spill_coeff(spill, start+j);
+		expr->inf_coeff[j] = -w;
+		expr->sup_coeff[j] = w;
+		if(spill->dtype==FPPOLY_WEIGHTS_FLOAT32){
+			double err = spill->coeff_ulp*fabs(w) + spill->coeff_min;
+			expr->inf_coeff[j] += err;
+			expr->sup_coeff[j] += err;
+		}
+	}
+	if(spill->type==SPARSE){
+		memcpy(expr->dim, spill->dim + start, size*sizeof(uint32_t));
+	}
+	return expr;
+}
+
+
+/* weight (i,j) of a layer given by a buffer */
+static inline double layer_weight(layer_weights_t *weights, size_t i, size_t j){
+	size_t k = weights->layout==FPPOLY_ROW_MAJOR ? i*weights->ld + j : j*weights->ld + i;
+	return weights->dtype==FPPOLY_WEIGHTS_FLOAT64 ? ((double *)weights->weights)[k] : (double)((float *)weights->weights)[k];
+}
+
+
+static inline double layer_bias(layer_weights_t *weights, size_t i){
+	return weights->dtype==FPPOLY_WEIGHTS_FLOAT64 ? ((double *)weights->bias)[i] : (double)((float *)weights->bias)[i];
+}
+
+
+/* the expression of neuron i of a layer given by a buffer, valid until the next call by the same thread */
+static expr_t * weights_neuron_expr(layer_weights_t *weights, size_t i){
+	size_t j, num_in = weights->num_in;
+	double bias = layer_bias(weights, i);
+	expr_t *expr = neuron_scratch_expr(num_in);
+	expr->size = num_in;
+	expr->type = DENSE;
+	expr->inf_cst = -bias;
+	expr->sup_cst = bias;
+	for(j=0; j < num_in; j++){
+		double w = layer_weight(weights, i, j);
+		expr->inf_coeff[j] = -w;
+		expr->sup_coeff[j] = w;
 	}
-	if(expr->sup_coeff){
-		free(expr->sup_coeff);
-		expr->sup_coeff = NULL;
+	return expr;
+}
+
+
+/* the expression of neuron i of layer; for an implicit convolutional layer, a packed layer or a layer given by a
+   buffer it is rebuilt in a buffer of the thread and only valid until the next call */
+static inline expr_t * neuron_expr(layer_t *layer, size_t i){
+	if(layer->conv!=NULL){
+		return conv_neuron_expr(layer->conv, i);
 	}
-	if(expr->type==SPARSE && expr->dim){
-		free(expr->dim);
+	if(layer->weights!=NULL){
+		return weights_neuron_expr(layer->weights, i);
 	}
-	expr->dim = NULL;
-	free(expr);
+	return layer->spill==NULL ? layer->neurons[i]->expr : spill_neuron_expr(layer->spill, i);
+}
+
+
+void free_expr(expr_t *expr){
+	expr_free_coeffs(expr);
+	fppoly_arena_free(expr);
 	expr = NULL;  
 }
 
 expr_t * copy_cst_expr(expr_t *src){
-	expr_t *dst = (expr_t *)malloc(sizeof(expr_t));
-	dst->inf_coeff = NULL;
-	dst->sup_coeff = NULL;
+	expr_t *dst = alloc_expr();
 	dst->inf_cst = src->inf_cst;
 	dst->sup_cst = src->sup_cst; 
 	dst->type = src->type;
-	dst->dim = NULL;
 	dst->size = src->size; 
 	return dst;
 }
@@ -237,9 +556,8 @@ expr_t * copy_cst_expr(expr_t *src){
 
 
 expr_t * copy_expr(expr_t *src){
-	expr_t *dst = (expr_t *)malloc(sizeof(expr_t));
-	dst->inf_coeff = (double *)malloc(src->size*sizeof(double));
-	dst->sup_coeff = (double *)malloc(src->size*sizeof(double));
+	expr_t *dst = alloc_expr();
+	expr_alloc_coeffs(dst,src->size,src->type);
 	
 	size_t i;
 	dst->inf_cst = src->inf_cst;
@@ -250,7 +568,6 @@ expr_t * copy_expr(expr_t *src){
 		dst->sup_coeff[i] = src->sup_coeff[i];
 	}
 	if(src->type==SPARSE){
-		dst->dim = (size_t *)malloc(src->size*sizeof(size_t));
 		for(i=0; i < src->size; i++){
 			dst->dim[i] = src->dim[i];
 		}
@@ -259,10 +576,226 @@ expr_t * copy_expr(expr_t *src){
 	return dst;
 }
 
+/* bytes of a coefficient of a packed layer */
+static inline size_t spill_coeff_size(layer_spill_t *spill){
+	return spill->dtype==FPPOLY_WEIGHTS_FLOAT64 ? sizeof(double) : sizeof(float);
+}
+
+
+/* bytes of the block of a packed layer of dims neurons */
+static size_t layer_spill_bytes(layer_spill_t *spill, size_t dims){
+	size_t total = spill->start[dims];
+	return 2*dims*sizeof(double) + total*spill_coeff_size(spill) + (spill->type==SPARSE ? total*sizeof(uint32_t) : 0);
+}
+
+
+/* points the constants, coefficients and dimensions of a packed layer of dims neurons into the block data */
+static void layer_spill_set_block(layer_spill_t *spill, size_t dims, void *data){
+	spill->cst = (double *)data;
+	spill->coeffs = spill->cst + 2*dims;
+	spill->dim = spill->type==SPARSE ? (uint32_t *)((char *)spill->coeffs + spill->start[dims]*spill_coeff_size(spill)) : NULL;
+}
+
+
+/* packs the expressions of the neurons of layer in a block on the heap or, with to_file, in a spill file, with
+   coefficients of type dtype. The rounding error of a coefficient packed in float32 is at most ulp_float times its
+   magnitude plus min_denormal_float, the coefficient stands for the interval of this radius around it. Returns false
+   and leaves layer as it is when the expressions are not point expressions of one type, a coefficient does not fit
+   in dtype or the block cannot be created */
+static bool layer_pack(fppoly_internal_t *pr, layer_t *layer, fppoly_weights_dtype_t dtype, bool to_file){
+	neuron_t **neurons = layer->neurons;
+	size_t dims = layer->dims;
+	size_t i, j;
+	if(layer->spill!=NULL || layer->conv!=NULL || (layer->type!=FFN && layer->type!=CONV) || dims==0){
+		return false;
+	}
+	for(i=0; i < dims; i++){
+		expr_t *expr = neurons[i]->expr;
+		if(expr==NULL || expr->type!=neurons[0]->expr->type){
+			return false;
+		}
+		for(j=0; j < expr->size; j++){
+			if(expr->inf_coeff[j]!=-expr->sup_coeff[j] || (dtype==FPPOLY_WEIGHTS_FLOAT32 && fabs(expr->sup_coeff[j]) > FLT_MAX)){
+				return false;
+			}
+		}
+	}
+	layer_spill_t *spill = (layer_spill_t *)malloc(sizeof(layer_spill_t));
+	spill->type = neurons[0]->expr->type;
+	spill->dtype = dtype;
+	spill->coeff_ulp = dtype==FPPOLY_WEIGHTS_FLOAT32 ? pr->ulp_float : 0;
+	spill->coeff_min = dtype==FPPOLY_WEIGHTS_FLOAT32 ? pr->min_denormal_float : 0;
+	spill->start = (size_t *)malloc((dims+1)*sizeof(size_t));
+	spill->start[0] = 0;
+	for(i=0; i < dims; i++){
+		spill->start[i+1] = spill->start[i] + neurons[i]->expr->size;
+	}
+	size_t bytes = layer_spill_bytes(spill, dims);
+	fppoly_spill_t *buffer = NULL;
+	void *data;
+	if(to_file){
+		buffer = fppoly_spill_alloc(bytes);
+		data = buffer==NULL ? NULL : fppoly_spill_data(buffer);
+	}
+	else{
+		data = malloc(bytes);
+	}
+	if(data==NULL){
+		free(spill->start);
+		free(spill);
+		return false;
+	}
+	spill->buffer = buffer;
+	layer_spill_set_block(spill, dims, data);
+	for(i=0; i < dims; i++){
+		expr_t *expr = neurons[i]->expr;
+		size_t start = spill->start[i];
+		spill->cst[2*i] = expr->inf_cst;
+		spill->cst[2*i+1] = expr->sup_cst;
+		if(dtype==FPPOLY_WEIGHTS_FLOAT64){
+			memcpy((double *)spill->coeffs + start, expr->sup_coeff, expr->size*sizeof(double));
+		}
+		else{
+			float *coeffs = (float *)spill->coeffs + start;
+			for(j=0; j < expr->size; j++){
+				coeffs[j] = (float)expr->sup_coeff[j];
+			}
+		}
+		if(spill->type==SPARSE && expr->size > 0){
+			memcpy(spill->dim + start, expr->dim, expr->size*sizeof(uint32_t));
+		}
+		free_expr(expr);
+		neurons[i]->expr = NULL;
+	}
+	if(buffer!=NULL){
+		fppoly_spill_seal(buffer);
+	}
+	layer->spill = spill;
+	return true;
+}
+
+
+/* moves the expressions of the neurons of layer, or their block on the heap once packed in float32, to a spill
+   file, returns false and leaves layer as it is when they cannot be spilled */
+static bool layer_spill(fppoly_internal_t *pr, layer_t *layer){
+	layer_spill_t *spill = layer->spill;
+	if(spill==NULL){
+		return layer_pack(pr, layer, FPPOLY_WEIGHTS_FLOAT64, true);
+	}
+	if(spill->buffer!=NULL){
+		return false;
+	}
+	size_t bytes = layer_spill_bytes(spill, layer->dims);
+	fppoly_spill_t *buffer = fppoly_spill_alloc(bytes);
+	if(buffer==NULL){
+		return false;
+	}
+	memcpy(fppoly_spill_data(buffer), spill->cst, bytes);
+	fppoly_spill_seal(buffer);
+	free(spill->cst);
+	spill->buffer = buffer;
+	layer_spill_set_block(spill, layer->dims, fppoly_spill_data(buffer));
+	return true;
+}
+
+
+/* frees the packed expressions of layer, if any */
+static void layer_spill_free(layer_t *layer){
+	if(layer->spill!=NULL){
+		if(layer->spill->buffer!=NULL){
+			fppoly_spill_free(layer->spill->buffer);
+		}
+		else{
+			free(layer->spill->cst);
+		}
+		free(layer->spill->start);
+		free(layer->spill);
+		layer->spill = NULL;
+	}
+}
+
+
+static size_t expr_bytes(expr_t *expr){
+	if(expr==NULL){
+		return 0;
+	}
+	return sizeof(expr_t) + expr->size*(2*sizeof(double) + (expr->type==SPARSE ? sizeof(uint32_t) : 0));
+}
+
+
+/* bytes of layer on the heap */
+static size_t layer_resident_bytes(layer_t *layer){
+	size_t i, res = sizeof(layer_t) + layer->dims*(sizeof(neuron_t *) + sizeof(neuron_t));
+	for(i=0; i < layer->dims; i++){
+		neuron_t *neuron = layer->neurons[i];
+		res += expr_bytes(neuron->expr) + expr_bytes(neuron->lexpr) + expr_bytes(neuron->uexpr);
+	}
+	if(layer->conv!=NULL){
+		conv_filter_t *conv = layer->conv;
+		res += sizeof(conv_filter_t) + conv->filter_size[0]*conv->filter_size[1]*conv->input_size[2]*conv->output_size[2]*sizeof(double);
+		if(conv->bias!=NULL){
+			res += conv->output_size[2]*sizeof(double);
+		}
+	}
+	if(layer->spill!=NULL){
+		res += sizeof(layer_spill_t) + (layer->dims+1)*sizeof(size_t);
+		if(layer->spill->buffer==NULL){
+			res += layer_spill_bytes(layer->spill, layer->dims);
+		}
+	}
+	if(layer->weights!=NULL){
+		res += sizeof(layer_weights_t);
+	}
+	if(layer->dirty!=NULL){
+		res += layer->dims*sizeof(bool);
+	}
+	return res + layer->num_predecessors*sizeof(size_t);
+}
+
+
+/* predecessor j of layer k, numbered as in layer_t */
+static inline size_t layer_predecessor(layer_t *layer, size_t k, size_t j){
+	return layer->predecessors==NULL ? k : layer->predecessors[j];
+}
+
+
+/* in float32 mode, packs the affine and convolutional layers of fp not packed yet in float32. Then with a memory
+   budget, spills the oldest layers of fp until the bytes of its layers fit in it and drops the pages of the spilled
+   layers read since the last call from memory */
+static void fppoly_compact_layers(fppoly_internal_t *pr, fppoly_t *fp){
+	size_t k, total = 0;
+	if(pr->float32){
+		for(k=0; k < fp->numlayers; k++){
+			layer_t *layer = fp->layers[k];
+			if(layer->spill==NULL && (layer->type==FFN || layer->type==CONV) && layer->conv==NULL && layer->weights==NULL){
+				layer_pack(pr, layer, FPPOLY_WEIGHTS_FLOAT32, false);
+			}
+		}
+	}
+	if(pr->memory_budget==0){
+		return;
+	}
+	for(k=0; k < fp->numlayers; k++){
+		total += layer_resident_bytes(fp->layers[k]);
+	}
+	for(k=0; k < fp->numlayers && total > pr->memory_budget; k++){
+		layer_t *layer = fp->layers[k];
+		size_t bytes = layer_resident_bytes(layer);
+		if(layer_spill(pr, layer)){
+			total -= bytes - layer_resident_bytes(layer);
+		}
+	}
+	for(k=0; k < fp->numlayers; k++){
+		if(fp->layers[k]->spill!=NULL && fp->layers[k]->spill->buffer!=NULL){
+			fppoly_spill_release(fp->layers[k]->spill->buffer);
+		}
+	}
+}
+
+
 expr_t* concretize_dense_sub_expr(fppoly_internal_t *pr, expr_t * expr, double *inf, double *sup, size_t start, size_t size){
-	expr_t * res = (expr_t *)malloc(sizeof(expr_t));
-	res->inf_coeff = (double *)malloc(start*sizeof(double));
-	res->sup_coeff = (double *)malloc(start*sizeof(double));
+	expr_t * res = alloc_expr();
+	expr_alloc_coeffs(res,start,expr->type);
 	size_t i;
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
@@ -288,8 +821,8 @@ void merge_sparse_expr(expr_t *expr, size_t l, size_t m, size_t r) {
     int n2 = r - m;
 
     /* create temp arrays */
-    size_t *L = (size_t *)malloc(n1*sizeof(size_t));
-    size_t *R = (size_t *)malloc(n2*sizeof(size_t));
+    uint32_t *L = (uint32_t *)malloc(n1*sizeof(uint32_t));
+    uint32_t *R = (uint32_t *)malloc(n2*sizeof(uint32_t));
     double *L2 = (double *)malloc(n1*sizeof(double));
     double *R2 = (double *)malloc(n2*sizeof(double));
     double *L3 = (double *)malloc(n1*sizeof(double));
@@ -398,6 +931,14 @@ layer_t * create_layer(size_t size, layertype_t type, activation_type_t activati
 	layer->h_t_sup = NULL;
 	layer->c_t_inf = NULL;
 	layer->c_t_sup = NULL;
+	layer->matrix_form = false;
+	layer->conv = NULL;
+	layer->predecessors = NULL;
+	layer->num_predecessors = 0;
+	layer->spill = NULL;
+	layer->weights = NULL;
+	layer->windows = NULL;
+	layer->dirty = NULL;
 	return layer;
 }
 
@@ -419,6 +960,7 @@ void fppoly_from_network_input_box(fppoly_t *res, size_t intdim, size_t realdim,
 	}
 	res->num_pixels = num_pixels;
 	res->out = NULL;
+	res->next_predecessor = -1;
 }
 
 
@@ -432,6 +974,7 @@ void fppoly_set_network_input_box(elina_manager_t *man, elina_abstract0_t* eleme
     fppoly_t * res = fppoly_of_abstract0(element);
     size_t num_pixels = intdim + realdim;
 	res->numlayers = 0;
+	res->next_predecessor = -1;
     size_t i;
     for(i=0; i < num_pixels; i++){
         res->input_inf[i] = -inf_array[i];
@@ -485,17 +1028,45 @@ void fppoly_alloc_first_layer(fppoly_t *fp, size_t size, layertype_t type, activ
         fp->layers = (layer_t **)malloc(2000*sizeof(layer_t *));
 	fp->layers[0] = layer;
 	fp->numlayers = 1;
+	fp->next_predecessor = -1;
 	return;
 }
 
 void fppoly_add_new_layer(fppoly_t *fp, size_t size, layertype_t type, activation_type_t activation){
 	size_t numlayers = fp->numlayers;
-	fp->layers[numlayers] = create_layer(size,type, activation);
+	layer_t *layer = create_layer(size,type, activation);
+	if(fp->next_predecessor >= 0 && (size_t)fp->next_predecessor!=numlayers){
+		layer->predecessors = (size_t *)malloc(sizeof(size_t));
+		layer->predecessors[0] = fp->next_predecessor;
+		layer->num_predecessors = 1;
+	}
+	fp->next_predecessor = -1;
+	fp->layers[numlayers] = layer;
 	fp->numlayers++;
 	return;
 }
 
 
+void fppoly_set_next_layer_input(elina_manager_t *man, elina_abstract0_t *element, size_t predecessor){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	assert(predecessor <= fp->numlayers);
+	fp->next_predecessor = predecessor;
+}
+
+
+/* true if each of the first num_layers layers of fp reads the output of the layer before it, back-substitution
+   from them then goes through the layers in order */
+static bool fppoly_is_chain(fppoly_t *fp, size_t num_layers){
+	size_t k;
+	for(k=0; k < num_layers; k++){
+		if(fp->layers[k]->predecessors!=NULL){
+			return false;
+		}
+	}
+	return true;
+}
+
+
 void elina_double_interval_add_expr_coeff(fppoly_internal_t *pr, double * res_inf, double *res_sup, double inf, double sup, double inf_expr, double sup_expr){
 	*res_inf = inf + inf_expr;
 	*res_sup = sup + sup_expr;
@@ -520,29 +1091,14 @@ void elina_double_interval_add_cst_coeff(fppoly_internal_t *pr, double * res_inf
 expr_t * multiply_expr(fppoly_internal_t *pr, expr_t *expr, double mul_inf, double mul_sup){
 	expr_t * res = alloc_expr();
 	if(expr->size > 0){
-		res->inf_coeff = malloc(expr->size*sizeof(double));
-		res->sup_coeff = malloc(expr->size*sizeof(double));
-	}
-	else{
-		res->inf_coeff = NULL;		
-		res->sup_coeff = NULL;
+		expr_alloc_coeffs(res,expr->size,expr->type);
 	}
 	res->type = expr->type;
 	size_t i;
-	for(i=0; i < expr->size; i++){
-		//res->coeff[i] = mul_coeff*expr->coeff[i];
-		elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],mul_inf,mul_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-		
-	}
+	fppoly_kernel_scale(res->inf_coeff,res->sup_coeff,expr->inf_coeff,expr->sup_coeff,mul_inf,mul_sup,pr->ulp,expr->size);
 	if(expr->type==SPARSE){
-		if(expr->size>0){
-			res->dim = (size_t*)malloc(expr->size*sizeof(size_t));
-			for(i=0; i < expr->size; i++){
-				res->dim[i] = expr->dim[i];
-			}
-		}
-		else{
-			res->dim = NULL;
+		for(i=0; i < expr->size; i++){
+			res->dim[i] = expr->dim[i];
 		}
 	}
 	res->size = expr->size;
@@ -598,15 +1154,14 @@ void add_expr(fppoly_internal_t *pr,expr_t * exprA, expr_t * exprB){
 		double maxB = fmax(fabs(exprB->inf_cst),fabs(exprB->sup_cst));
 		exprA->inf_cst += exprB->inf_cst  + (maxA + maxB)*pr->ulp + pr->min_denormal;
 		exprA->sup_cst += exprB->sup_cst  + (maxA + maxB)*pr->ulp + pr->min_denormal;
-		exprA->inf_coeff = (double *)malloc(sizeB*sizeof(double));
-		exprA->sup_coeff = (double *)malloc(sizeB*sizeof(double));
+		expr_free_coeffs(exprA);
+		expr_alloc_coeffs(exprA,sizeB,exprB->type);
 		for(i=0; i < sizeB; i++){
 			exprA->inf_coeff[i] = exprB->inf_coeff[i];
 			exprA->sup_coeff[i] = exprB->sup_coeff[i];
 		} 
 		exprA->type = exprB->type;
 		if(exprA->type==SPARSE){
-			exprA->dim = (size_t *)malloc(sizeB*sizeof(size_t));
 			for(i=0; i < sizeB; i++){
 				exprA->dim[i] = exprB->dim[i];
 			}
@@ -616,19 +1171,14 @@ void add_expr(fppoly_internal_t *pr,expr_t * exprA, expr_t * exprB){
 	}
 	else{
 		size_t sizeA = exprA->size;
-		assert(sizeA==sizeB);
 		double maxA = fmax(fabs(exprA->inf_cst),fabs(exprA->sup_cst));
 		double maxB = fmax(fabs(exprB->inf_cst),fabs(exprB->sup_cst));
 		exprA->inf_cst += exprB->inf_cst  + (maxA + maxB)*pr->ulp + pr->min_denormal;
 		exprA->sup_cst += exprB->sup_cst  + (maxA + maxB)*pr->ulp + pr->min_denormal;
 		if(exprA->type==DENSE){
 			if(exprB->type==DENSE){
-				for(i=0; i < sizeB; i++){
-					maxA = fmax(fabs(exprA->inf_coeff[i]),fabs(exprA->sup_coeff[i]));
-					maxB = fmax(fabs(exprB->inf_coeff[i]),fabs(exprB->sup_coeff[i]));
-					exprA->inf_coeff[i] = exprA->inf_coeff[i] + exprB->inf_coeff[i] + (maxA + maxB)*pr->ulp;
-					exprA->sup_coeff[i] = exprA->sup_coeff[i] + exprB->sup_coeff[i] + (maxA + maxB)*pr->ulp;
-				}
+				assert(sizeA==sizeB);
+				fppoly_kernel_add(exprA->inf_coeff,exprA->sup_coeff,exprB->inf_coeff,exprB->sup_coeff,pr->ulp,sizeB);
 			}
 			else{
 				
@@ -644,110 +1194,85 @@ void add_expr(fppoly_internal_t *pr,expr_t * exprA, expr_t * exprB){
 				}
 			}
 		}
+		else if(exprB->type==SPARSE && sizeA==sizeB && !memcmp(exprA->dim,exprB->dim,sizeA*sizeof(uint32_t))){
+			/* same support, the merge below reduces to the dense sum */
+			fppoly_kernel_add(exprA->inf_coeff,exprA->sup_coeff,exprB->inf_coeff,exprB->sup_coeff,pr->ulp,sizeB);
+		}
 		else{
 			size_t sizeB = exprB->size;
 			size_t k;
-			double * new_inf_coeff;
-			double * new_sup_coeff;
+			expr_t merged;
 			if(exprB->type==DENSE){
 				
 				i=0;
-				new_inf_coeff = (double *)malloc(sizeB*sizeof(double));
-				new_sup_coeff = (double *)malloc(sizeB*sizeof(double));				
+				expr_alloc_coeffs(&merged,sizeB,DENSE);
 				for(k=0; k < sizeB; k++){
 					if(i < sizeA && exprA->dim[i] == k){
 						maxA = fmax(fabs(exprA->inf_coeff[i]),fabs(exprA->sup_coeff[i]));
 						maxB = fmax(fabs(exprB->inf_coeff[k]),fabs(exprB->sup_coeff[k]));
-						new_inf_coeff[k] = exprA->inf_coeff[i] + exprB->inf_coeff[k] + (maxA + maxB)*pr->ulp;
-						new_sup_coeff[k] = exprA->sup_coeff[i] + exprB->sup_coeff[k] + (maxA + maxB)*pr->ulp;
+						merged.inf_coeff[k] = exprA->inf_coeff[i] + exprB->inf_coeff[k] + (maxA + maxB)*pr->ulp;
+						merged.sup_coeff[k] = exprA->sup_coeff[i] + exprB->sup_coeff[k] + (maxA + maxB)*pr->ulp;
 						i++;
 					}
 					else{
-						new_inf_coeff[k] = exprB->inf_coeff[k];
-						new_sup_coeff[k] = exprB->sup_coeff[k];
+						merged.inf_coeff[k] = exprB->inf_coeff[k];
+						merged.sup_coeff[k] = exprB->sup_coeff[k];
 					}
 				}
 				exprA->type = DENSE;
 				exprA->size = sizeB;
-				free(exprA->dim);
-				exprA->dim = NULL;
 			}
 			else{
 				i=0;
 				k=0;
 				size_t l = 0;
-				//printf("before sort\n");
-				//expr_print(exprA);
-				//fflush(stdout);
-				//if(exprA->size>0){
-				//	sort_sparse_expr(exprA);
-				//}
-				//printf("after sort\n");
-				//expr_print(exprA);
-				//fflush(stdout);
-				//sort_sparse_expr(exprB);
-				new_inf_coeff = (double *)malloc((sizeA+sizeB)*sizeof(double));
-				new_sup_coeff = (double *)malloc((sizeA+sizeB)*sizeof(double));
-				size_t * new_dim = (size_t *)malloc((sizeA+sizeB)*sizeof(size_t));
+				/* the result is stored with room for sizeA+sizeB coefficients rather than shrunk to l */
+				expr_alloc_coeffs(&merged,sizeA+sizeB,SPARSE);
 				while(i < sizeA && k < sizeB){
 					if(exprA->dim[i] < exprB->dim[k]){
-						new_inf_coeff[l] = exprA->inf_coeff[i];
-						new_sup_coeff[l] = exprA->sup_coeff[i];
-						new_dim[l] = exprA->dim[i];
+						merged.inf_coeff[l] = exprA->inf_coeff[i];
+						merged.sup_coeff[l] = exprA->sup_coeff[i];
+						merged.dim[l] = exprA->dim[i];
 						i++;
 						
 					}
 					else if(exprB->dim[k] < exprA->dim[i]){
-						new_inf_coeff[l] = exprB->inf_coeff[k];
-						new_sup_coeff[l] = exprB->sup_coeff[k];
-						new_dim[l] = exprB->dim[k];
+						merged.inf_coeff[l] = exprB->inf_coeff[k];
+						merged.sup_coeff[l] = exprB->sup_coeff[k];
+						merged.dim[l] = exprB->dim[k];
 						k++;
 					}
 					else{
 						maxA = fmax(fabs(exprA->inf_coeff[i]),fabs(exprA->sup_coeff[i]));
 						maxB = fmax(fabs(exprB->inf_coeff[k]),fabs(exprB->sup_coeff[k]));
-						new_inf_coeff[l] = exprA->inf_coeff[i] + exprB->inf_coeff[k] + (maxA + maxB)*pr->ulp;
-						new_sup_coeff[l] = exprA->sup_coeff[i] + exprB->sup_coeff[k] + (maxA + maxB)*pr->ulp;
-						new_dim[l] = exprA->dim[i];
+						merged.inf_coeff[l] = exprA->inf_coeff[i] + exprB->inf_coeff[k] + (maxA + maxB)*pr->ulp;
+						merged.sup_coeff[l] = exprA->sup_coeff[i] + exprB->sup_coeff[k] + (maxA + maxB)*pr->ulp;
+						merged.dim[l] = exprA->dim[i];
 						i++;
 						k++;
 					}
 					l++;
 				}
 				while(i < sizeA){
-					new_inf_coeff[l] = exprA->inf_coeff[i];
-					new_sup_coeff[l] = exprA->sup_coeff[i];
-					new_dim[l] = exprA->dim[i];
+					merged.inf_coeff[l] = exprA->inf_coeff[i];
+					merged.sup_coeff[l] = exprA->sup_coeff[i];
+					merged.dim[l] = exprA->dim[i];
 					i++;
 					l++;
 				}
 				while(k < sizeB){
-					new_inf_coeff[l] = exprB->inf_coeff[k];
-					new_sup_coeff[l] = exprB->sup_coeff[k];
-					new_dim[l] = exprB->dim[k];
+					merged.inf_coeff[l] = exprB->inf_coeff[k];
+					merged.sup_coeff[l] = exprB->sup_coeff[k];
+					merged.dim[l] = exprB->dim[k];
 					k++;
 					l++;
 				}
-				
-				new_inf_coeff = (double*)realloc(new_inf_coeff,l*sizeof(double));
-				new_sup_coeff = (double*)realloc(new_sup_coeff,l*sizeof(double));
-				free(exprA->dim);
-				exprA->dim = NULL;
-				new_dim = (size_t *)realloc(new_dim,l*sizeof(size_t));
-				exprA->dim = new_dim;
 				exprA->size = l;
 			}
-			if(exprA->inf_coeff){
-				free(exprA->inf_coeff);
-				exprA->inf_coeff = NULL;
-			}
-			if(exprA->sup_coeff){
-				free(exprA->sup_coeff);
-				exprA->sup_coeff = NULL;
-			}
-			exprA->inf_coeff = new_inf_coeff;
-			exprA->sup_coeff = new_sup_coeff;
-			
+			expr_free_coeffs(exprA);
+			exprA->inf_coeff = merged.inf_coeff;
+			exprA->sup_coeff = merged.sup_coeff;
+			exprA->dim = merged.dim;
 		}
 	}
 }
@@ -906,8 +1431,6 @@ expr_t * replace_input_poly_cons_in_uexpr(fppoly_internal_t *pr, expr_t * expr,
 }
 
 double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp){
-	size_t i,k;
-	double tmp1, tmp2;
         //printf("start\n");
         //fflush(stdout);
 	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL)){
@@ -916,23 +1439,10 @@ double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp)
 	/* expr_print(expr); */
 	/* fflush(stdout); */
 	size_t dims = expr->size;
-	double res_inf = expr->inf_cst;
 	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
 		return 0;
 	}
-	for(i=0; i < dims; i++){
-		//if(expr->inf_coeff[i]<0){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}
-			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->input_inf[k],fp->input_sup[k]);
-			//printf("tmp1: %g\n",tmp1);
-			res_inf = res_inf + tmp1;
-			
-	}
+	double res_inf = fppoly_kernel_concretize_inf(expr->inf_cst,expr->inf_coeff,expr->sup_coeff,expr->type==DENSE ? NULL : expr->dim,fp->input_inf,fp->input_sup,dims);
 //	printf("inf: %g\n",-res_inf);
 //	fflush(stdout);
         if(fp->input_lexpr!=NULL && fp->input_uexpr!=NULL){
@@ -944,30 +1454,16 @@ double compute_lb_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp)
 }
 
 double compute_ub_from_expr(fppoly_internal_t *pr, expr_t * expr, fppoly_t * fp){
-	size_t i,k;
-	double tmp1, tmp2;
 
 	if((fp->input_lexpr!=NULL) && (fp->input_uexpr!=NULL)){
 		expr =  replace_input_poly_cons_in_uexpr(pr, expr, fp);
 	}
 
 	size_t dims = expr->size;
-	double res_sup = expr->sup_cst;
 	if(expr->inf_coeff==NULL || expr->sup_coeff==NULL){
 		return 0;
 	}
-	for(i=0; i < dims; i++){
-		//if(expr->inf_coeff[i]<0){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}		
-		elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],fp->input_inf[k],fp->input_sup[k]);
-		res_sup = res_sup + tmp2;
-			
-	}
+	double res_sup = fppoly_kernel_concretize_sup(expr->sup_cst,expr->inf_coeff,expr->sup_coeff,expr->type==DENSE ? NULL : expr->dim,fp->input_inf,fp->input_sup,dims);
 	//printf("sup: %g\n",res_sup);
 	//fflush(stdout);
 	if(fp->input_lexpr!=NULL && fp->input_uexpr!=NULL){
@@ -987,6 +1483,7 @@ void ffn_handle_first_layer(elina_manager_t* man, elina_abstract0_t * abs, doubl
     if(alloc){
         fppoly_alloc_first_layer(res,size, FFN, activation);
     } else {
+        layer_spill_free(res->layers[0]);
         res->numlayers = 1;
 	}
 	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
@@ -1006,6 +1503,8 @@ void ffn_handle_first_layer(elina_manager_t* man, elina_abstract0_t * abs, doubl
 		neuron->lb = compute_lb_from_expr(pr, neuron->expr,res);
 		neuron->ub = compute_ub_from_expr(pr, neuron->expr,res);
 	}
+	res->layers[0]->matrix_form = num_pixels > 0;
+	fppoly_compact_layers(pr, res);
 	
 	//printf("return here\n");
 	//fppoly_fprint(stdout,man,res,NULL);
@@ -1071,8 +1570,7 @@ expr_t * lexpr_replace_parabola_bounds(fppoly_internal_t * pr, expr_t * expr, ne
 	size_t num_neurons = expr->size;
 	size_t i,k;
 	expr_t * res = alloc_expr();  
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
@@ -1157,7 +1655,6 @@ expr_t * lexpr_replace_parabola_bounds(fppoly_internal_t * pr, expr_t * expr, ne
 		/* printf("[%d] res->inf_cst = %lf, res->sup_cst = %lf\n", (int)i, res->inf_cst, res->sup_cst); */
 	}
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -1169,8 +1666,7 @@ expr_t * uexpr_replace_parabola_bounds(fppoly_internal_t *pr, expr_t * expr, neu
 	size_t num_neurons = expr->size;
 	size_t i, k;
 	expr_t * res = alloc_expr();
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
@@ -1244,7 +1740,6 @@ expr_t * uexpr_replace_parabola_bounds(fppoly_internal_t *pr, expr_t * expr, neu
 
 	
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -1258,8 +1753,7 @@ expr_t * lexpr_replace_log_bounds(fppoly_internal_t * pr, expr_t * expr, neuron_
 	size_t num_neurons = expr->size;
 	size_t i,k;
 	expr_t * res = alloc_expr();  
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
@@ -1368,7 +1862,6 @@ expr_t * lexpr_replace_log_bounds(fppoly_internal_t * pr, expr_t * expr, neuron_
 	}
 	
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -1381,8 +1874,7 @@ expr_t * uexpr_replace_log_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_t
 	size_t num_neurons = expr->size;
 	size_t i, k;
 	expr_t * res = alloc_expr();
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
@@ -1492,7 +1984,6 @@ expr_t * uexpr_replace_log_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_t
 	
 
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -1502,176 +1993,78 @@ expr_t * uexpr_replace_log_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_t
 }
 
 
-expr_t * lexpr_replace_relu_bounds(fppoly_internal_t * pr, expr_t * expr, neuron_t ** neurons){
-	size_t num_neurons = expr->size;
-	size_t i,k;
-	expr_t * res = alloc_expr();  
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->inf_cst = expr->inf_cst;
-	res->sup_cst = expr->sup_cst;
-	res->type = expr->type;
-	res->size = num_neurons;  
-
-	for(i = 0; i < num_neurons; i++){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}
-		neuron_t *neuron_k = neurons[k];
-		double lb = neurons[k]->lb;
-		double ub = neurons[k]->ub;
-
-		double width = ub + lb;
-		double lambda_inf = -ub/width;
-		double lambda_sup = ub/width;
-		if((expr->sup_coeff[i]==0) && (expr->inf_coeff[i]==0)){
-			res->inf_coeff[i] = 0.0;
-			res->sup_coeff[i] = 0.0;
-			continue;
+/* replaces the ReLU of neuron in coefficient i of expr by its lower linear bound, or its upper one if upper is set,
+   and stores the coefficient in res */
+static inline void replace_relu_coeff(fppoly_internal_t *pr, expr_t *res, expr_t *expr, size_t i, neuron_t *neuron, bool upper){
+	double lb = neuron->lb;
+	double ub = neuron->ub;
+	double width = ub + lb;
+	double lambda_inf = -ub/width;
+	double lambda_sup = ub/width;
+	/* the coefficient takes the bound of the other side when it is negative */
+	bool neg = upper ? expr->inf_coeff[i]<0 : expr->sup_coeff[i]<0;
+	bool mixed = upper ? expr->sup_coeff[i]<0 : expr->inf_coeff[i]<0;
+	if((expr->sup_coeff[i]==0) && (expr->inf_coeff[i]==0)){
+		res->inf_coeff[i] = 0.0;
+		res->sup_coeff[i] = 0.0;
+	}
+	else if(ub<=0){
+		res->inf_coeff[i] = 0.0;
+		res->sup_coeff[i] = 0.0;
+	}
+	else if(lb<0){
+		res->inf_coeff[i] = expr->inf_coeff[i];
+		res->sup_coeff[i] = expr->sup_coeff[i];
+	}
+	else if(neg){
+		double mu_inf = lambda_inf*lb;
+		double mu_sup = lambda_sup*lb;
+		//res->coeff[i] = lambda*expr->coeff[i];
+		//res->cst = res->cst + expr->coeff[i]*mu;
+		elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
+		double tmp1, tmp2;
+		elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,mu_inf,mu_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
+		res->inf_cst = res->inf_cst + tmp1 + pr->min_denormal;
+		res->sup_cst = res->sup_cst + tmp2 + pr->min_denormal;
+	}
+	else if(mixed){
+		double area1 = lb*ub;
+		double area2 = 0.5*ub*width;
+		double area3 = 0.5*lb*width;
+		if((area1 < area2) && (area1 < area3)){
+			//res->coeff[i] = lambda*expr->coeff[i];
+			elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
 		}
-		else if(neuron_k->ub<=0){
+		else if((area2 < area1) && (area2 < area3)){
 			res->inf_coeff[i] = 0.0;
 			res->sup_coeff[i] = 0.0;
-			continue;
 		}
-		else if(neuron_k->lb<0){
+		else{
 			res->inf_coeff[i] = expr->inf_coeff[i];
 			res->sup_coeff[i] = expr->sup_coeff[i];
-		} else if(expr->sup_coeff[i]<0){
-			
-			double mu_inf = lambda_inf*neurons[k]->lb;
-			double mu_sup = lambda_sup*neurons[k]->lb;
-			//res->coeff[i] = lambda*expr->coeff[i];
-			//res->cst = res->cst + expr->coeff[i]*mu;
-			elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-			double tmp1, tmp2;
-			elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,mu_inf,mu_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-			res->inf_cst = res->inf_cst + tmp1 + pr->min_denormal;
-			res->sup_cst = res->sup_cst + tmp2 + pr->min_denormal;
-		}
-		else if (expr->inf_coeff[i]<0){
-			
-			double area1 = lb*ub;
-			double area2 = 0.5*ub*width;
-			double area3 = 0.5*lb*width;
-			if((area1 < area2) && (area1 < area3)){
-			//if(1){
-				//res->coeff[i] = lambda*expr->coeff[i];
-				elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-				
-			}
-			else if((area2 < area1) && (area2 < area3)){
-				res->inf_coeff[i] = 0.0;
-				res->sup_coeff[i] = 0.0;
-			}
-			else{
-				res->inf_coeff[i] = expr->inf_coeff[i];
-				res->sup_coeff[i] = expr->sup_coeff[i];
-			}
-		}
-		else{
-			
-			res->inf_coeff[i] = 0.0;
-			res->sup_coeff[i] = 0.0;
-			double tmp1, tmp2;
-			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],0,ub);
-			res->inf_cst = res->inf_cst + tmp1;
-			res->sup_cst = res->sup_cst + tmp2;
 		}
 	}
-	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
-		for(i=0; i < num_neurons; i++){
-			res->dim[i] = expr->dim[i];
-		}
+	else{
+		res->inf_coeff[i] = 0.0;
+		res->sup_coeff[i] = 0.0;
+		double tmp1, tmp2;
+		elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],0,ub);
+		res->inf_cst = res->inf_cst + tmp1;
+		res->sup_cst = res->sup_cst + tmp2;
 	}
-	return res;
 }
 
-expr_t * uexpr_replace_relu_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_t ** neurons){
+/* an expression with the coefficients, constant and support of expr still to be replaced */
+static expr_t * alloc_replaced_expr(expr_t *expr){
 	size_t num_neurons = expr->size;
-	size_t i, k;
+	size_t i;
 	expr_t * res = alloc_expr();
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
-	res->size = num_neurons;  
-	for(i = 0; i < num_neurons; i++){
-		if(expr->type==DENSE){
-			k = i;
-		}
-		else{
-			k = expr->dim[i];
-		}
-		neuron_t *neuron_k = neurons[k];
-		double lb = neurons[k]->lb;
-		double ub = neurons[k]->ub;
-		double width = ub + lb;
-		double lambda_inf = -ub/width;
-		double lambda_sup = ub/width;
-		if((expr->sup_coeff[i]==0) && (expr->inf_coeff[i]==0)){
-			res->inf_coeff[i] = 0.0;
-			res->sup_coeff[i] = 0.0;
-			continue;
-		}
-		else if(neuron_k->ub<=0){
-			res->inf_coeff[i] = 0.0;
-			res->sup_coeff[i] = 0.0;
-			continue;
-		}
-		else if(neuron_k->lb<0){
-			res->inf_coeff[i] = expr->inf_coeff[i];
-			res->sup_coeff[i] = expr->sup_coeff[i];
-		} else if(expr->inf_coeff[i]<0){
-			
-			double mu_inf = lambda_inf*neurons[k]->lb;
-			double mu_sup = lambda_sup*neurons[k]->lb;
-			//res->coeff[i] = lambda*expr->coeff[i];
-			//res->cst = res->cst + expr->coeff[i]*mu;
-			elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-			double tmp1, tmp2;
-			elina_double_interval_mul_cst_coeff(pr,&tmp1,&tmp2,mu_inf,mu_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-			res->inf_cst = res->inf_cst + tmp1 + pr->min_denormal;
-			res->sup_cst = res->sup_cst + tmp2 + pr->min_denormal;
-		}
-		else if(expr->sup_coeff[i]<0){
-			
-			double area1 = lb*ub;
-			double area2 = 0.5*ub*width;
-			double area3 = 0.5*lb*width;
-			if((area1 < area2) && (area1 < area3)){
-			//if(1){
-				//res->coeff[i] = lambda*expr->coeff[i];
-				elina_double_interval_mul_expr_coeff(pr,&res->inf_coeff[i],&res->sup_coeff[i],lambda_inf,lambda_sup,expr->inf_coeff[i],expr->sup_coeff[i]);
-			}
-			else if((area2 < area1) && (area2 < area3)){
-				res->inf_coeff[i] = 0.0;
-				res->sup_coeff[i] = 0.0;
-			}
-			else{
-				res->inf_coeff[i] = expr->inf_coeff[i];
-				res->sup_coeff[i] = expr->sup_coeff[i];
-			}
-			//
-		}
-		else{
-			
-			res->inf_coeff[i] = 0.0;
-			res->sup_coeff[i] = 0.0;
-			double tmp1, tmp2;
-			elina_double_interval_mul(&tmp1,&tmp2,expr->inf_coeff[i],expr->sup_coeff[i],0,ub);
-			res->inf_cst = res->inf_cst + tmp1;
-			res->sup_cst = res->sup_cst + tmp2;
-		}
-		
-	}
+	res->size = num_neurons;
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -1679,6 +2072,47 @@ expr_t * uexpr_replace_relu_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_
 	return res;
 }
 
+static expr_t * replace_relu_bounds(fppoly_internal_t *pr, expr_t *expr, neuron_t **neurons, bool upper){
+	size_t num_neurons = expr->size;
+	size_t i;
+	expr_t * res = alloc_replaced_expr(expr);
+	for(i = 0; i < num_neurons; i++){
+		size_t k = expr->type==DENSE ? i : expr->dim[i];
+		replace_relu_coeff(pr,res,expr,i,neurons[k],upper);
+	}
+	return res;
+}
+
+expr_t * lexpr_replace_relu_bounds(fppoly_internal_t * pr, expr_t * expr, neuron_t ** neurons){
+	return replace_relu_bounds(pr,expr,neurons,false);
+}
+
+expr_t * uexpr_replace_relu_bounds(fppoly_internal_t *pr, expr_t * expr, neuron_t ** neurons){
+	return replace_relu_bounds(pr,expr,neurons,true);
+}
+
+/* true if the coefficients of a and b are stored at the same positions */
+static inline bool expr_same_support(expr_t *a, expr_t *b){
+	if(a->type!=b->type || a->size!=b->size){
+		return false;
+	}
+	return a->type==DENSE || a->size==0 || !memcmp(a->dim,b->dim,a->size*sizeof(uint32_t));
+}
+
+/* lexpr_replace_relu_bounds and uexpr_replace_relu_bounds of a lexpr and uexpr with the same support,
+   in one pass over the neurons */
+static void replace_relu_bounds_pair(fppoly_internal_t *pr, expr_t *lexpr, expr_t *uexpr, neuron_t **neurons, expr_t **res_l, expr_t **res_u){
+	size_t num_neurons = lexpr->size;
+	size_t i;
+	*res_l = alloc_replaced_expr(lexpr);
+	*res_u = alloc_replaced_expr(uexpr);
+	for(i = 0; i < num_neurons; i++){
+		neuron_t *neuron = neurons[lexpr->type==DENSE ? i : lexpr->dim[i]];
+		replace_relu_coeff(pr,*res_l,lexpr,i,neuron,false);
+		replace_relu_coeff(pr,*res_u,uexpr,i,neuron,true);
+	}
+}
+
 void compute_chord_slope(double *slope_inf, double *slope_sup, double f_sup_l, double f_sup_u, 
 			 double f_inf_l, double f_inf_u, double inf_l, double inf_u, double sup_l, double sup_u){
 	double num_l =  f_sup_l + f_inf_u;
@@ -2101,8 +2535,7 @@ expr_t * lexpr_replace_s_curve_bounds(fppoly_internal_t * pr, expr_t * expr, neu
 	size_t num_neurons = expr->size;
 	size_t i,k;
 	expr_t * res = alloc_expr();  
-	res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-	res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+	expr_alloc_coeffs(res,num_neurons,expr->type);
 	res->inf_cst = expr->inf_cst;
 	res->sup_cst = expr->sup_cst;
 	res->type = expr->type;
@@ -2141,7 +2574,6 @@ expr_t * lexpr_replace_s_curve_bounds(fppoly_internal_t * pr, expr_t * expr, neu
 		
 	}
 	if(expr->type==SPARSE){
-		res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
 		for(i=0; i < num_neurons; i++){
 			res->dim[i] = expr->dim[i];
 		}
@@ -2153,8 +2585,7 @@ expr_t * uexpr_replace_s_curve_bounds(fppoly_internal_t *pr, expr_t * expr, neur
     size_t num_neurons = expr->size;
     size_t i,k;
     expr_t * res = alloc_expr();
-    res->inf_coeff = (double *)malloc(num_neurons*sizeof(double));
-    res->sup_coeff = (double *)malloc(num_neurons*sizeof(double));
+    expr_alloc_coeffs(res,num_neurons,expr->type);
     res->inf_cst = expr->inf_cst;
     res->sup_cst = expr->sup_cst;
     res->type = expr->type;
@@ -2190,7 +2621,6 @@ expr_t * uexpr_replace_s_curve_bounds(fppoly_internal_t *pr, expr_t * expr, neur
 	}
     }
     if(expr->type==SPARSE){
-        res->dim = (size_t*)malloc(num_neurons*sizeof(size_t));
         for(i=0; i < num_neurons; i++){
             res->dim[i] = expr->dim[i];
         }
@@ -2231,7 +2661,7 @@ expr_t * lexpr_replace_maxpool_or_lstm_bounds(fppoly_internal_t * pr, expr_t * e
 	if(expr->sup_coeff[0]<0){
 		//expr_print(neuron_k->uexpr);
 		if(neuron_k->uexpr==NULL){
-			res = (expr_t *)malloc(sizeof(expr_t));
+			res = alloc_expr();
 			res->inf_coeff = res->sup_coeff =  NULL;
 			res->dim = NULL;
 			res->size = 0;
@@ -2248,7 +2678,7 @@ expr_t * lexpr_replace_maxpool_or_lstm_bounds(fppoly_internal_t * pr, expr_t * e
 	else if(expr->inf_coeff[0]<0){
 		//expr_print(neuron_k->lexpr);
 		if(neuron_k->lexpr==NULL){
-			res = (expr_t *)malloc(sizeof(expr_t));
+			res = alloc_expr();
 			res->inf_coeff = res->sup_coeff = NULL;
 			res->dim = NULL;
 			res->size = 0;
@@ -2291,7 +2721,7 @@ expr_t * lexpr_replace_maxpool_or_lstm_bounds(fppoly_internal_t * pr, expr_t * e
 				//expr_print(res);
 				
 			if(neuron_k->uexpr==NULL){
-				mul_expr = (expr_t *)malloc(sizeof(expr_t));
+				mul_expr = alloc_expr();
 				mul_expr->inf_coeff = mul_expr->sup_coeff = NULL;
 				mul_expr->dim = NULL;
 				mul_expr->size = 0;
@@ -2321,7 +2751,7 @@ expr_t * lexpr_replace_maxpool_or_lstm_bounds(fppoly_internal_t * pr, expr_t * e
 				//expr_print(res);
 				
 			if(neuron_k->lexpr==NULL){
-				mul_expr = (expr_t *)malloc(sizeof(expr_t));
+				mul_expr = alloc_expr();
 				mul_expr->inf_coeff = mul_expr->sup_coeff = NULL;
 				mul_expr->dim = NULL;
 				mul_expr->size = 0;
@@ -2432,7 +2862,6 @@ expr_t * expr_from_previous_layer(fppoly_internal_t *pr, expr_t * expr, layer_t
 	}
 	//printf("coming here %zu\n",expr->size);
 	//	fflush(stdout);
-	neuron_t **prev_neurons = prev_layer->neurons;
 	size_t out_num_neurons = prev_layer->dims;
 	size_t in_num_neurons = expr->size;
 	size_t i,k;
@@ -2452,14 +2881,15 @@ expr_t * expr_from_previous_layer(fppoly_internal_t *pr, expr_t * expr, layer_t
 		//expr_print(prev_neurons[k]->expr);
 		//fflush(stdout);
 		//}
-		if(prev_neurons[k]->expr->size==0){
+		expr_t * prev_expr = neuron_expr(prev_layer,k);
+		if(prev_expr->size==0){
 			
-			res = multiply_cst_expr(pr,prev_neurons[k]->expr,expr->inf_coeff[0],expr->sup_coeff[0]);
+			res = multiply_cst_expr(pr,prev_expr,expr->inf_coeff[0],expr->sup_coeff[0]);
 			
 		}
 		else{
 			
-			res = multiply_expr(pr,prev_neurons[k]->expr,expr->inf_coeff[0],expr->sup_coeff[0]);
+			res = multiply_expr(pr,prev_expr,expr->inf_coeff[0],expr->sup_coeff[0]);
 		}
     //printf("debug\n");
     //fflush(stdout);
@@ -2478,13 +2908,14 @@ expr_t * expr_from_previous_layer(fppoly_internal_t *pr, expr_t * expr, layer_t
 		//if(prev_layer->type==MAXPOOL){
 		
 		//}
-		if(prev_neurons[k]->expr->size==0){
-			mul_expr = multiply_cst_expr(pr,prev_neurons[k]->expr, expr->inf_coeff[i],expr->sup_coeff[i]);
+		prev_expr = neuron_expr(prev_layer,k);
+		if(prev_expr->size==0){
+			mul_expr = multiply_cst_expr(pr,prev_expr, expr->inf_coeff[i],expr->sup_coeff[i]);
 			add_cst_expr(pr,res,mul_expr);
 			free_expr(mul_expr);
 		}
 		else if(expr->inf_coeff[i]!=0 || expr->sup_coeff[i]!=0){
-			mul_expr = multiply_expr(pr,prev_neurons[k]->expr, expr->inf_coeff[i],expr->sup_coeff[i]);
+			mul_expr = multiply_expr(pr,prev_expr, expr->inf_coeff[i],expr->sup_coeff[i]);
 			//printf("start\n");
 			//fflush(stdout);
 			add_expr(pr,res,mul_expr);
@@ -2508,224 +2939,801 @@ expr_t * expr_from_previous_layer(fppoly_internal_t *pr, expr_t * expr, layer_t
 	return res;
 }
 
-expr_t * lexpr_unroll_lstm_layer(fppoly_internal_t *pr, expr_t * expr, neuron_t ** neurons){
+/* multiply_expr of expr by the coefficients of a lexpr and a uexpr, in one pass over expr */
+static void multiply_expr_pair(fppoly_internal_t *pr, expr_t *expr, double l_inf, double l_sup, double u_inf, double u_sup, expr_t **res_l, expr_t **res_u){
+	size_t i;
+	expr_t *rl = alloc_expr();
+	expr_t *ru = alloc_expr();
+	if(expr->size > 0){
+		expr_alloc_coeffs(rl,expr->size,expr->type);
+		expr_alloc_coeffs(ru,expr->size,expr->type);
+	}
+	rl->type = ru->type = expr->type;
+	rl->size = ru->size = expr->size;
+	fppoly_kernel_scale_pair(rl->inf_coeff,rl->sup_coeff,ru->inf_coeff,ru->sup_coeff,expr->inf_coeff,expr->sup_coeff,l_inf,l_sup,u_inf,u_sup,pr->ulp,expr->size);
+	if(expr->type==SPARSE){
+		for(i=0; i < expr->size; i++){
+			rl->dim[i] = expr->dim[i];
+			ru->dim[i] = expr->dim[i];
+		}
+	}
+	elina_double_interval_mul_cst_coeff(pr,&rl->inf_cst,&rl->sup_cst,l_inf,l_sup,expr->inf_cst,expr->sup_cst);
+	elina_double_interval_mul_cst_coeff(pr,&ru->inf_cst,&ru->sup_cst,u_inf,u_sup,expr->inf_cst,expr->sup_cst);
+	*res_l = rl;
+	*res_u = ru;
+}
+
+/* the constant of add_expr(pr,expr,multiply_expr(pr,prev_expr,mul_inf,mul_sup)) */
+static inline void add_mul_cst(fppoly_internal_t *pr, expr_t *expr, expr_t *prev_expr, double mul_inf, double mul_sup){
+	double tmp_inf, tmp_sup;
+	elina_double_interval_mul_cst_coeff(pr,&tmp_inf,&tmp_sup,mul_inf,mul_sup,prev_expr->inf_cst,prev_expr->sup_cst);
+	double maxA = fmax(fabs(expr->inf_cst),fabs(expr->sup_cst));
+	double maxB = fmax(fabs(tmp_inf),fabs(tmp_sup));
+	expr->inf_cst += tmp_inf + (maxA + maxB)*pr->ulp + pr->min_denormal;
+	expr->sup_cst += tmp_sup + (maxA + maxB)*pr->ulp + pr->min_denormal;
+}
+
+/* lexpr = lexpr + [l_inf,l_sup]*prev_expr and uexpr = uexpr + [u_inf,u_sup]*prev_expr, with the result of multiply_expr
+   followed by add_expr. When lexpr and uexpr have the same support and prev_expr adds to it in place, prev_expr is read once
+   and no temporary is built. */
+static void add_mul_expr_pair(fppoly_internal_t *pr, expr_t *lexpr, expr_t *uexpr, expr_t *prev_expr, double l_inf, double l_sup, double u_inf, double u_sup){
+	size_t size = prev_expr->size;
+	if(size > 0 && lexpr->size > 0 && expr_same_support(lexpr,uexpr)){
+		bool in_place = false;
+		uint32_t *dim = NULL;
+		if(lexpr->type==DENSE && prev_expr->type==DENSE){
+			in_place = lexpr->size==size;
+		}
+		else if(lexpr->type==DENSE){
+			/* add_expr adds the coefficients of a sparse expression at their positions */
+			in_place = prev_expr->dim[size-1] < lexpr->size;
+			dim = prev_expr->dim;
+		}
+		else if(prev_expr->type==SPARSE){
+			in_place = lexpr->size==size && !memcmp(lexpr->dim,prev_expr->dim,size*sizeof(uint32_t));
+		}
+		if(in_place){
+			add_mul_cst(pr,lexpr,prev_expr,l_inf,l_sup);
+			add_mul_cst(pr,uexpr,prev_expr,u_inf,u_sup);
+			fppoly_kernel_add_scale_pair(lexpr->inf_coeff,lexpr->sup_coeff,uexpr->inf_coeff,uexpr->sup_coeff,prev_expr->inf_coeff,prev_expr->sup_coeff,dim,
+						     l_inf,l_sup,u_inf,u_sup,pr->ulp,size);
+			return;
+		}
+	}
+	expr_t *tmp_l, *tmp_u;
+	multiply_expr_pair(pr,prev_expr,l_inf,l_sup,u_inf,u_sup,&tmp_l,&tmp_u);
+	add_expr(pr,lexpr,tmp_l);
+	add_expr(pr,uexpr,tmp_u);
+	free_expr(tmp_l);
+	free_expr(tmp_u);
+}
+
+/* expr_from_previous_layer of a lexpr and a uexpr with the same support, the expressions of the neurons of
+   prev_layer are traversed once for both */
+static void expr_pair_from_previous_layer(fppoly_internal_t *pr, expr_t *lexpr, expr_t *uexpr, layer_t *prev_layer, expr_t **res_l, expr_t **res_u){
+	if(lexpr->size==0 || lexpr->inf_coeff==NULL || lexpr->sup_coeff==NULL || uexpr->inf_coeff==NULL || uexpr->sup_coeff==NULL){
+		*res_l = expr_from_previous_layer(pr,lexpr,prev_layer);
+		*res_u = expr_from_previous_layer(pr,uexpr,prev_layer);
+		return;
+	}
+	size_t in_num_neurons = lexpr->size;
+	size_t i, k;
+	expr_t *rl, *ru;
+	k = lexpr->type==DENSE ? 0 : lexpr->dim[0];
+	expr_t *prev_expr = neuron_expr(prev_layer,k);
+	if(prev_expr->size==0){
+		rl = multiply_cst_expr(pr,prev_expr,lexpr->inf_coeff[0],lexpr->sup_coeff[0]);
+		ru = multiply_cst_expr(pr,prev_expr,uexpr->inf_coeff[0],uexpr->sup_coeff[0]);
+	}
+	else{
+		multiply_expr_pair(pr,prev_expr,lexpr->inf_coeff[0],lexpr->sup_coeff[0],uexpr->inf_coeff[0],uexpr->sup_coeff[0],&rl,&ru);
+	}
+	for(i=1; i < in_num_neurons; i++){
+		k = lexpr->type==DENSE ? i : lexpr->dim[i];
+		prev_expr = neuron_expr(prev_layer,k);
+		bool l_nz = lexpr->inf_coeff[i]!=0 || lexpr->sup_coeff[i]!=0;
+		bool u_nz = uexpr->inf_coeff[i]!=0 || uexpr->sup_coeff[i]!=0;
+		if(prev_expr->size==0){
+			expr_t *mul_expr = multiply_cst_expr(pr,prev_expr,lexpr->inf_coeff[i],lexpr->sup_coeff[i]);
+			add_cst_expr(pr,rl,mul_expr);
+			free_expr(mul_expr);
+			mul_expr = multiply_cst_expr(pr,prev_expr,uexpr->inf_coeff[i],uexpr->sup_coeff[i]);
+			add_cst_expr(pr,ru,mul_expr);
+			free_expr(mul_expr);
+		}
+		else if(l_nz && u_nz){
+			add_mul_expr_pair(pr,rl,ru,prev_expr,lexpr->inf_coeff[i],lexpr->sup_coeff[i],uexpr->inf_coeff[i],uexpr->sup_coeff[i]);
+		}
+		else if(l_nz || u_nz){
+			expr_t *res = l_nz ? rl : ru;
+			expr_t *expr = l_nz ? lexpr : uexpr;
+			expr_t *mul_expr = multiply_expr(pr,prev_expr,expr->inf_coeff[i],expr->sup_coeff[i]);
+			add_expr(pr,res,mul_expr);
+			free_expr(mul_expr);
+		}
+	}
+	rl->inf_cst = rl->inf_cst + lexpr->inf_cst;
+	rl->sup_cst = rl->sup_cst + lexpr->sup_cst;
+	ru->inf_cst = ru->inf_cst + uexpr->inf_cst;
+	ru->sup_cst = ru->sup_cst + uexpr->sup_cst;
+	*res_l = rl;
+	*res_u = ru;
+}
+
+/* number of output neurons back-substituted together, their lexpr and uexpr share the rows of the previous layers */
+#define BACKSUBST_BLOCK_SIZE 8
+/* number of coefficients of the result updated together, keeps the accumulated rows in cache */
+#define BACKSUBST_COLUMN_BLOCK 512
+
+/* the constant [-*inf_cst,*sup_cst] of neuron i of a layer in matrix form */
+static inline void layer_matrix_cst(layer_t *layer, size_t i, double *inf_cst, double *sup_cst){
+	if(layer->spill!=NULL){
+		*inf_cst = layer->spill->cst[2*i];
+		*sup_cst = layer->spill->cst[2*i+1];
+	}
+	else if(layer->weights!=NULL){
+		double bias = layer_bias(layer->weights, i);
+		*inf_cst = -bias;
+		*sup_cst = bias;
+	}
+	else{
+		*inf_cst = layer->neurons[i]->expr->inf_cst;
+		*sup_cst = layer->neurons[i]->expr->sup_cst;
+	}
+}
+
+
+/* number of coefficients of the rows of a layer in matrix form */
+static inline size_t layer_matrix_row_size(layer_t *layer){
+	if(layer->spill!=NULL){
+		return layer->spill->start[1];
+	}
+	return layer->weights!=NULL ? layer->weights->num_in : layer->neurons[0]->expr->size;
+}
+
+
+/* the rows of a layer given by a column-major buffer are converted there block by block */
+static __thread double layer_row_scratch[BACKSUBST_COLUMN_BLOCK];
+
+/* row i of a layer in matrix form whose rows are read in place as float32, packed in float32 or given by a row-major
+   float32 buffer, NULL for the other layers. *w_ulp and *w_min receive the error of its coefficients as in
+   layer_spill_t, none for a buffer */
+static inline float * layer_matrix_row_f32(layer_t *layer, size_t i, double *w_ulp, double *w_min){
+	layer_weights_t *weights = layer->weights;
+	layer_spill_t *spill = layer->spill;
+	if(spill!=NULL && spill->dtype==FPPOLY_WEIGHTS_FLOAT32){
+		*w_ulp = spill->coeff_ulp;
+		*w_min = spill->coeff_min;
+		return (float *)spill->coeffs + spill->start[i];
+	}
+	if(weights!=NULL && weights->layout==FPPOLY_ROW_MAJOR && weights->dtype==FPPOLY_WEIGHTS_FLOAT32){
+		*w_ulp = 0;
+		*w_min = 0;
+		return (float *)weights->weights + i*weights->ld;
+	}
 	return NULL;
 }
 
 
-void * update_state_using_previous_layers(void *args){
-	nn_thread_t * data = (nn_thread_t *)args;
-	elina_manager_t * man = data->man;
-	fppoly_t *fp = data->fp;
-	fppoly_internal_t * pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-	size_t layerno = data->layerno;
-	size_t idx_start = data->start;
-	size_t idx_end = data->end;
-	size_t i;
-	int k;
-	
-	neuron_t ** out_neurons = fp->layers[layerno]->neurons;
-	size_t num_out_neurons = fp->layers[layerno]->dims;
-	//printf("idx: %zu %zu\n",idx_start,idx_end);
-	//fflush(stdout);
-	for(i=idx_start; i < idx_end; i++){
-  	  /* printf("update: i %zu \n",i); */
-	  /* fflush(stdout); */
-		expr_t * lexpr = copy_expr(out_neurons[i]->expr);
-		expr_t * uexpr = copy_expr(out_neurons[i]->expr);
-		for(k=layerno - 1; k >=0; k--){
-		  /* printf("k = %d, type=%d, activation=%d\n",(int)k,(int)fp->layers[k]->type,(int)fp->layers[k]->activation); */
-			neuron_t ** aux_neurons = fp->layers[k]->neurons;
-			size_t dims = fp->layers[k]->dims;
-			expr_t * tmp_l;
-			expr_t * tmp_u;
-			if(fp->layers[k]->type==FFN || fp->layers[k]->type==CONV){
-				 tmp_l = lexpr;
-				 tmp_u = uexpr;
-                //if(i==0 && layerno==1){
-			//	printf("before relu %zu\n",lexpr->size);
-			//	expr_print(lexpr);
-			//	expr_print(uexpr);
-			//	fflush(stdout);
-                //}
-                if(fp->layers[k]->activation==RELU){
-                    lexpr = lexpr_replace_relu_bounds(pr,lexpr,aux_neurons);
-                    //printf("doesnt return\n");
-				
-                    //fflush(stdout);
-                    uexpr = uexpr_replace_relu_bounds(pr,uexpr,aux_neurons);
-                }
-                else if(fp->layers[k]->activation==SIGMOID){
-                        //printf("start\n");
-                        //fflush(stdout);
-                    lexpr = lexpr_replace_sigmoid_bounds(pr,lexpr,aux_neurons);
-                        //printf("finish\n");
-                        //fflush(stdout);
-                    uexpr = uexpr_replace_sigmoid_bounds(pr,uexpr,aux_neurons);
-                }
-                else if(fp->layers[k]->activation==TANH){
-                    lexpr = lexpr_replace_tanh_bounds(pr,lexpr,aux_neurons);
-                    uexpr = uexpr_replace_tanh_bounds(pr,uexpr,aux_neurons);
-                }
-		else if(fp->layers[k]->activation==PARABOLA){
-		    lexpr = lexpr_replace_parabola_bounds(pr,lexpr,aux_neurons);
-                    uexpr = uexpr_replace_parabola_bounds(pr,uexpr,aux_neurons);
-		}
-		else if(fp->layers[k]->activation==LOG){
-		    lexpr = lexpr_replace_log_bounds(pr,lexpr,aux_neurons);
-			uexpr = uexpr_replace_log_bounds(pr,uexpr,aux_neurons);
+/* coefficients jb to jb+block-1 of row i, the point coefficients of the expression of neuron i, of a layer in
+   matrix form whose rows are not read as float32, valid until the next call by the same thread; block is at most
+   BACKSUBST_COLUMN_BLOCK */
+static inline double * layer_matrix_row_block(layer_t *layer, size_t i, size_t jb, size_t block){
+	layer_weights_t *weights = layer->weights;
+	layer_spill_t *spill = layer->spill;
+	size_t j;
+	if(spill!=NULL){
+		return (double *)spill->coeffs + spill->start[i] + jb;
+	}
+	if(weights==NULL){
+		return layer->neurons[i]->expr->sup_coeff + jb;
+	}
+	if(weights->layout==FPPOLY_ROW_MAJOR && weights->dtype==FPPOLY_WEIGHTS_FLOAT64){
+		return (double *)weights->weights + i*weights->ld + jb;
+	}
+	for(j=0; j < block; j++){
+		layer_row_scratch[j] = layer_weight(weights, i, jb + j);
+	}
+	return layer_row_scratch;
+}
+
+
+bool expr_has_matrix_form(expr_t *expr, layer_t *prev_layer){
+	return prev_layer->matrix_form && expr->type==DENSE && expr->size==prev_layer->dims && expr->inf_coeff!=NULL && expr->sup_coeff!=NULL;
+}
+
+/* expr_from_previous_layer for num_exprs DENSE expressions over a layer in matrix form: the result
+   coefficients are the interval matrix product of the expression coefficients with the rows of the
+   layer, accumulated in the same order as expr_from_previous_layer so that the bounds are identical.
+   Rows stored in float32 are read in place by the float32 kernels */
+void exprs_from_previous_layer_matrix(fppoly_internal_t *pr, expr_t **exprs, expr_t **res, size_t num_exprs, layer_t * prev_layer){
+	size_t num_in_neurons = prev_layer->dims;
+	size_t size = layer_matrix_row_size(prev_layer);
+	size_t i, r, jb;
+	double cst_inf, cst_sup, w_ulp = 0, w_min = 0;
+	bool f32 = layer_matrix_row_f32(prev_layer,0,&w_ulp,&w_min)!=NULL;
+	for(r=0; r < num_exprs; r++){
+		expr_t *expr = exprs[r];
+		res[r] = alloc_expr();
+		expr_alloc_coeffs(res[r],size,DENSE);
+		res[r]->type = DENSE;
+		res[r]->size = size;
+		layer_matrix_cst(prev_layer,0,&cst_inf,&cst_sup);
+		elina_double_interval_mul_cst_coeff(pr,&res[r]->inf_cst,&res[r]->sup_cst,expr->inf_coeff[0],expr->sup_coeff[0],cst_inf,cst_sup);
+		for(i=1; i < num_in_neurons; i++){
+			if(expr->inf_coeff[i]!=0 || expr->sup_coeff[i]!=0){
+				double tmp_inf, tmp_sup;
+				layer_matrix_cst(prev_layer,i,&cst_inf,&cst_sup);
+				elina_double_interval_mul_cst_coeff(pr,&tmp_inf,&tmp_sup,expr->inf_coeff[i],expr->sup_coeff[i],cst_inf,cst_sup);
+				double maxA = fmax(fabs(res[r]->inf_cst),fabs(res[r]->sup_cst));
+				double maxB = fmax(fabs(tmp_inf),fabs(tmp_sup));
+				res[r]->inf_cst += tmp_inf + (maxA + maxB)*pr->ulp + pr->min_denormal;
+				res[r]->sup_cst += tmp_sup + (maxA + maxB)*pr->ulp + pr->min_denormal;
+			}
 		}
-		//else if(fp->layers[k]->activation==MULT){
-		if(fp->layers[k]->activation!=NONE){
-				free_expr(tmp_l);
-				
-				free_expr(tmp_u);
-		}	
-               // if(i==0 && layerno==1){
-                //    printf("after relu %zu\n",lexpr->size);
-                //    expr_print(lexpr);
-                 //   expr_print(uexpr);
-                 //   fflush(stdout);
-               // }
-				//if(k>=1){
-					tmp_l = lexpr;
-					tmp_u = uexpr;
-					//if(fp->layers[k]->type==MAXPOOL){
-					//printf("before replacing %zu %zu\n",lexpr->size,uexpr->size);
-					//expr_print(lexpr);
-					//expr_print(uexpr);
-					//fflush(stdout);
-					//}
-					lexpr = expr_from_previous_layer(pr,lexpr, fp->layers[k]);
-					//printf("doesnt return\n");
-					//expr_print(uexpr);
-					//fflush(stdout);
-					uexpr = expr_from_previous_layer(pr,uexpr, fp->layers[k]);
-
-					//if(fp->layers[k]->type==MAXPOOL){
-					////fflush(stdout);
-					//}
-					free_expr(tmp_l);
-					free_expr(tmp_u);
+		res[r]->inf_cst = res[r]->inf_cst + expr->inf_cst;
+		res[r]->sup_cst = res[r]->sup_cst + expr->sup_cst;
+	}
+	for(jb=0; jb < size; jb+=BACKSUBST_COLUMN_BLOCK){
+		size_t block = size - jb < BACKSUBST_COLUMN_BLOCK ? size - jb : BACKSUBST_COLUMN_BLOCK;
+		if(f32){
+			float *w = layer_matrix_row_f32(prev_layer,0,&w_ulp,&w_min) + jb;
+			for(r=0; r < num_exprs; r++){
+				fppoly_kernel_mul_point_f32(res[r]->inf_coeff+jb,res[r]->sup_coeff+jb,exprs[r]->inf_coeff[0],exprs[r]->sup_coeff[0],w,pr->ulp,w_ulp,w_min,block);
 			}
-			else if(fp->layers[k]->type==MAXPOOL || fp->layers[k]->type==LSTM){
-				expr_t * tmp_l = lexpr;
-				expr_t * tmp_u = uexpr;
-				//printf("before maxpool %zu %zu\n",lexpr->size,i);
-				//expr_print(lexpr);
-				//expr_print(uexpr);
-				//fflush(stdout);
-				lexpr = lexpr_replace_maxpool_or_lstm_bounds(pr,lexpr,aux_neurons);
-				
-				//fflush(stdout);
-				uexpr = uexpr_replace_maxpool_or_lstm_bounds(pr,uexpr,aux_neurons);
-				//printf("after maxpool %zu\n",lexpr->size);
-				//expr_print(lexpr);
-				//fflush(stdout);
-				free_expr(tmp_l);
-				
-				free_expr(tmp_u);
+			for(i=1; i < num_in_neurons; i++){
+				w = layer_matrix_row_f32(prev_layer,i,&w_ulp,&w_min) + jb;
+				for(r=0; r < num_exprs; r++){
+					double inf = exprs[r]->inf_coeff[i];
+					double sup = exprs[r]->sup_coeff[i];
+					if(inf!=0 || sup!=0){
+						fppoly_kernel_add_mul_point_f32(res[r]->inf_coeff+jb,res[r]->sup_coeff+jb,inf,sup,w,pr->ulp,w_ulp,w_min,block);
+					}
+				}
 			}
-			//}
-			else{
-				expr_t *tmp_l = lexpr;
-				expr_t *tmp_u = uexpr;
-				lexpr = lexpr_unroll_lstm_layer(pr,lexpr, aux_neurons);
-				
-				//uexpr = uexpr_unroll_lstm_layer(pr, uexpr, aux_neurons);
-				
-				free_expr(tmp_l);
-				free_expr(tmp_u);
+			continue;
+		}
+		double *w = layer_matrix_row_block(prev_layer,0,jb,block);
+		for(r=0; r < num_exprs; r++){
+			fppoly_kernel_mul_point(res[r]->inf_coeff+jb,res[r]->sup_coeff+jb,exprs[r]->inf_coeff[0],exprs[r]->sup_coeff[0],w,pr->ulp,block);
+		}
+		for(i=1; i < num_in_neurons; i++){
+			/* the row is only fetched, and converted for a layer given by a buffer, if an expression uses it */
+			w = NULL;
+			for(r=0; r < num_exprs; r++){
+				double inf = exprs[r]->inf_coeff[i];
+				double sup = exprs[r]->sup_coeff[i];
+				if(inf!=0 || sup!=0){
+					if(w==NULL){
+						w = layer_matrix_row_block(prev_layer,i,jb,block);
+					}
+					fppoly_kernel_add_mul_point(res[r]->inf_coeff+jb,res[r]->sup_coeff+jb,inf,sup,w,pr->ulp,block);
+				}
 			}
-			//printf("coming here\n");
-			//fflush(stdout);
 		}
-		//expr_print(lexpr);
-		//printf("uexpr: %zu %zu\n",uexpr->size,i);
-		//expr_print(uexpr);
-		//fflush(stdout);
-		
-		out_neurons[i]->lb = compute_lb_from_expr(pr, lexpr,fp); 
-		//- bias_i;
-		out_neurons[i]->ub = compute_ub_from_expr(pr, uexpr,fp); //+ bias_i;
-		//printf("lb: %g ub: %g\n",out_neurons[i]->lb,out_neurons[i]->ub);
-		if(fp->out!=NULL){
-			
-			fp->out->lexpr[i] = lexpr;
-			fp->out->uexpr[i] = uexpr;
+	}
+}
+
+/* replace exprs[r] by its back-substitution through prev_layer, using the matrix product when possible,
+   num_exprs is at most 2*BACKSUBST_BLOCK_SIZE */
+void exprs_from_previous_layer(fppoly_internal_t *pr, expr_t **exprs, size_t num_exprs, layer_t * prev_layer){
+	expr_t *res[2*BACKSUBST_BLOCK_SIZE];
+	size_t r, num_matrix = 0;
+	size_t index[2*BACKSUBST_BLOCK_SIZE];
+	expr_t *matrix_exprs[2*BACKSUBST_BLOCK_SIZE];
+	for(r=0; r < num_exprs; r++){
+		if(expr_has_matrix_form(exprs[r],prev_layer)){
+			index[num_matrix] = r;
+			matrix_exprs[num_matrix] = exprs[r];
+			num_matrix++;
 		}
 		else{
+			expr_t *tmp = exprs[r];
+			exprs[r] = expr_from_previous_layer(pr,tmp,prev_layer);
+			free_expr(tmp);
+		}
+	}
+	if(num_matrix > 0){
+		exprs_from_previous_layer_matrix(pr,matrix_exprs,res,num_matrix,prev_layer);
+		for(r=0; r < num_matrix; r++){
+			free_expr(exprs[index[r]]);
+			exprs[index[r]] = res[r];
+		}
+	}
+}
+
+/* exprs_from_previous_layer for num_pairs lexpr followed by their num_pairs uexpr: a lexpr and uexpr with the same support
+   that are not in matrix form are back-substituted together */
+void expr_pairs_from_previous_layer(fppoly_internal_t *pr, expr_t **exprs, size_t num_pairs, layer_t * prev_layer){
+	expr_t *others[2*BACKSUBST_BLOCK_SIZE];
+	size_t index[2*BACKSUBST_BLOCK_SIZE];
+	size_t j, r, num_others = 0;
+	for(j=0; j < num_pairs; j++){
+		expr_t *lexpr = exprs[j];
+		expr_t *uexpr = exprs[num_pairs + j];
+		if(!expr_has_matrix_form(lexpr,prev_layer) && !expr_has_matrix_form(uexpr,prev_layer) && expr_same_support(lexpr,uexpr)){
+			expr_pair_from_previous_layer(pr,lexpr,uexpr,prev_layer,&exprs[j],&exprs[num_pairs + j]);
 			free_expr(lexpr);
 			free_expr(uexpr);
 		}
+		else{
+			index[num_others] = j;
+			others[num_others++] = lexpr;
+			index[num_others] = num_pairs + j;
+			others[num_others++] = uexpr;
+		}
+	}
+	if(num_others > 0){
+		exprs_from_previous_layer(pr,others,num_others,prev_layer);
+		for(r=0; r < num_others; r++){
+			exprs[index[r]] = others[r];
+		}
 	}
+}
 
-	//printf("thread finish\n");
-	//fflush(stdout);
+
+expr_t * lexpr_unroll_lstm_layer(fppoly_internal_t *pr, expr_t * expr, neuron_t ** neurons){
 	return NULL;
 }
 
 
-void update_state_using_previous_layers_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno){
-  	//size_t NUM_THREADS = get_nprocs();
-  size_t NUM_THREADS = sysconf(_SC_NPROCESSORS_ONLN);
-	nn_thread_t args[NUM_THREADS];
-	pthread_t threads[NUM_THREADS];
-	size_t num_out_neurons = fp->layers[layerno]->dims;
+/* replace the activation of layer in lexpr and uexpr by its linear bounds */
+void replace_activation_bounds(fppoly_internal_t *pr, expr_t **lexpr, expr_t **uexpr, layer_t *layer){
+	neuron_t ** aux_neurons = layer->neurons;
+	expr_t * tmp_l = *lexpr;
+	expr_t * tmp_u = *uexpr;
+	if(layer->activation==RELU){
+		if(expr_same_support(tmp_l,tmp_u)){
+			replace_relu_bounds_pair(pr,tmp_l,tmp_u,aux_neurons,lexpr,uexpr);
+		}
+		else{
+			*lexpr = lexpr_replace_relu_bounds(pr,tmp_l,aux_neurons);
+			*uexpr = uexpr_replace_relu_bounds(pr,tmp_u,aux_neurons);
+		}
+	}
+	else if(layer->activation==SIGMOID){
+		*lexpr = lexpr_replace_sigmoid_bounds(pr,tmp_l,aux_neurons);
+		*uexpr = uexpr_replace_sigmoid_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==TANH){
+		*lexpr = lexpr_replace_tanh_bounds(pr,tmp_l,aux_neurons);
+		*uexpr = uexpr_replace_tanh_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==PARABOLA){
+		*lexpr = lexpr_replace_parabola_bounds(pr,tmp_l,aux_neurons);
+		*uexpr = uexpr_replace_parabola_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==LOG){
+		*lexpr = lexpr_replace_log_bounds(pr,tmp_l,aux_neurons);
+		*uexpr = uexpr_replace_log_bounds(pr,tmp_u,aux_neurons);
+	}
+	if(*lexpr!=tmp_l){
+		free_expr(tmp_l);
+		free_expr(tmp_u);
+	}
+}
+
+
+/* replaces the neurons of layer, an FFN or CONV layer, in lexpr by the lower bound of their activation */
+static void lexpr_replace_activation_bounds(fppoly_internal_t *pr, expr_t **lexpr, layer_t *layer){
+	neuron_t ** aux_neurons = layer->neurons;
+	expr_t * tmp_l = *lexpr;
+	if(layer->activation==RELU){
+		*lexpr = lexpr_replace_relu_bounds(pr,tmp_l,aux_neurons);
+	}
+	else if(layer->activation==SIGMOID){
+		*lexpr = lexpr_replace_sigmoid_bounds(pr,tmp_l,aux_neurons);
+	}
+	else if(layer->activation==TANH){
+		*lexpr = lexpr_replace_tanh_bounds(pr,tmp_l,aux_neurons);
+	}
+	else if(layer->activation==PARABOLA){
+		*lexpr = lexpr_replace_parabola_bounds(pr,tmp_l,aux_neurons);
+	}
+	else if(layer->activation==LOG){
+		*lexpr = lexpr_replace_log_bounds(pr,tmp_l,aux_neurons);
+	}
+	if(*lexpr!=tmp_l){
+		free_expr(tmp_l);
+	}
+}
+
+
+/* replaces the neurons of layer, an FFN or CONV layer, in uexpr by the upper bound of their activation */
+static void uexpr_replace_activation_bounds(fppoly_internal_t *pr, expr_t **uexpr, layer_t *layer){
+	neuron_t ** aux_neurons = layer->neurons;
+	expr_t * tmp_u = *uexpr;
+	if(layer->activation==RELU){
+		*uexpr = uexpr_replace_relu_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==SIGMOID){
+		*uexpr = uexpr_replace_sigmoid_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==TANH){
+		*uexpr = uexpr_replace_tanh_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==PARABOLA){
+		*uexpr = uexpr_replace_parabola_bounds(pr,tmp_u,aux_neurons);
+	}
+	else if(layer->activation==LOG){
+		*uexpr = uexpr_replace_log_bounds(pr,tmp_u,aux_neurons);
+	}
+	if(*uexpr!=tmp_u){
+		free_expr(tmp_u);
+	}
+}
+
+
+/* concretizes the expressions of the neurons of a block over the bounds of the neurons of a previous layer,
+   the neurons whose ReLU phase is decided keep these bounds and leave the block. exprs holds the num_active
+   lexpr followed by the uexpr, active the position in the block of their neurons. Returns the number of
+   neurons left, their expressions are moved to the front of exprs in the same layout. */
+static size_t backsubst_remove_decided(expr_t **exprs, size_t *active, size_t num_active, neuron_t **block_neurons, double *x_inf, double *x_sup){
+	expr_t ** lexpr = exprs;
+	expr_t ** uexpr = exprs + num_active;
+	expr_t * left[2*BACKSUBST_BLOCK_SIZE];
+	size_t j, num_left = 0;
+	for(j=0; j < num_active; j++){
+		double lb = fppoly_kernel_concretize_inf(lexpr[j]->inf_cst,lexpr[j]->inf_coeff,lexpr[j]->sup_coeff,lexpr[j]->type==DENSE ? NULL : lexpr[j]->dim,x_inf,x_sup,lexpr[j]->size);
+		double ub = fppoly_kernel_concretize_sup(uexpr[j]->sup_cst,uexpr[j]->inf_coeff,uexpr[j]->sup_coeff,uexpr[j]->type==DENSE ? NULL : uexpr[j]->dim,x_inf,x_sup,uexpr[j]->size);
+		/* same test as lexpr_replace_relu_bounds */
+		if(ub<=0 || lb<0){
+			block_neurons[active[j]]->lb = lb;
+			block_neurons[active[j]]->ub = ub;
+			free_expr(lexpr[j]);
+			free_expr(uexpr[j]);
+		}
+		else{
+			left[num_left] = lexpr[j];
+			left[BACKSUBST_BLOCK_SIZE + num_left] = uexpr[j];
+			active[num_left] = active[j];
+			num_left++;
+		}
+	}
+	for(j=0; j < num_left; j++){
+		exprs[j] = left[j];
+		exprs[num_left + j] = left[BACKSUBST_BLOCK_SIZE + j];
+	}
+	return num_left;
+}
+
+
+/* the bounds of the neurons of layer in the arena, their negated lower bounds followed by their upper bounds */
+static double * layer_bounds_alloc(layer_t *layer){
 	size_t i;
-	//printf("start %zu\n",num_out_neurons);
-	//fflush(stdout);
-	if(num_out_neurons < NUM_THREADS){
-		for (i = 0; i < num_out_neurons; i++){
-	    		args[i].start = i; 
-	    		args[i].end = i+1;   
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-	    		pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-			
-	  	}
-		for (i = 0; i < num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
+	double *res = (double *)fppoly_arena_alloc(2*layer->dims*sizeof(double));
+	for(i=0; i < layer->dims; i++){
+		res[i] = layer->neurons[i]->lb;
+		res[layer->dims + i] = layer->neurons[i]->ub;
+	}
+	return res;
+}
+
+
+/* negated lower bound of lexpr, an expression over the neurons of a layer with bounds x_inf and x_sup */
+static double concretize_lexpr_over_layer(expr_t *lexpr, double *x_inf, double *x_sup){
+	if(lexpr->inf_coeff==NULL || lexpr->sup_coeff==NULL){
+		return lexpr->inf_cst;
+	}
+	return fppoly_kernel_concretize_inf(lexpr->inf_cst,lexpr->inf_coeff,lexpr->sup_coeff,lexpr->type==DENSE ? NULL : lexpr->dim,x_inf,x_sup,lexpr->size);
+}
+
+
+/* upper bound of uexpr, an expression over the neurons of a layer with bounds x_inf and x_sup */
+static double concretize_uexpr_over_layer(expr_t *uexpr, double *x_inf, double *x_sup){
+	if(uexpr->inf_coeff==NULL || uexpr->sup_coeff==NULL){
+		return uexpr->sup_cst;
+	}
+	return fppoly_kernel_concretize_sup(uexpr->sup_cst,uexpr->inf_coeff,uexpr->sup_coeff,uexpr->type==DENSE ? NULL : uexpr->dim,x_inf,x_sup,uexpr->size);
+}
+
+
+/* adds expr to *acc, which is NULL if nothing reached it yet, and frees it */
+static void dag_add_expr(fppoly_internal_t *pr, expr_t **acc, expr_t *expr){
+	if(*acc==NULL){
+		*acc = expr;
+	}
+	else{
+		add_expr(pr,*acc,expr);
+		free_expr(expr);
+	}
+}
+
+
+/* once layer k is gone through, moves the pending expressions acc[0] to acc[k] to the other side of the arena,
+   the expressions they were built from are released at the next flip */
+static void dag_arena_flip(fppoly_arena_mark_t *mark, expr_t **acc, int k){
+	int j;
+	fppoly_arena_flip(mark);
+	for(j=0; j <= k; j++){
+		if(acc[j]!=NULL){
+			expr_t * tmp = acc[j];
+			acc[j] = copy_expr(tmp);
+			free_expr(tmp);
+		}
+	}
+}
+
+
+/* back-substitutes acc[p], an expression over the outputs of layer p-1 or over the input for p = 0, NULL if
+   none, through layers top-1 to 0 of fp when they do not form a chain. The expressions reaching a layer from
+   all its successors are summed before going through it, the layers shared by several paths are then gone
+   through once. Returns acc[0], the other entries are left NULL. With concretize_every_layer and best_res not
+   NULL, *best_res is lowered to the bound of the expression over a layer that every pending path goes through. */
+static expr_t * dag_backsubst(fppoly_internal_t *pr, fppoly_t *fp, expr_t **acc, size_t top, bool is_lower, double *best_res){
+	int k;
+	size_t j;
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	for(k=top - 1; k >=0; k--){
+		layer_t * layer = fp->layers[k];
+		expr_t * expr = acc[k+1];
+		if(expr==NULL){
+			continue;
+		}
+		acc[k+1] = NULL;
+		if(layer->type==MAXPOOL || layer->type==LSTM){
+			expr_t * tmp = expr;
+			expr = is_lower ? lexpr_replace_maxpool_or_lstm_bounds(pr,tmp,layer->neurons) : uexpr_replace_maxpool_or_lstm_bounds(pr,tmp,layer->neurons);
+			free_expr(tmp);
+			dag_add_expr(pr,&acc[layer_predecessor(layer,k,0)],expr);
+			dag_arena_flip(&mark,acc,k);
+			continue;
+		}
+		if(is_lower){
+			lexpr_replace_activation_bounds(pr,&expr,layer);
+		}
+		else{
+			uexpr_replace_activation_bounds(pr,&expr,layer);
+		}
+		if(best_res!=NULL && pr->concretize_every_layer){
+			bool single = true;
+			for(j=0; j <= (size_t)k; j++){
+				single = single && acc[j]==NULL;
+			}
+			if(single){
+				double *bounds = layer_bounds_alloc(layer);
+				double res = is_lower ? concretize_lexpr_over_layer(expr,bounds,bounds + layer->dims) : concretize_uexpr_over_layer(expr,bounds,bounds + layer->dims);
+				if(res < *best_res){
+					*best_res = res;
+				}
+				fppoly_arena_free(bounds);
+			}
+		}
+		if(layer->type==ADD){
+			/* every predecessor gets the coefficients, the constant is counted once */
+			for(j=1; j < layer->num_predecessors; j++){
+				expr_t * copy = copy_expr(expr);
+				copy->inf_cst = 0;
+				copy->sup_cst = 0;
+				dag_add_expr(pr,&acc[layer->predecessors[j]],copy);
+			}
+			dag_add_expr(pr,&acc[layer->predecessors[0]],expr);
+		}
+		else{
+			exprs_from_previous_layer(pr,&expr,1,layer);
+			dag_add_expr(pr,&acc[layer_predecessor(layer,k,0)],expr);
+		}
+		dag_arena_flip(&mark,acc,k);
+	}
+	return acc[0];
+}
+
+
+/* puts neuron i of layer layerno of fp, over the outputs of its predecessors, in acc as dag_backsubst expects it */
+static void dag_seed_neuron(fppoly_internal_t *pr, fppoly_t *fp, expr_t **acc, size_t layerno, size_t i){
+	layer_t * layer = fp->layers[layerno];
+	size_t j;
+	if(layer->type==ADD){
+		double one = 1;
+		for(j=0; j < layer->num_predecessors; j++){
+			dag_add_expr(pr,&acc[layer->predecessors[j]],create_sparse_expr(&one,0,&i,1));
 		}
 	}
 	else{
-		size_t idx_start = 0;
-		size_t idx_n = num_out_neurons / NUM_THREADS;
-		size_t idx_end = idx_start + idx_n;
-		
-		
-	  	for (i = 0; i < NUM_THREADS; i++){
-	    		args[i].start = idx_start; 
-	    		args[i].end = idx_end;   
-			args[i].man = man;
-			args[i].fp = fp;
-			args[i].layerno = layerno;
-	    		pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-			idx_start = idx_end;
-			idx_end = idx_start + idx_n;
-	    		if(idx_end>num_out_neurons){
-				idx_end = num_out_neurons;
+		dag_add_expr(pr,&acc[layer_predecessor(layer,layerno,0)],copy_expr(neuron_expr(layer,i)));
+	}
+}
+
+
+/* true if the back-substituted expressions of the neurons of layer layerno are kept as those of the output */
+static inline bool fppoly_keeps_output_exprs(fppoly_t *fp, size_t layerno){
+	return fp->out!=NULL && layerno + 1==fp->numlayers;
+}
+
+
+/* neuron number p of the neurons updated by data */
+static inline size_t nn_thread_neuron(nn_thread_t *data, size_t p){
+	return data->neurons==NULL ? p : data->neurons[p];
+}
+
+
+/* update_state_using_previous_layers when the layers up to layerno do not form a chain, the neurons are
+   back-substituted one at a time through the graph of the layers */
+static void update_state_using_layer_graph(fppoly_internal_t *pr, fppoly_t *fp, nn_thread_t *data){
+	size_t layerno = data->layerno;
+	neuron_t ** out_neurons = fp->layers[layerno]->neurons;
+	bool keep_out = fppoly_keeps_output_exprs(fp,layerno);
+	size_t p;
+	expr_t ** acc = (expr_t **)malloc((layerno+1)*sizeof(expr_t *));
+	/* the expressions of a neuron live in the arena of the thread until its bounds are computed */
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	for(p=data->start; p < data->end; p++){
+		size_t i = nn_thread_neuron(data,p);
+		neuron_t *neuron = out_neurons[i];
+		memset(acc,0,(layerno+1)*sizeof(expr_t *));
+		dag_seed_neuron(pr,fp,acc,layerno,i);
+		expr_t * lexpr = dag_backsubst(pr,fp,acc,layerno,true,NULL);
+		memset(acc,0,(layerno+1)*sizeof(expr_t *));
+		dag_seed_neuron(pr,fp,acc,layerno,i);
+		expr_t * uexpr = dag_backsubst(pr,fp,acc,layerno,false,NULL);
+		neuron->lb = compute_lb_from_expr(pr,lexpr,fp);
+		neuron->ub = compute_ub_from_expr(pr,uexpr,fp);
+		if(keep_out){
+			fppoly_arena_enable(false);
+			fp->out->lexpr[i] = copy_expr(lexpr);
+			fp->out->uexpr[i] = copy_expr(uexpr);
+			fppoly_arena_enable(true);
+		}
+		free_expr(lexpr);
+		free_expr(uexpr);
+		fppoly_arena_rewind(&mark);
+	}
+	fppoly_arena_enable(arena_enabled);
+	free(acc);
+}
+
+
+void * update_state_using_previous_layers(void *args){
+	nn_thread_t * data = (nn_thread_t *)args;
+	elina_manager_t * man = data->man;
+	fppoly_t *fp = data->fp;
+	fppoly_internal_t * pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t layerno = data->layerno;
+	size_t idx_start = data->start;
+	size_t idx_end = data->end;
+	size_t i, j, num_block, num_active;
+	size_t skipped_layers = 0;
+	int k;
+	/* the neurons are back-substituted in blocks, lexpr and uexpr of the neurons of a block still
+	   being back-substituted are stored together in exprs, active holds their positions in the block */
+	expr_t * exprs[2*BACKSUBST_BLOCK_SIZE];
+	size_t active[BACKSUBST_BLOCK_SIZE];
+	size_t block_index[BACKSUBST_BLOCK_SIZE];
+	neuron_t * block_neurons[BACKSUBST_BLOCK_SIZE];
+	neuron_t ** out_neurons = fp->layers[layerno]->neurons;
+	bool keep_out = fppoly_keeps_output_exprs(fp,layerno);
+	if(!fppoly_is_chain(fp,layerno+1)){
+		update_state_using_layer_graph(pr,fp,data);
+		return NULL;
+	}
+	/* the expressions of a block live in the arena of the thread until its bounds are computed, those built
+	   through a layer go to the other side of the arena than those they are built from */
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	for(i=idx_start; i < idx_end; i+=num_block){
+		num_block = idx_end - i < BACKSUBST_BLOCK_SIZE ? idx_end - i : BACKSUBST_BLOCK_SIZE;
+		num_active = num_block;
+		expr_t ** lexpr = exprs;
+		expr_t ** uexpr = exprs + num_active;
+		for(j=0; j < num_block; j++){
+			block_index[j] = nn_thread_neuron(data,i+j);
+			block_neurons[j] = out_neurons[block_index[j]];
+			expr_t * expr = neuron_expr(fp->layers[layerno], block_index[j]);
+			lexpr[j] = copy_expr(expr);
+			uexpr[j] = copy_expr(expr);
+			active[j] = j;
+		}
+		for(k=layerno - 1; k >=0 && num_active > 0; k--){
+			layer_t * layer = fp->layers[k];
+			if(layer->type==FFN || layer->type==CONV){
+				for(j=0; j < num_active; j++){
+					replace_activation_bounds(pr,&lexpr[j],&uexpr[j],layer);
+				}
+				if(data->layer_inf!=NULL && layerno - k >= pr->backsubst_min_depth){
+					size_t num_left = backsubst_remove_decided(exprs,active,num_active,block_neurons,data->layer_inf[k],data->layer_sup[k]);
+					/* layers k to 0 are not back-substituted through for the decided neurons */
+					skipped_layers += (num_active - num_left)*(k + 1);
+					num_active = num_left;
+					uexpr = exprs + num_active;
+					if(num_active==0){
+						break;
+					}
+				}
+				fppoly_arena_flip(&mark);
+				expr_pairs_from_previous_layer(pr,exprs,num_active,layer);
 			}
-			if((i==NUM_THREADS-2)){
-				idx_end = num_out_neurons;
-				
+			else if(layer->type==MAXPOOL || layer->type==LSTM){
+				fppoly_arena_flip(&mark);
+				for(j=0; j < num_active; j++){
+					expr_t * tmp_l = lexpr[j];
+					expr_t * tmp_u = uexpr[j];
+					lexpr[j] = lexpr_replace_maxpool_or_lstm_bounds(pr,tmp_l,layer->neurons);
+					uexpr[j] = uexpr_replace_maxpool_or_lstm_bounds(pr,tmp_u,layer->neurons);
+					free_expr(tmp_l);
+					free_expr(tmp_u);
+				}
 			}
-	  	}
-		//idx_start = idx_end;
-	    	//idx_end = num_out_neurons;
-		//args[i].start = idx_start; 
-	    	//args[i].end = idx_end;   
-		//args[i].man = man;
-		//args[i].fp = fp;
-		//args[i].layerno = layerno;
-	    	//pthread_create(&threads[i], NULL,update_state_using_previous_layers, (void*)&args[i]);
-		for (i = 0; i < NUM_THREADS; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
-	}
-	//printf("end\n");
-	//fflush(stdout);
+		}
+		for(j=0; j < num_active; j++){
+			neuron_t *neuron = block_neurons[active[j]];
+			neuron->lb = compute_lb_from_expr(pr, lexpr[j],fp);
+			neuron->ub = compute_ub_from_expr(pr, uexpr[j],fp);
+			if(keep_out){
+				fppoly_arena_enable(false);
+				fp->out->lexpr[block_index[active[j]]] = copy_expr(lexpr[j]);
+				fp->out->uexpr[block_index[active[j]]] = copy_expr(uexpr[j]);
+				fppoly_arena_enable(true);
+			}
+			free_expr(lexpr[j]);
+			free_expr(uexpr[j]);
+		}
+		fppoly_arena_rewind(&mark);
+	}
+	fppoly_arena_enable(arena_enabled);
+	if(skipped_layers > 0){
+		__atomic_fetch_add(&pr->skipped_layers, skipped_layers, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+
+void update_state_using_previous_layers_chunk(void *args, size_t start, size_t end){
+	nn_thread_t chunk = *(nn_thread_t *)args;
+	chunk.start = start;
+	chunk.end = end;
+	update_state_using_previous_layers(&chunk);
+}
+
+
+/* computes the bounds of neurons[0] to neurons[num_out_neurons-1] of layer layerno, or of its first num_out_neurons
+   neurons if neurons is NULL, in parallel */
+static void update_state_of_neurons(elina_manager_t *man, fppoly_t *fp, size_t layerno, size_t *neurons, size_t num_out_neurons){
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	/* small chunks so that threads finishing early can steal work from the others */
+	size_t chunk_size = num_out_neurons/(16*num_threads);
+	size_t i, k;
+	nn_thread_t args;
+	args.start = 0;
+	args.end = num_out_neurons;
+	args.man = man;
+	args.fp = fp;
+	args.layerno = layerno;
+	args.neurons = neurons;
+	args.layer_inf = NULL;
+	args.layer_sup = NULL;
+	/* the expressions of the output layer are kept, they have to reach the input layer */
+	if(pr->backsubst_policy==BACKSUBST_ADAPTIVE && fp->layers[layerno]->activation==RELU && !fppoly_keeps_output_exprs(fp,layerno)){
+		args.layer_inf = (double **)calloc(layerno, sizeof(double *));
+		args.layer_sup = (double **)calloc(layerno, sizeof(double *));
+		for(k=0; k < layerno; k++){
+			layer_t *layer = fp->layers[k];
+			if(layer->type!=FFN && layer->type!=CONV){
+				continue;
+			}
+			args.layer_inf[k] = (double *)malloc(layer->dims*sizeof(double));
+			args.layer_sup[k] = (double *)malloc(layer->dims*sizeof(double));
+			for(i=0; i < layer->dims; i++){
+				args.layer_inf[k][i] = layer->neurons[i]->lb;
+				args.layer_sup[k][i] = layer->neurons[i]->ub;
+			}
+		}
+	}
+	elina_thread_pool_for(pr->pool, update_state_using_previous_layers_chunk, &args, num_out_neurons, chunk_size==0 ? 1 : chunk_size);
+	if(args.layer_inf!=NULL){
+		for(k=0; k < layerno; k++){
+			free(args.layer_inf[k]);
+			free(args.layer_sup[k]);
+		}
+		free(args.layer_inf);
+		free(args.layer_sup);
+	}
+}
+
+
+void update_state_using_previous_layers_parallel(elina_manager_t *man, fppoly_t *fp, size_t layerno){
+	update_state_of_neurons(man, fp, layerno, NULL, fp->layers[layerno]->dims);
 }
 
 
@@ -2737,6 +3745,7 @@ void ffn_handle_intermediate_layer(elina_manager_t* man, elina_abstract0_t* elem
     if(alloc){
         fppoly_add_new_layer(fp,num_out_neurons, FFN, activation);
     } else {
+        layer_spill_free(fp->layers[numlayers]);
         fp->numlayers++;
 	}
 	/* printf("here, num_layers=%d\n",numlayers); */
@@ -2749,7 +3758,9 @@ void ffn_handle_intermediate_layer(elina_manager_t* man, elina_abstract0_t* elem
 	
         out_neurons[i]->expr = create_dense_expr(weight_i,bias_i,num_in_neurons);
     }
+    fp->layers[numlayers]->matrix_form = num_in_neurons > 0;
     update_state_using_previous_layers_parallel(man,fp,numlayers);
+    fppoly_compact_layers(fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY), fp);
     
     //printf("return here2\n");
     //fppoly_fprint(stdout,man,fp,NULL);
@@ -3070,36 +4081,20 @@ void handle_final_tanh_layer(fppoly_internal_t *pr, output_abstract_t * out, neu
 
 
 
-void ffn_handle_last_layer(elina_manager_t* man, elina_abstract0_t* element, double **weights, double * bias, size_t num_out_neurons, size_t num_in_neurons, bool has_activation, activation_type_t activation, bool alloc){
-  /* printf("last, num_out_neurons = %d\n",(int)num_out_neurons); */
-	//fflush(stdout);
-	fppoly_t *fp = fppoly_of_abstract0(element);
-	size_t numlayers = fp->numlayers;
-    if(alloc){
-        if(has_activation){
-	   fppoly_add_new_layer(fp,num_out_neurons, FFN, activation);
-        }
-        else{
-           fppoly_add_new_layer(fp,num_out_neurons, FFN, NONE);
-        }
-    } 
+/* computes the bounds of the neurons of layer layerno, whose expressions are set, and the output of fp from them */
+static void handle_last_layer_output(elina_manager_t* man, fppoly_t *fp, size_t layerno, bool has_activation, activation_type_t activation){
+	size_t num_out_neurons = fp->layers[layerno]->dims;
 	output_abstract_t * out = (output_abstract_t*)malloc(sizeof(output_abstract_t));
 	out->output_inf = (double *)malloc(num_out_neurons*sizeof(double)); 
 	out->output_sup = (double *)malloc(num_out_neurons*sizeof(double)); 
 	out->lexpr = (expr_t **)malloc(num_out_neurons*sizeof(expr_t *));
 	out->uexpr = (expr_t **)malloc(num_out_neurons*sizeof(expr_t *));
 	fp->out = out;
-	neuron_t ** out_neurons = fp->layers[numlayers]->neurons;
+	neuron_t ** out_neurons = fp->layers[layerno]->neurons;
 	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	size_t i;
-	for(i=0; i < num_out_neurons; i++){
-		double * weight_i = weights[i];
-		double bias_i = bias[i];
-		out_neurons[i]->expr = create_dense_expr(weight_i,bias_i,num_in_neurons);
-		/* printf("i = %d: ", (int)i); */
-		/* expr_print(out_neurons[i]->expr); */
-	}
-	update_state_using_previous_layers_parallel(man,fp,numlayers);
+	update_state_using_previous_layers_parallel(man,fp,layerno);
+	fppoly_compact_layers(pr, fp);
     if(activation==RELU){
         handle_final_relu_layer(pr,fp->out,out_neurons, num_out_neurons, has_activation);
     }
@@ -3116,6 +4111,35 @@ void ffn_handle_last_layer(elina_manager_t* man, elina_abstract0_t* element, dou
 		out->output_sup[i] = out_neurons[i]->ub;
 	}
     }
+}
+
+void ffn_handle_last_layer(elina_manager_t* man, elina_abstract0_t* element, double **weights, double * bias, size_t num_out_neurons, size_t num_in_neurons, bool has_activation, activation_type_t activation, bool alloc){
+  /* printf("last, num_out_neurons = %d\n",(int)num_out_neurons); */
+	//fflush(stdout);
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+    if(alloc){
+        if(has_activation){
+	   fppoly_add_new_layer(fp,num_out_neurons, FFN, activation);
+        }
+        else{
+           fppoly_add_new_layer(fp,num_out_neurons, FFN, NONE);
+        }
+    }
+    else{
+        layer_spill_free(fp->layers[numlayers]);
+    }
+	neuron_t ** out_neurons = fp->layers[numlayers]->neurons;
+	size_t i;
+	for(i=0; i < num_out_neurons; i++){
+		double * weight_i = weights[i];
+		double bias_i = bias[i];
+		out_neurons[i]->expr = create_dense_expr(weight_i,bias_i,num_in_neurons);
+		/* printf("i = %d: ", (int)i); */
+		/* expr_print(out_neurons[i]->expr); */
+	}
+	fp->layers[numlayers]->matrix_form = num_in_neurons > 0;
+	handle_last_layer_output(man,fp,numlayers,has_activation,activation);
     //printf("finish\n");
     //fppoly_fprint(stdout,man,fp,NULL);
     //fflush(stdout);
@@ -3164,156 +4188,246 @@ void ffn_handle_last_log_layer_no_alloc(elina_manager_t* man, elina_abstract0_t*
     ffn_handle_last_layer(man, element, weights, bias, num_out_neurons, num_in_neurons, has_log, LOG, false);
 }
 
-double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
-	size_t i;
-	int k;
-	//size_t numlayers = fp->numlayers;
-	expr_t * lexpr = copy_expr(expr);
-        fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-		double ret;
-		double best_res = -INFINITY;
-	for(k=layerno - 1; k >=0; k--){
-	//	fflush(stdout);	
-		neuron_t ** aux_neurons = fp->layers[k]->neurons;
-		expr_t * tmp_l;
-				
-	   if(fp->layers[k]->type==FFN || fp->layers[k]->type==CONV){
-			
-		    if(fp->layers[k]->activation==RELU){
-		        tmp_l = lexpr;
-		        lexpr = lexpr_replace_relu_bounds(pr,lexpr,aux_neurons);
-		        free_expr(tmp_l);
-		    }
-		    else if(fp->layers[k]->activation==SIGMOID){
-		        tmp_l = lexpr;
-			//printf("start\n");
-			//fflush(stdout);
-		        lexpr = lexpr_replace_sigmoid_bounds(pr,lexpr,aux_neurons);
-			//printf("finish\n");
-			//fflush(stdout);
-		        free_expr(tmp_l);
-		    }
-		    else if(fp->layers[k]->activation==TANH){
-		         tmp_l = lexpr;
-		        lexpr = lexpr_replace_tanh_bounds(pr,lexpr,aux_neurons);
-		        free_expr(tmp_l);
-		    }
-		
-		    else if(fp->layers[k]->activation==PARABOLA){
-		         tmp_l = lexpr;
-		        lexpr = lexpr_replace_parabola_bounds(pr,lexpr,aux_neurons);
-		        free_expr(tmp_l);
-		    }		
-			else if(fp->layers[k]->activation==LOG){
-				tmp_l = lexpr;
-		        	lexpr = lexpr_replace_log_bounds(pr,lexpr,aux_neurons);
-		        	free_expr(tmp_l);
-			}
-			
-			/* size_t num_neurons = lexpr->size; */
-			/* double lb_inf = lexpr->inf_cst, lb_sup = lexpr->sup_cst; */
-			/* for (i = 0; i < num_neurons; ++i) { */
-			/*   double tmp1, tmp2; */
-			/*   elina_double_interval_mul(&tmp1,&tmp2,aux_neurons[i]->lb,aux_neurons[i]->ub,lexpr->inf_coeff[i],lexpr->sup_coeff[i]); */
-			/*   lb_inf += tmp1; */
-			/*   lb_sup += tmp2; */
-			/* } */
-			/* if (k == (int)(layerno - 1) || lb_inf < best_res) { */
-			/*   best_res = lb_inf; */
-			/* } */
-
-
-			/* printf("%d, activation = %d\n",(int)k, (int)fp->layers[k]->activation); */
-			/* expr_print(lexpr); */
-
-				tmp_l = lexpr;			
-				lexpr = expr_from_previous_layer(pr,lexpr, fp->layers[k]);		
-				free_expr(tmp_l);
-			}
-		else{
-			expr_t * tmp_l = lexpr;
-			lexpr = lexpr_replace_maxpool_or_lstm_bounds(pr,lexpr,aux_neurons);	
-			free_expr(tmp_l);
-		}
 
-	}
-		
-	double res = compute_lb_from_expr(pr,lexpr,fp);
+static layer_weights_t * layer_weights_alloc(void *weights, void *bias, size_t ld, fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t num_in_neurons){
+	layer_weights_t *res = (layer_weights_t *)malloc(sizeof(layer_weights_t));
+	res->weights = weights;
+	res->bias = bias;
+	res->ld = ld;
+	res->num_in = num_in_neurons;
+	res->layout = layout;
+	res->dtype = dtype;
 	return res;
-	//return best_res;
 }
 
 
-double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+void ffn_handle_first_layer_buffer(elina_manager_t* man, elina_abstract0_t *abs, void *weights, void *bias, size_t ld,
+				   fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t size, size_t num_pixels, activation_type_t activation){
+	fppoly_t *res = fppoly_of_abstract0(abs);
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	size_t i;
-	int k;
-	//size_t numlayers = fp->numlayers;
-	expr_t * uexpr = copy_expr(expr);
-        fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-		double best_res = INFINITY;
-	for(k=layerno - 1; k >=0; k--){
-		neuron_t ** aux_neurons = fp->layers[k]->neurons;
-		expr_t * tmp_u;
-		if(fp->layers[k]->type==FFN || fp->layers[k]->type==CONV){
-			
-		    	if(fp->layers[k]->activation==RELU){
-		        	tmp_u = uexpr;
-		        	uexpr = uexpr_replace_relu_bounds(pr,uexpr,aux_neurons);
-		        	free_expr(tmp_u);
-		    	}
-		    	else if(fp->layers[k]->activation==SIGMOID){
-		        	tmp_u = uexpr;
-		        	uexpr = uexpr_replace_sigmoid_bounds(pr,uexpr,aux_neurons);
-		        	free_expr(tmp_u);
-		    	}
-		    	else if(fp->layers[k]->activation==TANH){
-		         	tmp_u = uexpr;
-		        	uexpr = uexpr_replace_tanh_bounds(pr,uexpr,aux_neurons);
-		        	free_expr(tmp_u);
-		    	}
-		
-		    	else if(fp->layers[k]->activation==PARABOLA){
-		         	tmp_u = uexpr;
-		        	uexpr = uexpr_replace_parabola_bounds(pr,uexpr,aux_neurons);
-		        	free_expr(tmp_u);
-		    	}		
-			else if(fp->layers[k]->activation==LOG){
-				tmp_u = uexpr;
-		        	uexpr = uexpr_replace_log_bounds(pr,uexpr,aux_neurons);
-		        	free_expr(tmp_u);
-			}
+	fppoly_alloc_first_layer(res, size, FFN, activation);
+	layer_t *layer = res->layers[0];
+	layer->weights = layer_weights_alloc(weights, bias, ld, layout, dtype, num_pixels);
+	layer->matrix_form = num_pixels > 0;
+	for(i=0; i < size; i++){
+		expr_t *expr = neuron_expr(layer, i);
+		layer->neurons[i]->lb = compute_lb_from_expr(pr, expr, res);
+		layer->neurons[i]->ub = compute_ub_from_expr(pr, expr, res);
+	}
+	fppoly_compact_layers(pr, res);
+}
 
-			/* size_t num_neurons = uexpr->size; */
-			/* double ub_sup = uexpr->sup_cst; */
-			/* for (i = 0; i < num_neurons; ++i) { */
-			/*   double tmp1, tmp2; */
-			/*   elina_double_interval_mul(&tmp1,&tmp2,aux_neurons[i]->lb,aux_neurons[i]->ub,uexpr->inf_coeff[i],uexpr->sup_coeff[i]); */
-			/*   ub_sup += tmp2; */
-			/* } */
-			/* if (k == (int)(layerno - 1) || ub_sup < best_res) { */
-			/*   best_res = ub_sup; */
-			/* } */
-			
-			tmp_u = uexpr;			
-			uexpr = expr_from_previous_layer(pr,uexpr, fp->layers[k]);		
-			free_expr(tmp_u);
-		}
-		else{
-			expr_t * tmp_u = uexpr;
-			uexpr = uexpr_replace_maxpool_or_lstm_bounds(pr,uexpr,aux_neurons);	
-			free_expr(tmp_u);
-		}
-			
+
+void ffn_handle_intermediate_layer_buffer(elina_manager_t* man, elina_abstract0_t* element, void *weights, void *bias, size_t ld,
+					  fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t num_out_neurons, size_t num_in_neurons,
+					  activation_type_t activation){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+	fppoly_add_new_layer(fp, num_out_neurons, FFN, activation);
+	layer_t *layer = fp->layers[numlayers];
+	layer->weights = layer_weights_alloc(weights, bias, ld, layout, dtype, num_in_neurons);
+	layer->matrix_form = num_in_neurons > 0;
+	update_state_using_previous_layers_parallel(man, fp, numlayers);
+	fppoly_compact_layers(fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY), fp);
+}
+
+
+void ffn_handle_last_layer_buffer(elina_manager_t* man, elina_abstract0_t* element, void *weights, void *bias, size_t ld,
+				  fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t num_out_neurons, size_t num_in_neurons,
+				  bool has_activation, activation_type_t activation){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+	fppoly_add_new_layer(fp, num_out_neurons, FFN, has_activation ? activation : NONE);
+	layer_t *layer = fp->layers[numlayers];
+	layer->weights = layer_weights_alloc(weights, bias, ld, layout, dtype, num_in_neurons);
+	layer->matrix_form = num_in_neurons > 0;
+	handle_last_layer_output(man, fp, numlayers, has_activation, activation);
+}
+
+static activation_type_t activation_of_model(elina_nn_activation_t activation){
+	switch(activation){
+		case ELINA_NN_RELU:
+			return RELU;
+		case ELINA_NN_SIGMOID:
+			return SIGMOID;
+		case ELINA_NN_TANH:
+			return TANH;
+		case ELINA_NN_PARABOLA:
+			return PARABOLA;
+		case ELINA_NN_LOG:
+			return LOG;
+		default:
+			return NONE;
 	}
-		
-	double res = compute_ub_from_expr(pr,uexpr,fp);
-	return res;
-	//return best_res;
 }
 
-void coeff_to_interval(elina_coeff_t *coeff, double *inf, double *sup){
-	double d;
-	if(coeff->discr==ELINA_COEFF_SCALAR){
+
+/* sets the expressions of the neurons of a layer from the rows of layer, the rows of CONV layers are already sorted */
+static void create_model_layer_exprs(neuron_t **neurons, elina_nn_layer_t *layer){
+	size_t i, j;
+	for(i=0; i < layer->num_out; i++){
+		size_t start = layer->row_start[i];
+		size_t size = layer->row_start[i+1] - start;
+		if(layer->dim==NULL){
+			neurons[i]->expr = create_dense_expr(layer->weights + start, layer->bias[i], size);
+			continue;
+		}
+		expr_t *expr = alloc_expr();
+		if(size>0){
+			expr_alloc_coeffs(expr,size,SPARSE);
+			memcpy(expr->dim, layer->dim + start, size*sizeof(uint32_t));
+		}
+		expr->size = size;
+		expr->inf_cst = -layer->bias[i];
+		expr->sup_cst = layer->bias[i];
+		expr->type = SPARSE;
+		for(j=0; j < size; j++){
+			expr->inf_coeff[j] = -layer->weights[start+j];
+			expr->sup_coeff[j] = layer->weights[start+j];
+		}
+		neurons[i]->expr = expr;
+	}
+}
+
+
+void fppoly_handle_model_layer(elina_manager_t* man, elina_abstract0_t* element, elina_nn_model_t *model, size_t layerno){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	elina_nn_layer_t *model_layer = model->layers + layerno;
+	layertype_t type = model_layer->type==ELINA_NN_CONV ? CONV : FFN;
+	activation_type_t activation = activation_of_model(model_layer->activation);
+	size_t numlayers = fp->numlayers;
+	size_t i;
+	if(layerno==0){
+		fppoly_alloc_first_layer(fp, model_layer->num_out, type, activation);
+	}
+	else{
+		fppoly_add_new_layer(fp, model_layer->num_out, type, activation);
+	}
+	layer_t *layer = fp->layers[numlayers];
+	create_model_layer_exprs(layer->neurons, model_layer);
+	layer->matrix_form = model_layer->dim==NULL && model_layer->num_in > 0;
+	if(layerno==0){
+		for(i=0; i < layer->dims; i++){
+			layer->neurons[i]->lb = compute_lb_from_expr(pr, layer->neurons[i]->expr, fp);
+			layer->neurons[i]->ub = compute_ub_from_expr(pr, layer->neurons[i]->expr, fp);
+		}
+	}
+	else if(layerno + 1 < model->num_layers){
+		update_state_using_previous_layers_parallel(man, fp, numlayers);
+	}
+	else{
+		handle_last_layer_output(man, fp, numlayers, activation!=NONE, activation);
+		return;
+	}
+	fppoly_compact_layers(pr, fp);
+}
+
+
+/* get_lb_using_previous_layers, for is_lower, or get_ub_using_previous_layers when the layers before
+   layerno do not form a chain */
+static double get_bound_using_layer_graph(fppoly_internal_t *pr, fppoly_t *fp, expr_t *expr, size_t layerno, bool is_lower){
+	double best_res = INFINITY, res;
+	expr_t ** acc = (expr_t **)calloc(layerno+1, sizeof(expr_t *));
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	acc[layerno] = copy_expr(expr);
+	expr_t * res_expr = dag_backsubst(pr,fp,acc,layerno,is_lower,&best_res);
+	res = is_lower ? compute_lb_from_expr(pr,res_expr,fp) : compute_ub_from_expr(pr,res_expr,fp);
+	free_expr(res_expr);
+	fppoly_arena_rewind(&mark);
+	fppoly_arena_enable(arena_enabled);
+	free(acc);
+	return best_res < res ? best_res : res;
+}
+
+
+double get_lb_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+	int k;
+	if(!fppoly_is_chain(fp,layerno)){
+		return get_bound_using_layer_graph(fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY),fp,expr,layerno,true);
+	}
+	/* every expression built below is temporary, those built through a layer go to the other side of the arena */
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	expr_t * lexpr = copy_expr(expr);
+	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	/* with concretize_every_layer, the best bound of lexpr over the neurons of the layers it went through */
+	double best_res = INFINITY;
+	for(k=layerno - 1; k >=0; k--){
+		layer_t * layer = fp->layers[k];
+		if(layer->type==FFN || layer->type==CONV){
+			lexpr_replace_activation_bounds(pr,&lexpr,layer);
+			if(pr->concretize_every_layer){
+				double *bounds = layer_bounds_alloc(layer);
+				double res = concretize_lexpr_over_layer(lexpr,bounds,bounds + layer->dims);
+				if(res < best_res){
+					best_res = res;
+				}
+				fppoly_arena_free(bounds);
+			}
+			fppoly_arena_flip(&mark);
+			exprs_from_previous_layer(pr,&lexpr,1,layer);
+		}
+		else{
+			fppoly_arena_flip(&mark);
+			expr_t * tmp_l = lexpr;
+			lexpr = lexpr_replace_maxpool_or_lstm_bounds(pr,lexpr,layer->neurons);
+			free_expr(tmp_l);
+		}
+	}
+	double res = compute_lb_from_expr(pr,lexpr,fp);
+	free_expr(lexpr);
+	fppoly_arena_rewind(&mark);
+	fppoly_arena_enable(arena_enabled);
+	return best_res < res ? best_res : res;
+}
+
+
+double get_ub_using_previous_layers(elina_manager_t *man, fppoly_t *fp, expr_t *expr, size_t layerno){
+	int k;
+	if(!fppoly_is_chain(fp,layerno)){
+		return get_bound_using_layer_graph(fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY),fp,expr,layerno,false);
+	}
+	/* every expression built below is temporary, those built through a layer go to the other side of the arena */
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	expr_t * uexpr = copy_expr(expr);
+	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	double best_res = INFINITY;
+	for(k=layerno - 1; k >=0; k--){
+		layer_t * layer = fp->layers[k];
+		if(layer->type==FFN || layer->type==CONV){
+			uexpr_replace_activation_bounds(pr,&uexpr,layer);
+			if(pr->concretize_every_layer){
+				double *bounds = layer_bounds_alloc(layer);
+				double res = concretize_uexpr_over_layer(uexpr,bounds,bounds + layer->dims);
+				if(res < best_res){
+					best_res = res;
+				}
+				fppoly_arena_free(bounds);
+			}
+			fppoly_arena_flip(&mark);
+			exprs_from_previous_layer(pr,&uexpr,1,layer);
+		}
+		else{
+			fppoly_arena_flip(&mark);
+			expr_t * tmp_u = uexpr;
+			uexpr = uexpr_replace_maxpool_or_lstm_bounds(pr,uexpr,layer->neurons);
+			free_expr(tmp_u);
+		}
+	}
+	double res = compute_ub_from_expr(pr,uexpr,fp);
+	free_expr(uexpr);
+	fppoly_arena_rewind(&mark);
+	fppoly_arena_enable(arena_enabled);
+	return best_res < res ? best_res : res;
+}
+
+void coeff_to_interval(elina_coeff_t *coeff, double *inf, double *sup){
+	double d;
+	if(coeff->discr==ELINA_COEFF_SCALAR){
 		elina_scalar_t * scalar = coeff->val.scalar;
 		d = scalar->val.dbl;
 		*inf = -d;
@@ -3332,18 +4446,15 @@ void coeff_to_interval(elina_coeff_t *coeff, double *inf, double *sup){
 expr_t * elina_linexpr0_to_expr(elina_linexpr0_t *linexpr0){
 	size_t size = linexpr0->size;
 	size_t i;
-	expr_t *res = (expr_t*)malloc(sizeof(expr_t));
-	res->inf_coeff = (double*)malloc(size*sizeof(double));
-	res->sup_coeff = (double*)malloc(size*sizeof(double));
+	expr_t *res = alloc_expr();
 	res->size = size;
 	if(linexpr0->discr==ELINA_LINEXPR_SPARSE){
 		res->type = SPARSE;
-		res->dim = (size_t *)malloc(size*sizeof(size_t));
 	}
 	else{
 		res->type = DENSE;
-		res->dim = NULL;
 	}
+	expr_alloc_coeffs(res,size,res->type);
 	size_t k;
 	for(i=0; i< size; i++){
 		elina_coeff_t *coeff;
@@ -3928,30 +5039,36 @@ void handle_lstm_layer(elina_manager_t *man, elina_abstract0_t *abs, double **we
 
 
 
+/* the output y - x of the network as an expression over the output layer */
+static expr_t * create_output_sub_expr(size_t out_size, elina_dim_t y, elina_dim_t x){
+	expr_t * sub = alloc_expr();
+	sub->size = out_size;
+	sub->type = DENSE;
+	
+	expr_alloc_coeffs(sub,sub->size,DENSE);
+
+	size_t i;
+	for (i = 0; i < sub->size; ++i) {
+		sub->inf_coeff[i] = 0;
+		sub->sup_coeff[i] = 0;
+	}
+	sub->inf_cst = 0;
+	sub->sup_cst = 0;
+	sub->inf_coeff[y] = -1;
+	sub->sup_coeff[y] = 1;
+	sub->inf_coeff[x] = 1;
+	sub->sup_coeff[x] = -1;
+	return sub;
+}
+
+
 bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y, elina_dim_t x){
 	fppoly_t *fp = fppoly_of_abstract0(element);
 	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	if(1){
 	  size_t out_size = fp->layers[fp->numlayers - 1]->dims;
 	  
-	  expr_t * sub = (expr_t *)malloc(sizeof(expr_t));
-	  sub->size = out_size;
-	  sub->type = DENSE;
-	  
-	  sub->inf_coeff = (double*)malloc(sub->size*sizeof(double));
-	  sub->sup_coeff = (double*)malloc(sub->size*sizeof(double));
-
-	  size_t i;
-	  for (i = 0; i < sub->size; ++i) {
-		sub->inf_coeff[i] = 0;
-		sub->sup_coeff[i] = 0;
-	  }
-	  sub->inf_cst = 0;
-	  sub->sup_cst = 0;
-	  sub->inf_coeff[y] = -1;
-	  sub->sup_coeff[y] = 1;
-	  sub->inf_coeff[x] = 1;
-	  sub->sup_coeff[x] = -1;
+	  expr_t * sub = create_output_sub_expr(out_size, y, x);
 
 	  /* expr_print(sub); */
 	  
@@ -3990,7 +5107,7 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 			//printf("after access\n");
 			//fflush(stdout);
 			size_t i,k;
-			expr_t * sub = (expr_t *)malloc(sizeof(expr_t));
+			expr_t * sub = alloc_expr();
 			//
 			//sub->size = size;
 			sub->inf_cst = exprA->inf_cst + exprB->sup_cst;
@@ -4000,9 +5117,7 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 			//expr_print(exprB);
 			//fflush(stdout);
 			if(exprA->type==DENSE){
-				sub->inf_coeff = (double*)malloc(sizeA*sizeof(double));
-				sub->sup_coeff = (double*)malloc(sizeA*sizeof(double));
-				sub->dim=NULL;
+				expr_alloc_coeffs(sub,sizeA,DENSE);
 				sub->size = sizeA;
 				sub->type = DENSE;
 				if(exprB->type==DENSE){
@@ -4029,9 +5144,7 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 			}
 			else{
 				if(exprB->type==DENSE){
-					sub->inf_coeff = (double*)malloc(sizeB*sizeof(double));
-					sub->sup_coeff = (double*)malloc(sizeB*sizeof(double));
-					sub->dim=NULL;
+					expr_alloc_coeffs(sub,sizeB,DENSE);
 					sub->size = sizeB;
 					sub->type = DENSE;
 					i = 0;
@@ -4048,15 +5161,12 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 					}
 				}
 				else{
-					sub->inf_coeff = (double*)malloc((sizeA+sizeB)*sizeof(double));
-					sub->sup_coeff = (double*)malloc((sizeA+sizeB)*sizeof(double));
-					sub->dim=NULL;
+					expr_alloc_coeffs(sub,sizeA+sizeB,SPARSE);
 					
 					sub->type = SPARSE;
 					size_t l = 0;
 					i=0;
 					k=0;
-					sub->dim = (size_t *)malloc((sizeA+sizeB)*sizeof(size_t));
 					while(i < sizeA && k < sizeB){
 						if(exprA->dim[i] < exprB->dim[k]){
 							sub->inf_coeff[l] = exprA->inf_coeff[i];
@@ -4095,9 +5205,6 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 						l++;
 					}
 					sub->size = l;
-					sub->inf_coeff = (double*)realloc(sub->inf_coeff,l*sizeof(double));
-					sub->sup_coeff = (double*)realloc(sub->sup_coeff,l*sizeof(double));
-					sub->dim = (size_t *)realloc(sub->dim,l*sizeof(size_t));
 				}
 			}
 			
@@ -4120,110 +5227,209 @@ bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y,
 }
 
 
-long int max(long int a, long int b){
-	return a> b? a : b;
+size_t fppoly_layer_resident_bytes(elina_manager_t* man, elina_abstract0_t* element, size_t layerno){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	return layer_resident_bytes(fp->layers[layerno]);
+}
 
+
+size_t fppoly_resident_bytes(elina_manager_t* man, elina_abstract0_t* element){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t i, k, res = 0;
+	for(k=0; k < fp->numlayers; k++){
+		res += layer_resident_bytes(fp->layers[k]);
+	}
+	if(fp->input_lexpr!=NULL){
+		for(i=0; i < fp->num_pixels; i++){
+			res += expr_bytes(fp->input_lexpr[i]) + expr_bytes(fp->input_uexpr[i]);
+		}
+	}
+	if(fp->out!=NULL){
+		size_t out_size = fp->layers[fp->numlayers-1]->dims;
+		for(i=0; i < out_size; i++){
+			res += expr_bytes(fp->out->lexpr[i]) + expr_bytes(fp->out->uexpr[i]);
+		}
+	}
+	return res;
 }
 
-void conv_handle_first_layer(elina_manager_t *man, elina_abstract0_t *abs, double *filter_weights, double *filter_bias, 
-					  size_t *input_size, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias){
-	
-	size_t i, j;
-	size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
-	
-	size_t output_size[3];
-	if(is_valid_padding){
-		output_size[0] = ceil((double)(input_size[0] - filter_size[0]+1) / (double)strides[0]);
-		output_size[1] = ceil((double)(input_size[1] - filter_size[1]+1) / (double)strides[1]);
+
+typedef struct output_specs_thread_t{
+	elina_manager_t *man;
+	fppoly_t *fp;
+	size_t out_size;
+	double *coeffs;
+	double *cst;
+	double *lb;
+}output_specs_thread_t;
+
+
+/* bounds the specifications start to end, the ones of a block of 2*BACKSUBST_BLOCK_SIZE are back-substituted
+   together so that the weights of a layer are read once for all of them */
+static void get_lb_for_output_specs_chunk(void *args, size_t start, size_t end){
+	output_specs_thread_t * data = (output_specs_thread_t *)args;
+	fppoly_t *fp = data->fp;
+	fppoly_internal_t * pr = fppoly_init_from_manager(data->man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t out_size = data->out_size;
+	size_t i, j, num_block;
+	int k;
+	expr_t * lexpr[2*BACKSUBST_BLOCK_SIZE];
+	double best_res[2*BACKSUBST_BLOCK_SIZE];
+	/* every expression built below is temporary, those built through a layer go to the other side of the arena */
+	bool arena_enabled = fppoly_arena_enable(true);
+	fppoly_arena_mark_t mark = fppoly_arena_mark();
+	if(!fppoly_is_chain(fp,fp->numlayers)){
+		/* the graph of the layers is gone through for one specification at a time */
+		for(i=start; i < end; i++){
+			expr_t * spec = create_dense_expr(data->coeffs + i*out_size, data->cst==NULL ? 0 : data->cst[i], out_size);
+			data->lb[i] = -get_bound_using_layer_graph(pr,fp,spec,fp->numlayers,true);
+			free_expr(spec);
+			fppoly_arena_rewind(&mark);
+		}
+		fppoly_arena_enable(arena_enabled);
+		return;
+	}
+	for(i=start; i < end; i+=num_block){
+		num_block = end - i < 2*BACKSUBST_BLOCK_SIZE ? end - i : 2*BACKSUBST_BLOCK_SIZE;
+		for(j=0; j < num_block; j++){
+			lexpr[j] = create_dense_expr(data->coeffs + (i+j)*out_size, data->cst==NULL ? 0 : data->cst[i+j], out_size);
+			best_res[j] = INFINITY;
+		}
+		for(k=fp->numlayers - 1; k >=0; k--){
+			layer_t * layer = fp->layers[k];
+			if(layer->type==FFN || layer->type==CONV){
+				for(j=0; j < num_block; j++){
+					lexpr_replace_activation_bounds(pr,&lexpr[j],layer);
+				}
+				if(pr->concretize_every_layer){
+					/* the bounds of the layer are gathered once for the block */
+					double *bounds = layer_bounds_alloc(layer);
+					for(j=0; j < num_block; j++){
+						double res = concretize_lexpr_over_layer(lexpr[j],bounds,bounds + layer->dims);
+						if(res < best_res[j]){
+							best_res[j] = res;
+						}
+					}
+					fppoly_arena_free(bounds);
+				}
+				fppoly_arena_flip(&mark);
+				exprs_from_previous_layer(pr,lexpr,num_block,layer);
+			}
+			else{
+				fppoly_arena_flip(&mark);
+				for(j=0; j < num_block; j++){
+					expr_t * tmp_l = lexpr[j];
+					lexpr[j] = lexpr_replace_maxpool_or_lstm_bounds(pr,tmp_l,layer->neurons);
+					free_expr(tmp_l);
+				}
+			}
+		}
+		for(j=0; j < num_block; j++){
+			double res = compute_lb_from_expr(pr,lexpr[j],fp);
+			data->lb[i+j] = best_res[j] < res ? -best_res[j] : -res;
+			free_expr(lexpr[j]);
+		}
+		fppoly_arena_rewind(&mark);
+	}
+	fppoly_arena_enable(arena_enabled);
+}
+
+
+void get_lb_for_output_specs(elina_manager_t* man, elina_abstract0_t* element, size_t num_specs, double *coeffs, double *cst, double *lb){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	/* full blocks unless there are too few specifications to keep every thread busy */
+	size_t chunk_size = (num_specs + num_threads - 1)/num_threads;
+	output_specs_thread_t args;
+	if(chunk_size > 2*BACKSUBST_BLOCK_SIZE){
+		chunk_size = 2*BACKSUBST_BLOCK_SIZE;
+	}
+	args.man = man;
+	args.fp = fp;
+	args.out_size = fp->layers[fp->numlayers - 1]->dims;
+	args.coeffs = coeffs;
+	args.cst = cst;
+	args.lb = lb;
+	elina_thread_pool_for(pr->pool, get_lb_for_output_specs_chunk, &args, num_specs, chunk_size==0 ? 1 : chunk_size);
+}
+
+
+typedef struct conv_thread_t{
+	neuron_t **neurons;
+	conv_filter_t *conv;
+}conv_thread_t;
+
+
+/* sets the expressions of the neurons of the output positions start to end, for all the filters */
+static void conv_create_exprs_chunk(void *args, size_t start, size_t end){
+	conv_thread_t * data = (conv_thread_t *)args;
+	conv_filter_t * conv = data->conv;
+	size_t num_filters = conv->output_size[2];
+	size_t pos, out_z;
+	for(pos=start; pos < end; pos++){
+		conv_window_t win;
+		conv_window(conv, pos, &win);
+		size_t size = conv_window_size(conv, &win);
+		for(out_z=0; out_z < num_filters; out_z++){
+			expr_t * expr = alloc_expr();
+			expr_alloc_coeffs(expr,size,SPARSE);
+			conv_fill_expr(conv, &win, out_z, expr);
+			data->neurons[pos*num_filters + out_z]->expr = expr;
+		}
+	}
+}
+
+
+/* sets the expressions of the neurons of a convolutional layer with output of size output_size,
+   in parallel over the output positions if pool is not NULL */
+static void conv_create_exprs(elina_thread_pool_t *pool, neuron_t **neurons, double *filter_weights, double *filter_bias, size_t *input_size,
+			      size_t *filter_size, size_t *output_size, size_t *strides, bool is_valid_padding, bool has_bias){
+	conv_filter_t conv;
+	conv_thread_t args;
+	size_t num_positions = output_size[0]*output_size[1];
+	size_t num_threads = pool==NULL ? 1 : elina_thread_pool_get_num_threads(pool);
+	size_t chunk_size = num_positions/(4*num_threads);
+	conv_filter_init(&conv, filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
+	args.neurons = neurons;
+	args.conv = &conv;
+	elina_thread_pool_for(pool, conv_create_exprs_chunk, &args, num_positions, chunk_size==0 ? 1 : chunk_size);
+}
+
+
+/* sets the neurons of the convolutional layer layer, implicit if pr->implicit_conv */
+static void conv_layer_create_exprs(fppoly_internal_t *pr, layer_t *layer, double *filter_weights, double *filter_bias, size_t *input_size,
+				    size_t *filter_size, size_t *output_size, size_t *strides, bool is_valid_padding, bool has_bias){
+	if(pr->implicit_conv){
+		layer->conv = conv_filter_alloc(filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
 	}
 	else{
-		output_size[0] = ceil((double)input_size[0] / (double)strides[0]);
-		output_size[1] = ceil((double)input_size[1] / (double)strides[1]);
+		conv_create_exprs(pr->pool, layer->neurons, filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
 	}
+}
+
+
+void conv_handle_first_layer(elina_manager_t *man, elina_abstract0_t *abs, double *filter_weights, double *filter_bias, 
+					  size_t *input_size, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias){
 	
-	output_size[2] = num_filters;
+	size_t i;
+	size_t output_size[3];
+	elina_nn_conv_geometry(output_size, NULL, NULL, input_size, filter_size, num_filters, strides, is_valid_padding);
 	size_t size = output_size[0]*output_size[1]*output_size[2];
 	
 	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	fppoly_t *res = fppoly_of_abstract0(abs);
 	fppoly_alloc_first_layer(res,size,  CONV, RELU);
 
-	neuron_t ** neurons = res->layers[0]->neurons;
-	size_t out_x, out_y, out_z;
-        size_t inp_x, inp_y, inp_z;
-	size_t x_shift, y_shift;
-
-	long int pad_along_height=0, pad_along_width=0;
-	long int pad_top=0,  pad_left=0,  tmp=0;
-	if(!is_valid_padding){
-		if (input_size[0] % strides[0] == 0){
-			long int tmp = filter_size[0] - strides[0];
-	  		pad_along_height = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[0] - (input_size[0] % strides[0]);
-	  		pad_along_height = max(tmp, 0);
-		}
-		if (input_size[1] % strides[1] == 0){
-			tmp = filter_size[1] - strides[1];
-	  		pad_along_width = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[1] - (input_size[1] % strides[1]);
-	  		pad_along_width = max(tmp, 0);
-		}
-		pad_top = pad_along_height / 2;
-		
-		pad_left = pad_along_width / 2;
-		
-	}
-
-	for(out_x=0; out_x < output_size[0]; out_x++) {
-	    for(out_y = 0; out_y < output_size[1]; out_y++) {
-		 for(out_z=0; out_z < output_size[2]; out_z++) {
-		     size_t mat_x = out_x*output_size[1]*output_size[2] + out_y*output_size[2] + out_z;
-		     size_t num_coeff = input_size[2]*filter_size[0]*filter_size[1];
-		     size_t actual_coeff = 0;
-		     double *coeff = (double *)malloc(num_coeff*sizeof(double));
-		     size_t *dim = (size_t *)malloc(num_coeff*sizeof(double));
-		     i=0;
-		     for(inp_z=0; inp_z <input_size[2]; inp_z++) {
-			 for(x_shift = 0; x_shift < filter_size[0]; x_shift++) {
-			     for(y_shift =0; y_shift < filter_size[1]; y_shift++) {
-				     long int x_val = out_x*strides[0]+x_shift-pad_top;	
-			  	     long int y_val = out_y*strides[1]+y_shift-pad_left;
-			  	     if(y_val<0 || y_val >= (long int)input_size[1]){
-			     			continue;
-			  	     }
-				     
-			  	     if(x_val<0 || x_val >= (long int)input_size[0]){
-			     			continue;
-			  	     }
-				     size_t mat_y = x_val*input_size[1]*input_size[2] + y_val*input_size[2] + inp_z;
-				     if(mat_y>=num_pixels){		 
-			     			continue;
-		          	     } 
-				     size_t filter_index = x_shift*filter_size[1]*input_size[2]*output_size[2] + y_shift*input_size[2]*output_size[2] + inp_z*output_size[2] + out_z;
-				     coeff[i] = filter_weights[filter_index];
-				     dim[i] = mat_y;
-				     i++;
-				     actual_coeff++;
-			     }
-			}
-		    }
-		    double cst = has_bias? filter_bias[out_z] : 0;
-	            neurons[mat_x]->expr = create_sparse_expr(coeff,cst,dim,actual_coeff);
-		    sort_sparse_expr(neurons[mat_x]->expr);
-		  
-		
-		   neurons[mat_x]->lb = compute_lb_from_expr(pr, neurons[mat_x]->expr,res);
-		   neurons[mat_x]->ub = compute_ub_from_expr(pr, neurons[mat_x]->expr,res);
-		   free(coeff);
-		   free(dim);
-	        }
-	     }
+	layer_t * layer = res->layers[0];
+	neuron_t ** neurons = layer->neurons;
+	conv_layer_create_exprs(pr, layer, filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
+	for(i=0; i < size; i++){
+		expr_t *expr = neuron_expr(layer, i);
+		neurons[i]->lb = compute_lb_from_expr(pr, expr,res);
+		neurons[i]->ub = compute_ub_from_expr(pr, expr,res);
 	}
-
+	fppoly_compact_layers(pr, res);
 	
 	//printf("return here\n");
 	//fppoly_fprint(stdout,man,res,NULL);
@@ -4237,98 +5443,19 @@ void conv_handle_intermediate_relu_layer(elina_manager_t* man, elina_abstract0_t
 				         size_t * input_size, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias){
 	//printf("conv intermediate starts here\n");
 	//fflush(stdout);
+	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 	fppoly_t *fp = fppoly_of_abstract0(element);
 	size_t numlayers = fp->numlayers;
-	size_t i, j;
-	size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
 	size_t output_size[3];
-	if(is_valid_padding){
-		output_size[0] = ceil((double)(input_size[0] - filter_size[0]+1) / (double)strides[0]);
-		output_size[1] = ceil((double)(input_size[1] - filter_size[1]+1) / (double)strides[1]);
-	}
-	else{
-		output_size[0] = ceil((double)input_size[0] / (double)strides[0]);
-		output_size[1] = ceil((double)input_size[1] / (double)strides[1]);
-	}
-	
-	output_size[2] = num_filters;
+	elina_nn_conv_geometry(output_size, NULL, NULL, input_size, filter_size, num_filters, strides, is_valid_padding);
 	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
 	//printf("num_out_neurons: %zu %zu\n",num_out_neurons,num_pixels);
 	//fflush(stdout);
 	fppoly_add_new_layer(fp,num_out_neurons, CONV, RELU);
-	neuron_t ** out_neurons = fp->layers[numlayers]->neurons;
-	size_t out_x, out_y, out_z;
-        size_t inp_x, inp_y, inp_z;
-	size_t x_shift, y_shift;
-
-	long int pad_along_height=0, pad_along_width=0;
-	long int pad_top=0,  pad_left=0,  tmp=0;
-	if(!is_valid_padding){
-		if (input_size[0] % strides[0] == 0){
-			long int tmp = filter_size[0] - strides[0];
-	  		pad_along_height = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[0] - (input_size[0] % strides[0]);
-	  		pad_along_height = max(tmp, 0);
-		}
-		if (input_size[1] % strides[1] == 0){
-			tmp = filter_size[1] - strides[1];
-	  		pad_along_width = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[1] - (input_size[1] % strides[1]);
-	  		pad_along_width = max(tmp, 0);
-		}
-		pad_top = pad_along_height / 2;
-		
-		pad_left = pad_along_width / 2;
-		
-	}
-
-	for(out_x=0; out_x < output_size[0]; out_x++) {
-	    for(out_y = 0; out_y < output_size[1]; out_y++) {
-		 for(out_z=0; out_z < output_size[2]; out_z++) {
-		     size_t mat_x = out_x*output_size[1]*output_size[2] + out_y*output_size[2] + out_z;
-		     size_t num_coeff = input_size[2]*filter_size[0]*filter_size[1];
-		     size_t actual_coeff = 0;
-		     double *coeff = (double *)malloc(num_coeff*sizeof(double));
-		     size_t *dim = (size_t *)malloc(num_coeff*sizeof(double));
-		     i=0;
-		     for(inp_z=0; inp_z <input_size[2]; inp_z++) {
-			 for(x_shift = 0; x_shift < filter_size[0]; x_shift++) {
-			     for(y_shift =0; y_shift < filter_size[1]; y_shift++) {
-				     long int x_val = out_x*strides[0]+x_shift-pad_top;	
-			  	     long int y_val = out_y*strides[1]+y_shift-pad_left;
-			  	     if(y_val<0 || y_val >= (long int)input_size[1]){
-			     			continue;
-			  	     }
-				     
-			  	     if(x_val<0 || x_val >= (long int)input_size[0]){
-			     			continue;
-			  	     }
-				     size_t mat_y = x_val*input_size[1]*input_size[2] + y_val*input_size[2] + inp_z;
-				     if(mat_y>=num_pixels){		 
-			     			continue;
-		          	     }
-				     size_t filter_index = x_shift*filter_size[1]*input_size[2]*output_size[2] + y_shift*input_size[2]*output_size[2] + inp_z*output_size[2] + out_z;
-				     coeff[i] = filter_weights[filter_index];
-				     dim[i] = mat_y;
-				     actual_coeff++;
-				     i++;
-			     }
-			}
-		    }
-		   double cst = has_bias? filter_bias[out_z] : 0;
-	           out_neurons[mat_x]->expr = create_sparse_expr(coeff,cst,dim,actual_coeff);
-		   sort_sparse_expr(out_neurons[mat_x]->expr); 
-		   free(coeff);
-		   free(dim);
-	        }
-	     }
-	}
+	conv_layer_create_exprs(pr, fp->layers[numlayers], filter_weights, filter_bias, input_size, filter_size, output_size, strides, is_valid_padding, has_bias);
 	
 	update_state_using_previous_layers_parallel(man,fp,numlayers);
+	fppoly_compact_layers(pr, fp);
 	
 	//printf("return here2\n");
 	//fppoly_fprint(stdout,man,fp,NULL);
@@ -4337,107 +5464,62 @@ void conv_handle_intermediate_relu_layer(elina_manager_t* man, elina_abstract0_t
 }
 
 
-size_t handle_maxpool_layer(elina_manager_t *man, elina_abstract0_t *element, 
-			   size_t *pool_size, size_t *input_size){
-	//assert(dimensionality==3);
-	//printf("maxpool start\n");
-	//fflush(stdout);
-	//printf("maxpool start\n");
-	//fflush(stdout);
-	assert(pool_size[0]==2 && pool_size[1]==2 && pool_size[2]==1);
-	//assert(stride[0]==2 && stride[1]==2 && stride[2]==1);
-	
-	size_t i,j,k;
-	size_t * output_size = (size_t *)malloc(3*sizeof(size_t));
-	for(i=0; i < 3; i++){
-		output_size[i] = input_size[i]/pool_size[i];
-	}
-
-
-	size_t num_input_neurons = input_size[0]*input_size[1]*input_size[2];
-	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
-
-    	size_t o12 = output_size[1]*output_size[2];
-   	size_t i12 = input_size[1]*input_size[2];
-    	size_t p01 = pool_size[0]*pool_size[1];
-	
-	fppoly_t * fp = fppoly_of_abstract0(element);
-	size_t numlayers = fp->numlayers;
-	fppoly_add_new_layer(fp,num_out_neurons, MAXPOOL, NONE);
-	size_t out_pos;
-	double * inf = (double *) calloc(p01,sizeof(double));
-	double * sup = (double *) calloc(p01,sizeof(double));
-	size_t * pool_map = (size_t *)calloc(p01,sizeof(size_t));
-	neuron_t ** out_neurons = fp->layers[numlayers]->neurons;
-	size_t count = 0;
-	for(out_pos=0; out_pos<num_out_neurons; out_pos++){
-		size_t out_x = out_pos / o12;
-		size_t out_y = (out_pos-out_x*o12) / output_size[2];
-		size_t out_z = out_pos-out_x*o12 - out_y*output_size[2];
-		size_t inp_x = out_x*pool_size[0];
-		size_t inp_y = out_y*pool_size[1];
-		size_t inp_z = out_z;
-		size_t inp_pos = inp_x*i12 + inp_y*input_size[2] + inp_z;
-		size_t pool_start_dim = out_pos*pool_size[0]*pool_size[1];
-		//printf("inpXYZ: %zu, %zu, %zu %zu %zu\n", inp_x, inp_y, inp_z, out_pos, num_out_neurons);
-        	//printf("outXYZ: %zu, %zu, %zu\n", out_x, out_y, out_z);
-		//fflush(stdout);
-		size_t x_shift, y_shift, l = 0;
-		double sum_u = 0.0;
-		double sum_l = 0.0;
+typedef struct maxpool_thread_t{
+	neuron_t **in_neurons;
+	neuron_t **out_neurons;
+	maxpool_windows_t *windows;
+	/* the output neurons set, NULL for all of them */
+	size_t *neurons;
+}maxpool_thread_t;
+
+
+/* sets the expressions and bounds of the output neurons start to end of a maxpool layer from the bounds of their
+   inputs, replacing the ones they had */
+static void maxpool_create_exprs_chunk(void *args, size_t start, size_t end){
+	maxpool_thread_t * data = (maxpool_thread_t *)args;
+	neuron_t ** out_neurons = data->out_neurons;
+	maxpool_windows_t * windows = data->windows;
+	size_t p, j, k;
+	double * inf = (double *)malloc(windows->pool_area*sizeof(double));
+	double * sup = (double *)malloc(windows->pool_area*sizeof(double));
+	for(p=start; p < end; p++){
+		size_t out_pos = data->neurons==NULL ? p : data->neurons[p];
+		size_t * pool_map = windows->window_map + out_pos*windows->pool_area;
+		size_t num_pool = windows->window_size[out_pos];
 		double max_u = -INFINITY;
 		double max_l = -INFINITY;
-		
-		size_t max_l_var = 0.0; 
-		size_t max_u_var = 0.0;
-		size_t min_width_var = 0.0;
-		double min_width = INFINITY;
-		for(x_shift = 0; x_shift < pool_size[0]; x_shift++){
-			for(y_shift = 0; y_shift < pool_size[1]; y_shift++){
-				size_t pool_cur_dim = inp_pos + x_shift*i12 + y_shift*input_size[2];
-				//printf("pool_cur_dim %zu %zu %zu\n",pool_cur_dim,fp->layers[numlayers-1]->dims,numlayers);
-				//fflush(stdout);
-				pool_map[l] = pool_cur_dim;
-				// use the ReLU bounds from the previous layer
-				double lb = -fp->layers[numlayers-1]->neurons[pool_cur_dim]->lb;
-				double ub = fp->layers[numlayers-1]->neurons[pool_cur_dim]->ub;
-				if(ub<=0){
-					inf[l] = 0.0;
-					sup[l] = 0.0;
-				}
-				else if(lb>0){
-					inf[l] = lb;
-					sup[l] = ub;
-				}
-				else{
-					inf[l] = 0;
-					sup[l] = ub;
-				}
-				//printf("inf: %g %g\n",inf[l],sup[l]);
-				//fflush(stdout);
-				sum_u = sum_u + sup[l];
-				sum_l = sum_l + inf[l];
-				if(sup[l]>max_u){
-					max_u = sup[l];
-					max_u_var = pool_map[l];
-				}
-				if(inf[l] > max_l){
-					max_l = inf[l];
-					max_l_var = pool_map[l];
-				}
-				if((ub-lb) < min_width){
-					min_width = ub - lb;
-					min_width_var = pool_map[l];
-				}
-				l++;
+		size_t max_l_var = 0;
+		size_t l;
+		for(l=0; l < num_pool; l++){
+			// use the ReLU bounds from the previous layer
+			double lb = -data->in_neurons[pool_map[l]]->lb;
+			double ub = data->in_neurons[pool_map[l]]->ub;
+			if(ub<=0){
+				inf[l] = 0.0;
+				sup[l] = 0.0;
+			}
+			else if(lb>0){
+				inf[l] = lb;
+				sup[l] = ub;
+			}
+			else{
+				inf[l] = 0;
+				sup[l] = ub;
+			}
+			if(sup[l]>max_u){
+				max_u = sup[l];
+			}
+			if(inf[l] > max_l){
+				max_l = inf[l];
+				max_l_var = pool_map[l];
 			}
 		}
-		
+		/* an input neuron greater than the others of the window is the output */
 		bool flag = false;
 		size_t var = 0;
-		for(j=0; j < p01; j++){
-			bool is_greater = true;
-			for(k = 0;  k < p01; k++){
+		for(j=0; j < num_pool; j++){
+			bool is_max = true;
+			for(k = 0;  k < num_pool; k++){
 				if(k==j)continue;
 				if((inf[k]==sup[k]) && (inf[j]>=sup[k])){
 					continue;
@@ -4446,83 +5528,154 @@ size_t handle_maxpool_layer(elina_manager_t *man, elina_abstract0_t *element,
 					continue;
 				}
 				else if(inf[j]<=sup[k]){
-					is_greater = false;
+					is_max = false;
 					break;
 				}
 			}
-			if(is_greater){
+			if(is_max){
 				flag = true;
-				var =pool_map[j];
+				var = pool_map[j];
 				break;
 			}
 		}
-		//printf("max_l: %gmax_u: %g\n",max_l,max_u);
-		//fflush(stdout);
+		double coeff[1];
+		size_t dim[1];
+		if(out_neurons[out_pos]->lexpr!=NULL){
+			free_expr(out_neurons[out_pos]->lexpr);
+		}
+		if(out_neurons[out_pos]->uexpr!=NULL){
+			free_expr(out_neurons[out_pos]->uexpr);
+		}
 		if(flag){
-		//if(0){
 			//x_new = x_var
-			count++;
-			//printf("out_pos: %zu\n",out_pos);
-			//fflush(stdout);
-			double coeff[1];
-			size_t dim[1];
 			coeff[0] = 1;
 			dim[0] = var;
 			out_neurons[out_pos]->lexpr = create_sparse_expr(coeff,0,dim,1);
 			out_neurons[out_pos]->uexpr = create_sparse_expr(coeff,0,dim,1);
-			//out_neurons[out_pos]->expr = create_sparse_expr(coeff,0,dim,1);
 		}
 		else{
 			//max_l	<= x_new <= max_u
-			double lcoeff[1];
-			size_t ldim[1];
-			lcoeff[0] = 1;
-			ldim[0] = max_l_var;
-			//lcoeff[0] = 0;
-			//ldim[0] = 0;
-			//printf("max_l: %gmax_u: %g\n",max_l,max_u);
-			//fflush(stdout);
-			//expr_t * expr = (expr_t *)malloc(sizeof(expr_t));
-			//expr->inf_coeff= expr->sup_coeff = expr->dim = NULL;
-			//expr->size = 0;
-			//expr->inf_cst = -max_l;
-			
-			//out_neurons[out_pos]->lexpr = NULL;//create_sparse_expr(NULL,max_l,NULL,0);
-			out_neurons[out_pos]->lexpr = create_sparse_expr(lcoeff,0,ldim,1);
-			//double *ucoeff = (double *)malloc(p01*sizeof(double));
-			//size_t *udim = (size_t *)malloc(p01*sizeof(size_t));
-			//for(j=0; j < p01; j++){
-			//	ucoeff[j] = 1.0;
-			//	udim[j] = pool_map[j];
-			//}
-			double ucoeff[1];
-			size_t udim[1];
-			ucoeff[0] = 0;
-			udim[0] = 0;
-			out_neurons[out_pos]->uexpr = create_sparse_expr(ucoeff,max_u,udim,1);
-			//out_neurons[out_pos]->uexpr = create_sparse_expr(ucoeff,max_l-sum_l,udim,p01);
-			//sort_sparse_expr(out_neurons[out_pos]->uexpr);
-			//free(ucoeff);
-			//free(udim);
-			//out_neurons[out_pos]->lexpr = create_cst_expr(-max_l,max_l);
-			//out_neurons[out_pos]->uexpr = create_cst_expr(-max_u,max_u);
+			coeff[0] = 1;
+			dim[0] = max_l_var;
+			out_neurons[out_pos]->lexpr = create_sparse_expr(coeff,0,dim,1);
+			coeff[0] = 0;
+			dim[0] = 0;
+			out_neurons[out_pos]->uexpr = create_sparse_expr(coeff,max_u,dim,1);
 		}
 		out_neurons[out_pos]->lb = -max_l;
-		out_neurons[out_pos]->ub = max_u;		
+		out_neurons[out_pos]->ub = max_u;
 	}
-	//update_state_using_previous_layers_parallel(man,fp,numlayers);
-        free(inf);
+	free(inf);
 	free(sup);
-	free(pool_map);
-	free(output_size);
-        //printf("count: %zu\n",count);
-	//fflush(stdout);
-	//printf("return here2\n");
-	//fppoly_fprint(stdout,man,fp,NULL);
-	//fflush(stdout);
+}
+
+
+/* sets the relaxations and bounds of the neurons of the maxpool layer layerno of fp, neurons[0] to neurons[num-1]
+   or the num first ones for neurons NULL */
+static void maxpool_update_neurons(fppoly_internal_t *pr, fppoly_t *fp, size_t layerno, size_t *neurons, size_t num){
+	layer_t *layer = fp->layers[layerno];
+	maxpool_thread_t args;
+	size_t predecessor = layer_predecessor(layer, layerno, 0);
+	assert(predecessor > 0);
+	args.in_neurons = fp->layers[predecessor-1]->neurons;
+	args.out_neurons = layer->neurons;
+	args.windows = layer->windows;
+	args.neurons = neurons;
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t chunk_size = num/(4*num_threads);
+	elina_thread_pool_for(pr->pool, maxpool_create_exprs_chunk, &args, num, chunk_size==0 ? 1 : chunk_size);
+}
+
+
+size_t handle_maxpool_layer_strided(elina_manager_t *man, elina_abstract0_t *element, size_t *pool_size, size_t *input_size,
+				    size_t *strides, size_t dimensionality, bool is_valid_padding){
+	assert(dimensionality==3);
+	assert(pool_size[2]==1);
+	fppoly_internal_t * pr = fppoly_init_from_manager(man,ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t output_size[3];
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, pool_size, input_size[2], strides, is_valid_padding);
+
+	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
+	size_t o12 = output_size[1]*output_size[2];
+	size_t i12 = input_size[1]*input_size[2];
+	size_t p01 = pool_size[0]*pool_size[1];
+
+	fppoly_t * fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+	fppoly_add_new_layer(fp,num_out_neurons, MAXPOOL, NONE);
+
+	/* the windows are computed once and kept with the layer, the relaxations of the output neurons then only read
+	   them, also when fppoly_propagate_dirty_neurons recomputes them */
+	maxpool_windows_t *windows = (maxpool_windows_t *)malloc(sizeof(maxpool_windows_t));
+	windows->window_map = (size_t *)malloc(num_out_neurons*p01*sizeof(size_t));
+	windows->window_size = (size_t *)malloc(num_out_neurons*sizeof(size_t));
+	windows->pool_area = p01;
+	fp->layers[numlayers]->windows = windows;
+	size_t out_pos;
+	for(out_pos=0; out_pos < num_out_neurons; out_pos++){
+		size_t out_x = out_pos / o12;
+		size_t out_y = (out_pos-out_x*o12) / output_size[2];
+		size_t inp_z = out_pos-out_x*o12 - out_y*output_size[2];
+		size_t x_shift, y_shift, l = 0;
+		for(x_shift = 0; x_shift < pool_size[0]; x_shift++){
+			long int x_val = out_x*strides[0] + x_shift - pad_top;
+			if(x_val<0 || x_val>=(long int)input_size[0]){
+				continue;
+			}
+			for(y_shift = 0; y_shift < pool_size[1]; y_shift++){
+				long int y_val = out_y*strides[1] + y_shift - pad_left;
+				if(y_val<0 || y_val >= (long int)input_size[1]){
+					continue;
+				}
+				windows->window_map[out_pos*p01 + l] = x_val*i12 + y_val*input_size[2] + inp_z;
+				l++;
+			}
+		}
+		windows->window_size[out_pos] = l;
+	}
+	maxpool_update_neurons(pr, fp, numlayers, NULL, num_out_neurons);
 	return num_out_neurons;
 }
 
+
+size_t handle_maxpool_layer(elina_manager_t *man, elina_abstract0_t *element, 
+			   size_t *pool_size, size_t *input_size){
+	/* non-overlapping windows */
+	return handle_maxpool_layer_strided(man, element, pool_size, input_size, pool_size, 3, true);
+}
+
+
+static void handle_residual_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_neurons, size_t *predecessors, size_t num_predecessors,
+				  activation_type_t activation){
+	fppoly_t *fp = fppoly_of_abstract0(element);
+	size_t numlayers = fp->numlayers;
+	size_t j;
+	assert(numlayers > 0 && num_predecessors > 0);
+	fppoly_add_new_layer(fp, num_neurons, ADD, activation);
+	layer_t *layer = fp->layers[numlayers];
+	free(layer->predecessors);
+	layer->predecessors = (size_t *)malloc(num_predecessors*sizeof(size_t));
+	for(j=0; j < num_predecessors; j++){
+		assert(predecessors[j] <= numlayers);
+		assert((predecessors[j]==0 ? fp->num_pixels : fp->layers[predecessors[j]-1]->dims)==num_neurons);
+		layer->predecessors[j] = predecessors[j];
+	}
+	layer->num_predecessors = num_predecessors;
+	update_state_using_previous_layers_parallel(man,fp,numlayers);
+	fppoly_compact_layers(fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY), fp);
+}
+
+
+void handle_residual_relu_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_neurons, size_t *predecessors, size_t num_predecessors){
+	handle_residual_layer(man, element, num_neurons, predecessors, num_predecessors, RELU);
+}
+
+
+void handle_residual_affine_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_neurons, size_t *predecessors, size_t num_predecessors){
+	handle_residual_layer(man, element, num_neurons, predecessors, num_predecessors, NONE);
+}
+
 void free_neuron(neuron_t *neuron){
 	if(neuron->expr){
 		free_expr(neuron->expr);
@@ -4587,6 +5740,31 @@ void layer_free(layer_t * layer){
 		layer->c_t_sup = NULL;
 	}
 
+	if(layer->predecessors!=NULL){
+		free(layer->predecessors);
+		layer->predecessors = NULL;
+	}
+
+	layer_spill_free(layer);
+	free(layer->dirty);
+
+	if(layer->weights!=NULL){
+		free(layer->weights);
+		layer->weights = NULL;
+	}
+
+	if(layer->conv!=NULL){
+		conv_filter_free(layer->conv);
+		layer->conv = NULL;
+	}
+
+	if(layer->windows!=NULL){
+		free(layer->windows->window_map);
+		free(layer->windows->window_size);
+		free(layer->windows);
+		layer->windows = NULL;
+	}
+
 	free(layer);
 	layer = NULL;
 }
@@ -4645,6 +5823,197 @@ void fppoly_free(elina_manager_t *man, fppoly_t *fp){
 }
 
 
+/* ************************************************************************* */
+/* Batched analysis of many input boxes through one network                  */
+/* ************************************************************************* */
+
+static elina_nn_activation_t model_of_activation(activation_type_t activation){
+	switch(activation){
+		case RELU:
+			return ELINA_NN_RELU;
+		case SIGMOID:
+			return ELINA_NN_SIGMOID;
+		case TANH:
+			return ELINA_NN_TANH;
+		case PARABOLA:
+			return ELINA_NN_PARABOLA;
+		case LOG:
+			return ELINA_NN_LOG;
+		default:
+			return ELINA_NN_NONE;
+	}
+}
+
+
+static fppoly_network_t * fppoly_network_of_model(elina_nn_model_t *model, bool owns_model){
+	fppoly_network_t *net = (fppoly_network_t *)malloc(sizeof(fppoly_network_t));
+	net->model = model;
+	net->owns_model = owns_model;
+	net->numlayers = 0;
+	net->layers = NULL;
+	return net;
+}
+
+
+/* adds the layers of the model of net it does not have yet */
+static void fppoly_network_add_model_layers(fppoly_network_t *net){
+	elina_nn_model_t *model = net->model;
+	while(net->numlayers < model->num_layers){
+		elina_nn_layer_t *model_layer = model->layers + net->numlayers;
+		net->layers = (layer_t **)realloc(net->layers, (net->numlayers+1)*sizeof(layer_t *));
+		layer_t *layer = create_layer(model_layer->num_out, model_layer->type==ELINA_NN_CONV ? CONV : FFN,
+					      activation_of_model(model_layer->activation));
+		create_model_layer_exprs(layer->neurons, model_layer);
+		layer->matrix_form = model_layer->dim==NULL && model_layer->num_in > 0;
+		net->layers[net->numlayers++] = layer;
+	}
+}
+
+
+fppoly_network_t * fppoly_network_alloc(size_t num_pixels){
+	return fppoly_network_of_model(elina_nn_model_alloc(num_pixels), true);
+}
+
+
+void fppoly_network_add_ffn_layer(fppoly_network_t *net, double **weights, double *bias, size_t num_out_neurons, size_t num_in_neurons, activation_type_t activation){
+	elina_nn_model_add_ffn_layer(net->model, weights, bias, num_out_neurons, num_in_neurons, model_of_activation(activation));
+	fppoly_network_add_model_layers(net);
+}
+
+
+void fppoly_network_add_conv_layer(fppoly_network_t *net, double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+				   size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias){
+	elina_nn_model_add_conv_layer(net->model, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias);
+	fppoly_network_add_model_layers(net);
+}
+
+
+fppoly_network_t * fppoly_network_from_model(elina_nn_model_t *model){
+	fppoly_network_t *net = fppoly_network_of_model(model, false);
+	fppoly_network_add_model_layers(net);
+	return net;
+}
+
+
+void fppoly_network_free(fppoly_network_t *net){
+	size_t i;
+	for(i=0; i < net->numlayers; i++){
+		layer_free(net->layers[i]);
+	}
+	free(net->layers);
+	if(net->owns_model){
+		elina_nn_model_free(net->model);
+	}
+	free(net);
+}
+
+
+typedef struct fppoly_batch_t{
+	elina_manager_t *man;
+	fppoly_network_t *net;
+	double *inf_array;
+	double *sup_array;
+	double *output_inf;
+	double *output_sup;
+	elina_dim_t *labels;
+	bool *is_greater_res;
+}fppoly_batch_t;
+
+
+/* analyses the input box q of the batch, the layers of the abstract element borrow the expressions of the network */
+static void fppoly_batch_analyze_query(fppoly_batch_t *batch, size_t q){
+	elina_manager_t *man = batch->man;
+	fppoly_network_t *net = batch->net;
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t num_pixels = net->model->num_pixels;
+	size_t out_size = net->layers[net->numlayers-1]->dims;
+	size_t i, k;
+	fppoly_t *fp = (fppoly_t *)malloc(sizeof(fppoly_t));
+	fppoly_from_network_input_box(fp, 0, num_pixels, batch->inf_array + q*num_pixels, batch->sup_array + q*num_pixels);
+	fp->layers = (layer_t **)malloc(net->numlayers*sizeof(layer_t *));
+	for(k=0; k < net->numlayers; k++){
+		layer_t *layer = net->layers[k];
+		fp->layers[k] = create_layer(layer->dims, layer->type, layer->activation);
+		fp->layers[k]->matrix_form = layer->matrix_form;
+		neuron_t **neurons = fp->layers[k]->neurons;
+		for(i=0; i < layer->dims; i++){
+			neurons[i]->expr = layer->neurons[i]->expr;
+		}
+		fp->numlayers = k + 1;
+		if(k==0){
+			for(i=0; i < layer->dims; i++){
+				neurons[i]->lb = compute_lb_from_expr(pr, neurons[i]->expr, fp);
+				neurons[i]->ub = compute_ub_from_expr(pr, neurons[i]->expr, fp);
+			}
+		}
+		else{
+			update_state_using_previous_layers_parallel(man, fp, k);
+		}
+	}
+	neuron_t **out_neurons = fp->layers[fp->numlayers-1]->neurons;
+	for(i=0; i < out_size; i++){
+		batch->output_inf[q*out_size+i] = -out_neurons[i]->lb;
+		batch->output_sup[q*out_size+i] = out_neurons[i]->ub;
+	}
+	if(batch->labels!=NULL){
+		elina_dim_t y = batch->labels[q];
+		for(i=0; i < out_size; i++){
+			bool res = false;
+			if(i!=y){
+				expr_t *sub = create_output_sub_expr(out_size, y, (elina_dim_t)i);
+				res = get_lb_using_previous_layers(man, fp, sub, fp->numlayers) < 0;
+				free_expr(sub);
+			}
+			batch->is_greater_res[q*out_size+i] = res;
+		}
+	}
+	for(k=0; k < fp->numlayers; k++){
+		for(i=0; i < fp->layers[k]->dims; i++){
+			fp->layers[k]->neurons[i]->expr = NULL;
+		}
+	}
+	fppoly_free(man, fp);
+}
+
+
+static void fppoly_batch_analyze_chunk(void *args, size_t start, size_t end){
+	size_t q;
+	for(q=start; q < end; q++){
+		fppoly_batch_analyze_query((fppoly_batch_t *)args, q);
+	}
+}
+
+
+void fppoly_network_analyze_batch(elina_manager_t *man, fppoly_network_t *net, size_t num_queries, double *inf_array, double *sup_array,
+				  double *output_inf, double *output_sup, elina_dim_t *labels, bool *is_greater_res){
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t q;
+	fppoly_batch_t batch;
+	if(net->numlayers==0){
+		return;
+	}
+	batch.man = man;
+	batch.net = net;
+	batch.inf_array = inf_array;
+	batch.sup_array = sup_array;
+	batch.output_inf = output_inf;
+	batch.output_sup = output_sup;
+	batch.labels = labels;
+	batch.is_greater_res = is_greater_res;
+	if(num_queries >= num_threads){
+		/* one query per thread at a time, the loops over the neurons inside a query run on the thread of the query */
+		elina_thread_pool_for(pr->pool, fppoly_batch_analyze_chunk, &batch, num_queries, 1);
+	}
+	else{
+		/* too few queries to keep the threads busy, the neurons of each query are analysed in parallel */
+		for(q=0; q < num_queries; q++){
+			fppoly_batch_analyze_query(&batch, q);
+		}
+	}
+}
+
+
 void neuron_fprint(FILE * stream, neuron_t *neuron, char ** name_of_dim){
 	//expr_fprint(stream,neuron->expr);
 	fprintf(stream,"[%g, %g]\n",-neuron->lb,neuron->ub);
@@ -4810,4 +6179,159 @@ void update_bounds_for_neuron(elina_manager_t *man, elina_abstract0_t *abs, size
 	neuron_t * neuron = layer->neurons[neuron_no];
 	neuron->lb = -lb;
 	neuron->ub = ub;
+	if(layer->dirty==NULL){
+		layer->dirty = (bool *)calloc(layer->dims, sizeof(bool));
+	}
+	layer->dirty[neuron_no] = true;
+}
+
+
+/* true if neuron i of layer layerno of fp depends on a neuron of its predecessors marked in reach */
+static bool neuron_depends_on(fppoly_t *fp, size_t layerno, size_t i, bool **reach){
+	layer_t *layer = fp->layers[layerno];
+	size_t j, m, num_predecessors = layer->predecessors==NULL ? 1 : layer->num_predecessors;
+	if(layer->type==ADD){
+		for(m=0; m < num_predecessors; m++){
+			size_t p = layer_predecessor(layer,layerno,m);
+			if(p > 0 && reach[p-1][i]){
+				return true;
+			}
+		}
+		return false;
+	}
+	size_t p = layer_predecessor(layer,layerno,0);
+	if(p==0){
+		return false;
+	}
+	if(layer->type==MAXPOOL){
+		maxpool_windows_t *windows = layer->windows;
+		for(j=0; j < windows->window_size[i]; j++){
+			if(reach[p-1][windows->window_map[i*windows->pool_area + j]]){
+				return true;
+			}
+		}
+		return false;
+	}
+	if(layer->type!=FFN && layer->type!=CONV){
+		/* the inputs of the neurons of LSTM layers are not tracked, they depend on the whole layer */
+		for(j=0; j < fp->layers[p-1]->dims; j++){
+			if(reach[p-1][j]){
+				return true;
+			}
+		}
+		return false;
+	}
+	expr_t *expr = neuron_expr(layer,i);
+	for(j=0; j < expr->size; j++){
+		size_t k = expr->type==DENSE ? j : expr->dim[j];
+		if((expr->inf_coeff[j]!=0 || expr->sup_coeff[j]!=0) && reach[p-1][k]){
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/* recomputes the bounds of the neurons that depend on the neurons whose bounds were changed by
+   update_bounds_for_neuron since the last call, layer by layer, and returns their number. A neuron depends on the
+   neurons of its predecessor its expression has a non-zero coefficient for, and on what these depend on; a ReLU
+   already decided to output 0 keeps its bounds and cuts the dependencies through it. The neurons of a maxpool layer depend on their window and
+   their relaxations are rebuilt from its new bounds, those of LSTM layers keep theirs. The recomputed bounds are
+   intersected with the previous ones and, for the last layer, the output of abs is updated */
+size_t fppoly_propagate_dirty_neurons(elina_manager_t *man, elina_abstract0_t *abs){
+	fppoly_t *fp = fppoly_of_abstract0(abs);
+	fppoly_internal_t *pr = fppoly_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t numlayers = fp->numlayers;
+	size_t i, k, res = 0;
+	bool any_reach = false;
+	/* reach[k][i] if the bounds of neuron i of layer k or of the neurons it depends on changed */
+	bool **reach = (bool **)malloc(numlayers*sizeof(bool *));
+	for(k=0; k < numlayers; k++){
+		layer_t *layer = fp->layers[k];
+		neuron_t **neurons = layer->neurons;
+		bool recompute = layer->type==FFN || layer->type==CONV || layer->type==ADD || layer->type==MAXPOOL;
+		size_t num = 0;
+		size_t *index = (size_t *)malloc(layer->dims*sizeof(size_t));
+		reach[k] = (bool *)calloc(layer->dims, sizeof(bool));
+		for(i=0; i < layer->dims && any_reach; i++){
+			if(layer->activation==RELU && neurons[i]->ub<=0 && (layer->dirty==NULL || !layer->dirty[i])){
+				continue;
+			}
+			if(neuron_depends_on(fp,k,i,reach)){
+				reach[k][i] = true;
+				if(recompute){
+					index[num++] = i;
+				}
+			}
+		}
+		if(num > 0){
+			bool keep_out = fppoly_keeps_output_exprs(fp,k) && layer->type!=MAXPOOL;
+			double *old_lb = (double *)malloc(num*sizeof(double));
+			double *old_ub = (double *)malloc(num*sizeof(double));
+			for(i=0; i < num; i++){
+				old_lb[i] = neurons[index[i]]->lb;
+				old_ub[i] = neurons[index[i]]->ub;
+				if(keep_out && fp->out->lexpr[index[i]]!=NULL){
+					free_expr(fp->out->lexpr[index[i]]);
+				}
+				if(keep_out && fp->out->uexpr[index[i]]!=NULL){
+					free_expr(fp->out->uexpr[index[i]]);
+				}
+			}
+			if(layer->type==MAXPOOL){
+				maxpool_update_neurons(pr,fp,k,index,num);
+			}
+			else{
+				update_state_of_neurons(man,fp,k,index,num);
+			}
+			for(i=0; i < num; i++){
+				neuron_t *neuron = neurons[index[i]];
+				neuron->lb = fmin(neuron->lb, old_lb[i]);
+				neuron->ub = fmin(neuron->ub, old_ub[i]);
+				if(keep_out){
+					output_abstract_t *out = fp->out;
+					size_t o = index[i];
+					double inf, sup;
+					switch(layer->activation){
+						case RELU:
+							inf = apply_relu_lexpr(pr,&out->lexpr[o],neuron);
+							sup = apply_relu_uexpr(pr,&out->uexpr[o],neuron);
+							break;
+						case SIGMOID:
+							inf = apply_sigmoid_lexpr(pr,&out->lexpr[o],neuron,false);
+							sup = apply_sigmoid_uexpr(pr,&out->uexpr[o],neuron,false);
+							break;
+						case TANH:
+							inf = apply_tanh_lexpr(pr,&out->lexpr[o],neuron,false);
+							sup = apply_tanh_uexpr(pr,&out->uexpr[o],neuron,false);
+							break;
+						default:
+							inf = neuron->lb;
+							sup = neuron->ub;
+					}
+					out->output_inf[o] = fmin(out->output_inf[o], inf);
+					out->output_sup[o] = fmin(out->output_sup[o], sup);
+				}
+			}
+			free(old_lb);
+			free(old_ub);
+			res += num;
+		}
+		if(layer->dirty!=NULL){
+			for(i=0; i < layer->dims; i++){
+				reach[k][i] = reach[k][i] || layer->dirty[i];
+			}
+			free(layer->dirty);
+			layer->dirty = NULL;
+		}
+		for(i=0; i < layer->dims && !any_reach; i++){
+			any_reach = reach[k][i];
+		}
+		free(index);
+	}
+	for(k=0; k < numlayers; k++){
+		free(reach[k]);
+	}
+	free(reach);
+	return res;
 }
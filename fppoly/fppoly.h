@@ -37,11 +37,30 @@ extern "C" {
 #endif
 
 #include <fenv.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <unistd.h>
 //#include <sys/sysinfo.h>
 #include "elina_generic.h"
 #include "elina_box_meetjoin.h"
+#include "elina_thread_pool.h"
+#include "elina_nn_model.h"
+
+
+typedef enum backsubst_policy_t{
+  BACKSUBST_FULL, /* back-substitute every neuron to the input layer */
+  BACKSUBST_ADAPTIVE, /* stop as soon as the bounds at a previous layer decide the ReLU phase of the neuron */
+}backsubst_policy_t;
+
+typedef enum fppoly_weights_layout_t{
+  FPPOLY_ROW_MAJOR, /* weight (i,j) of output i and input j at weights[i*ld + j] */
+  FPPOLY_COLUMN_MAJOR, /* weight (i,j) at weights[j*ld + i] */
+}fppoly_weights_layout_t;
+
+typedef enum fppoly_weights_dtype_t{
+  FPPOLY_WEIGHTS_FLOAT64,
+  FPPOLY_WEIGHTS_FLOAT32,
+}fppoly_weights_dtype_t;
 
 
 typedef struct fppoly_internal_t{
@@ -56,6 +75,24 @@ typedef struct fppoly_internal_t{
   bool conv;
   double min_denormal;
   double ulp;
+  /* the same for the coefficients of the layers stored in float32, see fppoly_manager_set_float32 */
+  double min_denormal_float;
+  double ulp_float;
+  /* worker threads shared by all parallel loops */
+  elina_thread_pool_t *pool;
+  /* depth of the back-substitution of the neurons of ReLU layers */
+  backsubst_policy_t backsubst_policy;
+  size_t backsubst_min_depth;
+  /* bound the back-substituted expressions of get_lb/get_ub_using_previous_layers at every layer they reach */
+  bool concretize_every_layer;
+  /* convolutional layers keep their filter instead of one expression per neuron */
+  bool implicit_conv;
+  /* bytes the layers of an abstract element may keep in memory before the oldest are spilled, 0 for no limit */
+  size_t memory_budget;
+  /* the affine and convolutional layers are stored with float32 coefficients once their bounds are computed */
+  bool float32;
+  /* layers not back-substituted through thanks to the policy, since the last reset */
+  size_t skipped_layers;
   /* back pointer to elina_manager*/
   elina_manager_t* man;
 }fppoly_internal_t;
@@ -67,6 +104,7 @@ typedef enum layertype_t {
   CONV,    /* CONV layer */
   MAXPOOL,   /* MAXPOOL layer */
   LSTM, /* LSTM layer */
+  ADD, /* sum of the outputs of its predecessors, for residual connections */
 } layertype_t;
 
 typedef enum activation_type_t{
@@ -83,13 +121,14 @@ typedef enum exprtype_t{
  SPARSE,
 }exprtype_t;
 
+/* inf_coeff, sup_coeff and, for SPARSE expressions, dim share one allocation made by expr_alloc_coeffs */
 typedef struct expr_t{
 	double *inf_coeff;
 	double *sup_coeff;
 	double inf_cst;
 	double sup_cst;
 	exprtype_t type;
-	size_t * dim;
+	uint32_t * dim;
     size_t size;
 }expr_t;
 
@@ -101,6 +140,56 @@ typedef struct neuron_t{
 	expr_t * uexpr;
 }neuron_t;
 
+/* filter of a convolutional layer, the weight of input (x,y,z) of the window for filter f is
+   weights[((x*filter_size[1] + y)*input_size[2] + z)*output_size[2] + f]; bias is NULL without bias */
+typedef struct conv_filter_t{
+	double *weights;
+	double *bias;
+	size_t input_size[3];
+	size_t filter_size[2];
+	size_t output_size[3];
+	size_t strides[2];
+	long int pad_top;
+	long int pad_left;
+}conv_filter_t;
+
+/* windows of the output neurons of a maxpool layer: the input neurons of the window of output neuron i are
+   window_map[i*pool_area] to window_map[i*pool_area + window_size[i] - 1], the ones of the padding are left out */
+typedef struct maxpool_windows_t{
+	size_t *window_map;
+	size_t *window_size;
+	size_t pool_area;
+}maxpool_windows_t;
+
+/* the expressions of the neurons of a layer packed in one block, on the heap for a layer stored in float32 (see
+   fppoly_manager_set_float32) or in a file mapped in memory once spilled (see fppoly_manager_set_memory_budget).
+   They are point expressions of the same type: neuron i has the coefficients coeffs[start[i]] to coeffs[start[i+1]-1],
+   of type dtype, over dim[start[i]] to dim[start[i+1]-1] for SPARSE expressions, and the constant [-cst[2*i],cst[2*i+1]].
+   A coefficient w stands for the interval [w-e,w+e] with e = coeff_ulp*|w| + coeff_min, which bounds the error of its
+   rounding to dtype. The block starts at cst */
+typedef struct layer_spill_t{
+	/* the spill file holding the block, NULL for a block on the heap */
+	struct fppoly_spill_t *buffer;
+	exprtype_t type;
+	fppoly_weights_dtype_t dtype;
+	double coeff_ulp;
+	double coeff_min;
+	size_t *start;
+	double *cst;
+	void *coeffs;
+	uint32_t *dim;
+}layer_spill_t;
+
+/* the weights and bias of an affine layer read in place from a buffer of the caller, see ffn_handle_intermediate_layer_buffer */
+typedef struct layer_weights_t{
+	void *weights;
+	void *bias;
+	size_t ld;
+	size_t num_in;
+	fppoly_weights_layout_t layout;
+	fppoly_weights_dtype_t dtype;
+}layer_weights_t;
+
 typedef struct layer_t{
 	size_t dims;
 	layertype_t type;
@@ -110,6 +199,23 @@ typedef struct layer_t{
 	double * h_t_sup;
 	double * c_t_inf;
 	double * c_t_sup;
+	/* all neuron expressions are DENSE point expressions of the same size, back-substitution is a matrix product */
+	bool matrix_form;
+	/* for an implicit convolutional layer the filter, the neurons have no expr and theirs are built from it when needed */
+	conv_filter_t *conv;
+	/* the layers whose outputs are the inputs of the layer, k for layer k-1 and 0 for the input of the
+	   network; NULL for a layer reading only the output of the layer before it */
+	size_t *predecessors;
+	size_t num_predecessors;
+	/* the expressions of the neurons once packed in float32 or spilled, they then have no expr */
+	layer_spill_t *spill;
+	/* for an affine layer given by a buffer, its weights, the neurons have no expr */
+	layer_weights_t *weights;
+	/* for a maxpool layer, the windows of its neurons */
+	maxpool_windows_t *windows;
+	/* the neurons whose bounds were changed by update_bounds_for_neuron since the last call to
+	   fppoly_propagate_dirty_neurons, NULL if there are none */
+	bool *dirty;
 }layer_t;
 
 typedef struct output_abstract_t{
@@ -130,8 +236,21 @@ typedef struct fppoly_t{
 	size_t num_pixels;
 	size_t lstm_index;
 	output_abstract_t * out;
+	/* predecessor of the next layer added, as in layer_t, or -1 for the last layer */
+	long int next_predecessor;
 }fppoly_t;
 
+/* layers of a network shared by the analyses of many input boxes, built from the
+   layers of its model: only the expressions of the neurons are set, they are
+   never modified */
+typedef struct fppoly_network_t{
+	elina_nn_model_t *model;
+	/* the model is freed with the network if it was allocated by fppoly_network_alloc */
+	bool owns_model;
+	layer_t ** layers;
+	size_t numlayers;
+}fppoly_network_t;
+
 
 typedef struct nn_thread_t{
 	size_t start;
@@ -139,11 +258,38 @@ typedef struct nn_thread_t{
 	elina_manager_t *man;
 	fppoly_t *fp;
 	size_t layerno;
+	/* the neurons updated are neurons[start] to neurons[end-1], NULL for the neurons start to end-1 */
+	size_t *neurons;
+	/* bounds of the neurons of the previous layers for BACKSUBST_ADAPTIVE, NULL otherwise */
+	double **layer_inf;
+	double **layer_sup;
 }nn_thread_t;
 
 
 elina_manager_t* fppoly_manager_alloc(void);
 
+void fppoly_manager_set_num_threads(elina_manager_t* man, size_t num_threads);
+
+size_t fppoly_manager_get_num_threads(elina_manager_t* man);
+
+void fppoly_manager_get_busy_time(elina_manager_t* man, double *busy_time);
+
+void fppoly_manager_reset_busy_time(elina_manager_t* man);
+
+void fppoly_manager_set_backsubst_policy(elina_manager_t* man, backsubst_policy_t policy, size_t min_depth);
+
+void fppoly_manager_set_concretize_every_layer(elina_manager_t* man, bool enable);
+
+void fppoly_manager_set_implicit_conv(elina_manager_t* man, bool enable);
+
+void fppoly_manager_set_memory_budget(elina_manager_t* man, size_t budget);
+
+void fppoly_manager_set_float32(elina_manager_t* man, bool enable);
+
+size_t fppoly_manager_get_skipped_layers(elina_manager_t* man);
+
+void fppoly_manager_reset_skipped_layers(elina_manager_t* man);
+
 elina_abstract0_t* fppoly_from_network_input(elina_manager_t *man, size_t intdim, size_t realdim, double *inf_array, double *sup_array);
 
 void fppoly_set_network_input_box(elina_manager_t *man, elina_abstract0_t* element, size_t intdim, size_t realdim, double *inf_array, double * sup_array);
@@ -220,10 +366,39 @@ void ffn_handle_last_parabola_layer_no_alloc(elina_manager_t* man, elina_abstrac
     
 void ffn_handle_last_log_layer_no_alloc(elina_manager_t* man, elina_abstract0_t* element, double **weights, double * bias,  size_t num_out_neurons, size_t num_in_neurons, bool has_log);
 
+/* the ffn_handle_*_layer functions for weights and bias given as one buffer each, of type dtype, with weight (i,j) of
+   output neuron i and input j at weights[i*ld + j] for FPPOLY_ROW_MAJOR and weights[j*ld + i] for
+   FPPOLY_COLUMN_MAJOR. The buffers are read in place, not copied: they must stay valid until element is freed */
+void ffn_handle_first_layer_buffer(elina_manager_t* man, elina_abstract0_t *abs, void *weights, void *bias, size_t ld,
+				   fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t size, size_t num_pixels, activation_type_t activation);
+
+void ffn_handle_intermediate_layer_buffer(elina_manager_t* man, elina_abstract0_t* element, void *weights, void *bias, size_t ld,
+					  fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t num_out_neurons, size_t num_in_neurons,
+					  activation_type_t activation);
+
+void ffn_handle_last_layer_buffer(elina_manager_t* man, elina_abstract0_t* element, void *weights, void *bias, size_t ld,
+				  fppoly_weights_layout_t layout, fppoly_weights_dtype_t dtype, size_t num_out_neurons, size_t num_in_neurons,
+				  bool has_activation, activation_type_t activation);
+
+/* adds layer layerno of model to element, which holds the layers before it; the last layer of model
+   sets the output of element as ffn_handle_last_*_layer */
+void fppoly_handle_model_layer(elina_manager_t* man, elina_abstract0_t* element, elina_nn_model_t *model, size_t layerno);
+
 void fppoly_free(elina_manager_t *man, fppoly_t *fp);
 
 bool is_greater(elina_manager_t* man, elina_abstract0_t* element, elina_dim_t y, elina_dim_t x);
 
+/* bytes held in memory by layer layerno of element, its expressions, bounds and filter; a spilled layer only
+   counts what is left on the heap */
+size_t fppoly_layer_resident_bytes(elina_manager_t* man, elina_abstract0_t* element, size_t layerno);
+
+/* bytes held in memory by all the layers of element and the expressions of its input and output */
+size_t fppoly_resident_bytes(elina_manager_t* man, elina_abstract0_t* element);
+
+/* lb[s] receives a lower bound of cst[s] + sum_i coeffs[s*out_size+i]*y_i over the outputs y of element,
+   cst may be NULL; the num_specs specifications are back-substituted together in blocks */
+void get_lb_for_output_specs(elina_manager_t* man, elina_abstract0_t* element, size_t num_specs, double *coeffs, double *cst, double *lb);
+
 void conv_handle_first_layer(elina_manager_t *man, elina_abstract0_t * element, double *filter_weights, double *filter_bias,  
 					  size_t *input_size, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias);
 
@@ -233,6 +408,41 @@ void conv_handle_intermediate_relu_layer(elina_manager_t* man, elina_abstract0_t
 size_t handle_maxpool_layer(elina_manager_t *man, elina_abstract0_t *abs, 
 			   size_t *pool_size, size_t *input_size);
 
+/* maxpool with windows of size pool_size moved by strides over the input, as maxpool_zono; with SAME padding
+   the windows are cut at the border of the input. handle_maxpool_layer is the case strides == pool_size with
+   VALID padding */
+size_t handle_maxpool_layer_strided(elina_manager_t *man, elina_abstract0_t *element, size_t *pool_size, size_t *input_size,
+				    size_t *strides, size_t dimensionality, bool is_valid_padding);
+
+/* the next layer added to element reads the output of layer predecessor-1, or the input of the network for
+   predecessor 0, instead of the output of the last layer; it starts a branch of a residual network */
+void fppoly_set_next_layer_input(elina_manager_t *man, elina_abstract0_t *element, size_t predecessor);
+
+/* adds a layer summing the outputs of the num_predecessors layers predecessors, numbered as in
+   fppoly_set_next_layer_input, all of num_neurons neurons; the sum goes through a ReLU for the relu version.
+   Back-substitution then goes through the branches of the network and merges them where they meet */
+void handle_residual_relu_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_neurons, size_t *predecessors, size_t num_predecessors);
+
+void handle_residual_affine_layer(elina_manager_t *man, elina_abstract0_t *element, size_t num_neurons, size_t *predecessors, size_t num_predecessors);
+
+fppoly_network_t * fppoly_network_alloc(size_t num_pixels);
+
+void fppoly_network_add_ffn_layer(fppoly_network_t *net, double **weights, double *bias, size_t num_out_neurons, size_t num_in_neurons, activation_type_t activation);
+
+void fppoly_network_add_conv_layer(fppoly_network_t *net, double *filter_weights, double *filter_bias, size_t *input_size, size_t *filter_size,
+				   size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias);
+
+/* the network is built on model, which must not be freed before it */
+fppoly_network_t * fppoly_network_from_model(elina_nn_model_t *model);
+
+void fppoly_network_free(fppoly_network_t *net);
+
+/* analyses the num_queries input boxes stored row by row in inf_array and sup_array, output_inf and
+   output_sup receive the bounds of the neurons of the last layer of each query, before its activation;
+   if labels is not NULL is_greater_res[q*out_size+x] is is_greater(labels[q],x) for query q */
+void fppoly_network_analyze_batch(elina_manager_t *man, fppoly_network_t *net, size_t num_queries, double *inf_array, double *sup_array,
+				  double *output_inf, double *output_sup, elina_dim_t *labels, bool *is_greater_res);
+
 void create_lstm_layer(elina_manager_t *man, elina_abstract0_t *abs, size_t h, bool alloc);
 
 void handle_lstm_layer(elina_manager_t *man, elina_abstract0_t *abs, double **weights,  double *bias, size_t d, size_t h);
@@ -257,6 +467,9 @@ void free_non_lstm_layer_expr(elina_manager_t *man, elina_abstract0_t *abs, size
 
 void update_bounds_for_neuron(elina_manager_t *man, elina_abstract0_t *abs, size_t layerno, size_t neuron_no, double lb, double ub);
 
+/* the bounds of the neurons of LSTM layers are not recomputed, the neurons after them still are */
+size_t fppoly_propagate_dirty_neurons(elina_manager_t *man, elina_abstract0_t *abs);
+
 elina_interval_t * get_bounds_for_linexpr(elina_manager_t *man, elina_abstract0_t *element, elina_linexpr0_t *linexpr0, size_t layerno);
 
 #ifdef __cplusplus
@@ -0,0 +1,264 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "fppoly_arena.h"
+
+/* alignment of every allocation, one cache line */
+#define FPPOLY_ARENA_ALIGN 64
+/* size of the first chunk of a side, the following ones double */
+#define FPPOLY_ARENA_MIN_CHUNK (1UL<<20)
+#define FPPOLY_ARENA_MAX_CHUNKS 48
+
+typedef struct fppoly_arena_chunk_t{
+	char *base;
+	size_t size;
+}fppoly_arena_chunk_t;
+
+typedef struct fppoly_arena_side_t{
+	fppoly_arena_chunk_t chunks[FPPOLY_ARENA_MAX_CHUNKS];
+	size_t num_chunks;
+	/* allocations come from chunk current, of which used bytes are taken: the previous chunks are full and the
+	   following ones, kept by a rewind, are free */
+	size_t current;
+	size_t used;
+	/* bytes allocated from the side */
+	size_t in_use;
+}fppoly_arena_side_t;
+
+typedef struct fppoly_arena_t{
+	fppoly_arena_side_t sides[2];
+	/* the side allocations come from */
+	int side;
+	bool enabled;
+}fppoly_arena_t;
+
+static __thread fppoly_arena_t *fppoly_arena = NULL;
+
+static pthread_key_t fppoly_arena_key;
+static pthread_once_t fppoly_arena_key_once = PTHREAD_ONCE_INIT;
+
+/* largest number of bytes an arena held since the last fppoly_arena_reset_peak */
+static size_t fppoly_arena_peak = 0;
+
+
+static void fppoly_arena_release_chunks(fppoly_arena_side_t *side){
+	size_t i;
+	for(i=0; i < side->num_chunks; i++){
+		free(side->chunks[i].base);
+	}
+	side->num_chunks = 0;
+	side->current = 0;
+	side->used = 0;
+	side->in_use = 0;
+}
+
+static void fppoly_arena_destroy(void *arg){
+	fppoly_arena_t *arena = (fppoly_arena_t *)arg;
+	fppoly_arena_release_chunks(&arena->sides[0]);
+	fppoly_arena_release_chunks(&arena->sides[1]);
+	free(arena);
+}
+
+static void fppoly_arena_key_alloc(void){
+	pthread_key_create(&fppoly_arena_key, fppoly_arena_destroy);
+}
+
+static bool fppoly_arena_add_chunk(fppoly_arena_side_t *side, size_t size){
+	void *base;
+	if(side->num_chunks==FPPOLY_ARENA_MAX_CHUNKS || posix_memalign(&base, FPPOLY_ARENA_ALIGN, size)){
+		return false;
+	}
+	side->chunks[side->num_chunks].base = (char *)base;
+	side->chunks[side->num_chunks].size = size;
+	side->current = side->num_chunks;
+	side->num_chunks++;
+	side->used = 0;
+	return true;
+}
+
+static inline bool fppoly_arena_owns(fppoly_arena_t *arena, void *ptr){
+	size_t i;
+	int s;
+	for(s=0; s < 2; s++){
+		fppoly_arena_side_t *side = &arena->sides[s];
+		for(i=0; i < side->num_chunks; i++){
+			if((uintptr_t)ptr - (uintptr_t)side->chunks[i].base < side->chunks[i].size){
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/* called before the arena releases memory, when the bytes it holds are at a local maximum */
+static void fppoly_arena_record_peak(fppoly_arena_t *arena){
+	size_t in_use = arena->sides[0].in_use + arena->sides[1].in_use;
+	size_t peak = __atomic_load_n(&fppoly_arena_peak, __ATOMIC_RELAXED);
+	while(in_use > peak && !__atomic_compare_exchange_n(&fppoly_arena_peak, &peak, in_use, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+static void fppoly_arena_side_rewind(fppoly_arena_side_t *side, size_t current, size_t used, size_t in_use){
+	side->current = current;
+	side->used = used;
+	side->in_use = in_use;
+}
+
+
+bool fppoly_arena_enable(bool enable){
+	fppoly_arena_t *arena = fppoly_arena;
+	if(arena==NULL){
+		if(!enable){
+			return false;
+		}
+		arena = (fppoly_arena_t *)calloc(1, sizeof(fppoly_arena_t));
+		if(arena==NULL){
+			return false;
+		}
+		pthread_once(&fppoly_arena_key_once, fppoly_arena_key_alloc);
+		pthread_setspecific(fppoly_arena_key, arena);
+		fppoly_arena = arena;
+	}
+	bool res = arena->enabled;
+	arena->enabled = enable;
+	return res;
+}
+
+
+void fppoly_arena_reset(void){
+	fppoly_arena_t *arena = fppoly_arena;
+	int s;
+	if(arena==NULL){
+		return;
+	}
+	fppoly_arena_record_peak(arena);
+	for(s=0; s < 2; s++){
+		fppoly_arena_side_t *side = &arena->sides[s];
+		if(side->num_chunks > 1){
+			/* the previous round overflowed the first chunk, replace the chunks by a single one large enough for it */
+			size_t i, size = 0;
+			for(i=0; i < side->num_chunks; i++){
+				size += side->chunks[i].size;
+			}
+			fppoly_arena_release_chunks(side);
+			fppoly_arena_add_chunk(side, size);
+		}
+		fppoly_arena_side_rewind(side, 0, 0, 0);
+	}
+	arena->side = 0;
+}
+
+
+fppoly_arena_mark_t fppoly_arena_mark(void){
+	fppoly_arena_t *arena = fppoly_arena;
+	fppoly_arena_mark_t res;
+	int s;
+	memset(&res, 0, sizeof(res));
+	if(arena==NULL){
+		return res;
+	}
+	for(s=0; s < 2; s++){
+		res.current[s] = arena->sides[s].current;
+		res.used[s] = arena->sides[s].used;
+		res.in_use[s] = arena->sides[s].in_use;
+	}
+	res.side = arena->side;
+	return res;
+}
+
+
+void fppoly_arena_rewind(fppoly_arena_mark_t *mark){
+	fppoly_arena_t *arena = fppoly_arena;
+	int s;
+	if(arena==NULL){
+		return;
+	}
+	fppoly_arena_record_peak(arena);
+	for(s=0; s < 2; s++){
+		fppoly_arena_side_rewind(&arena->sides[s], mark->current[s], mark->used[s], mark->in_use[s]);
+	}
+	arena->side = mark->side;
+}
+
+
+void fppoly_arena_flip(fppoly_arena_mark_t *mark){
+	fppoly_arena_t *arena = fppoly_arena;
+	if(arena==NULL){
+		return;
+	}
+	fppoly_arena_record_peak(arena);
+	int s = 1 - arena->side;
+	fppoly_arena_side_rewind(&arena->sides[s], mark->current[s], mark->used[s], mark->in_use[s]);
+	arena->side = s;
+}
+
+
+size_t fppoly_arena_get_peak(void){
+	return __atomic_load_n(&fppoly_arena_peak, __ATOMIC_RELAXED);
+}
+
+
+void fppoly_arena_reset_peak(void){
+	__atomic_store_n(&fppoly_arena_peak, 0, __ATOMIC_RELAXED);
+}
+
+
+void * fppoly_arena_alloc(size_t size){
+	fppoly_arena_t *arena = fppoly_arena;
+	if(arena==NULL || !arena->enabled){
+		return malloc(size);
+	}
+	fppoly_arena_side_t *side = &arena->sides[arena->side];
+	/* every allocation gets its own address so that it is recognised by fppoly_arena_owns */
+	if(size==0){
+		size = 1;
+	}
+	size = (size + FPPOLY_ARENA_ALIGN - 1) & ~((size_t)FPPOLY_ARENA_ALIGN - 1);
+	while(side->num_chunks==0 || side->used + size > side->chunks[side->current].size){
+		if(side->current + 1 < side->num_chunks){
+			side->current++;
+			side->used = 0;
+		}
+		else{
+			size_t chunk_size = side->num_chunks==0 ? FPPOLY_ARENA_MIN_CHUNK : 2*side->chunks[side->num_chunks-1].size;
+			if(chunk_size < size){
+				chunk_size = size;
+			}
+			if(!fppoly_arena_add_chunk(side, chunk_size)){
+				return malloc(size);
+			}
+		}
+	}
+	void *res = side->chunks[side->current].base + side->used;
+	side->used += size;
+	side->in_use += size;
+	return res;
+}
+
+
+void fppoly_arena_free(void *ptr){
+	fppoly_arena_t *arena = fppoly_arena;
+	if(arena!=NULL && fppoly_arena_owns(arena, ptr)){
+		return;
+	}
+	free(ptr);
+}
@@ -0,0 +1,86 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* ************************************************************************* */
+/* fppoly_arena: per-thread bump allocator for temporary expressions */
+/* ************************************************************************* */
+
+#ifndef __FPPOLY_ARENA_H_INCLUDED__
+#define __FPPOLY_ARENA_H_INCLUDED__
+
+#include <stdlib.h>
+#include "elina_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Every thread owns one arena, created on first use and released when the
+   thread exits. While the arena of a thread is enabled, the allocations below
+   are served from it and freeing them is a no-op; the memory is reclaimed at
+   once by fppoly_arena_reset or fppoly_arena_rewind. When it is disabled they
+   behave as malloc/free.
+
+   The arena has two sides and allocations come from one of them. A loop that
+   builds the expressions of each step from those of the previous one flips to
+   the other side at every step: what the side flipped to got since the mark is
+   released, so the arena holds two steps at most whatever the number of steps. */
+
+typedef struct fppoly_arena_mark_t{
+	size_t current[2];
+	size_t used[2];
+	size_t in_use[2];
+	int side;
+}fppoly_arena_mark_t;
+
+bool fppoly_arena_enable(bool enable);
+  /* Enable or disable the arena of the calling thread, returns the previous state */
+
+void fppoly_arena_reset(void);
+  /* Release everything allocated from the arena of the calling thread, the
+     memory is kept for the next allocations */
+
+fppoly_arena_mark_t fppoly_arena_mark(void);
+  /* Position of both sides of the arena of the calling thread */
+
+void fppoly_arena_rewind(fppoly_arena_mark_t *mark);
+  /* Release everything allocated from both sides since mark, the allocations
+     then come from the side they came from at mark */
+
+void fppoly_arena_flip(fppoly_arena_mark_t *mark);
+  /* Allocate from the other side, releasing what it got since mark */
+
+size_t fppoly_arena_get_peak(void);
+  /* Largest number of bytes an arena of any thread held since the last
+     fppoly_arena_reset_peak */
+
+void fppoly_arena_reset_peak(void);
+
+void * fppoly_arena_alloc(size_t size);
+  /* Allocate size bytes, aligned for vector loads */
+
+void fppoly_arena_free(void *ptr);
+  /* Free memory returned by fppoly_arena_alloc or malloc */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
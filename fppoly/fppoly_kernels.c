@@ -0,0 +1,833 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include "fppoly_kernels.h"
+#include "elina_box_meetjoin.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FPPOLY_KERNELS_X86
+#include <immintrin.h>
+#define FPPOLY_AVX2 __attribute__((target("avx2")))
+#define FPPOLY_AVX512 __attribute__((target("avx512f")))
+#endif
+
+
+/* ====================================================================== */
+/* Scalar kernels, the reference for the vector ones */
+/* ====================================================================== */
+
+/* r = [mul_inf,mul_sup]*[inf,sup] with the rounding error of elina_double_interval_mul_expr_coeff */
+static inline void fppoly_scale_scalar(double *r_inf, double *r_sup, double inf, double sup, double mul_inf, double mul_sup, double ulp){
+	double maxA = fmax(fabs(inf), fabs(sup));
+	double tmp1, tmp2;
+	elina_double_interval_mul(r_inf, r_sup, mul_inf, mul_sup, inf, sup);
+	elina_double_interval_mul(&tmp1, &tmp2, mul_inf, mul_sup, maxA*ulp, maxA*ulp);
+	*r_inf += tmp1;
+	*r_sup += tmp2;
+}
+
+/* a = a + b with the rounding error of add_expr */
+static inline void fppoly_add_scalar(double *a_inf, double *a_sup, double b_inf, double b_sup, double ulp){
+	double maxA = fmax(fabs(*a_inf), fabs(*a_sup));
+	double maxB = fmax(fabs(b_inf), fabs(b_sup));
+	*a_inf = *a_inf + b_inf + (maxA + maxB)*ulp;
+	*a_sup = *a_sup + b_sup + (maxA + maxB)*ulp;
+}
+
+static void fppoly_kernel_scale_scalar(double *res_inf, double *res_sup, double *inf, double *sup, double mul_inf, double mul_sup, double ulp, size_t size){
+	size_t i;
+	for(i=0; i < size; i++){
+		fppoly_scale_scalar(&res_inf[i], &res_sup[i], inf[i], sup[i], mul_inf, mul_sup, ulp);
+	}
+}
+
+static void fppoly_kernel_add_scalar(double *a_inf, double *a_sup, double *b_inf, double *b_sup, double ulp, size_t size){
+	size_t i;
+	for(i=0; i < size; i++){
+		fppoly_add_scalar(&a_inf[i], &a_sup[i], b_inf[i], b_sup[i], ulp);
+	}
+}
+
+static void fppoly_kernel_scale_pair_scalar(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup,
+					    double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	size_t i;
+	for(i=0; i < size; i++){
+		fppoly_scale_scalar(&l_inf[i], &l_sup[i], inf[i], sup[i], l_mul_inf, l_mul_sup, ulp);
+		fppoly_scale_scalar(&u_inf[i], &u_sup[i], inf[i], sup[i], u_mul_inf, u_mul_sup, ulp);
+	}
+}
+
+static void fppoly_kernel_add_scale_pair_scalar(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup, uint32_t *dim,
+						double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	size_t i;
+	for(i=0; i < size; i++){
+		size_t k = dim==NULL ? i : dim[i];
+		double t_inf, t_sup;
+		fppoly_scale_scalar(&t_inf, &t_sup, inf[i], sup[i], l_mul_inf, l_mul_sup, ulp);
+		fppoly_add_scalar(&l_inf[k], &l_sup[k], t_inf, t_sup, ulp);
+		fppoly_scale_scalar(&t_inf, &t_sup, inf[i], sup[i], u_mul_inf, u_mul_sup, ulp);
+		fppoly_add_scalar(&u_inf[k], &u_sup[k], t_inf, t_sup, ulp);
+	}
+}
+
+static double fppoly_kernel_concretize_inf_scalar(double cst_inf, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	double res = cst_inf;
+	size_t i;
+	for(i=0; i < size; i++){
+		size_t k = dim==NULL ? i : dim[i];
+		double tmp1, tmp2;
+		elina_double_interval_mul(&tmp1, &tmp2, inf[i], sup[i], x_inf[k], x_sup[k]);
+		res = res + tmp1;
+	}
+	return res;
+}
+
+static double fppoly_kernel_concretize_sup_scalar(double cst_sup, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	double res = cst_sup;
+	size_t i;
+	for(i=0; i < size; i++){
+		size_t k = dim==NULL ? i : dim[i];
+		double tmp1, tmp2;
+		elina_double_interval_mul(&tmp1, &tmp2, inf[i], sup[i], x_inf[k], x_sup[k]);
+		res = res + tmp2;
+	}
+	return res;
+}
+
+static void fppoly_kernel_mul_point_scalar(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	double max_coeff = fmax(inf, sup);
+	size_t j;
+	for(j=0; j < size; j++){
+		double abs_w = fabs(w[j]);
+		double err = max_coeff*(abs_w*ulp);
+		res_inf[j] = (w[j]>=0 ? inf : sup)*abs_w + err;
+		res_sup[j] = (w[j]>=0 ? sup : inf)*abs_w + err;
+	}
+}
+
+static void fppoly_kernel_add_mul_point_scalar(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	double max_coeff = fmax(inf, sup);
+	size_t j;
+	for(j=0; j < size; j++){
+		double abs_w = fabs(w[j]);
+		double err = max_coeff*(abs_w*ulp);
+		double tmp_inf = (w[j]>=0 ? inf : sup)*abs_w + err;
+		double tmp_sup = (w[j]>=0 ? sup : inf)*abs_w + err;
+		double maxA = fmax(fabs(res_inf[j]), fabs(res_sup[j]));
+		double maxB = fmax(fabs(tmp_inf), fabs(tmp_sup));
+		res_inf[j] = res_inf[j] + tmp_inf + (maxA + maxB)*ulp;
+		res_sup[j] = res_sup[j] + tmp_sup + (maxA + maxB)*ulp;
+	}
+}
+
+/* [inf,sup]*w for a float32 coefficient w standing for [w-e,w+e], e = w_ulp*|w| + w_min, err_ulp is ulp + w_ulp */
+static inline void fppoly_mul_point_f32_scalar(double *r_inf, double *r_sup, double inf, double sup, double max_coeff, double err_ulp, double w_min, float w){
+	double abs_w = fabs((double)w);
+	double err = max_coeff*(abs_w*err_ulp + w_min);
+	*r_inf = (w>=0 ? inf : sup)*abs_w + err;
+	*r_sup = (w>=0 ? sup : inf)*abs_w + err;
+}
+
+static void fppoly_kernel_mul_point_f32_scalar(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	double max_coeff = fmax(inf, sup);
+	double err_ulp = ulp + w_ulp;
+	size_t j;
+	for(j=0; j < size; j++){
+		fppoly_mul_point_f32_scalar(&res_inf[j], &res_sup[j], inf, sup, max_coeff, err_ulp, w_min, w[j]);
+	}
+}
+
+static void fppoly_kernel_add_mul_point_f32_scalar(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	double max_coeff = fmax(inf, sup);
+	double err_ulp = ulp + w_ulp;
+	size_t j;
+	for(j=0; j < size; j++){
+		double tmp_inf, tmp_sup;
+		fppoly_mul_point_f32_scalar(&tmp_inf, &tmp_sup, inf, sup, max_coeff, err_ulp, w_min, w[j]);
+		fppoly_add_scalar(&res_inf[j], &res_sup[j], tmp_inf, tmp_sup, ulp);
+	}
+}
+
+/* the tail of a concretization started by a vector kernel at position i */
+static inline double fppoly_concretize_tail(double (*f)(double, double *, double *, uint32_t *, double *, double *, size_t),
+					    double res, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t i, size_t size){
+	if(dim==NULL){
+		return f(res, inf + i, sup + i, NULL, x_inf + i, x_sup + i, size - i);
+	}
+	return f(res, inf + i, sup + i, dim + i, x_inf, x_sup, size - i);
+}
+
+
+#if defined(FPPOLY_KERNELS_X86)
+
+/* The vector kernels give exactly the results of the scalar ones. The product of two
+   intervals is the largest of the four products of their bounds, which is what the case
+   analysis of elina_double_interval_mul selects; as every product is rounded upwards the
+   maximum of the rounded products is the same value. A product with a zero factor is +0
+   as in elina_double_interval_mul, and sums are accumulated in the scalar order. */
+
+/* ====================================================================== */
+/* AVX2 */
+/* ====================================================================== */
+
+static inline FPPOLY_AVX2 __m256d fppoly_abs_avx2(__m256d x){
+	return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+static inline FPPOLY_AVX2 void fppoly_interval_mul_avx2(__m256d *a_inf, __m256d *a_sup, __m256d b_inf, __m256d b_sup, __m256d c_inf, __m256d c_sup){
+	__m256d zero = _mm256_setzero_pd();
+	__m256d sign = _mm256_set1_pd(-0.0);
+	__m256d zb_inf = _mm256_cmp_pd(b_inf, zero, _CMP_EQ_OQ);
+	__m256d zb_sup = _mm256_cmp_pd(b_sup, zero, _CMP_EQ_OQ);
+	__m256d zc_inf = _mm256_cmp_pd(c_inf, zero, _CMP_EQ_OQ);
+	__m256d zc_sup = _mm256_cmp_pd(c_sup, zero, _CMP_EQ_OQ);
+	__m256d z_ii = _mm256_or_pd(zb_inf, zc_inf);
+	__m256d z_is = _mm256_or_pd(zb_inf, zc_sup);
+	__m256d z_si = _mm256_or_pd(zb_sup, zc_inf);
+	__m256d z_ss = _mm256_or_pd(zb_sup, zc_sup);
+	__m256d neg_c_inf = _mm256_xor_pd(c_inf, sign);
+	__m256d neg_c_sup = _mm256_xor_pd(c_sup, sign);
+	if(a_inf){
+		__m256d t1 = _mm256_andnot_pd(z_ii, _mm256_mul_pd(b_inf, neg_c_inf));
+		__m256d t2 = _mm256_andnot_pd(z_is, _mm256_mul_pd(b_inf, c_sup));
+		__m256d t3 = _mm256_andnot_pd(z_si, _mm256_mul_pd(b_sup, c_inf));
+		__m256d t4 = _mm256_andnot_pd(z_ss, _mm256_mul_pd(b_sup, neg_c_sup));
+		*a_inf = _mm256_max_pd(_mm256_max_pd(t1, t2), _mm256_max_pd(t3, t4));
+	}
+	if(a_sup){
+		__m256d t1 = _mm256_andnot_pd(z_ii, _mm256_mul_pd(b_inf, c_inf));
+		__m256d t2 = _mm256_andnot_pd(z_is, _mm256_mul_pd(b_inf, neg_c_sup));
+		__m256d t3 = _mm256_andnot_pd(z_si, _mm256_mul_pd(b_sup, neg_c_inf));
+		__m256d t4 = _mm256_andnot_pd(z_ss, _mm256_mul_pd(b_sup, c_sup));
+		*a_sup = _mm256_max_pd(_mm256_max_pd(t1, t2), _mm256_max_pd(t3, t4));
+	}
+}
+
+/* the entries of x at the positions dim[i..i+4), or x[i..i+4) if dim is NULL */
+static inline FPPOLY_AVX2 __m256d fppoly_gather_avx2(double *x, uint32_t *dim, size_t i){
+	if(dim==NULL){
+		return _mm256_loadu_pd(x + i);
+	}
+	return _mm256_i32gather_pd(x, _mm_loadu_si128((__m128i *)(dim + i)), 8);
+}
+
+static inline FPPOLY_AVX2 void fppoly_scale_avx2(__m256d *r_inf, __m256d *r_sup, __m256d inf, __m256d sup, __m256d mul_inf, __m256d mul_sup, __m256d ulp){
+	__m256d e_inf, e_sup;
+	__m256d err = _mm256_mul_pd(_mm256_max_pd(fppoly_abs_avx2(inf), fppoly_abs_avx2(sup)), ulp);
+	fppoly_interval_mul_avx2(r_inf, r_sup, mul_inf, mul_sup, inf, sup);
+	fppoly_interval_mul_avx2(&e_inf, &e_sup, mul_inf, mul_sup, err, err);
+	*r_inf = _mm256_add_pd(*r_inf, e_inf);
+	*r_sup = _mm256_add_pd(*r_sup, e_sup);
+}
+
+static inline FPPOLY_AVX2 void fppoly_add_avx2(__m256d *a_inf, __m256d *a_sup, __m256d b_inf, __m256d b_sup, __m256d ulp){
+	__m256d maxA = _mm256_max_pd(fppoly_abs_avx2(*a_inf), fppoly_abs_avx2(*a_sup));
+	__m256d maxB = _mm256_max_pd(fppoly_abs_avx2(b_inf), fppoly_abs_avx2(b_sup));
+	__m256d err = _mm256_mul_pd(_mm256_add_pd(maxA, maxB), ulp);
+	*a_inf = _mm256_add_pd(_mm256_add_pd(*a_inf, b_inf), err);
+	*a_sup = _mm256_add_pd(_mm256_add_pd(*a_sup, b_sup), err);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_scale_avx2(double *res_inf, double *res_sup, double *inf, double *sup, double mul_inf, double mul_sup, double ulp, size_t size){
+	__m256d b_inf = _mm256_set1_pd(mul_inf);
+	__m256d b_sup = _mm256_set1_pd(mul_sup);
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d r_inf, r_sup;
+		fppoly_scale_avx2(&r_inf, &r_sup, _mm256_loadu_pd(inf + i), _mm256_loadu_pd(sup + i), b_inf, b_sup, v_ulp);
+		_mm256_storeu_pd(res_inf + i, r_inf);
+		_mm256_storeu_pd(res_sup + i, r_sup);
+	}
+	fppoly_kernel_scale_scalar(res_inf + i, res_sup + i, inf + i, sup + i, mul_inf, mul_sup, ulp, size - i);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_add_avx2(double *a_inf, double *a_sup, double *b_inf, double *b_sup, double ulp, size_t size){
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d x_inf = _mm256_loadu_pd(a_inf + i);
+		__m256d x_sup = _mm256_loadu_pd(a_sup + i);
+		fppoly_add_avx2(&x_inf, &x_sup, _mm256_loadu_pd(b_inf + i), _mm256_loadu_pd(b_sup + i), v_ulp);
+		_mm256_storeu_pd(a_inf + i, x_inf);
+		_mm256_storeu_pd(a_sup + i, x_sup);
+	}
+	fppoly_kernel_add_scalar(a_inf + i, a_sup + i, b_inf + i, b_sup + i, ulp, size - i);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_scale_pair_avx2(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup,
+						      double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	__m256d lb_inf = _mm256_set1_pd(l_mul_inf);
+	__m256d lb_sup = _mm256_set1_pd(l_mul_sup);
+	__m256d ub_inf = _mm256_set1_pd(u_mul_inf);
+	__m256d ub_sup = _mm256_set1_pd(u_mul_sup);
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d c_inf = _mm256_loadu_pd(inf + i);
+		__m256d c_sup = _mm256_loadu_pd(sup + i);
+		__m256d r_inf, r_sup;
+		fppoly_scale_avx2(&r_inf, &r_sup, c_inf, c_sup, lb_inf, lb_sup, v_ulp);
+		_mm256_storeu_pd(l_inf + i, r_inf);
+		_mm256_storeu_pd(l_sup + i, r_sup);
+		fppoly_scale_avx2(&r_inf, &r_sup, c_inf, c_sup, ub_inf, ub_sup, v_ulp);
+		_mm256_storeu_pd(u_inf + i, r_inf);
+		_mm256_storeu_pd(u_sup + i, r_sup);
+	}
+	fppoly_kernel_scale_pair_scalar(l_inf + i, l_sup + i, u_inf + i, u_sup + i, inf + i, sup + i, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+}
+
+/* a[dim[i..i+4)] = a[dim[i..i+4)] + b, or a[i..i+4) if dim is NULL; the positions are distinct */
+static inline FPPOLY_AVX2 void fppoly_add_at_avx2(double *a_inf, double *a_sup, uint32_t *dim, size_t i, __m256d b_inf, __m256d b_sup, __m256d ulp){
+	__m256d x_inf = fppoly_gather_avx2(a_inf, dim, i);
+	__m256d x_sup = fppoly_gather_avx2(a_sup, dim, i);
+	fppoly_add_avx2(&x_inf, &x_sup, b_inf, b_sup, ulp);
+	if(dim==NULL){
+		_mm256_storeu_pd(a_inf + i, x_inf);
+		_mm256_storeu_pd(a_sup + i, x_sup);
+	}
+	else{
+		double tmp_inf[4], tmp_sup[4];
+		size_t j;
+		_mm256_storeu_pd(tmp_inf, x_inf);
+		_mm256_storeu_pd(tmp_sup, x_sup);
+		for(j=0; j < 4; j++){
+			a_inf[dim[i+j]] = tmp_inf[j];
+			a_sup[dim[i+j]] = tmp_sup[j];
+		}
+	}
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_add_scale_pair_avx2(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup, uint32_t *dim,
+							  double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	__m256d lb_inf = _mm256_set1_pd(l_mul_inf);
+	__m256d lb_sup = _mm256_set1_pd(l_mul_sup);
+	__m256d ub_inf = _mm256_set1_pd(u_mul_inf);
+	__m256d ub_sup = _mm256_set1_pd(u_mul_sup);
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d c_inf = _mm256_loadu_pd(inf + i);
+		__m256d c_sup = _mm256_loadu_pd(sup + i);
+		__m256d t_inf, t_sup;
+		fppoly_scale_avx2(&t_inf, &t_sup, c_inf, c_sup, lb_inf, lb_sup, v_ulp);
+		fppoly_add_at_avx2(l_inf, l_sup, dim, i, t_inf, t_sup, v_ulp);
+		fppoly_scale_avx2(&t_inf, &t_sup, c_inf, c_sup, ub_inf, ub_sup, v_ulp);
+		fppoly_add_at_avx2(u_inf, u_sup, dim, i, t_inf, t_sup, v_ulp);
+	}
+	if(dim==NULL){
+		fppoly_kernel_add_scale_pair_scalar(l_inf + i, l_sup + i, u_inf + i, u_sup + i, inf + i, sup + i, NULL, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+	}
+	else{
+		fppoly_kernel_add_scale_pair_scalar(l_inf, l_sup, u_inf, u_sup, inf + i, sup + i, dim + i, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+	}
+}
+
+static FPPOLY_AVX2 double fppoly_kernel_concretize_inf_avx2(double cst_inf, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	double res = cst_inf;
+	double tmp[4];
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d r_inf;
+		fppoly_interval_mul_avx2(&r_inf, NULL, _mm256_loadu_pd(inf + i), _mm256_loadu_pd(sup + i), fppoly_gather_avx2(x_inf, dim, i), fppoly_gather_avx2(x_sup, dim, i));
+		_mm256_storeu_pd(tmp, r_inf);
+		res = res + tmp[0];
+		res = res + tmp[1];
+		res = res + tmp[2];
+		res = res + tmp[3];
+	}
+	return fppoly_concretize_tail(fppoly_kernel_concretize_inf_scalar, res, inf, sup, dim, x_inf, x_sup, i, size);
+}
+
+static FPPOLY_AVX2 double fppoly_kernel_concretize_sup_avx2(double cst_sup, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	double res = cst_sup;
+	double tmp[4];
+	size_t i;
+	for(i=0; i + 4 <= size; i+=4){
+		__m256d r_sup;
+		fppoly_interval_mul_avx2(NULL, &r_sup, _mm256_loadu_pd(inf + i), _mm256_loadu_pd(sup + i), fppoly_gather_avx2(x_inf, dim, i), fppoly_gather_avx2(x_sup, dim, i));
+		_mm256_storeu_pd(tmp, r_sup);
+		res = res + tmp[0];
+		res = res + tmp[1];
+		res = res + tmp[2];
+		res = res + tmp[3];
+	}
+	return fppoly_concretize_tail(fppoly_kernel_concretize_sup_scalar, res, inf, sup, dim, x_inf, x_sup, i, size);
+}
+
+/* [inf,sup]*w[j..j+4) for a point row w */
+static inline FPPOLY_AVX2 void fppoly_mul_point_avx2(__m256d *r_inf, __m256d *r_sup, __m256d inf, __m256d sup, __m256d max_coeff, __m256d ulp, __m256d w){
+	__m256d abs_w = fppoly_abs_avx2(w);
+	__m256d err = _mm256_mul_pd(max_coeff, _mm256_mul_pd(abs_w, ulp));
+	__m256d pos = _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_GE_OQ);
+	*r_inf = _mm256_add_pd(_mm256_mul_pd(_mm256_blendv_pd(sup, inf, pos), abs_w), err);
+	*r_sup = _mm256_add_pd(_mm256_mul_pd(_mm256_blendv_pd(inf, sup, pos), abs_w), err);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_mul_point_avx2(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	__m256d v_inf = _mm256_set1_pd(inf);
+	__m256d v_sup = _mm256_set1_pd(sup);
+	__m256d max_coeff = _mm256_set1_pd(fmax(inf, sup));
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 4 <= size; j+=4){
+		__m256d r_inf, r_sup;
+		fppoly_mul_point_avx2(&r_inf, &r_sup, v_inf, v_sup, max_coeff, v_ulp, _mm256_loadu_pd(w + j));
+		_mm256_storeu_pd(res_inf + j, r_inf);
+		_mm256_storeu_pd(res_sup + j, r_sup);
+	}
+	fppoly_kernel_mul_point_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, size - j);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_add_mul_point_avx2(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	__m256d v_inf = _mm256_set1_pd(inf);
+	__m256d v_sup = _mm256_set1_pd(sup);
+	__m256d max_coeff = _mm256_set1_pd(fmax(inf, sup));
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 4 <= size; j+=4){
+		__m256d t_inf, t_sup;
+		fppoly_mul_point_avx2(&t_inf, &t_sup, v_inf, v_sup, max_coeff, v_ulp, _mm256_loadu_pd(w + j));
+		__m256d x_inf = _mm256_loadu_pd(res_inf + j);
+		__m256d x_sup = _mm256_loadu_pd(res_sup + j);
+		__m256d maxA = _mm256_max_pd(fppoly_abs_avx2(x_inf), fppoly_abs_avx2(x_sup));
+		__m256d maxB = _mm256_max_pd(fppoly_abs_avx2(t_inf), fppoly_abs_avx2(t_sup));
+		__m256d err = _mm256_mul_pd(_mm256_add_pd(maxA, maxB), v_ulp);
+		_mm256_storeu_pd(res_inf + j, _mm256_add_pd(_mm256_add_pd(x_inf, t_inf), err));
+		_mm256_storeu_pd(res_sup + j, _mm256_add_pd(_mm256_add_pd(x_sup, t_sup), err));
+	}
+	fppoly_kernel_add_mul_point_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, size - j);
+}
+
+
+/* [inf,sup]*w[j..j+4) for a row w of float32 coefficients widened to double, see fppoly_mul_point_f32_scalar */
+static inline FPPOLY_AVX2 void fppoly_mul_point_f32_avx2(__m256d *r_inf, __m256d *r_sup, __m256d inf, __m256d sup, __m256d max_coeff, __m256d err_ulp, __m256d w_min, __m256d w){
+	__m256d abs_w = fppoly_abs_avx2(w);
+	__m256d err = _mm256_mul_pd(max_coeff, _mm256_add_pd(_mm256_mul_pd(abs_w, err_ulp), w_min));
+	__m256d pos = _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_GE_OQ);
+	*r_inf = _mm256_add_pd(_mm256_mul_pd(_mm256_blendv_pd(sup, inf, pos), abs_w), err);
+	*r_sup = _mm256_add_pd(_mm256_mul_pd(_mm256_blendv_pd(inf, sup, pos), abs_w), err);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_mul_point_f32_avx2(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	__m256d v_inf = _mm256_set1_pd(inf);
+	__m256d v_sup = _mm256_set1_pd(sup);
+	__m256d max_coeff = _mm256_set1_pd(fmax(inf, sup));
+	__m256d err_ulp = _mm256_set1_pd(ulp + w_ulp);
+	__m256d v_min = _mm256_set1_pd(w_min);
+	size_t j;
+	for(j=0; j + 4 <= size; j+=4){
+		__m256d r_inf, r_sup;
+		fppoly_mul_point_f32_avx2(&r_inf, &r_sup, v_inf, v_sup, max_coeff, err_ulp, v_min, _mm256_cvtps_pd(_mm_loadu_ps(w + j)));
+		_mm256_storeu_pd(res_inf + j, r_inf);
+		_mm256_storeu_pd(res_sup + j, r_sup);
+	}
+	fppoly_kernel_mul_point_f32_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, w_ulp, w_min, size - j);
+}
+
+static FPPOLY_AVX2 void fppoly_kernel_add_mul_point_f32_avx2(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	__m256d v_inf = _mm256_set1_pd(inf);
+	__m256d v_sup = _mm256_set1_pd(sup);
+	__m256d max_coeff = _mm256_set1_pd(fmax(inf, sup));
+	__m256d err_ulp = _mm256_set1_pd(ulp + w_ulp);
+	__m256d v_min = _mm256_set1_pd(w_min);
+	__m256d v_ulp = _mm256_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 4 <= size; j+=4){
+		__m256d t_inf, t_sup;
+		fppoly_mul_point_f32_avx2(&t_inf, &t_sup, v_inf, v_sup, max_coeff, err_ulp, v_min, _mm256_cvtps_pd(_mm_loadu_ps(w + j)));
+		__m256d x_inf = _mm256_loadu_pd(res_inf + j);
+		__m256d x_sup = _mm256_loadu_pd(res_sup + j);
+		fppoly_add_avx2(&x_inf, &x_sup, t_inf, t_sup, v_ulp);
+		_mm256_storeu_pd(res_inf + j, x_inf);
+		_mm256_storeu_pd(res_sup + j, x_sup);
+	}
+	fppoly_kernel_add_mul_point_f32_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, w_ulp, w_min, size - j);
+}
+
+
+/* ====================================================================== */
+/* AVX-512 */
+/* ====================================================================== */
+
+static inline FPPOLY_AVX512 void fppoly_interval_mul_avx512(__m512d *a_inf, __m512d *a_sup, __m512d b_inf, __m512d b_sup, __m512d c_inf, __m512d c_sup){
+	__m512d zero = _mm512_setzero_pd();
+	__mmask8 zb_inf = _mm512_cmp_pd_mask(b_inf, zero, _CMP_EQ_OQ);
+	__mmask8 zb_sup = _mm512_cmp_pd_mask(b_sup, zero, _CMP_EQ_OQ);
+	__mmask8 zc_inf = _mm512_cmp_pd_mask(c_inf, zero, _CMP_EQ_OQ);
+	__mmask8 zc_sup = _mm512_cmp_pd_mask(c_sup, zero, _CMP_EQ_OQ);
+	/* lanes where the product has no zero factor */
+	__mmask8 nz_ii = (__mmask8)~(zb_inf | zc_inf);
+	__mmask8 nz_is = (__mmask8)~(zb_inf | zc_sup);
+	__mmask8 nz_si = (__mmask8)~(zb_sup | zc_inf);
+	__mmask8 nz_ss = (__mmask8)~(zb_sup | zc_sup);
+	__m512d neg_c_inf = _mm512_sub_pd(zero, c_inf);
+	__m512d neg_c_sup = _mm512_sub_pd(zero, c_sup);
+	if(a_inf){
+		__m512d t1 = _mm512_maskz_mul_pd(nz_ii, b_inf, neg_c_inf);
+		__m512d t2 = _mm512_maskz_mul_pd(nz_is, b_inf, c_sup);
+		__m512d t3 = _mm512_maskz_mul_pd(nz_si, b_sup, c_inf);
+		__m512d t4 = _mm512_maskz_mul_pd(nz_ss, b_sup, neg_c_sup);
+		*a_inf = _mm512_max_pd(_mm512_max_pd(t1, t2), _mm512_max_pd(t3, t4));
+	}
+	if(a_sup){
+		__m512d t1 = _mm512_maskz_mul_pd(nz_ii, b_inf, c_inf);
+		__m512d t2 = _mm512_maskz_mul_pd(nz_is, b_inf, neg_c_sup);
+		__m512d t3 = _mm512_maskz_mul_pd(nz_si, b_sup, neg_c_inf);
+		__m512d t4 = _mm512_maskz_mul_pd(nz_ss, b_sup, c_sup);
+		*a_sup = _mm512_max_pd(_mm512_max_pd(t1, t2), _mm512_max_pd(t3, t4));
+	}
+}
+
+static inline FPPOLY_AVX512 __m512d fppoly_abs_avx512(__m512d x){
+	return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(x), _mm512_set1_epi64(0x7fffffffffffffffLL)));
+}
+
+static inline FPPOLY_AVX512 void fppoly_scale_avx512(__m512d *r_inf, __m512d *r_sup, __m512d inf, __m512d sup, __m512d mul_inf, __m512d mul_sup, __m512d ulp){
+	__m512d e_inf, e_sup;
+	__m512d err = _mm512_mul_pd(_mm512_max_pd(fppoly_abs_avx512(inf), fppoly_abs_avx512(sup)), ulp);
+	fppoly_interval_mul_avx512(r_inf, r_sup, mul_inf, mul_sup, inf, sup);
+	fppoly_interval_mul_avx512(&e_inf, &e_sup, mul_inf, mul_sup, err, err);
+	*r_inf = _mm512_add_pd(*r_inf, e_inf);
+	*r_sup = _mm512_add_pd(*r_sup, e_sup);
+}
+
+static inline FPPOLY_AVX512 void fppoly_add_avx512(__m512d *a_inf, __m512d *a_sup, __m512d b_inf, __m512d b_sup, __m512d ulp){
+	__m512d maxA = _mm512_max_pd(fppoly_abs_avx512(*a_inf), fppoly_abs_avx512(*a_sup));
+	__m512d maxB = _mm512_max_pd(fppoly_abs_avx512(b_inf), fppoly_abs_avx512(b_sup));
+	__m512d err = _mm512_mul_pd(_mm512_add_pd(maxA, maxB), ulp);
+	*a_inf = _mm512_add_pd(_mm512_add_pd(*a_inf, b_inf), err);
+	*a_sup = _mm512_add_pd(_mm512_add_pd(*a_sup, b_sup), err);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_scale_avx512(double *res_inf, double *res_sup, double *inf, double *sup, double mul_inf, double mul_sup, double ulp, size_t size){
+	__m512d b_inf = _mm512_set1_pd(mul_inf);
+	__m512d b_sup = _mm512_set1_pd(mul_sup);
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 8 <= size; i+=8){
+		__m512d r_inf, r_sup;
+		fppoly_scale_avx512(&r_inf, &r_sup, _mm512_loadu_pd(inf + i), _mm512_loadu_pd(sup + i), b_inf, b_sup, v_ulp);
+		_mm512_storeu_pd(res_inf + i, r_inf);
+		_mm512_storeu_pd(res_sup + i, r_sup);
+	}
+	fppoly_kernel_scale_scalar(res_inf + i, res_sup + i, inf + i, sup + i, mul_inf, mul_sup, ulp, size - i);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_add_avx512(double *a_inf, double *a_sup, double *b_inf, double *b_sup, double ulp, size_t size){
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 8 <= size; i+=8){
+		__m512d x_inf = _mm512_loadu_pd(a_inf + i);
+		__m512d x_sup = _mm512_loadu_pd(a_sup + i);
+		fppoly_add_avx512(&x_inf, &x_sup, _mm512_loadu_pd(b_inf + i), _mm512_loadu_pd(b_sup + i), v_ulp);
+		_mm512_storeu_pd(a_inf + i, x_inf);
+		_mm512_storeu_pd(a_sup + i, x_sup);
+	}
+	fppoly_kernel_add_scalar(a_inf + i, a_sup + i, b_inf + i, b_sup + i, ulp, size - i);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_scale_pair_avx512(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup,
+							  double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	__m512d lb_inf = _mm512_set1_pd(l_mul_inf);
+	__m512d lb_sup = _mm512_set1_pd(l_mul_sup);
+	__m512d ub_inf = _mm512_set1_pd(u_mul_inf);
+	__m512d ub_sup = _mm512_set1_pd(u_mul_sup);
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 8 <= size; i+=8){
+		__m512d c_inf = _mm512_loadu_pd(inf + i);
+		__m512d c_sup = _mm512_loadu_pd(sup + i);
+		__m512d r_inf, r_sup;
+		fppoly_scale_avx512(&r_inf, &r_sup, c_inf, c_sup, lb_inf, lb_sup, v_ulp);
+		_mm512_storeu_pd(l_inf + i, r_inf);
+		_mm512_storeu_pd(l_sup + i, r_sup);
+		fppoly_scale_avx512(&r_inf, &r_sup, c_inf, c_sup, ub_inf, ub_sup, v_ulp);
+		_mm512_storeu_pd(u_inf + i, r_inf);
+		_mm512_storeu_pd(u_sup + i, r_sup);
+	}
+	fppoly_kernel_scale_pair_scalar(l_inf + i, l_sup + i, u_inf + i, u_sup + i, inf + i, sup + i, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+}
+
+/* a[dim[i..i+8)] = a[dim[i..i+8)] + b, or a[i..i+8) if dim is NULL; the positions are distinct */
+static inline FPPOLY_AVX512 void fppoly_add_at_avx512(double *a_inf, double *a_sup, uint32_t *dim, size_t i, __m512d b_inf, __m512d b_sup, __m512d ulp){
+	if(dim==NULL){
+		__m512d x_inf = _mm512_loadu_pd(a_inf + i);
+		__m512d x_sup = _mm512_loadu_pd(a_sup + i);
+		fppoly_add_avx512(&x_inf, &x_sup, b_inf, b_sup, ulp);
+		_mm512_storeu_pd(a_inf + i, x_inf);
+		_mm512_storeu_pd(a_sup + i, x_sup);
+	}
+	else{
+		__m256i index = _mm256_loadu_si256((__m256i *)(dim + i));
+		__m512d x_inf = _mm512_i32gather_pd(index, a_inf, 8);
+		__m512d x_sup = _mm512_i32gather_pd(index, a_sup, 8);
+		fppoly_add_avx512(&x_inf, &x_sup, b_inf, b_sup, ulp);
+		_mm512_i32scatter_pd(a_inf, index, x_inf, 8);
+		_mm512_i32scatter_pd(a_sup, index, x_sup, 8);
+	}
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_add_scale_pair_avx512(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup, uint32_t *dim,
+							      double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	__m512d lb_inf = _mm512_set1_pd(l_mul_inf);
+	__m512d lb_sup = _mm512_set1_pd(l_mul_sup);
+	__m512d ub_inf = _mm512_set1_pd(u_mul_inf);
+	__m512d ub_sup = _mm512_set1_pd(u_mul_sup);
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t i;
+	for(i=0; i + 8 <= size; i+=8){
+		__m512d c_inf = _mm512_loadu_pd(inf + i);
+		__m512d c_sup = _mm512_loadu_pd(sup + i);
+		__m512d t_inf, t_sup;
+		fppoly_scale_avx512(&t_inf, &t_sup, c_inf, c_sup, lb_inf, lb_sup, v_ulp);
+		fppoly_add_at_avx512(l_inf, l_sup, dim, i, t_inf, t_sup, v_ulp);
+		fppoly_scale_avx512(&t_inf, &t_sup, c_inf, c_sup, ub_inf, ub_sup, v_ulp);
+		fppoly_add_at_avx512(u_inf, u_sup, dim, i, t_inf, t_sup, v_ulp);
+	}
+	if(dim==NULL){
+		fppoly_kernel_add_scale_pair_scalar(l_inf + i, l_sup + i, u_inf + i, u_sup + i, inf + i, sup + i, NULL, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+	}
+	else{
+		fppoly_kernel_add_scale_pair_scalar(l_inf, l_sup, u_inf, u_sup, inf + i, sup + i, dim + i, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size - i);
+	}
+}
+
+static inline FPPOLY_AVX512 void fppoly_mul_point_avx512(__m512d *r_inf, __m512d *r_sup, __m512d inf, __m512d sup, __m512d max_coeff, __m512d ulp, __m512d w){
+	__m512d abs_w = fppoly_abs_avx512(w);
+	__m512d err = _mm512_mul_pd(max_coeff, _mm512_mul_pd(abs_w, ulp));
+	__mmask8 pos = _mm512_cmp_pd_mask(w, _mm512_setzero_pd(), _CMP_GE_OQ);
+	*r_inf = _mm512_add_pd(_mm512_mul_pd(_mm512_mask_blend_pd(pos, sup, inf), abs_w), err);
+	*r_sup = _mm512_add_pd(_mm512_mul_pd(_mm512_mask_blend_pd(pos, inf, sup), abs_w), err);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_mul_point_avx512(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	__m512d v_inf = _mm512_set1_pd(inf);
+	__m512d v_sup = _mm512_set1_pd(sup);
+	__m512d max_coeff = _mm512_set1_pd(fmax(inf, sup));
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 8 <= size; j+=8){
+		__m512d r_inf, r_sup;
+		fppoly_mul_point_avx512(&r_inf, &r_sup, v_inf, v_sup, max_coeff, v_ulp, _mm512_loadu_pd(w + j));
+		_mm512_storeu_pd(res_inf + j, r_inf);
+		_mm512_storeu_pd(res_sup + j, r_sup);
+	}
+	fppoly_kernel_mul_point_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, size - j);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_add_mul_point_avx512(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	__m512d v_inf = _mm512_set1_pd(inf);
+	__m512d v_sup = _mm512_set1_pd(sup);
+	__m512d max_coeff = _mm512_set1_pd(fmax(inf, sup));
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 8 <= size; j+=8){
+		__m512d t_inf, t_sup;
+		fppoly_mul_point_avx512(&t_inf, &t_sup, v_inf, v_sup, max_coeff, v_ulp, _mm512_loadu_pd(w + j));
+		__m512d x_inf = _mm512_loadu_pd(res_inf + j);
+		__m512d x_sup = _mm512_loadu_pd(res_sup + j);
+		__m512d maxA = _mm512_max_pd(fppoly_abs_avx512(x_inf), fppoly_abs_avx512(x_sup));
+		__m512d maxB = _mm512_max_pd(fppoly_abs_avx512(t_inf), fppoly_abs_avx512(t_sup));
+		__m512d err = _mm512_mul_pd(_mm512_add_pd(maxA, maxB), v_ulp);
+		_mm512_storeu_pd(res_inf + j, _mm512_add_pd(_mm512_add_pd(x_inf, t_inf), err));
+		_mm512_storeu_pd(res_sup + j, _mm512_add_pd(_mm512_add_pd(x_sup, t_sup), err));
+	}
+	fppoly_kernel_add_mul_point_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, size - j);
+}
+
+
+static inline FPPOLY_AVX512 void fppoly_mul_point_f32_avx512(__m512d *r_inf, __m512d *r_sup, __m512d inf, __m512d sup, __m512d max_coeff, __m512d err_ulp, __m512d w_min, __m512d w){
+	__m512d abs_w = fppoly_abs_avx512(w);
+	__m512d err = _mm512_mul_pd(max_coeff, _mm512_add_pd(_mm512_mul_pd(abs_w, err_ulp), w_min));
+	__mmask8 pos = _mm512_cmp_pd_mask(w, _mm512_setzero_pd(), _CMP_GE_OQ);
+	*r_inf = _mm512_add_pd(_mm512_mul_pd(_mm512_mask_blend_pd(pos, sup, inf), abs_w), err);
+	*r_sup = _mm512_add_pd(_mm512_mul_pd(_mm512_mask_blend_pd(pos, inf, sup), abs_w), err);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_mul_point_f32_avx512(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	__m512d v_inf = _mm512_set1_pd(inf);
+	__m512d v_sup = _mm512_set1_pd(sup);
+	__m512d max_coeff = _mm512_set1_pd(fmax(inf, sup));
+	__m512d err_ulp = _mm512_set1_pd(ulp + w_ulp);
+	__m512d v_min = _mm512_set1_pd(w_min);
+	size_t j;
+	for(j=0; j + 8 <= size; j+=8){
+		__m512d r_inf, r_sup;
+		fppoly_mul_point_f32_avx512(&r_inf, &r_sup, v_inf, v_sup, max_coeff, err_ulp, v_min, _mm512_cvtps_pd(_mm256_loadu_ps(w + j)));
+		_mm512_storeu_pd(res_inf + j, r_inf);
+		_mm512_storeu_pd(res_sup + j, r_sup);
+	}
+	fppoly_kernel_mul_point_f32_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, w_ulp, w_min, size - j);
+}
+
+static FPPOLY_AVX512 void fppoly_kernel_add_mul_point_f32_avx512(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	__m512d v_inf = _mm512_set1_pd(inf);
+	__m512d v_sup = _mm512_set1_pd(sup);
+	__m512d max_coeff = _mm512_set1_pd(fmax(inf, sup));
+	__m512d err_ulp = _mm512_set1_pd(ulp + w_ulp);
+	__m512d v_min = _mm512_set1_pd(w_min);
+	__m512d v_ulp = _mm512_set1_pd(ulp);
+	size_t j;
+	for(j=0; j + 8 <= size; j+=8){
+		__m512d t_inf, t_sup;
+		fppoly_mul_point_f32_avx512(&t_inf, &t_sup, v_inf, v_sup, max_coeff, err_ulp, v_min, _mm512_cvtps_pd(_mm256_loadu_ps(w + j)));
+		__m512d x_inf = _mm512_loadu_pd(res_inf + j);
+		__m512d x_sup = _mm512_loadu_pd(res_sup + j);
+		fppoly_add_avx512(&x_inf, &x_sup, t_inf, t_sup, v_ulp);
+		_mm512_storeu_pd(res_inf + j, x_inf);
+		_mm512_storeu_pd(res_sup + j, x_sup);
+	}
+	fppoly_kernel_add_mul_point_f32_scalar(res_inf + j, res_sup + j, inf, sup, w + j, ulp, w_ulp, w_min, size - j);
+}
+
+#endif
+
+
+/* ====================================================================== */
+/* Dispatch */
+/* ====================================================================== */
+
+typedef struct fppoly_kernel_table_t{
+	void (*scale)(double *, double *, double *, double *, double, double, double, size_t);
+	void (*add)(double *, double *, double *, double *, double, size_t);
+	double (*concretize_inf)(double, double *, double *, uint32_t *, double *, double *, size_t);
+	double (*concretize_sup)(double, double *, double *, uint32_t *, double *, double *, size_t);
+	void (*mul_point)(double *, double *, double, double, double *, double, size_t);
+	void (*add_mul_point)(double *, double *, double, double, double *, double, size_t);
+	void (*mul_point_f32)(double *, double *, double, double, float *, double, double, double, size_t);
+	void (*add_mul_point_f32)(double *, double *, double, double, float *, double, double, double, size_t);
+	void (*scale_pair)(double *, double *, double *, double *, double *, double *, double, double, double, double, double, size_t);
+	void (*add_scale_pair)(double *, double *, double *, double *, double *, double *, uint32_t *, double, double, double, double, double, size_t);
+}fppoly_kernel_table_t;
+
+static fppoly_kernel_table_t fppoly_kernel_tables[] = {
+	{fppoly_kernel_scale_scalar, fppoly_kernel_add_scalar, fppoly_kernel_concretize_inf_scalar, fppoly_kernel_concretize_sup_scalar,
+	 fppoly_kernel_mul_point_scalar, fppoly_kernel_add_mul_point_scalar, fppoly_kernel_mul_point_f32_scalar, fppoly_kernel_add_mul_point_f32_scalar,
+	 fppoly_kernel_scale_pair_scalar, fppoly_kernel_add_scale_pair_scalar},
+#if defined(FPPOLY_KERNELS_X86)
+	{fppoly_kernel_scale_avx2, fppoly_kernel_add_avx2, fppoly_kernel_concretize_inf_avx2, fppoly_kernel_concretize_sup_avx2,
+	 fppoly_kernel_mul_point_avx2, fppoly_kernel_add_mul_point_avx2, fppoly_kernel_mul_point_f32_avx2, fppoly_kernel_add_mul_point_f32_avx2,
+	 fppoly_kernel_scale_pair_avx2, fppoly_kernel_add_scale_pair_avx2},
+	/* the concretization is bound by its sequential sum, wider vectors do not pay for the longer gathers */
+	{fppoly_kernel_scale_avx512, fppoly_kernel_add_avx512, fppoly_kernel_concretize_inf_avx2, fppoly_kernel_concretize_sup_avx2,
+	 fppoly_kernel_mul_point_avx512, fppoly_kernel_add_mul_point_avx512, fppoly_kernel_mul_point_f32_avx512, fppoly_kernel_add_mul_point_f32_avx512,
+	 fppoly_kernel_scale_pair_avx512, fppoly_kernel_add_scale_pair_avx512},
+#endif
+};
+
+static fppoly_kernel_isa_t fppoly_kernel_isa;
+static fppoly_kernel_table_t *fppoly_kernels;
+static pthread_once_t fppoly_kernels_once = PTHREAD_ONCE_INIT;
+
+static bool fppoly_kernel_isa_supported(fppoly_kernel_isa_t isa){
+	switch(isa){
+		case FPPOLY_KERNEL_SCALAR:
+			return true;
+#if defined(FPPOLY_KERNELS_X86)
+		case FPPOLY_KERNEL_AVX2:
+			return __builtin_cpu_supports("avx2")!=0;
+		case FPPOLY_KERNEL_AVX512:
+			return __builtin_cpu_supports("avx512f")!=0;
+#endif
+		default:
+			return false;
+	}
+}
+
+static void fppoly_kernels_init(void){
+	fppoly_kernel_isa = FPPOLY_KERNEL_SCALAR;
+#if defined(FPPOLY_KERNELS_X86)
+	__builtin_cpu_init();
+	if(fppoly_kernel_isa_supported(FPPOLY_KERNEL_AVX512)){
+		fppoly_kernel_isa = FPPOLY_KERNEL_AVX512;
+	}
+	else if(fppoly_kernel_isa_supported(FPPOLY_KERNEL_AVX2)){
+		fppoly_kernel_isa = FPPOLY_KERNEL_AVX2;
+	}
+#endif
+	fppoly_kernels = &fppoly_kernel_tables[fppoly_kernel_isa];
+}
+
+static inline fppoly_kernel_table_t * fppoly_kernel_table(void){
+	pthread_once(&fppoly_kernels_once, fppoly_kernels_init);
+	return fppoly_kernels;
+}
+
+
+fppoly_kernel_isa_t fppoly_kernel_get_isa(void){
+	fppoly_kernel_table();
+	return fppoly_kernel_isa;
+}
+
+bool fppoly_kernel_set_isa(fppoly_kernel_isa_t isa){
+	fppoly_kernel_table();
+	if(!fppoly_kernel_isa_supported(isa)){
+		return false;
+	}
+	fppoly_kernel_isa = isa;
+	fppoly_kernels = &fppoly_kernel_tables[isa];
+	return true;
+}
+
+
+void fppoly_kernel_scale(double *res_inf, double *res_sup, double *inf, double *sup, double mul_inf, double mul_sup, double ulp, size_t size){
+	fppoly_kernel_table()->scale(res_inf, res_sup, inf, sup, mul_inf, mul_sup, ulp, size);
+}
+
+void fppoly_kernel_add(double *a_inf, double *a_sup, double *b_inf, double *b_sup, double ulp, size_t size){
+	fppoly_kernel_table()->add(a_inf, a_sup, b_inf, b_sup, ulp, size);
+}
+
+double fppoly_kernel_concretize_inf(double cst_inf, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	return fppoly_kernel_table()->concretize_inf(cst_inf, inf, sup, dim, x_inf, x_sup, size);
+}
+
+double fppoly_kernel_concretize_sup(double cst_sup, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size){
+	return fppoly_kernel_table()->concretize_sup(cst_sup, inf, sup, dim, x_inf, x_sup, size);
+}
+
+void fppoly_kernel_mul_point(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	fppoly_kernel_table()->mul_point(res_inf, res_sup, inf, sup, w, ulp, size);
+}
+
+void fppoly_kernel_add_mul_point(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size){
+	fppoly_kernel_table()->add_mul_point(res_inf, res_sup, inf, sup, w, ulp, size);
+}
+
+void fppoly_kernel_mul_point_f32(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	fppoly_kernel_table()->mul_point_f32(res_inf, res_sup, inf, sup, w, ulp, w_ulp, w_min, size);
+}
+
+void fppoly_kernel_add_mul_point_f32(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size){
+	fppoly_kernel_table()->add_mul_point_f32(res_inf, res_sup, inf, sup, w, ulp, w_ulp, w_min, size);
+}
+
+void fppoly_kernel_scale_pair(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup,
+			      double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	fppoly_kernel_table()->scale_pair(l_inf, l_sup, u_inf, u_sup, inf, sup, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size);
+}
+
+void fppoly_kernel_add_scale_pair(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup, uint32_t *dim,
+				  double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size){
+	fppoly_kernel_table()->add_scale_pair(l_inf, l_sup, u_inf, u_sup, inf, sup, dim, l_mul_inf, l_mul_sup, u_mul_inf, u_mul_sup, ulp, size);
+}
@@ -0,0 +1,98 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* ************************************************************************* */
+/* fppoly_kernels: interval kernels on the coefficient arrays of expressions */
+/* ************************************************************************* */
+
+#ifndef __FPPOLY_KERNELS_H_INCLUDED__
+#define __FPPOLY_KERNELS_H_INCLUDED__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "elina_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Intervals are stored as (inf,sup) with inf the negated lower bound, all
+   kernels assume rounding towards +oo and give the same result as the
+   scalar functions of fppoly.c they replace. The kernels have scalar, AVX2
+   and AVX-512 versions, the ones used are chosen at the first call from the
+   instruction sets supported by the processor. All versions give
+   bit-identical results. */
+
+typedef enum fppoly_kernel_isa_t{
+	FPPOLY_KERNEL_SCALAR,
+	FPPOLY_KERNEL_AVX2,
+	FPPOLY_KERNEL_AVX512,
+}fppoly_kernel_isa_t;
+
+fppoly_kernel_isa_t fppoly_kernel_get_isa(void);
+  /* Instruction set of the kernels in use */
+
+bool fppoly_kernel_set_isa(fppoly_kernel_isa_t isa);
+  /* Use the kernels for isa, returns false if the processor does not support it.
+     Not to be called while an analysis is running. */
+
+void fppoly_kernel_scale(double *res_inf, double *res_sup, double *inf, double *sup, double mul_inf, double mul_sup, double ulp, size_t size);
+  /* res[i] = [mul_inf,mul_sup]*[inf[i],sup[i]] as elina_double_interval_mul_expr_coeff */
+
+void fppoly_kernel_add(double *a_inf, double *a_sup, double *b_inf, double *b_sup, double ulp, size_t size);
+  /* a[i] = a[i] + b[i] with the rounding error of add_expr */
+
+double fppoly_kernel_concretize_inf(double cst_inf, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size);
+  /* inf of cst + sum_i [inf[i],sup[i]]*x_k with k = dim[i], or k = i if dim is NULL,
+     summed in the order of i */
+
+double fppoly_kernel_concretize_sup(double cst_sup, double *inf, double *sup, uint32_t *dim, double *x_inf, double *x_sup, size_t size);
+  /* sup of the same sum */
+
+void fppoly_kernel_mul_point(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size);
+  /* res[j] = [inf,sup]*w[j] for a row w of point coefficients */
+
+void fppoly_kernel_add_mul_point(double *res_inf, double *res_sup, double inf, double sup, double *w, double ulp, size_t size);
+  /* res[j] = res[j] + [inf,sup]*w[j] */
+
+void fppoly_kernel_mul_point_f32(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size);
+  /* fppoly_kernel_mul_point for a row w of float32 coefficients read in place, w[j] standing for
+     the interval [w[j]-e,w[j]+e] with e = w_ulp*|w[j]| + w_min: the rounding error of coefficients
+     converted to float32 is folded in the result, there is none for w_ulp = w_min = 0 */
+
+void fppoly_kernel_add_mul_point_f32(double *res_inf, double *res_sup, double inf, double sup, float *w, double ulp, double w_ulp, double w_min, size_t size);
+  /* res[j] = res[j] + [inf,sup]*w[j] for the same row */
+
+void fppoly_kernel_scale_pair(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup,
+			      double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size);
+  /* fppoly_kernel_scale of [inf,sup] by the multipliers of a lower and an upper
+     expression, in one pass over [inf,sup] */
+
+void fppoly_kernel_add_scale_pair(double *l_inf, double *l_sup, double *u_inf, double *u_sup, double *inf, double *sup, uint32_t *dim,
+				  double l_mul_inf, double l_mul_sup, double u_mul_inf, double u_mul_sup, double ulp, size_t size);
+  /* l[k] = l[k] + [l_mul_inf,l_mul_sup]*[inf[i],sup[i]] and the same for u with k = dim[i],
+     or k = i if dim is NULL, as fppoly_kernel_scale followed by fppoly_kernel_add;
+     the dim[i] are distinct */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
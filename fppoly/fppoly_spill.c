@@ -0,0 +1,94 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "fppoly_spill.h"
+
+struct fppoly_spill_t{
+	void *data;
+	/* size of the mapping, at least one byte */
+	size_t size;
+	int fd;
+};
+
+
+fppoly_spill_t * fppoly_spill_alloc(size_t size){
+	const char *dir = getenv("TMPDIR");
+	char *path;
+	int fd;
+	if(dir==NULL || dir[0]=='\0'){
+		dir = "/tmp";
+	}
+	path = (char *)malloc(strlen(dir) + sizeof("/fppoly_spill_XXXXXX"));
+	sprintf(path, "%s/fppoly_spill_XXXXXX", dir);
+	fd = mkstemp(path);
+	if(fd < 0){
+		free(path);
+		return NULL;
+	}
+	/* the file only lives as long as its descriptor */
+	unlink(path);
+	free(path);
+	if(size==0){
+		size = 1;
+	}
+	fppoly_spill_t *spill = (fppoly_spill_t *)malloc(sizeof(fppoly_spill_t));
+	spill->size = size;
+	spill->fd = fd;
+	spill->data = MAP_FAILED;
+	if(ftruncate(fd, (off_t)size)==0){
+		spill->data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	if(spill->data==MAP_FAILED){
+		close(fd);
+		free(spill);
+		return NULL;
+	}
+	return spill;
+}
+
+
+void * fppoly_spill_data(fppoly_spill_t *spill){
+	return spill->data;
+}
+
+
+void fppoly_spill_seal(fppoly_spill_t *spill){
+	/* once written back the pages are clean, dropping them loses nothing */
+	msync(spill->data, spill->size, MS_SYNC);
+	mprotect(spill->data, spill->size, PROT_READ);
+	fppoly_spill_release(spill);
+}
+
+
+void fppoly_spill_release(fppoly_spill_t *spill){
+	madvise(spill->data, spill->size, MADV_DONTNEED);
+}
+
+
+void fppoly_spill_free(fppoly_spill_t *spill){
+	munmap(spill->data, spill->size);
+	close(spill->fd);
+	free(spill);
+}
@@ -0,0 +1,65 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+/* ************************************************************************* */
+/* fppoly_spill: read-only buffers kept in a temporary file mapped in memory */
+/* ************************************************************************* */
+
+#ifndef __FPPOLY_SPILL_H_INCLUDED__
+#define __FPPOLY_SPILL_H_INCLUDED__
+
+#include <stdlib.h>
+#include "elina_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A spill buffer is filled once and then only read. Its content lives in an
+   unlinked temporary file, created in $TMPDIR or /tmp, mapped in memory: the
+   pages are read back from the file when they are accessed and
+   fppoly_spill_release takes them out of the resident memory of the process
+   without losing anything. */
+
+typedef struct fppoly_spill_t fppoly_spill_t;
+
+fppoly_spill_t * fppoly_spill_alloc(size_t size);
+  /* A buffer of size bytes to be filled through fppoly_spill_data, NULL if
+     the file cannot be created or mapped */
+
+void * fppoly_spill_data(fppoly_spill_t *spill);
+  /* The content of the buffer */
+
+void fppoly_spill_seal(fppoly_spill_t *spill);
+  /* Write the content to the file and make the buffer read-only, called once
+     it is filled */
+
+void fppoly_spill_release(fppoly_spill_t *spill);
+  /* Take the pages of a sealed buffer out of the resident memory */
+
+void fppoly_spill_free(fppoly_spill_t *spill);
+  /* Unmap the buffer and close its file */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
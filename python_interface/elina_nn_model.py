@@ -0,0 +1,174 @@
+#
+#
+#  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+#  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+#  This software is distributed under GNU Lesser General Public License Version 3.0.
+#  For more information, see the ELINA project website at:
+#  http://elina.ethz.ch
+#
+#  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+#  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+#  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+#  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+#  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+#  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+#  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+#  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+#  CONTRACT, TORT OR OTHERWISE).
+#
+#
+
+from elina_auxiliary_imports import *
+import numpy as np
+from numpy.ctypeslib import ndpointer
+import ctypes
+
+elina_nn_model_api = CDLL("libelinalinearize.so")
+
+_doublepp = ndpointer(dtype=np.uintp, ndim=1, flags='C')
+
+
+class ElinaNNActivation(CtypesEnum):
+    """ Enum compatible with elina_nn_activation_t from elina_nn_model.h """
+
+    ELINA_NN_RELU = 0
+    ELINA_NN_SIGMOID = 1
+    ELINA_NN_TANH = 2
+    ELINA_NN_PARABOLA = 3
+    ELINA_NN_LOG = 4
+    ELINA_NN_NONE = 5
+
+
+ElinaNNModelPtr = c_void_p
+
+# ====================================================================== #
+# Basics
+# ====================================================================== #
+
+def elina_nn_model_alloc(num_pixels):
+    """
+    Create a network model without layers, shared by fppoly and zonoml analyses.
+
+    Parameters
+    ----------
+    num_pixels : c_size_t
+        Number of neurons of the input layer.
+
+    Returns
+    -------
+    res : ElinaNNModelPtr
+        Pointer to the elina_nn_model_t.
+
+    """
+
+    res = None
+    try:
+        elina_nn_model_alloc_c = elina_nn_model_api.elina_nn_model_alloc
+        elina_nn_model_alloc_c.restype = ElinaNNModelPtr
+        elina_nn_model_alloc_c.argtypes = [c_size_t]
+        res = elina_nn_model_alloc_c(num_pixels)
+    except Exception as inst:
+        print('Problem with loading/calling "elina_nn_model_alloc" from "libelinalinearize.so"')
+        print(inst)
+    return res
+
+
+def elina_nn_model_free(model):
+    """
+    Free a network model.
+
+    Parameters
+    ----------
+    model : ElinaNNModelPtr
+        Pointer to the elina_nn_model_t.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        elina_nn_model_free_c = elina_nn_model_api.elina_nn_model_free
+        elina_nn_model_free_c.restype = None
+        elina_nn_model_free_c.argtypes = [ElinaNNModelPtr]
+        elina_nn_model_free_c(model)
+    except Exception as inst:
+        print('Problem with loading/calling "elina_nn_model_free" from "libelinalinearize.so"')
+        print(inst)
+
+
+def elina_nn_model_add_ffn_layer(model, weights, bias, num_out_neurons, num_in_neurons, activation):
+    """
+    Append a fully connected layer to the model.
+
+    Parameters
+    ----------
+    model : ElinaNNModelPtr
+        Pointer to the elina_nn_model_t.
+    weights: POINTER(POINTER(c_double))
+        The weight matrix.
+    bias: POINTER(c_double)
+        The bias vector
+    num_out_neurons: c_size_t
+        number of output neurons
+    num_in_neurons: c_size_t
+        number of input neurons
+    activation: c_uint
+        activation of the layer, an ElinaNNActivation
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        elina_nn_model_add_ffn_layer_c = elina_nn_model_api.elina_nn_model_add_ffn_layer
+        elina_nn_model_add_ffn_layer_c.restype = None
+        elina_nn_model_add_ffn_layer_c.argtypes = [ElinaNNModelPtr, _doublepp, ndpointer(ctypes.c_double), c_size_t, c_size_t, ElinaNNActivation]
+        elina_nn_model_add_ffn_layer_c(model, weights, bias, num_out_neurons, num_in_neurons, activation)
+    except Exception as inst:
+        print('Problem with loading/calling "elina_nn_model_add_ffn_layer" from "libelinalinearize.so"')
+        print(inst)
+
+
+def elina_nn_model_add_conv_layer(model, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+    """
+    Append a convolutional ReLU layer to the model.
+
+    Parameters
+    ----------
+    model : ElinaNNModelPtr
+        Pointer to the elina_nn_model_t.
+    filter_weights: POINTER(double)
+        filter weights
+    filter_bias: POINTER(double)
+        filter biases
+    input_size: POINTER(c_size_t)
+        size of the input
+    filter_size: POINTER(c_size_t)
+        size of the filters
+    num_filters: c_size_t
+        number of filters
+    strides: POINTER(c_size_t)
+       size of the strides
+    is_valid_padding: c_bool
+       if the padding is valid
+    has_bias: c_bool
+       if the filter has bias
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        elina_nn_model_add_conv_layer_c = elina_nn_model_api.elina_nn_model_add_conv_layer
+        elina_nn_model_add_conv_layer_c.restype = None
+        elina_nn_model_add_conv_layer_c.argtypes = [ElinaNNModelPtr, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), c_bool, c_bool]
+        elina_nn_model_add_conv_layer_c(model, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias)
+    except Exception as inst:
+        print('Problem with loading/calling "elina_nn_model_add_conv_layer" from "libelinalinearize.so"')
+        print(inst)
@@ -55,6 +55,308 @@ def fppoly_manager_alloc():
 
     return man
 
+
+def fppoly_manager_set_num_threads(man, num_threads):
+    """
+    Set the number of threads used by the parallel transformers of the manager.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    num_threads : c_size_t
+        Number of threads, 0 selects the number of online processors.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_num_threads_c = fppoly_api.fppoly_manager_set_num_threads
+        fppoly_manager_set_num_threads_c.restype = None
+        fppoly_manager_set_num_threads_c.argtypes = [ElinaManagerPtr, c_size_t]
+        fppoly_manager_set_num_threads_c(man, num_threads)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_num_threads" from "libfppoly.so"')
+
+
+def fppoly_manager_get_num_threads(man):
+    """
+    Get the number of threads used by the parallel transformers of the manager, including the caller.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of threads.
+
+    """
+
+    res = None
+    try:
+        fppoly_manager_get_num_threads_c = fppoly_api.fppoly_manager_get_num_threads
+        fppoly_manager_get_num_threads_c.restype = c_size_t
+        fppoly_manager_get_num_threads_c.argtypes = [ElinaManagerPtr]
+        res = fppoly_manager_get_num_threads_c(man)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_manager_get_num_threads" from "libfppoly.so"')
+        print(inst)
+
+    return res
+
+
+def fppoly_manager_get_busy_time(man):
+    """
+    Get the seconds each thread spent on back-substitution since the last reset.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : numpy array of float64
+        Busy time of every thread, entry 0 is the calling thread.
+
+    """
+
+    res = None
+    try:
+        res = np.zeros(fppoly_manager_get_num_threads(man), dtype=np.float64)
+        fppoly_manager_get_busy_time_c = fppoly_api.fppoly_manager_get_busy_time
+        fppoly_manager_get_busy_time_c.restype = None
+        fppoly_manager_get_busy_time_c.argtypes = [ElinaManagerPtr, ndpointer(ctypes.c_double)]
+        fppoly_manager_get_busy_time_c(man, res)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_manager_get_busy_time" from "libfppoly.so"')
+        print(inst)
+
+    return res
+
+
+def fppoly_manager_reset_busy_time(man):
+    """
+    Reset the busy time of the threads of the manager.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_reset_busy_time_c = fppoly_api.fppoly_manager_reset_busy_time
+        fppoly_manager_reset_busy_time_c.restype = None
+        fppoly_manager_reset_busy_time_c.argtypes = [ElinaManagerPtr]
+        fppoly_manager_reset_busy_time_c(man)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_manager_reset_busy_time" from "libfppoly.so"')
+        print(inst)
+
+
+class BacksubstPolicy(CtypesEnum):
+    """ Enum compatible with backsubst_policy_t from fppoly.h """
+
+    BACKSUBST_FULL = 0
+    BACKSUBST_ADAPTIVE = 1
+
+
+def fppoly_manager_set_backsubst_policy(man, policy, min_depth):
+    """
+    Set how far the neurons of ReLU layers are back-substituted.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    policy : c_uint
+        BACKSUBST_FULL to always reach the input layer, BACKSUBST_ADAPTIVE to stop once the ReLU phase is decided.
+    min_depth : c_size_t
+        Number of layers back-substituted before the bounds are first checked.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_backsubst_policy_c = fppoly_api.fppoly_manager_set_backsubst_policy
+        fppoly_manager_set_backsubst_policy_c.restype = None
+        fppoly_manager_set_backsubst_policy_c.argtypes = [ElinaManagerPtr, BacksubstPolicy, c_size_t]
+        fppoly_manager_set_backsubst_policy_c(man, policy, min_depth)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_backsubst_policy" from "libfppoly.so"')
+
+
+def fppoly_manager_set_concretize_every_layer(man, enable):
+    """
+    Bound the expressions back-substituted by is_greater and the LSTM layers at every layer they reach.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    enable : c_bool
+        True to keep the tightest of the bounds over the neurons of every layer, False to only use the input layer.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_concretize_every_layer_c = fppoly_api.fppoly_manager_set_concretize_every_layer
+        fppoly_manager_set_concretize_every_layer_c.restype = None
+        fppoly_manager_set_concretize_every_layer_c.argtypes = [ElinaManagerPtr, c_bool]
+        fppoly_manager_set_concretize_every_layer_c(man, enable)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_concretize_every_layer" from "libfppoly.so"')
+
+
+def fppoly_manager_set_implicit_conv(man, enable):
+    """
+    Keep the filter of the convolutional layers instead of one expression per neuron.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    enable : c_bool
+        True to rebuild the expressions of the neurons of convolutional layers from their filter at each use.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_implicit_conv_c = fppoly_api.fppoly_manager_set_implicit_conv
+        fppoly_manager_set_implicit_conv_c.restype = None
+        fppoly_manager_set_implicit_conv_c.argtypes = [ElinaManagerPtr, c_bool]
+        fppoly_manager_set_implicit_conv_c(man, enable)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_implicit_conv" from "libfppoly.so"')
+
+
+def fppoly_manager_set_memory_budget(man, budget):
+    """
+    Spill the expressions of the oldest layers to a temporary file once the layers of an abstract element hold more than budget bytes.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    budget : c_size_t
+        Bytes the layers may keep in memory, 0 for no limit.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_memory_budget_c = fppoly_api.fppoly_manager_set_memory_budget
+        fppoly_manager_set_memory_budget_c.restype = None
+        fppoly_manager_set_memory_budget_c.argtypes = [ElinaManagerPtr, c_size_t]
+        fppoly_manager_set_memory_budget_c(man, budget)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_memory_budget" from "libfppoly.so"')
+
+
+def fppoly_manager_set_float32(man, enable):
+    """
+    Store the expressions of the affine and convolutional layers with float32 coefficients once their bounds are computed, the bounds remain sound.
+    This halves the memory held by these layers and read by the back-substitution through the dense ones, the bounds can be slightly looser.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    enable : c_bool
+        Whether the layers are stored in float32.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_set_float32_c = fppoly_api.fppoly_manager_set_float32
+        fppoly_manager_set_float32_c.restype = None
+        fppoly_manager_set_float32_c.argtypes = [ElinaManagerPtr, c_bool]
+        fppoly_manager_set_float32_c(man, enable)
+    except:
+        print('Problem with loading/calling "fppoly_manager_set_float32" from "libfppoly.so"')
+
+
+def fppoly_manager_get_skipped_layers(man):
+    """
+    Get the number of layers not back-substituted through since the last reset, summed over all neurons.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of skipped layers.
+
+    """
+
+    res = None
+    try:
+        fppoly_manager_get_skipped_layers_c = fppoly_api.fppoly_manager_get_skipped_layers
+        fppoly_manager_get_skipped_layers_c.restype = c_size_t
+        fppoly_manager_get_skipped_layers_c.argtypes = [ElinaManagerPtr]
+        res = fppoly_manager_get_skipped_layers_c(man)
+    except:
+        print('Problem with loading/calling "fppoly_manager_get_skipped_layers" from "libfppoly.so"')
+
+    return res
+
+
+def fppoly_manager_reset_skipped_layers(man):
+    """
+    Reset the number of skipped layers.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_manager_reset_skipped_layers_c = fppoly_api.fppoly_manager_reset_skipped_layers
+        fppoly_manager_reset_skipped_layers_c.restype = None
+        fppoly_manager_reset_skipped_layers_c.argtypes = [ElinaManagerPtr]
+        fppoly_manager_reset_skipped_layers_c(man)
+    except:
+        print('Problem with loading/calling "fppoly_manager_reset_skipped_layers" from "libfppoly.so"')
+
 def fppoly_from_network_input(man, intdim, realdim, inf_array, sup_array):
     """
     Create an abstract element from perturbed input
@@ -1327,76 +1629,172 @@ def is_greater(man, element, y, x):
         print(inst)
     return res
 
-def conv_handle_first_layer(man, element, filter_weights, filter_bias,  input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+def fppoly_layer_resident_bytes(man, element, layerno):
     """
-    Convolutional Matrix multiplication in the first layer
+    Bytes held in memory by a layer of the abstract element.
     
     Parameters
     ----------
     man : ElinaManagerPtr
         Pointer to the ElinaManager.
     element : ElinaAbstract0Ptr
-        Pointer to the ElinaAbstract0 abstract element.
-    filter_weights: POINTER(double)
-        filter weights
-    filter_bias: POINTER(double)
-        filter biases
-    input_size: POINTER(c_size_t)
-        size of the input
-    filter_size: POINTER(c_size_t)  
-        size of the filters
-    num_filters: c_size_t
-        number of filters
-    strides: POINTER(c_size_t)
-       size of the strides
-    is_valid_padding: c_bool
-       if the padding is valid
-    has_bias: c_bool
-       if the filter has bias
+        Pointer to the ElinaAbstract0.
+    layerno : c_size_t
+        Number of the layer, counted from 0.
+
     Returns
     -------
-    None
+    res : c_size_t
+        Bytes of the layer on the heap, without the spilled expressions.
 
     """
+    res = None
     try:
-        conv_handle_first_layer_c = fppoly_api.conv_handle_first_layer
-        conv_handle_first_layer_c.restype = None
-        conv_handle_first_layer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), c_bool, c_bool]
-        conv_handle_first_layer_c(man,element, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias)
+        fppoly_layer_resident_bytes_c = fppoly_api.fppoly_layer_resident_bytes
+        fppoly_layer_resident_bytes_c.restype = c_size_t
+        fppoly_layer_resident_bytes_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t]
+        res = fppoly_layer_resident_bytes_c(man, element, layerno)
     except Exception as inst:
-        print('Problem with loading/calling "conv_handle_first_layer" from "libfppoly.so"')
+        print('Problem with loading/calling "fppoly_layer_resident_bytes" from "libfppoly.so"')
         print(inst)
-    return
+    return res
 
-def conv_handle_intermediate_relu_layer(man, element, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+
+def fppoly_resident_bytes(man, element):
     """
-    Convolutional Matrix multiplication in an Intermediate layer
+    Bytes held in memory by the layers of the abstract element and the expressions of its input and output.
     
     Parameters
     ----------
     man : ElinaManagerPtr
         Pointer to the ElinaManager.
     element : ElinaAbstract0Ptr
-        Pointer to the ElinaAbstract0 abstract element.
-    filter_weights: POINTER(double)
-        filter weights
-    filter_bias: POINTER(double)
-        filter biases
-    input_size: POINTER(c_size_t)
-        size of the input
-    filter_size: POINTER(c_size_t)  
-        size of the filters
-    num_filters: c_size_t
-        number of filters
-    strides: POINTER(c_size_t)
-       size of the strides
-    is_valid_padding: c_bool
-       if the padding is valid
-    has_bias: c_bool
-       if the filter has bias
+        Pointer to the ElinaAbstract0.
+
     Returns
     -------
-    None
+    res : c_size_t
+        Bytes of the abstract element on the heap.
+
+    """
+    res = None
+    try:
+        fppoly_resident_bytes_c = fppoly_api.fppoly_resident_bytes
+        fppoly_resident_bytes_c.restype = c_size_t
+        fppoly_resident_bytes_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr]
+        res = fppoly_resident_bytes_c(man, element)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_resident_bytes" from "libfppoly.so"')
+        print(inst)
+    return res
+
+def get_lb_for_output_specs(man, element, num_specs, coeffs, cst, lb):
+    """
+    Lower bounds of many linear combinations of the outputs, back-substituted together.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    num_specs : c_size_t
+        Number of specifications.
+    coeffs : POINTER(c_double)
+        Coefficients of the outputs in the specifications, one row of num_outputs values per specification.
+    cst : POINTER(c_double)
+        Constant of each specification, or None for 0.
+    lb : POINTER(c_double)
+        Receives the lower bound of each specification.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        get_lb_for_output_specs_c = fppoly_api.get_lb_for_output_specs
+        get_lb_for_output_specs_c.restype = None
+        get_lb_for_output_specs_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, ndpointer(ctypes.c_double), c_void_p, ndpointer(ctypes.c_double)]
+        if cst is None:
+            get_lb_for_output_specs_c(man, element, num_specs, coeffs, None, lb)
+        else:
+            get_lb_for_output_specs_c(man, element, num_specs, coeffs, cst.ctypes.data_as(c_void_p), lb)
+    except Exception as inst:
+        print('Problem with loading/calling "get_lb_for_output_specs" from "libfppoly.so"')
+        print(inst)
+
+def conv_handle_first_layer(man, element, filter_weights, filter_bias,  input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+    """
+    Convolutional Matrix multiplication in the first layer
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    filter_weights: POINTER(double)
+        filter weights
+    filter_bias: POINTER(double)
+        filter biases
+    input_size: POINTER(c_size_t)
+        size of the input
+    filter_size: POINTER(c_size_t)  
+        size of the filters
+    num_filters: c_size_t
+        number of filters
+    strides: POINTER(c_size_t)
+       size of the strides
+    is_valid_padding: c_bool
+       if the padding is valid
+    has_bias: c_bool
+       if the filter has bias
+    Returns
+    -------
+    None
+
+    """
+    try:
+        conv_handle_first_layer_c = fppoly_api.conv_handle_first_layer
+        conv_handle_first_layer_c.restype = None
+        conv_handle_first_layer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), c_bool, c_bool]
+        conv_handle_first_layer_c(man,element, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias)
+    except Exception as inst:
+        print('Problem with loading/calling "conv_handle_first_layer" from "libfppoly.so"')
+        print(inst)
+    return
+
+def conv_handle_intermediate_relu_layer(man, element, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+    """
+    Convolutional Matrix multiplication in an Intermediate layer
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    filter_weights: POINTER(double)
+        filter weights
+    filter_bias: POINTER(double)
+        filter biases
+    input_size: POINTER(c_size_t)
+        size of the input
+    filter_size: POINTER(c_size_t)  
+        size of the filters
+    num_filters: c_size_t
+        number of filters
+    strides: POINTER(c_size_t)
+       size of the strides
+    is_valid_padding: c_bool
+       if the padding is valid
+    has_bias: c_bool
+       if the filter has bias
+    Returns
+    -------
+    None
 
     """
     try:
@@ -1442,6 +1840,536 @@ def handle_maxpool_layer(man, element, pool_size, input_size):
     return res
 
 
+def handle_maxpool_layer_strided(man, element, pool_size, input_size, strides, dimensionality, is_valid_padding):
+    """
+    handle a Maxpool layer with arbitrary strides and padding
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    pool_size: POINTER(c_size_t)
+        The size of the Maxpool filter 
+    input_size : POINTER(c_size_t)
+        The number of variables on which Maxpool will be applied.
+    strides : POINTER(c_size_t)
+        Strides of the Maxpool filter.
+    dimensionality : c_size_t
+        Number of dimensions of the input, 3.
+    is_valid_padding : c_bool
+        True for VALID padding, False for SAME padding.
+    
+    Returns
+    -------
+    res : c_size_t
+        Number of neurons in the last layer
+
+    """
+    res=None
+    try:
+        handle_maxpool_layer_strided_c = fppoly_api.handle_maxpool_layer_strided
+        handle_maxpool_layer_strided_c.restype = c_size_t
+        handle_maxpool_layer_strided_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, ndpointer(ctypes.c_size_t), ndpointer(ctypes.c_size_t), ndpointer(ctypes.c_size_t), c_size_t, c_bool]
+        res = handle_maxpool_layer_strided_c(man, element, pool_size, input_size, strides, dimensionality, is_valid_padding)
+    except Exception as inst:
+        print('Problem with loading/calling "handle_maxpool_layer_strided" from "libfppoly.so"')
+        print(inst)
+    return res
+
+
+def fppoly_set_next_layer_input(man, element, predecessor):
+    """
+    make the next layer read the output of layer predecessor-1, or the input of the network for predecessor 0, instead of the output of the last layer
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    predecessor : c_size_t
+        Number of the layer whose output the next layer reads, counted from 1, 0 for the input.
+
+    Returns
+    -------
+    None
+
+    """
+    try:
+        fppoly_set_next_layer_input_c = fppoly_api.fppoly_set_next_layer_input
+        fppoly_set_next_layer_input_c.restype = None
+        fppoly_set_next_layer_input_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t]
+        fppoly_set_next_layer_input_c(man, element, predecessor)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_set_next_layer_input" from "libfppoly.so"')
+        print(inst)
+
+
+def handle_residual_relu_layer(man, element, num_neurons, predecessors, num_predecessors):
+    """
+    handle a layer summing the outputs of several layers followed by a ReLU
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    num_neurons : c_size_t
+        Number of neurons of the layer and of each of its predecessors.
+    predecessors : POINTER(c_size_t)
+        The layers summed, numbered as in fppoly_set_next_layer_input.
+    num_predecessors : c_size_t
+        Number of layers summed.
+
+    Returns
+    -------
+    None
+
+    """
+    try:
+        handle_residual_relu_layer_c = fppoly_api.handle_residual_relu_layer
+        handle_residual_relu_layer_c.restype = None
+        handle_residual_relu_layer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, ndpointer(ctypes.c_size_t), c_size_t]
+        handle_residual_relu_layer_c(man, element, num_neurons, predecessors, num_predecessors)
+    except Exception as inst:
+        print('Problem with loading/calling "handle_residual_relu_layer" from "libfppoly.so"')
+        print(inst)
+
+
+def handle_residual_affine_layer(man, element, num_neurons, predecessors, num_predecessors):
+    """
+    handle a layer summing the outputs of several layers
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    num_neurons : c_size_t
+        Number of neurons of the layer and of each of its predecessors.
+    predecessors : POINTER(c_size_t)
+        The layers summed, numbered as in fppoly_set_next_layer_input.
+    num_predecessors : c_size_t
+        Number of layers summed.
+
+    Returns
+    -------
+    None
+
+    """
+    try:
+        handle_residual_affine_layer_c = fppoly_api.handle_residual_affine_layer
+        handle_residual_affine_layer_c.restype = None
+        handle_residual_affine_layer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, ndpointer(ctypes.c_size_t), c_size_t]
+        handle_residual_affine_layer_c(man, element, num_neurons, predecessors, num_predecessors)
+    except Exception as inst:
+        print('Problem with loading/calling "handle_residual_affine_layer" from "libfppoly.so"')
+        print(inst)
+
+
+class ActivationType(CtypesEnum):
+    """ Enum compatible with activation_type_t from fppoly.h """
+
+    RELU = 0
+    SIGMOID = 1
+    TANH = 2
+    PARABOLA = 3
+    LOG = 4
+    NONE = 5
+
+
+class WeightsLayout(CtypesEnum):
+    """ Enum compatible with fppoly_weights_layout_t from fppoly.h """
+
+    FPPOLY_ROW_MAJOR = 0
+    FPPOLY_COLUMN_MAJOR = 1
+
+
+class WeightsDtype(CtypesEnum):
+    """ Enum compatible with fppoly_weights_dtype_t from fppoly.h """
+
+    FPPOLY_WEIGHTS_FLOAT64 = 0
+    FPPOLY_WEIGHTS_FLOAT32 = 1
+
+
+def _weights_buffer_args(weights, bias):
+    """
+    Layout, leading dimension and type of a 2D numpy weight matrix with strides of a whole number of elements,
+    as taken by the ffn_handle_*_layer_buffer functions.
+
+    """
+
+    if weights.dtype == np.float64:
+        dtype = WeightsDtype.FPPOLY_WEIGHTS_FLOAT64
+    elif weights.dtype == np.float32:
+        dtype = WeightsDtype.FPPOLY_WEIGHTS_FLOAT32
+    else:
+        raise TypeError('weights must be float64 or float32')
+    if bias.dtype != weights.dtype or not bias.flags['C_CONTIGUOUS']:
+        raise TypeError('bias must be a contiguous vector of the type of weights')
+    itemsize = weights.itemsize
+    if weights.strides[1] == itemsize:
+        return WeightsLayout.FPPOLY_ROW_MAJOR, weights.strides[0] // itemsize, dtype
+    if weights.strides[0] == itemsize:
+        return WeightsLayout.FPPOLY_COLUMN_MAJOR, weights.strides[1] // itemsize, dtype
+    raise TypeError('weights must be contiguous along one of its dimensions')
+
+
+def ffn_handle_first_layer_buffer(man, element, weights, bias, size, num_pixels, activation):
+    """
+    handle the first FFN layer with the weights read in place from a numpy array, without copy.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    weights : numpy.ndarray
+        The size x num_pixels weight matrix, float64 or float32, row or column major, possibly a slice of a larger array.
+        It must stay alive until element is freed.
+    bias : numpy.ndarray
+        The bias vector, of the type of weights. It must stay alive until element is freed.
+    size: c_size_t
+        Number of neurons in the first layer
+    num_pixels:
+        Number of pixels in the input
+    activation: c_uint
+        activation of the layer, an ActivationType
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        layout, ld, dtype = _weights_buffer_args(weights, bias)
+        ffn_handle_first_layer_buffer_c = fppoly_api.ffn_handle_first_layer_buffer
+        ffn_handle_first_layer_buffer_c.restype = None
+        ffn_handle_first_layer_buffer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_void_p, c_void_p, c_size_t, WeightsLayout, WeightsDtype, c_size_t, c_size_t, ActivationType]
+        ffn_handle_first_layer_buffer_c(man, element, weights.ctypes.data_as(c_void_p), bias.ctypes.data_as(c_void_p), ld, layout, dtype, size, num_pixels, activation)
+    except Exception as inst:
+        print('Problem with loading/calling "ffn_handle_first_layer_buffer" from "libfppoly.so"')
+        print(inst)
+
+
+def ffn_handle_intermediate_layer_buffer(man, element, weights, bias, num_out_neurons, num_in_neurons, activation):
+    """
+    handle an intermediate FFN layer with the weights read in place from a numpy array, without copy.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    weights : numpy.ndarray
+        The num_out_neurons x num_in_neurons weight matrix, float64 or float32, row or column major, possibly a slice
+        of a larger array. It must stay alive until element is freed.
+    bias : numpy.ndarray
+        The bias vector, of the type of weights. It must stay alive until element is freed.
+    num_out_neurons: c_size_t
+        number of output neurons
+    num_in_neurons: c_size_t
+        number of input neurons
+    activation: c_uint
+        activation of the layer, an ActivationType
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        layout, ld, dtype = _weights_buffer_args(weights, bias)
+        ffn_handle_intermediate_layer_buffer_c = fppoly_api.ffn_handle_intermediate_layer_buffer
+        ffn_handle_intermediate_layer_buffer_c.restype = None
+        ffn_handle_intermediate_layer_buffer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_void_p, c_void_p, c_size_t, WeightsLayout, WeightsDtype, c_size_t, c_size_t, ActivationType]
+        ffn_handle_intermediate_layer_buffer_c(man, element, weights.ctypes.data_as(c_void_p), bias.ctypes.data_as(c_void_p), ld, layout, dtype, num_out_neurons, num_in_neurons, activation)
+    except Exception as inst:
+        print('Problem with loading/calling "ffn_handle_intermediate_layer_buffer" from "libfppoly.so"')
+        print(inst)
+
+
+def ffn_handle_last_layer_buffer(man, element, weights, bias, num_out_neurons, num_in_neurons, has_activation, activation):
+    """
+    handle the last FFN layer with the weights read in place from a numpy array, without copy.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 abstract element.
+    weights : numpy.ndarray
+        The num_out_neurons x num_in_neurons weight matrix, float64 or float32, row or column major, possibly a slice
+        of a larger array. It must stay alive until element is freed.
+    bias : numpy.ndarray
+        The bias vector, of the type of weights. It must stay alive until element is freed.
+    num_out_neurons: c_size_t
+        number of output neurons
+    num_in_neurons: c_size_t
+        number of input neurons
+    has_activation: c_bool
+        if the last layer has an activation
+    activation: c_uint
+        activation of the layer, an ActivationType
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        layout, ld, dtype = _weights_buffer_args(weights, bias)
+        ffn_handle_last_layer_buffer_c = fppoly_api.ffn_handle_last_layer_buffer
+        ffn_handle_last_layer_buffer_c.restype = None
+        ffn_handle_last_layer_buffer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_void_p, c_void_p, c_size_t, WeightsLayout, WeightsDtype, c_size_t, c_size_t, c_bool, ActivationType]
+        ffn_handle_last_layer_buffer_c(man, element, weights.ctypes.data_as(c_void_p), bias.ctypes.data_as(c_void_p), ld, layout, dtype, num_out_neurons, num_in_neurons, has_activation, activation)
+    except Exception as inst:
+        print('Problem with loading/calling "ffn_handle_last_layer_buffer" from "libfppoly.so"')
+        print(inst)
+
+
+def fppoly_network_alloc(num_pixels):
+    """
+    Allocate a network shared by the analyses of many input boxes, without layers.
+
+    Parameters
+    ----------
+    num_pixels : c_size_t
+        Number of neurons of the input layer.
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the fppoly_network_t.
+
+    """
+
+    res = None
+    try:
+        fppoly_network_alloc_c = fppoly_api.fppoly_network_alloc
+        fppoly_network_alloc_c.restype = c_void_p
+        fppoly_network_alloc_c.argtypes = [c_size_t]
+        res = fppoly_network_alloc_c(num_pixels)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_alloc" from "libfppoly.so"')
+        print(inst)
+    return res
+
+
+def fppoly_network_add_ffn_layer(net, weights, bias, num_out_neurons, num_in_neurons, activation):
+    """
+    Append a FFN layer to the network.
+
+    Parameters
+    ----------
+    net : c_void_p
+        Pointer to the fppoly_network_t.
+    weights: POINTER(POINTER(c_double))
+        The weight matrix.
+    bias: POINTER(c_double)
+        The bias vector
+    num_out_neurons: c_size_t
+        number of output neurons
+    num_in_neurons: c_size_t
+        number of input neurons
+    activation: c_uint
+        activation of the layer, an ActivationType
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_add_ffn_layer_c = fppoly_api.fppoly_network_add_ffn_layer
+        fppoly_network_add_ffn_layer_c.restype = None
+        fppoly_network_add_ffn_layer_c.argtypes = [c_void_p, _doublepp, ndpointer(ctypes.c_double), c_size_t, c_size_t, ActivationType]
+        fppoly_network_add_ffn_layer_c(net, weights, bias, num_out_neurons, num_in_neurons, activation)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_add_ffn_layer" from "libfppoly.so"')
+        print(inst)
+
+
+def fppoly_network_add_conv_layer(net, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias):
+    """
+    Append a convolutional ReLU layer to the network.
+
+    Parameters
+    ----------
+    net : c_void_p
+        Pointer to the fppoly_network_t.
+    filter_weights: POINTER(double)
+        filter weights
+    filter_bias: POINTER(double)
+        filter biases
+    input_size: POINTER(c_size_t)
+        size of the input
+    filter_size: POINTER(c_size_t)
+        size of the filters
+    num_filters: c_size_t
+        number of filters
+    strides: POINTER(c_size_t)
+       size of the strides
+    is_valid_padding: c_bool
+       if the padding is valid
+    has_bias: c_bool
+       if the filter has bias
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_add_conv_layer_c = fppoly_api.fppoly_network_add_conv_layer
+        fppoly_network_add_conv_layer_c.restype = None
+        fppoly_network_add_conv_layer_c.argtypes = [c_void_p, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_size_t), POINTER(c_size_t), c_size_t, POINTER(c_size_t), c_bool, c_bool]
+        fppoly_network_add_conv_layer_c(net, filter_weights, filter_bias, input_size, filter_size, num_filters, strides, is_valid_padding, has_bias)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_add_conv_layer" from "libfppoly.so"')
+        print(inst)
+
+
+def fppoly_network_free(net):
+    """
+    Free the network and the expressions of its neurons.
+
+    Parameters
+    ----------
+    net : c_void_p
+        Pointer to the fppoly_network_t.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_free_c = fppoly_api.fppoly_network_free
+        fppoly_network_free_c.restype = None
+        fppoly_network_free_c.argtypes = [c_void_p]
+        fppoly_network_free_c(net)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_free" from "libfppoly.so"')
+        print(inst)
+
+
+def fppoly_network_analyze_batch(man, net, num_queries, inf_array, sup_array, output_inf, output_sup, labels, is_greater_res):
+    """
+    Analyse many input boxes through the network, in parallel over the boxes and the neurons.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    net : c_void_p
+        Pointer to the fppoly_network_t.
+    num_queries : c_size_t
+        Number of input boxes.
+    inf_array : POINTER(c_double)
+        Lower bounds of the input boxes, one row of num_pixels values per box.
+    sup_array : POINTER(c_double)
+        Upper bounds of the input boxes.
+    output_inf : POINTER(c_double)
+        Receives the lower bounds of the last layer, one row per box.
+    output_sup : POINTER(c_double)
+        Receives the upper bounds of the last layer.
+    labels : POINTER(c_uint)
+        Label of each box, or None to skip the is_greater checks.
+    is_greater_res : POINTER(c_bool)
+        Receives is_greater(labels[q], x) at q*num_outputs + x, ignored if labels is None.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_network_analyze_batch_c = fppoly_api.fppoly_network_analyze_batch
+        fppoly_network_analyze_batch_c.restype = None
+        fppoly_network_analyze_batch_c.argtypes = [ElinaManagerPtr, c_void_p, c_size_t, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), ndpointer(ctypes.c_double), c_void_p, c_void_p]
+        if labels is None:
+            fppoly_network_analyze_batch_c(man, net, num_queries, inf_array, sup_array, output_inf, output_sup, None, None)
+        else:
+            fppoly_network_analyze_batch_c(man, net, num_queries, inf_array, sup_array, output_inf, output_sup, labels.ctypes.data_as(c_void_p), is_greater_res.ctypes.data_as(c_void_p))
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_analyze_batch" from "libfppoly.so"')
+        print(inst)
+
+
+def fppoly_network_from_model(model):
+    """
+    Build a network for fppoly_network_analyze_batch from a network model, the model must not be freed before the network.
+
+    Parameters
+    ----------
+    model : c_void_p
+        Pointer to the elina_nn_model_t.
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the fppoly_network_t.
+
+    """
+
+    res = None
+    try:
+        fppoly_network_from_model_c = fppoly_api.fppoly_network_from_model
+        fppoly_network_from_model_c.restype = c_void_p
+        fppoly_network_from_model_c.argtypes = [c_void_p]
+        res = fppoly_network_from_model_c(model)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_network_from_model" from "libfppoly.so"')
+        print(inst)
+    return res
+
+
+def fppoly_handle_model_layer(man, element, model, layerno):
+    """
+    Add a layer of a network model to the abstract element, the last layer of the model sets its output.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the abstract element holding the layers before layerno.
+    model : c_void_p
+        Pointer to the elina_nn_model_t.
+    layerno : c_size_t
+        Index of the layer in the model.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        fppoly_handle_model_layer_c = fppoly_api.fppoly_handle_model_layer
+        fppoly_handle_model_layer_c.restype = None
+        fppoly_handle_model_layer_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_void_p, c_size_t]
+        fppoly_handle_model_layer_c(man, element, model, layerno)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_handle_model_layer" from "libfppoly.so"')
+        print(inst)
+
+
 def box_for_neuron(man, element,layerno, neuron_no):
     """
     returns bounds for a neuron in a layer
@@ -1608,6 +2536,38 @@ def update_bounds_for_neuron(man, element,layerno, neuron_no, lb, ub):
 
 
 
+def fppoly_propagate_dirty_neurons(man, element):
+    """
+    recomputes the bounds of the neurons depending on the neurons updated by update_bounds_for_neuron
+    since the last call, and the output of the network
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0.
+    Returns
+    -------
+    res : c_size_t
+        the number of recomputed neurons
+
+    """
+
+    res = None
+    try:
+        fppoly_propagate_dirty_neurons_c = fppoly_api.fppoly_propagate_dirty_neurons
+        fppoly_propagate_dirty_neurons_c.restype = c_size_t
+        fppoly_propagate_dirty_neurons_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr]
+        res = fppoly_propagate_dirty_neurons_c(man, element)
+    except Exception as inst:
+        print('Problem with loading/calling "fppoly_propagate_dirty_neurons" from "fppoly.so"')
+        print(inst)
+
+    return res
+
+
+
 def get_bounds_for_linexpr0(man,element,linexpr0,layerno):
     """
     returns bounds for a linexpr0 over neurons in "layerno"
@@ -56,6 +56,143 @@ def zonoml_manager_alloc():
     return man
 
 
+def zonoml_manager_set_num_threads(man, num_threads):
+    """
+    Set the number of threads used by the parallel transformers of the manager.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    num_threads : c_size_t
+        Number of threads, 0 selects the number of online processors.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        zonoml_manager_set_num_threads_c = zonoml_api.zonoml_manager_set_num_threads
+        zonoml_manager_set_num_threads_c.restype = None
+        zonoml_manager_set_num_threads_c.argtypes = [ElinaManagerPtr, c_size_t]
+        zonoml_manager_set_num_threads_c(man, num_threads)
+    except:
+        print('Problem with loading/calling "zonoml_manager_set_num_threads" from "libzonoml.so"')
+
+
+def zonoml_manager_get_num_threads(man):
+    """
+    Get the number of threads used by the parallel transformers of the manager, including the caller.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : c_size_t
+        Number of threads.
+
+    """
+
+    res = None
+    try:
+        zonoml_manager_get_num_threads_c = zonoml_api.zonoml_manager_get_num_threads
+        zonoml_manager_get_num_threads_c.restype = c_size_t
+        zonoml_manager_get_num_threads_c.argtypes = [ElinaManagerPtr]
+        res = zonoml_manager_get_num_threads_c(man)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_manager_get_num_threads" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_manager_get_busy_time(man):
+    """
+    Get the seconds each thread spent in the parallel transformers since the last reset.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    res : numpy array of float64
+        Busy time of every thread, entry 0 is the calling thread.
+
+    """
+
+    res = None
+    try:
+        res = np.zeros(zonoml_manager_get_num_threads(man), dtype=np.float64)
+        zonoml_manager_get_busy_time_c = zonoml_api.zonoml_manager_get_busy_time
+        zonoml_manager_get_busy_time_c.restype = None
+        zonoml_manager_get_busy_time_c.argtypes = [ElinaManagerPtr, ndpointer(ctypes.c_double)]
+        zonoml_manager_get_busy_time_c(man, res)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_manager_get_busy_time" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_manager_reset_busy_time(man):
+    """
+    Reset the busy time of the threads of the manager.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        zonoml_manager_reset_busy_time_c = zonoml_api.zonoml_manager_reset_busy_time
+        zonoml_manager_reset_busy_time_c.restype = None
+        zonoml_manager_reset_busy_time_c.argtypes = [ElinaManagerPtr]
+        zonoml_manager_reset_busy_time_c(man)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_manager_reset_busy_time" from "libzonoml.so"')
+        print(inst)
+
+
+def zonoml_manager_set_max_generators(man, max_gen):
+    """
+    Set the number of noise symbols above which the layerwise transformers reduce a layer.
+
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    max_gen : c_size_t
+        Maximal number of noise symbols of a layer, 0 disables the reduction.
+
+    Returns
+    -------
+    None
+
+    """
+
+    try:
+        zonoml_manager_set_max_generators_c = zonoml_api.zonoml_manager_set_max_generators
+        zonoml_manager_set_max_generators_c.restype = None
+        zonoml_manager_set_max_generators_c.argtypes = [ElinaManagerPtr, c_size_t]
+        zonoml_manager_set_max_generators_c(man, max_gen)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_manager_set_max_generators" from "libzonoml.so"')
+        print(inst)
+
+
 def zonotope_from_network_input(man, intdim, realdim, inf_array, sup_array):
     """
     Create the perturbed zonotope from input
@@ -134,6 +271,45 @@ def ffn_matmult_zono(man, destructive, element, start_offset, weights, bias, num
     return res
 
 
+def model_matmult_zono(man, destructive, element, start_offset, model, layerno, expr_offset):
+    """
+    Matrix multiplication by a layer of a network model
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive: c_bool
+        Boolean flag
+    element : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0 which dimensions need to be assigned.
+    start_offset: ElinaDim
+        The start offset from which the dimensions should be assigned.
+    model: c_void_p
+        Pointer to the elina_nn_model_t
+    layerno: c_size_t
+        index of the layer in the model
+    expr_offset: c_size_t
+        the offset of the first variable in the assignment expression
+    Returns
+    -------
+    res: ElinaAbstract0Ptr
+         Pointer to the new abstract object
+
+    """
+
+    try:
+        model_matmult_zono_c = zonoml_api.model_matmult_zono
+        model_matmult_zono_c.restype = ElinaAbstract0Ptr
+        model_matmult_zono_c.argtypes = [ElinaManagerPtr, c_bool,  ElinaAbstract0Ptr, ElinaDim, c_void_p, c_size_t, c_size_t]
+        res = model_matmult_zono_c(man, destructive, element, start_offset, model, layerno, expr_offset)
+    except Exception as inst:
+        print('Problem with loading/calling "model_matmult_zono" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
 def ffn_matmult_without_bias_zono(man, destructive, element, start_offset, weights, num_var, expr_offset, expr_size):
     """
     FFN Matrix multiplication without bias
@@ -644,6 +820,44 @@ def affine_form_is_box(man, element, x):
         print(inst)
     return res
 
+def zono_reduce_order(man, destructive, elem, start_offset, num_dim, max_gen):
+    """
+    Box the noise symbols of a layer that contribute the least until at most max(max_gen, num_dim) are left
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag.
+    elem : ElinaAbstract0Ptr
+        Pointer to the ElinaAbstract0.
+    start_offset : ElinaDim
+        The starting dimension.
+    num_dim : ElinaDim
+        The number of variables of the layer.
+    max_gen : c_size_t
+        Maximal number of noise symbols of the layer.
+
+    Returns
+    -------
+    res : ElinaAbstract0Ptr
+        Pointer to the new abstract object.
+
+    """
+
+    res = None
+    try:
+        zono_reduce_order_c = zonoml_api.zono_reduce_order
+        zono_reduce_order_c.restype = ElinaAbstract0Ptr
+        zono_reduce_order_c.argtypes = [ElinaManagerPtr, c_bool, ElinaAbstract0Ptr, ElinaDim, ElinaDim, c_size_t]
+        res = zono_reduce_order_c(man, destructive, elem, start_offset, num_dim, max_gen)
+    except Exception as inst:
+        print('Problem with loading/calling "zono_reduce_order" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
 def zono_add(man, element, dst_offset, src_offset, num_var):
     """
     Add the affine forms (y:=y+x) in different sections of the abstract element
@@ -736,3 +950,440 @@ def get_interval_width_var_zono(man, element, i):
         print(inst)
 
     return width
+
+
+def zonoml_dense_from_network_input(man, num_var, inf_array, sup_array):
+    """
+    Create the dense zonotope of the input layer
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    num_var : c_size_t
+        Number of input neurons
+    inf_array : POINTER(double)
+        lower bound array
+    sup_array : POINTER(double)
+        upper bound array
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the new zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        zonoml_dense_from_network_input_c = zonoml_api.zonoml_dense_from_network_input
+        zonoml_dense_from_network_input_c.restype = c_void_p
+        zonoml_dense_from_network_input_c.argtypes = [ElinaManagerPtr, c_size_t, ndpointer(ctypes.c_double), ndpointer(ctypes.c_double)]
+        res = zonoml_dense_from_network_input_c(man, num_var, inf_array, sup_array)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_from_network_input" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_dense_of_abstract0(man, element, offset, num_var):
+    """
+    Dense zonotope of dimensions offset to offset+num_var-1 of an abstract element
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    element : ElinaAbstract0Ptr
+        Pointer to the abstract element
+    offset : c_size_t
+        The first dimension
+    num_var : c_size_t
+        The number of dimensions
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the new zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        zonoml_dense_of_abstract0_c = zonoml_api.zonoml_dense_of_abstract0
+        zonoml_dense_of_abstract0_c.restype = c_void_p
+        zonoml_dense_of_abstract0_c.argtypes = [ElinaManagerPtr, ElinaAbstract0Ptr, c_size_t, c_size_t]
+        res = zonoml_dense_of_abstract0_c(man, element, offset, num_var)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_of_abstract0" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_dense_to_abstract0(man, dense):
+    """
+    Abstract element of a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    Returns
+    -------
+    res : ElinaAbstract0Ptr
+        Pointer to the new abstract object
+
+    """
+
+    res = None
+    try:
+        zonoml_dense_to_abstract0_c = zonoml_api.zonoml_dense_to_abstract0
+        zonoml_dense_to_abstract0_c.restype = ElinaAbstract0Ptr
+        zonoml_dense_to_abstract0_c.argtypes = [ElinaManagerPtr, c_void_p]
+        res = zonoml_dense_to_abstract0_c(man, dense)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_to_abstract0" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_dense_free(dense):
+    """
+    Free a dense zonotope
+    
+    Parameters
+    ----------
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    """
+
+    try:
+        zonoml_dense_free_c = zonoml_api.zonoml_dense_free
+        zonoml_dense_free_c.restype = None
+        zonoml_dense_free_c.argtypes = [c_void_p]
+        zonoml_dense_free_c(dense)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_free" from "libzonoml.so"')
+        print(inst)
+
+
+def zonoml_dense_get_num_gen(dense):
+    """
+    Number of noise symbols of a dense zonotope
+    
+    Parameters
+    ----------
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    Returns
+    -------
+    res : c_size_t
+        Number of columns of the generator matrix
+
+    """
+
+    res = None
+    try:
+        zonoml_dense_get_num_gen_c = zonoml_api.zonoml_dense_get_num_gen
+        zonoml_dense_get_num_gen_c.restype = c_size_t
+        zonoml_dense_get_num_gen_c.argtypes = [c_void_p]
+        res = zonoml_dense_get_num_gen_c(dense)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_get_num_gen" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def ffn_matmult_zono_dense(man, destructive, dense, weights, bias, num_out):
+    """
+    FFN Matrix multiplication of a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t of the input layer
+    weights : _doublepp
+        weight matrix
+    bias : POINTER(double)
+        bias vector
+    num_out : c_size_t
+        number of output neurons
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the zonoml_dense_t of the output layer
+
+    """
+
+    res = None
+    try:
+        ffn_matmult_zono_dense_c = zonoml_api.ffn_matmult_zono_dense
+        ffn_matmult_zono_dense_c.restype = c_void_p
+        ffn_matmult_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p, _doublepp, ndpointer(ctypes.c_double), c_size_t]
+        res = ffn_matmult_zono_dense_c(man, destructive, dense, weights, bias, num_out)
+    except Exception as inst:
+        print('Problem with loading/calling "ffn_matmult_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def model_matmult_zono_dense(man, destructive, dense, model, layerno):
+    """
+    Matrix multiplication of a dense zonotope by a layer of a network model
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t of the input layer
+    model : c_void_p
+        Pointer to the elina_nn_model_t
+    layerno : c_size_t
+        index of the layer in the model
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the zonoml_dense_t of the output layer
+
+    """
+
+    res = None
+    try:
+        model_matmult_zono_dense_c = zonoml_api.model_matmult_zono_dense
+        model_matmult_zono_dense_c.restype = c_void_p
+        model_matmult_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p, c_void_p, c_size_t]
+        res = model_matmult_zono_dense_c(man, destructive, dense, model, layerno)
+    except Exception as inst:
+        print('Problem with loading/calling "model_matmult_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def relu_zono_dense(man, destructive, dense):
+    """
+    Performs the ReLU operation on every neuron of a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the resulting zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        relu_zono_dense_c = zonoml_api.relu_zono_dense
+        relu_zono_dense_c.restype = c_void_p
+        relu_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p]
+        res = relu_zono_dense_c(man, destructive, dense)
+    except Exception as inst:
+        print('Problem with loading/calling "relu_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def sigmoid_zono_dense(man, destructive, dense):
+    """
+    Performs the Sigmoid operation on every neuron of a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the resulting zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        sigmoid_zono_dense_c = zonoml_api.sigmoid_zono_dense
+        sigmoid_zono_dense_c.restype = c_void_p
+        sigmoid_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p]
+        res = sigmoid_zono_dense_c(man, destructive, dense)
+    except Exception as inst:
+        print('Problem with loading/calling "sigmoid_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def tanh_zono_dense(man, destructive, dense):
+    """
+    Performs the Tanh operation on every neuron of a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the resulting zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        tanh_zono_dense_c = zonoml_api.tanh_zono_dense
+        tanh_zono_dense_c.restype = c_void_p
+        tanh_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p]
+        res = tanh_zono_dense_c(man, destructive, dense)
+    except Exception as inst:
+        print('Problem with loading/calling "tanh_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def maxpool_zono_dense(man, destructive, dense, pool_size, input_size, strides, is_valid_padding):
+    """
+    Performs the Maxpool operation on a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t of the input layer
+    pool_size : POINTER(c_size_t)
+        The size of the Maxpool filter
+    input_size : POINTER(c_size_t)
+        The shape of the input layer
+    strides : POINTER(c_size_t)
+        The size of the sliding window
+    is_valid_padding : c_bool
+        whether the padding is valid or same
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the zonoml_dense_t of the output layer
+
+    """
+
+    res = None
+    try:
+        maxpool_zono_dense_c = zonoml_api.maxpool_zono_dense
+        maxpool_zono_dense_c.restype = c_void_p
+        maxpool_zono_dense_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p, POINTER(c_size_t), POINTER(c_size_t), POINTER(c_size_t), c_bool]
+        res = maxpool_zono_dense_c(man, destructive, dense, pool_size, input_size, strides, is_valid_padding)
+    except Exception as inst:
+        print('Problem with loading/calling "maxpool_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def zonoml_dense_reduce_order(man, destructive, dense, max_gen):
+    """
+    Box the generators of a dense zonotope that contribute the least until at most max(max_gen, number of neurons) are left
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    destructive : c_bool
+        Boolean flag
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+    max_gen : c_size_t
+        Maximal number of generators.
+
+    Returns
+    -------
+    res : c_void_p
+        Pointer to the resulting zonoml_dense_t
+
+    """
+
+    res = None
+    try:
+        zonoml_dense_reduce_order_c = zonoml_api.zonoml_dense_reduce_order
+        zonoml_dense_reduce_order_c.restype = c_void_p
+        zonoml_dense_reduce_order_c.argtypes = [ElinaManagerPtr, c_bool, c_void_p, c_size_t]
+        res = zonoml_dense_reduce_order_c(man, destructive, dense, max_gen)
+    except Exception as inst:
+        print('Problem with loading/calling "zonoml_dense_reduce_order" from "libzonoml.so"')
+        print(inst)
+
+    return res
+
+
+def is_greater_zono_dense(man, dense, y, x):
+    """
+    Check if y is strictly greater than x in a dense zonotope
+    
+    Parameters
+    ----------
+    man : ElinaManagerPtr
+        Pointer to the ElinaManager.
+    dense : c_void_p
+        Pointer to the zonoml_dense_t
+    y : ElinaDim
+        The dimension y in the constraint y-x>0.
+    x : ElinaDim
+        The dimension x in the constraint y-x>0.
+
+    Returns
+    -------
+    res : c_bool
+        whether y-x>0 holds
+
+    """
+
+    res = None
+    try:
+        is_greater_zono_dense_c = zonoml_api.is_greater_zono_dense
+        is_greater_zono_dense_c.restype = c_bool
+        is_greater_zono_dense_c.argtypes = [ElinaManagerPtr, c_void_p, ElinaDim, ElinaDim]
+        res = is_greater_zono_dense_c(man, dense, y, x)
+    except Exception as inst:
+        print('Problem with loading/calling "is_greater_zono_dense" from "libzonoml.so"')
+        print(inst)
+
+    return res
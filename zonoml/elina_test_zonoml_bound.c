@@ -0,0 +1,126 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Bounds before and after the layer bound pass: analyses a random ReLU network on an
+   MNIST-sized input box with the affine zonotopes. Before each layer the bounds of its
+   inputs are read, ffn_matmult_zono re-bounds them, and the new bounds must be contained
+   in the old ones and contain the values of sampled inputs. */
+
+#include <stdio.h>
+#include <math.h>
+#include "zonoml.h"
+#include "elina_test_zonoml_network.h"
+
+/* values[s*num_hidden+i] is neuron i of the first num_layers layers for sample s */
+static void sample_layer(network_t *net, double *samples, size_t num_layers, double *values){
+	size_t s;
+	for(s=0; s < NUM_SAMPLES; s++){
+		network_eval(net, samples + s*NUM_INPUT, num_layers, values + s*net->num_hidden);
+	}
+}
+
+static void get_bounds(elina_manager_t *man, elina_abstract0_t *abs, size_t offset, size_t size, double *lb, double *ub){
+	size_t i;
+	for(i=0; i < size; i++){
+		elina_interval_t *itv = elina_abstract0_bound_dimension(man, abs, offset + i);
+		lb[i] = itv->inf->val.dbl;
+		ub[i] = itv->sup->val.dbl;
+		elina_interval_free(itv);
+	}
+}
+
+
+int main(int argc, char **argv){
+	size_t num_hidden = argc > 1 ? (size_t)atol(argv[1]) : 128;
+	size_t num_layers = argc > 2 ? (size_t)atol(argv[2]) : 4;
+	elina_manager_t *man = zonoml_manager_alloc();
+	double *samples = (double *)malloc(NUM_SAMPLES*NUM_INPUT*sizeof(double));
+	double *values = (double *)malloc(NUM_SAMPLES*num_hidden*sizeof(double));
+	double *lb = (double *)malloc(num_hidden*sizeof(double));
+	double *ub = (double *)malloc(num_hidden*sizeof(double));
+	double *new_lb = (double *)malloc(num_hidden*sizeof(double));
+	double *new_ub = (double *)malloc(num_hidden*sizeof(double));
+	size_t s, l, i, offset = 0, num_in = NUM_INPUT;
+	int res = 0;
+	srand(0);
+	network_t *net = network_alloc(num_hidden, num_layers);
+	for(s=0; s < NUM_SAMPLES; s++){
+		network_sample_input(net, s, samples + s*NUM_INPUT);
+	}
+	elina_abstract0_t *abs = zonotope_from_network_input(man, 0, NUM_INPUT, net->inf, net->sup);
+	printf("%zu inputs, %zu ReLU layers of %zu neurons\n", (size_t)NUM_INPUT, num_layers, num_hidden);
+	printf("%6s %10s %14s %14s %10s %10s\n", "layer", "tightened", "max tightening", "width", "widened", "violations");
+	for(l=0; l < num_layers; l++){
+		elina_dimchange_t *dimchange = elina_dimchange_alloc(0, num_hidden);
+		for(i=0; i < num_hidden; i++){
+			dimchange->dim[i] = offset + num_in;
+		}
+		abs = elina_abstract0_add_dimensions(man, true, abs, dimchange, false);
+		elina_dimchange_free(dimchange);
+		if(l > 0){
+			get_bounds(man, abs, offset, num_in, lb, ub);
+		}
+		/* ffn_matmult_zono always works on a copy */
+		elina_abstract0_t *tmp = ffn_matmult_zono(man, false, abs, offset + num_in, net->weights[l], net->bias[l], num_hidden, offset, num_in);
+		elina_abstract0_free(man, abs);
+		abs = tmp;
+		if(l > 0){
+			/* the inputs of layer l are the outputs of layer l-1 */
+			size_t num_tightened = 0, num_widened = 0, num_violations = 0;
+			double max_tightening = 0, width = 0;
+			get_bounds(man, abs, offset, num_in, new_lb, new_ub);
+			sample_layer(net, samples, l, values);
+			for(i=0; i < num_in; i++){
+				double tightening = (new_lb[i] - lb[i]) + (ub[i] - new_ub[i]);
+				if(new_lb[i] < lb[i] || new_ub[i] > ub[i]){
+					num_widened++;
+				}
+				else if(tightening > 0){
+					num_tightened++;
+					max_tightening = fmax(max_tightening, tightening);
+				}
+				width += new_ub[i] - new_lb[i];
+				for(s=0; s < NUM_SAMPLES; s++){
+					double v = values[s*num_hidden+i];
+					if(v < new_lb[i] - 1e-9 || v > new_ub[i] + 1e-9){
+						num_violations++;
+					}
+				}
+			}
+			printf("%6zu %10zu %14.3g %14.5g %10zu %10zu\n", l, num_tightened, max_tightening, width/num_in, num_widened, num_violations);
+			if(num_widened || num_violations){
+				res = 1;
+			}
+		}
+		offset += num_in;
+		num_in = num_hidden;
+		abs = relu_zono_layerwise(man, true, abs, offset, num_in);
+	}
+	elina_abstract0_free(man, abs);
+	network_free(net);
+	free(samples);
+	free(values);
+	free(lb);
+	free(ub);
+	free(new_lb);
+	free(new_ub);
+	elina_manager_free(man);
+	return res;
+}
@@ -0,0 +1,230 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Dense zonotopes against the affine forms: analyses a random network of an affine layer,
+   a ReLU, a maxpool with SAME padding and a second affine and ReLU layer on an MNIST-sized
+   input box with both representations. After every layer the dense bounds must contain the
+   bounds of the affine forms up to rounding, and both must contain the values of sampled
+   inputs. */
+
+#include <stdio.h>
+#include <math.h>
+#include "zonoml.h"
+#include "elina_test_zonoml_network.h"
+
+/* the dense bounds may be tighter than the ones of the affine forms by this much, they are rounded differently */
+#define TOLERANCE 1e-9
+
+/* values of the concrete network for the sampled inputs, values[s*size+i] is neuron i for sample s */
+typedef struct samples_t{
+	size_t size;
+	double *values;
+}samples_t;
+
+static void samples_affine(samples_t *samples, double **weights, double *bias, size_t num_out){
+	double *values = (double *)malloc(NUM_SAMPLES*num_out*sizeof(double));
+	size_t s, i, j;
+	for(s=0; s < NUM_SAMPLES; s++){
+		double *in = samples->values + s*samples->size;
+		for(i=0; i < num_out; i++){
+			double sum = bias[i];
+			for(j=0; j < samples->size; j++){
+				sum += weights[i][j]*in[j];
+			}
+			values[s*num_out+i] = sum;
+		}
+	}
+	free(samples->values);
+	samples->values = values;
+	samples->size = num_out;
+}
+
+static void samples_relu(samples_t *samples){
+	size_t i;
+	for(i=0; i < NUM_SAMPLES*samples->size; i++){
+		samples->values[i] = fmax(samples->values[i], 0);
+	}
+}
+
+static void samples_maxpool(samples_t *samples, size_t *pool_size, size_t *input_size, size_t *strides, bool is_valid_padding){
+	size_t output_size[3];
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, pool_size, input_size[2], strides, is_valid_padding);
+	size_t num_out = output_size[0]*output_size[1]*output_size[2];
+	double *values = (double *)malloc(NUM_SAMPLES*num_out*sizeof(double));
+	size_t s, out_x, out_y, out_z, x_shift, y_shift;
+	for(s=0; s < NUM_SAMPLES; s++){
+		double *in = samples->values + s*samples->size;
+		double *out = values + s*num_out;
+		for(out_x=0; out_x < output_size[0]; out_x++){
+			for(out_y=0; out_y < output_size[1]; out_y++){
+				for(out_z=0; out_z < output_size[2]; out_z++){
+					double m = -INFINITY;
+					for(x_shift=0; x_shift < pool_size[0]; x_shift++){
+						long int x_val = (long int)(out_x*strides[0] + x_shift) - pad_top;
+						if(x_val < 0 || x_val >= (long int)input_size[0]){
+							continue;
+						}
+						for(y_shift=0; y_shift < pool_size[1]; y_shift++){
+							long int y_val = (long int)(out_y*strides[1] + y_shift) - pad_left;
+							if(y_val < 0 || y_val >= (long int)input_size[1]){
+								continue;
+							}
+							m = fmax(m, in[(x_val*input_size[1] + y_val)*input_size[2] + out_z]);
+						}
+					}
+					out[(out_x*output_size[1] + out_y)*output_size[2] + out_z] = m;
+				}
+			}
+		}
+	}
+	free(samples->values);
+	samples->values = values;
+	samples->size = num_out;
+}
+
+/* compares the dense zonotope d with the neurons offset to offset+size-1 of abs, and both with samples if it is
+   not NULL; returns false if a bound of the affine forms is not contained in the dense one or a sample is outside */
+static bool compare(elina_manager_t *man, const char *name, elina_abstract0_t *abs, size_t offset, zonoml_dense_t *d, samples_t *samples){
+	size_t size = zonoml_dense_get_num_var(d);
+	size_t i, s, num_outside = 0, num_violations = 0;
+	double max_diff = 0, width = 0;
+	for(i=0; i < size; i++){
+		elina_interval_t *itv = elina_abstract0_bound_dimension(man, abs, offset + i);
+		double lb = itv->inf->val.dbl;
+		double ub = itv->sup->val.dbl;
+		double dense_lb, dense_ub;
+		elina_interval_free(itv);
+		zonoml_dense_bound(d, i, &dense_lb, &dense_ub);
+		if(dense_lb > lb + TOLERANCE || dense_ub < ub - TOLERANCE){
+			num_outside++;
+		}
+		max_diff = fmax(max_diff, fmax(fabs(dense_lb - lb), fabs(dense_ub - ub)));
+		width += dense_ub - dense_lb;
+		for(s=0; samples!=NULL && s < NUM_SAMPLES; s++){
+			double v = samples->values[s*size+i];
+			if(v < lb - 1e-9 || v > ub + 1e-9 || v < dense_lb - 1e-9 || v > dense_ub + 1e-9){
+				num_violations++;
+			}
+		}
+	}
+	printf("%10s %8zu %8zu %12.3g %12.5g %10zu %10zu\n", name, size, zonoml_dense_get_num_gen(d), max_diff, width/size, num_outside, num_violations);
+	return num_outside==0 && num_violations==0;
+}
+
+static double ** random_weights(size_t num_out, size_t num_in){
+	double **weights = (double **)malloc(num_out*sizeof(double *));
+	size_t i, j;
+	for(i=0; i < num_out; i++){
+		weights[i] = (double *)malloc(num_in*sizeof(double));
+		for(j=0; j < num_in; j++){
+			weights[i][j] = random_double()/sqrt((double)num_in);
+		}
+	}
+	return weights;
+}
+
+/* the num_out neurons of an affine layer on the num_in neurons from offset, added after them */
+static elina_abstract0_t * affine_layer(elina_manager_t *man, elina_abstract0_t *abs, double **weights, double *bias, size_t num_out,
+					size_t offset, size_t num_in){
+	elina_dimchange_t *dimchange = elina_dimchange_alloc(0, num_out);
+	size_t i;
+	for(i=0; i < num_out; i++){
+		dimchange->dim[i] = offset + num_in;
+	}
+	abs = elina_abstract0_add_dimensions(man, true, abs, dimchange, false);
+	elina_dimchange_free(dimchange);
+	/* ffn_matmult_zono always works on a copy */
+	elina_abstract0_t *res = ffn_matmult_zono(man, false, abs, offset + num_in, weights, bias, num_out, offset, num_in);
+	elina_abstract0_free(man, abs);
+	return res;
+}
+
+
+int main(void){
+	/* the first layer is seen as a 9x9x4 image, pooled by 3x3 windows of stride 2 padded by one row and column */
+	size_t image_size[3] = {9, 9, 4};
+	size_t pool_size[3] = {3, 3, 1};
+	size_t strides[2] = {2, 2};
+	size_t pool_output_size[3];
+	size_t num_hidden = image_size[0]*image_size[1]*image_size[2];
+	size_t num_out = 10;
+	elina_manager_t *man = zonoml_manager_alloc();
+	size_t s, i, offset, num_pooled;
+	bool ok = true;
+	samples_t samples;
+	srand(0);
+	elina_nn_conv_geometry(pool_output_size, NULL, NULL, image_size, pool_size, image_size[2], strides, false);
+	num_pooled = pool_output_size[0]*pool_output_size[1]*pool_output_size[2];
+	network_t *net = network_alloc(num_hidden, 1);
+	double **weights = random_weights(num_out, num_pooled);
+	double *bias = (double *)malloc(num_out*sizeof(double));
+	for(i=0; i < num_out; i++){
+		bias[i] = 0.1*random_double();
+	}
+	samples.size = NUM_INPUT;
+	samples.values = (double *)malloc(NUM_SAMPLES*NUM_INPUT*sizeof(double));
+	for(s=0; s < NUM_SAMPLES; s++){
+		network_sample_input(net, s, samples.values + s*NUM_INPUT);
+	}
+
+	printf("%10s %8s %8s %12s %12s %10s %10s\n", "layer", "neurons", "gens", "max diff", "mean width", "outside", "violations");
+	elina_abstract0_t *abs = zonotope_from_network_input(man, 0, NUM_INPUT, net->inf, net->sup);
+	zonoml_dense_t *d = zonoml_dense_from_network_input(man, NUM_INPUT, net->inf, net->sup);
+	ok &= compare(man, "input", abs, 0, d, &samples);
+
+	abs = affine_layer(man, abs, net->weights[0], net->bias[0], num_hidden, 0, NUM_INPUT);
+	d = ffn_matmult_zono_dense(man, true, d, net->weights[0], net->bias[0], num_hidden);
+	offset = NUM_INPUT;
+	samples_affine(&samples, net->weights[0], net->bias[0], num_hidden);
+	ok &= compare(man, "affine", abs, offset, d, &samples);
+	abs = relu_zono_layerwise(man, true, abs, offset, num_hidden);
+	d = relu_zono_dense(man, true, d);
+	samples_relu(&samples);
+	ok &= compare(man, "relu", abs, offset, d, &samples);
+
+	abs = maxpool_zono(man, true, abs, pool_size, image_size, offset, strides, 3, offset + num_hidden, false);
+	d = maxpool_zono_dense(man, true, d, pool_size, image_size, strides, false);
+	offset += num_hidden;
+	samples_maxpool(&samples, pool_size, image_size, strides, false);
+	ok &= compare(man, "maxpool", abs, offset, d, &samples);
+
+	abs = affine_layer(man, abs, weights, bias, num_out, offset, num_pooled);
+	d = ffn_matmult_zono_dense(man, true, d, weights, bias, num_out);
+	offset += num_pooled;
+	samples_affine(&samples, weights, bias, num_out);
+	ok &= compare(man, "affine", abs, offset, d, &samples);
+	abs = relu_zono_layerwise(man, true, abs, offset, num_out);
+	d = relu_zono_dense(man, true, d);
+	samples_relu(&samples);
+	ok &= compare(man, "relu", abs, offset, d, &samples);
+
+	zonoml_dense_free(d);
+	elina_abstract0_free(man, abs);
+	for(i=0; i < num_out; i++){
+		free(weights[i]);
+	}
+	free(weights);
+	free(bias);
+	free(samples.values);
+	network_free(net);
+	elina_manager_free(man);
+	return ok ? 0 : 1;
+}
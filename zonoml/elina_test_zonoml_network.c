@@ -0,0 +1,107 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+#include <string.h>
+#include <math.h>
+#include "elina_test_zonoml_network.h"
+
+double random_unit(void){
+	double r = rand();
+	return r/RAND_MAX;
+}
+
+double random_double(void){
+	return 2.0*random_unit() - 1.0;
+}
+
+network_t * network_alloc(size_t num_hidden, size_t num_layers){
+	network_t *net = (network_t *)malloc(sizeof(network_t));
+	size_t l, i, j;
+	net->num_hidden = num_hidden;
+	net->num_layers = num_layers;
+	net->weights = (double ***)malloc(num_layers*sizeof(double **));
+	net->bias = (double **)malloc(num_layers*sizeof(double *));
+	for(l=0; l < num_layers; l++){
+		size_t num_in = l==0 ? NUM_INPUT : num_hidden;
+		net->weights[l] = (double **)malloc(num_hidden*sizeof(double *));
+		net->bias[l] = (double *)malloc(num_hidden*sizeof(double));
+		for(i=0; i < num_hidden; i++){
+			net->weights[l][i] = (double *)malloc(num_in*sizeof(double));
+			for(j=0; j < num_in; j++){
+				net->weights[l][i][j] = random_double()/sqrt((double)num_in);
+			}
+			net->bias[l][i] = 0.1*random_double();
+		}
+	}
+	net->inf = (double *)malloc(NUM_INPUT*sizeof(double));
+	net->sup = (double *)malloc(NUM_INPUT*sizeof(double));
+	for(i=0; i < NUM_INPUT; i++){
+		double c = random_unit();
+		net->inf[i] = c - 0.01;
+		net->sup[i] = c + 0.01;
+	}
+	return net;
+}
+
+void network_free(network_t *net){
+	size_t l, i;
+	for(l=0; l < net->num_layers; l++){
+		for(i=0; i < net->num_hidden; i++){
+			free(net->weights[l][i]);
+		}
+		free(net->weights[l]);
+		free(net->bias[l]);
+	}
+	free(net->weights);
+	free(net->bias);
+	free(net->inf);
+	free(net->sup);
+	free(net);
+}
+
+void network_sample_input(network_t *net, size_t s, double *x){
+	size_t i;
+	for(i=0; i < NUM_INPUT; i++){
+		double t = random_unit();
+		if(s%2){
+			t = t < 0.5 ? 0 : 1;
+		}
+		x[i] = net->inf[i] + t*(net->sup[i] - net->inf[i]);
+	}
+}
+
+void network_eval(network_t *net, double *x, size_t num_layers, double *y){
+	double *z = (double *)malloc(net->num_hidden*sizeof(double));
+	double *in = x;
+	size_t l, i, j, num_in = NUM_INPUT;
+	for(l=0; l < num_layers; l++){
+		for(i=0; i < net->num_hidden; i++){
+			double sum = net->bias[l][i];
+			for(j=0; j < num_in; j++){
+				sum += net->weights[l][i][j]*in[j];
+			}
+			z[i] = sum > 0 ? sum : 0;
+		}
+		memcpy(y, z, net->num_hidden*sizeof(double));
+		in = y;
+		num_in = net->num_hidden;
+	}
+	free(z);
+}
@@ -0,0 +1,57 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Random ReLU networks on an MNIST-sized input box, shared by the zonoml tests. */
+
+#ifndef _ELINA_TEST_ZONOML_NETWORK_H_
+#define _ELINA_TEST_ZONOML_NETWORK_H_
+
+#include <stdlib.h>
+
+#define NUM_INPUT 784
+#define NUM_SAMPLES 100
+
+typedef struct network_t{
+	size_t num_hidden;
+	size_t num_layers;
+	double ***weights;
+	double **bias;
+	double *inf;
+	double *sup;
+}network_t;
+
+/* uniform in [0,1] */
+double random_unit(void);
+
+/* uniform in [-1,1] */
+double random_double(void);
+
+/* num_layers ReLU layers of num_hidden neurons and an L_oo ball of radius 0.01 around a random image */
+network_t * network_alloc(size_t num_hidden, size_t num_layers);
+
+void network_free(network_t *net);
+
+/* sets x to a random input of the box of net, the odd samples s are corners of the box */
+void network_sample_input(network_t *net, size_t s, double *x);
+
+/* sets y to the outputs of layer num_layers-1 of net for the input x */
+void network_eval(network_t *net, double *x, size_t num_layers, double *y);
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+/* Precision versus time of the order reduction: analyses a random ReLU network on an
+   MNIST-sized input box with the dense zonotopes for several max_gen and checks that the
+   bounds contain the outputs of sampled inputs. */
+
+#include <stdio.h>
+#include <time.h>
+#include "zonoml.h"
+#include "elina_test_zonoml_network.h"
+
+static double elapsed(struct timespec *start, struct timespec *end){
+	return (double)(end->tv_sec - start->tv_sec) + 1e-9*(double)(end->tv_nsec - start->tv_nsec);
+}
+
+/* number of outputs of sampled inputs outside of [lb,ub] */
+static size_t count_violations(network_t *net, double *lb, double *ub){
+	double *x = (double *)malloc(NUM_INPUT*sizeof(double));
+	double *y = (double *)malloc(net->num_hidden*sizeof(double));
+	size_t s, i, res = 0;
+	for(s=0; s < NUM_SAMPLES; s++){
+		network_sample_input(net, s, x);
+		network_eval(net, x, net->num_layers, y);
+		for(i=0; i < net->num_hidden; i++){
+			if(y[i] < lb[i] - 1e-9 || y[i] > ub[i] + 1e-9){
+				res++;
+			}
+		}
+	}
+	free(x);
+	free(y);
+	return res;
+}
+
+/* analyses net with max_gen, returns the sum of the widths of the outputs */
+static double analyse(elina_manager_t *man, network_t *net, size_t max_gen, double *time, size_t *num_gen, size_t *num_violations){
+	double *lb = (double *)malloc(net->num_hidden*sizeof(double));
+	double *ub = (double *)malloc(net->num_hidden*sizeof(double));
+	struct timespec start, end;
+	double res = 0;
+	size_t l, i;
+	zonoml_manager_set_max_generators(man, max_gen);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	zonoml_dense_t *d = zonoml_dense_from_network_input(man, NUM_INPUT, net->inf, net->sup);
+	for(l=0; l < net->num_layers; l++){
+		d = ffn_matmult_zono_dense(man, true, d, net->weights[l], net->bias[l], net->num_hidden);
+		d = relu_zono_dense(man, true, d);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	*time = elapsed(&start, &end);
+	*num_gen = zonoml_dense_get_num_gen(d);
+	for(i=0; i < net->num_hidden; i++){
+		zonoml_dense_bound(d, i, lb + i, ub + i);
+		res += ub[i] - lb[i];
+	}
+	*num_violations = count_violations(net, lb, ub);
+	zonoml_dense_free(d);
+	free(lb);
+	free(ub);
+	return res;
+}
+
+
+int main(int argc, char **argv){
+	size_t num_hidden = argc > 1 ? (size_t)atol(argv[1]) : 256;
+	size_t num_layers = argc > 2 ? (size_t)atol(argv[2]) : 6;
+	/* thresholds in percent of the number of generators without reduction */
+	size_t percent[] = {100, 75, 50, 35, 25};
+	size_t num_percent = sizeof(percent)/sizeof(percent[0]);
+	elina_manager_t *man = zonoml_manager_alloc();
+	size_t p, num_gen, full_gen, num_violations;
+	double time, full_time, full_width;
+	int res = 0;
+	srand(0);
+	network_t *net = network_alloc(num_hidden, num_layers);
+	full_width = analyse(man, net, 0, &full_time, &full_gen, &num_violations);
+	printf("%zu inputs, %zu ReLU layers of %zu neurons, %zu generators without reduction\n",
+	       (size_t)NUM_INPUT, num_layers, num_hidden, full_gen);
+	printf("%8s %8s %10s %10s %12s %10s\n", "max_gen", "gens", "time (s)", "speedup", "mean width", "widening");
+	for(p=0; p < num_percent; p++){
+		size_t max_gen = full_gen*percent[p]/100;
+		double width = p==0 ? full_width : analyse(man, net, max_gen, &time, &num_gen, &num_violations);
+		if(p==0){
+			time = full_time;
+			num_gen = full_gen;
+			max_gen = 0;
+		}
+		printf("%8zu %8zu %10.3f %10.2f %12.5g %10.3f", max_gen, num_gen, time, full_time/time, width/num_hidden, width/full_width);
+		if(num_violations){
+			printf(" UNSOUND (%zu)", num_violations);
+			res = 1;
+		}
+		printf("\n");
+	}
+	network_free(net);
+	elina_manager_free(man);
+	return res;
+}
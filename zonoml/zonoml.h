@@ -36,9 +36,21 @@ extern "C" {
 #endif
 
 #include "elina_generic.h"
+#include "elina_nn_model.h"
 
 elina_manager_t* zonoml_manager_alloc(void);
 
+void zonoml_manager_set_num_threads(elina_manager_t* man, size_t num_threads);
+
+size_t zonoml_manager_get_num_threads(elina_manager_t* man);
+
+void zonoml_manager_get_busy_time(elina_manager_t* man, double *busy_time);
+
+void zonoml_manager_reset_busy_time(elina_manager_t* man);
+
+// the layerwise transformers and the dense activations reduce the layers with more than max_gen noise symbols, see zono_reduce_order
+void zonoml_manager_set_max_generators(elina_manager_t* man, size_t max_gen);
+
 elina_abstract0_t *relu_zono(elina_manager_t* man, bool destructive, elina_abstract0_t * abs, elina_dim_t x);
 
 elina_abstract0_t *relu_zono_refined(elina_manager_t* man, bool destructive, elina_abstract0_t * abs,  elina_dim_t x, double new_inf, double new_sup);
@@ -55,6 +67,10 @@ elina_abstract0_t* ffn_matmult_zono(elina_manager_t * man, bool destructive, eli
 elina_abstract0_t* conv_matmult_zono(elina_manager_t* man, bool destructive, elina_abstract0_t* element, elina_dim_t start_offset, double *filter_weights, double * filter_bias,  
 				      size_t * input_size, size_t expr_offset, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias);
 
+// the rows of layer layerno of model, with input i at dimension expr_offset+i, are assigned to start_offset and the following dimensions
+elina_abstract0_t* model_matmult_zono(elina_manager_t* man, bool destructive, elina_abstract0_t* element, elina_dim_t start_offset,
+				      elina_nn_model_t *model, size_t layerno, size_t expr_offset);
+
 bool is_greater(elina_manager_t *man, elina_abstract0_t *elem, elina_dim_t y, elina_dim_t x);
 
 elina_abstract0_t* zonotope_from_network_input(elina_manager_t* man, size_t intdim, size_t realdim, double* inf_array, double * sup_array);
@@ -80,6 +96,50 @@ elina_abstract0_t* ffn_add_bias_zono(elina_manager_t * man, bool destructive, el
 
 bool affine_form_is_box(elina_manager_t* man, elina_abstract0_t *abs, elina_dim_t x);
 
+// boxes the noise symbols of dimensions start_offset to start_offset+num_dim-1 that contribute the least, leaving at most max(max_gen,num_dim)
+elina_abstract0_t * zono_reduce_order(elina_manager_t *man, bool destructive, elina_abstract0_t *abs,
+				      elina_dim_t start_offset, elina_dim_t num_dim, size_t max_gen);
+
+// the neurons of one layer as a zonotope with a dense matrix of generators, see zonoml_dense.h
+typedef struct _zonoml_dense_t zonoml_dense_t;
+
+zonoml_dense_t * zonoml_dense_from_network_input(elina_manager_t *man, size_t num_var, double *inf_array, double *sup_array);
+
+// dimensions offset to offset+num_var-1 of abs, the constraints on the noise symbols are ignored
+zonoml_dense_t * zonoml_dense_of_abstract0(elina_manager_t *man, elina_abstract0_t *abs, size_t offset, size_t num_var);
+
+elina_abstract0_t * zonoml_dense_to_abstract0(elina_manager_t *man, zonoml_dense_t *d);
+
+zonoml_dense_t * zonoml_dense_copy(zonoml_dense_t *d);
+
+void zonoml_dense_free(zonoml_dense_t *d);
+
+size_t zonoml_dense_get_num_var(zonoml_dense_t *d);
+
+size_t zonoml_dense_get_num_gen(zonoml_dense_t *d);
+
+void zonoml_dense_bound(zonoml_dense_t *d, size_t i, double *inf, double *sup);
+
+// the following return the neurons of the next layer, the input is freed if destructive
+zonoml_dense_t * ffn_matmult_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+					double **weights, double *bias, size_t num_out);
+
+zonoml_dense_t * model_matmult_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+					  elina_nn_model_t *model, size_t layerno);
+
+zonoml_dense_t * relu_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d);
+
+zonoml_dense_t * sigmoid_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d);
+
+zonoml_dense_t * tanh_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d);
+
+zonoml_dense_t * maxpool_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+				    size_t *pool_size, size_t *input_size, size_t *strides, bool is_valid_padding);
+
+zonoml_dense_t * zonoml_dense_reduce_order(elina_manager_t *man, bool destructive, zonoml_dense_t *d, size_t max_gen);
+
+bool is_greater_zono_dense(elina_manager_t *man, zonoml_dense_t *d, elina_dim_t y, elina_dim_t x);
+
 static inline long int max(long int a, long int b){
 	return a > b ? a : b;
 }
@@ -0,0 +1,883 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+#include "zonoml_dense.h"
+
+
+static zonoml_dense_t * zonoml_dense_alloc(size_t num_var, size_t num_gen, size_t ld){
+	zonoml_dense_t *d = (zonoml_dense_t *)malloc(sizeof(zonoml_dense_t));
+	d->num_var = num_var;
+	d->num_gen = num_gen;
+	d->ld = ld;
+	d->c_inf = (double *)calloc(num_var, sizeof(double));
+	d->c_sup = (double *)calloc(num_var, sizeof(double));
+	d->box_inf = (double *)calloc(num_var, sizeof(double));
+	d->box_sup = (double *)calloc(num_var, sizeof(double));
+	d->gen_inf = (double *)calloc(num_var*ld, sizeof(double));
+	d->gen_sup = (double *)calloc(num_var*ld, sizeof(double));
+	d->nsym = (zonotope_noise_symbol_t **)calloc(ld, sizeof(zonotope_noise_symbol_t *));
+	return d;
+}
+
+
+void zonoml_dense_free(zonoml_dense_t *d){
+	free(d->c_inf);
+	free(d->c_sup);
+	free(d->box_inf);
+	free(d->box_sup);
+	free(d->gen_inf);
+	free(d->gen_sup);
+	free(d->nsym);
+	free(d);
+}
+
+
+zonoml_dense_t * zonoml_dense_copy(zonoml_dense_t *d){
+	zonoml_dense_t *res = zonoml_dense_alloc(d->num_var, d->num_gen, d->ld);
+	memcpy(res->c_inf, d->c_inf, d->num_var*sizeof(double));
+	memcpy(res->c_sup, d->c_sup, d->num_var*sizeof(double));
+	memcpy(res->box_inf, d->box_inf, d->num_var*sizeof(double));
+	memcpy(res->box_sup, d->box_sup, d->num_var*sizeof(double));
+	memcpy(res->gen_inf, d->gen_inf, d->num_var*d->ld*sizeof(double));
+	memcpy(res->gen_sup, d->gen_sup, d->num_var*d->ld*sizeof(double));
+	memcpy(res->nsym, d->nsym, d->num_gen*sizeof(zonotope_noise_symbol_t *));
+	return res;
+}
+
+
+size_t zonoml_dense_get_num_var(zonoml_dense_t *d){
+	return d->num_var;
+}
+
+
+size_t zonoml_dense_get_num_gen(zonoml_dense_t *d){
+	return d->num_gen;
+}
+
+
+void zonoml_dense_bound(zonoml_dense_t *d, size_t i, double *inf, double *sup){
+	*inf = -d->box_inf[i];
+	*sup = d->box_sup[i];
+}
+
+
+/* appends num columns with fresh noise symbols, moving the rows only if there is no room
+   left, and returns the first one */
+static size_t zonoml_dense_add_columns(zonotope_internal_t *pr, zonoml_dense_t *d, size_t num){
+	size_t first = d->num_gen;
+	size_t num_gen = first + num;
+	size_t i, k;
+	if(num_gen > d->ld){
+		size_t ld = num_gen + d->num_var;
+		double *gen_inf = (double *)calloc(d->num_var*ld, sizeof(double));
+		double *gen_sup = (double *)calloc(d->num_var*ld, sizeof(double));
+		for(i=0; i < d->num_var; i++){
+			memcpy(gen_inf + i*ld, d->gen_inf + i*d->ld, first*sizeof(double));
+			memcpy(gen_sup + i*ld, d->gen_sup + i*d->ld, first*sizeof(double));
+		}
+		free(d->gen_inf);
+		free(d->gen_sup);
+		d->gen_inf = gen_inf;
+		d->gen_sup = gen_sup;
+		d->nsym = (zonotope_noise_symbol_t **)realloc(d->nsym, ld*sizeof(zonotope_noise_symbol_t *));
+		d->ld = ld;
+	}
+	uint_t nsym_first = zonotope_noise_symbol_reserve(pr, num);
+	for(k=first; k < num_gen; k++){
+		d->nsym[k] = zonotope_noise_symbol_add_with_index(pr, IN, nsym_first + (k - first));
+	}
+	d->num_gen = num_gen;
+	return first;
+}
+
+
+/* sets the box of row i to itv met with the bound given by its generators */
+static void zonoml_dense_set_box(zonoml_dense_t *d, size_t i, double itv_inf, double itv_sup){
+	double *g_inf = d->gen_inf + i*d->ld;
+	double *g_sup = d->gen_sup + i*d->ld;
+	double sum = 0;
+	size_t k;
+	for(k=0; k < d->num_gen; k++){
+		sum += fmax(fabs(g_inf[k]), fabs(g_sup[k]));
+	}
+	d->box_inf[i] = fmin(itv_inf, d->c_inf[i] + sum);
+	d->box_sup[i] = fmin(itv_sup, d->c_sup[i] + sum);
+}
+
+
+/* negated lower bound of x_j - x_k */
+static double zonoml_dense_diff_inf(zonoml_dense_t *d, size_t j, size_t k){
+	double *gj_inf = d->gen_inf + j*d->ld;
+	double *gj_sup = d->gen_sup + j*d->ld;
+	double *gk_inf = d->gen_inf + k*d->ld;
+	double *gk_sup = d->gen_sup + k*d->ld;
+	double res = d->c_inf[j] + d->c_sup[k];
+	size_t t;
+	for(t=0; t < d->num_gen; t++){
+		res += fmax(fabs(gj_inf[t] + gk_sup[t]), fabs(gj_sup[t] + gk_inf[t]));
+	}
+	return fmin(res, d->box_inf[j] + d->box_sup[k]);
+}
+
+
+zonoml_dense_t * zonoml_dense_from_network_input(elina_manager_t *man, size_t num_var, double *inf_array, double *sup_array){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_OF_BOX);
+	size_t i, num_gen = 0;
+	for(i=0; i < num_var; i++){
+		if(inf_array[i]!=sup_array[i]){
+			num_gen++;
+		}
+	}
+	zonoml_dense_t *d = zonoml_dense_alloc(num_var, 0, num_gen + num_var);
+	size_t col = zonoml_dense_add_columns(pr, d, num_gen);
+	for(i=0; i < num_var; i++){
+		d->box_inf[i] = -inf_array[i];
+		d->box_sup[i] = sup_array[i];
+		if(inf_array[i]==sup_array[i]){
+			d->c_inf[i] = -inf_array[i];
+			d->c_sup[i] = sup_array[i];
+		}
+		else{
+			elina_interval_middev(d->c_inf + i, d->c_sup + i, d->gen_inf + i*d->ld + col, d->gen_sup + i*d->ld + col,
+					      -inf_array[i], sup_array[i]);
+			col++;
+		}
+	}
+	record_timing(zonoml_network_input_time);
+	return d;
+}
+
+
+static int zonoml_dense_nsym_cmp(const void *a, const void *b){
+	uint_t ia = (*(zonotope_noise_symbol_t * const *)a)->index;
+	uint_t ib = (*(zonotope_noise_symbol_t * const *)b)->index;
+	return ia < ib ? -1 : (ia > ib);
+}
+
+
+static zonoml_dense_t * zonoml_dense_of_zonotope(zonotope_t *z, size_t offset, size_t num_var){
+	zonotope_aaterm_t *p;
+	size_t i, num_terms = 0, num_gen = 0;
+	for(i=0; i < num_var; i++){
+		num_terms += z->paf[offset+i]->l;
+	}
+	/* the columns are the noise symbols of the dimensions in the order of their index */
+	zonotope_noise_symbol_t **nsym = (zonotope_noise_symbol_t **)malloc((num_terms+1)*sizeof(zonotope_noise_symbol_t *));
+	for(i=0; i < num_var; i++){
+		for(p=z->paf[offset+i]->q; p < z->paf[offset+i]->q + z->paf[offset+i]->l; p++){
+			nsym[num_gen++] = p->pnsym;
+		}
+	}
+	qsort(nsym, num_gen, sizeof(zonotope_noise_symbol_t *), zonoml_dense_nsym_cmp);
+	num_terms = num_gen;
+	num_gen = 0;
+	for(i=0; i < num_terms; i++){
+		if(num_gen==0 || nsym[num_gen-1]->index!=nsym[i]->index){
+			nsym[num_gen++] = nsym[i];
+		}
+	}
+	zonoml_dense_t *d = zonoml_dense_alloc(num_var, num_gen, num_gen + num_var);
+	memcpy(d->nsym, nsym, num_gen*sizeof(zonotope_noise_symbol_t *));
+	free(nsym);
+	for(i=0; i < num_var; i++){
+		zonotope_aff_t *aff = z->paf[offset+i];
+		d->c_inf[i] = aff->c_inf;
+		d->c_sup[i] = aff->c_sup;
+		d->box_inf[i] = z->box_inf[offset+i];
+		d->box_sup[i] = z->box_sup[offset+i];
+		size_t low = 0;
+		for(p=aff->q; p < aff->q + aff->l; p++){
+			/* the terms are sorted by index too */
+			size_t high = num_gen;
+			while(low < high){
+				size_t mid = (low + high)/2;
+				if(d->nsym[mid]->index < p->pnsym->index){
+					low = mid + 1;
+				}
+				else{
+					high = mid;
+				}
+			}
+			d->gen_inf[i*d->ld + low] = p->inf;
+			d->gen_sup[i*d->ld + low] = p->sup;
+		}
+	}
+	return d;
+}
+
+
+zonoml_dense_t * zonoml_dense_of_abstract0(elina_manager_t *man, elina_abstract0_t *abs, size_t offset, size_t num_var){
+	return zonoml_dense_of_zonotope(zonotope_of_abstract0(abs), offset, num_var);
+}
+
+
+/* the affine form of row i */
+static zonotope_aff_t * zonoml_dense_row_to_aff(zonotope_internal_t *pr, zonoml_dense_t *d, size_t i){
+	zonotope_aff_t *aff = zonotope_aff_alloc_init(pr);
+	double *g_inf = d->gen_inf + i*d->ld;
+	double *g_sup = d->gen_sup + i*d->ld;
+	size_t k;
+	aff->c_inf = d->c_inf[i];
+	aff->c_sup = d->c_sup[i];
+	for(k=0; k < d->num_gen; k++){
+		if(g_inf[k]!=0 || g_sup[k]!=0){
+			zonotope_aff_push_term(aff, d->nsym[k], g_inf[k], g_sup[k]);
+		}
+	}
+	aff->itv_inf = d->box_inf[i];
+	aff->itv_sup = d->box_sup[i];
+	return aff;
+}
+
+
+elina_abstract0_t * zonoml_dense_to_abstract0(elina_manager_t *man, zonoml_dense_t *d){
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_UNKNOWN);
+	zonotope_t *z = zonotope_alloc(man, 0, d->num_var);
+	size_t i;
+	for(i=0; i < d->num_var; i++){
+		z->paf[i] = zonoml_dense_row_to_aff(pr, d, i);
+		z->paf[i]->pby++;
+		z->box_inf[i] = d->box_inf[i];
+		z->box_sup[i] = d->box_sup[i];
+	}
+	man->result.flag_best = false;
+	man->result.flag_exact = false;
+	return abstract0_of_zonotope(man, z);
+}
+
+
+/* res = res + w*[inf,sup] for a point w, as zonotope_aff_mul_weight followed by zonotope_aff_add */
+static inline void zonoml_dense_axpy(double *res_inf, double *res_sup, double w, double *inf, double *sup, size_t size){
+	size_t k;
+	if(w>0){
+		for(k=0; k < size; k++){
+			res_inf[k] += w*inf[k];
+			res_sup[k] += w*sup[k];
+		}
+	}
+	else if(w<0){
+		double mw = -w;
+		for(k=0; k < size; k++){
+			res_inf[k] += mw*sup[k];
+			res_sup[k] += mw*inf[k];
+		}
+	}
+}
+
+
+static inline double * zonoml_dense_row(zonoml_dense_matmult_t *data, size_t i, uint32_t **dim, size_t *size){
+	elina_nn_layer_t *layer = data->layer;
+	if(layer==NULL){
+		*dim = NULL;
+		*size = data->src->num_var;
+		return data->weights[i];
+	}
+	size_t row = layer->row_start[i];
+	*dim = layer->dim==NULL ? NULL : layer->dim + row;
+	*size = layer->row_start[i+1] - row;
+	return layer->weights + row;
+}
+
+
+/* the generators of the rows are computed by blocks of ZONOML_DENSE_ROW_BLOCK rows and
+   ZONOML_DENSE_COL_BLOCK columns, for dense rows a block of an input row is loaded once
+   for all the rows of the block */
+static void zonoml_dense_matmult_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_matmult_t *data = (zonoml_dense_matmult_t *)args;
+	zonoml_dense_t *src = data->src;
+	zonoml_dense_t *dst = data->dst;
+	size_t num_gen = src->num_gen;
+	double *w[ZONOML_DENSE_ROW_BLOCK];
+	uint32_t *dim[ZONOML_DENSE_ROW_BLOCK];
+	size_t size[ZONOML_DENSE_ROW_BLOCK];
+	size_t i, r, t, k;
+	for(i=start; i < end; i+=ZONOML_DENSE_ROW_BLOCK){
+		size_t num_rows = end - i < ZONOML_DENSE_ROW_BLOCK ? end - i : ZONOML_DENSE_ROW_BLOCK;
+		bool is_dense = true;
+		for(r=0; r < num_rows; r++){
+			w[r] = zonoml_dense_row(data, i+r, &dim[r], &size[r]);
+			is_dense = is_dense && dim[r]==NULL && size[r]==size[0];
+		}
+		for(k=0; k < num_gen; k+=ZONOML_DENSE_COL_BLOCK){
+			size_t num_cols = num_gen - k < ZONOML_DENSE_COL_BLOCK ? num_gen - k : ZONOML_DENSE_COL_BLOCK;
+			if(is_dense){
+				for(t=0; t < size[0]; t++){
+					double *s_inf = src->gen_inf + t*src->ld + k;
+					double *s_sup = src->gen_sup + t*src->ld + k;
+					for(r=0; r < num_rows; r++){
+						zonoml_dense_axpy(dst->gen_inf + (i+r)*dst->ld + k, dst->gen_sup + (i+r)*dst->ld + k,
+								  w[r][t], s_inf, s_sup, num_cols);
+					}
+				}
+			}
+			else{
+				for(r=0; r < num_rows; r++){
+					for(t=0; t < size[r]; t++){
+						size_t j = dim[r]==NULL ? t : dim[r][t];
+						zonoml_dense_axpy(dst->gen_inf + (i+r)*dst->ld + k, dst->gen_sup + (i+r)*dst->ld + k,
+								  w[r][t], src->gen_inf + j*src->ld + k, src->gen_sup + j*src->ld + k, num_cols);
+					}
+				}
+			}
+		}
+		for(r=0; r < num_rows; r++){
+			double bias = data->layer==NULL ? data->bias[i+r] : data->layer->bias[i+r];
+			double c_inf = 0, c_sup = 0, itv_inf = 0, itv_sup = 0;
+			for(t=0; t < size[r]; t++){
+				size_t j = dim[r]==NULL ? t : dim[r][t];
+				double wt = w[r][t];
+				if(wt>0){
+					c_inf += wt*src->c_inf[j];
+					c_sup += wt*src->c_sup[j];
+					itv_inf += wt*src->box_inf[j];
+					itv_sup += wt*src->box_sup[j];
+				}
+				else if(wt<0){
+					c_inf += -wt*src->c_sup[j];
+					c_sup += -wt*src->c_inf[j];
+					itv_inf += -wt*src->box_sup[j];
+					itv_sup += -wt*src->box_inf[j];
+				}
+			}
+			dst->c_inf[i+r] = c_inf - bias;
+			dst->c_sup[i+r] = c_sup + bias;
+			zonoml_dense_set_box(dst, i+r, itv_inf - bias, itv_sup + bias);
+		}
+	}
+}
+
+
+static zonoml_dense_t * zonoml_dense_matmult(zonotope_internal_t *pr, bool destructive, zonoml_dense_t *d,
+					     double **weights, double *bias, elina_nn_layer_t *layer, size_t num_out){
+	/* leave room for the columns added by the activation of the layer */
+	zonoml_dense_t *res = zonoml_dense_alloc(num_out, d->num_gen, d->num_gen + num_out);
+	memcpy(res->nsym, d->nsym, d->num_gen*sizeof(zonotope_noise_symbol_t *));
+	zonoml_dense_matmult_t args;
+	args.src = d;
+	args.dst = res;
+	args.weights = weights;
+	args.bias = bias;
+	args.layer = layer;
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t chunk_size = num_out/(4*num_threads*ZONOML_DENSE_ROW_BLOCK)*ZONOML_DENSE_ROW_BLOCK;
+	elina_thread_pool_for(pr->pool, zonoml_dense_matmult_chunk, &args, num_out, chunk_size==0 ? ZONOML_DENSE_ROW_BLOCK : chunk_size);
+	if(destructive){
+		zonoml_dense_free(d);
+	}
+	return res;
+}
+
+
+zonoml_dense_t * ffn_matmult_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+					double **weights, double *bias, size_t num_out){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonoml_dense_t *res = zonoml_dense_matmult(pr, destructive, d, weights, bias, NULL, num_out);
+	record_timing(zonoml_ffn_matmult_time);
+	return res;
+}
+
+
+zonoml_dense_t * model_matmult_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+					  elina_nn_model_t *model, size_t layerno){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	elina_nn_layer_t *layer = model->layers + layerno;
+	zonoml_dense_t *res = zonoml_dense_matmult(pr, destructive, d, NULL, NULL, layer, layer->num_out);
+	if(layer->type==ELINA_NN_CONV){
+		record_timing(zonoml_conv_matmult_time);
+	}
+	else{
+		record_timing(zonoml_ffn_matmult_time);
+	}
+	return res;
+}
+
+
+/* the neuron is replaced by the box [lo,hi] */
+static void zonoml_dense_set_neuron_box(zonoml_dense_neuron_t *n, double lo, double hi){
+	double mid_inf, mid_sup, dev_inf, dev_sup;
+	elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, lo, hi);
+	n->kind = ZONOML_DENSE_BOX;
+	n->lo = lo;
+	n->hi = hi;
+	n->num_col = (dev_inf!=0 || dev_sup!=0);
+}
+
+
+static void zonoml_dense_relu_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_activation_t *data = (zonoml_dense_activation_t *)args;
+	zonoml_dense_t *src = data->src;
+	size_t i;
+	for(i=start; i < end; i++){
+		zonoml_dense_neuron_t *n = data->neurons + i;
+		double inf = -src->box_inf[i];
+		double sup = src->box_sup[i];
+		n->num_col = 0;
+		if(sup<=0){
+			zonoml_dense_set_neuron_box(n, 0, 0);
+		}
+		else if(inf>=0){
+			n->kind = ZONOML_DENSE_KEEP;
+		}
+		else{
+			double bound_l;
+			if(zonoml_relu_coeffs(inf, sup, &n->lambda_l, &n->lambda_u, &bound_l, &n->hi,
+					      &n->alpha_l, &n->alpha_u, &n->beta_l, &n->beta_u)){
+				n->kind = ZONOML_DENSE_RELU_REFINED;
+				n->num_col = 2;
+			}
+			else{
+				n->kind = ZONOML_DENSE_LINEAR;
+				n->num_col = 1;
+			}
+			n->lo = 0;
+		}
+	}
+}
+
+
+static void zonoml_dense_s_curve_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_activation_t *data = (zonoml_dense_activation_t *)args;
+	zonoml_dense_t *src = data->src;
+	size_t i;
+	for(i=start; i < end; i++){
+		zonoml_dense_neuron_t *n = data->neurons + i;
+		double lo, hi;
+		if(zonoml_s_curve_coeffs(-src->box_inf[i], src->box_sup[i], data->is_sigmoid, &n->lambda_l, &n->lambda_u, &lo, &hi)){
+			n->kind = ZONOML_DENSE_LINEAR;
+			n->lo = lo;
+			n->hi = hi;
+			n->num_col = 1;
+		}
+		else{
+			zonoml_dense_set_neuron_box(n, lo, hi);
+		}
+	}
+}
+
+
+/* output neuron mat_x is the input neuron that dominates the others in its pool as in maxpool_zono,
+   or else the box of the maximum of their bounds */
+static void zonoml_dense_maxpool_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_activation_t *data = (zonoml_dense_activation_t *)args;
+	zonoml_dense_t *src = data->src;
+	size_t *pool_size = data->pool_size;
+	size_t *input_size = data->input_size;
+	size_t *output_size = data->output_size;
+	size_t *strides = data->strides;
+	size_t o12 = output_size[1]*output_size[2];
+	size_t i12 = input_size[1]*input_size[2];
+	size_t p01 = pool_size[0]*pool_size[1];
+	size_t m = input_size[0]*input_size[1]*input_size[2];
+	size_t *pool_map = (size_t *)malloc(p01*sizeof(size_t));
+	size_t mat_x, j, k;
+	for(mat_x=start; mat_x < end; mat_x++){
+		zonoml_dense_neuron_t *n = data->neurons + mat_x;
+		size_t out_x = mat_x / o12;
+		size_t out_y = (mat_x-out_x*o12) / output_size[2];
+		size_t out_z = mat_x-out_x*o12 - out_y*output_size[2];
+		size_t x_shift, y_shift, l = 0;
+		double max_u = -INFINITY;
+		double max_l = -INFINITY;
+		for(x_shift = 0; x_shift < pool_size[0]; x_shift++){
+			for(y_shift = 0; y_shift < pool_size[1]; y_shift++){
+				long int x_val = out_x*strides[0] + x_shift - data->pad_top;
+				long int y_val = out_y*strides[1] + y_shift - data->pad_left;
+				if(x_val<0 || x_val>=(long int)input_size[0] || y_val<0 || y_val>=(long int)input_size[1]){
+					continue;
+				}
+				size_t mat_offset = x_val*i12 + y_val*input_size[2] + out_z;
+				if(mat_offset>=m){
+					continue;
+				}
+				pool_map[l] = mat_offset;
+				max_u = fmax(max_u, src->box_sup[mat_offset]);
+				max_l = fmax(max_l, -src->box_inf[mat_offset]);
+				l++;
+			}
+		}
+		n->num_col = 0;
+		for(j=0; j < l; j++){
+			size_t pj = pool_map[j];
+			double inf_j = -src->box_inf[pj];
+			double sup_j = src->box_sup[pj];
+			bool g_flag = true;
+			for(k=0; k < l && g_flag; k++){
+				size_t pk = pool_map[k];
+				double inf_k = -src->box_inf[pk];
+				double sup_k = src->box_sup[pk];
+				if(k==j || ((inf_k==sup_k) && (inf_j>=sup_k)) || ((inf_j==inf_k) && (sup_j==sup_k) && (inf_j==sup_j))){
+					continue;
+				}
+				g_flag = zonoml_dense_diff_inf(src, pj, pk) < 0;
+			}
+			if(g_flag){
+				n->kind = ZONOML_DENSE_COPY;
+				n->src = pj;
+				break;
+			}
+		}
+		if(j==l){
+			zonoml_dense_set_neuron_box(n, -max_l, max_u);
+		}
+	}
+	free(pool_map);
+}
+
+
+static void zonoml_dense_apply_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_activation_t *data = (zonoml_dense_activation_t *)args;
+	zonoml_dense_t *src = data->src;
+	zonoml_dense_t *dst = data->dst;
+	size_t num_gen = data->num_gen;
+	double mid_inf, mid_sup, dev_inf, dev_sup;
+	double tmp_inf, tmp_sup;
+	size_t i, k;
+	for(i=start; i < end; i++){
+		zonoml_dense_neuron_t *n = data->neurons + i;
+		double *g_inf = dst->gen_inf + i*dst->ld;
+		double *g_sup = dst->gen_sup + i*dst->ld;
+		switch(n->kind){
+			case ZONOML_DENSE_KEEP:
+				break;
+			case ZONOML_DENSE_COPY:
+				memcpy(g_inf, src->gen_inf + n->src*src->ld, num_gen*sizeof(double));
+				memcpy(g_sup, src->gen_sup + n->src*src->ld, num_gen*sizeof(double));
+				dst->c_inf[i] = src->c_inf[n->src];
+				dst->c_sup[i] = src->c_sup[n->src];
+				dst->box_inf[i] = src->box_inf[n->src];
+				dst->box_sup[i] = src->box_sup[n->src];
+				break;
+			case ZONOML_DENSE_BOX:
+				memset(g_inf, 0, num_gen*sizeof(double));
+				memset(g_sup, 0, num_gen*sizeof(double));
+				elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, n->lo, n->hi);
+				dst->c_inf[i] = mid_inf;
+				dst->c_sup[i] = mid_sup;
+				if(n->num_col){
+					g_inf[n->col] = dev_inf;
+					g_sup[n->col] = dev_sup;
+				}
+				dst->box_inf[i] = n->lo;
+				dst->box_sup[i] = n->hi;
+				break;
+			case ZONOML_DENSE_LINEAR:
+				/* lambda*x + [lo,hi] */
+				for(k=0; k < num_gen; k++){
+					elina_double_interval_mul(g_inf + k, g_sup + k, n->lambda_l, n->lambda_u, g_inf[k], g_sup[k]);
+				}
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->lambda_l, n->lambda_u, dst->c_inf[i], dst->c_sup[i]);
+				elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, n->lo, n->hi);
+				dst->c_inf[i] = tmp_inf + mid_inf;
+				dst->c_sup[i] = tmp_sup + mid_sup;
+				g_inf[n->col] = dev_inf;
+				g_sup[n->col] = dev_sup;
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->lambda_l, n->lambda_u, dst->box_inf[i], dst->box_sup[i]);
+				dst->box_inf[i] = tmp_inf + n->lo;
+				dst->box_sup[i] = tmp_sup + n->hi;
+				break;
+			case ZONOML_DENSE_RELU_REFINED:{
+				/* beta*[0,sup] + alpha*(lambda*x + [0,bound]) as relu_zono */
+				double sup = dst->box_sup[i];
+				double box_c_inf, box_c_sup, box_itv_inf, box_itv_sup;
+				elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, 0, sup);
+				elina_double_interval_mul(&box_c_inf, &box_c_sup, n->beta_l, n->beta_u, mid_inf, mid_sup);
+				elina_double_interval_mul(&box_itv_inf, &box_itv_sup, n->beta_l, n->beta_u, 0, sup);
+				elina_double_interval_mul(g_inf + n->col + 1, g_sup + n->col + 1, n->beta_l, n->beta_u, dev_inf, dev_sup);
+				for(k=0; k < num_gen; k++){
+					elina_double_interval_mul(g_inf + k, g_sup + k, n->lambda_l, n->lambda_u, g_inf[k], g_sup[k]);
+					elina_double_interval_mul(g_inf + k, g_sup + k, n->alpha_l, n->alpha_u, g_inf[k], g_sup[k]);
+				}
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->lambda_l, n->lambda_u, dst->c_inf[i], dst->c_sup[i]);
+				elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, 0, n->hi);
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->alpha_l, n->alpha_u, tmp_inf + mid_inf, tmp_sup + mid_sup);
+				dst->c_inf[i] = box_c_inf + tmp_inf;
+				dst->c_sup[i] = box_c_sup + tmp_sup;
+				elina_double_interval_mul(g_inf + n->col, g_sup + n->col, n->alpha_l, n->alpha_u, dev_inf, dev_sup);
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->lambda_l, n->lambda_u, dst->box_inf[i], dst->box_sup[i]);
+				elina_double_interval_mul(&tmp_inf, &tmp_sup, n->alpha_l, n->alpha_u, tmp_inf, tmp_sup + n->hi);
+				zonoml_dense_set_box(dst, i, box_itv_inf + tmp_inf, box_itv_sup + tmp_sup);
+				break;
+			}
+		}
+	}
+}
+
+
+/* computes the transformer of every neuron with function, allocates the columns they need
+   and applies them to res, then reduces res to the max_gen of the manager */
+static void zonoml_dense_activation(zonotope_internal_t *pr, zonoml_dense_activation_t *args, zonoml_dense_t *res,
+				    size_t num_out, void (*function)(void *, size_t, size_t)){
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t chunk_size = num_out/(4*num_threads);
+	size_t i, num_col = 0;
+	args->neurons = (zonoml_dense_neuron_t *)malloc(num_out*sizeof(zonoml_dense_neuron_t));
+	elina_thread_pool_for(pr->pool, function, args, num_out, chunk_size==0 ? 1 : chunk_size);
+	args->num_gen = args->src->num_gen;
+	for(i=0; i < num_out; i++){
+		args->neurons[i].col = args->num_gen + num_col;
+		num_col += args->neurons[i].num_col;
+	}
+	zonoml_dense_add_columns(pr, res, num_col);
+	args->dst = res;
+	elina_thread_pool_for(pr->pool, zonoml_dense_apply_chunk, args, num_out, chunk_size==0 ? 1 : chunk_size);
+	free(args->neurons);
+	if(pr->max_gen){
+		zonoml_dense_reduce(pr, res, pr->max_gen);
+	}
+}
+
+
+zonoml_dense_t * relu_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonoml_dense_t *res = destructive ? d : zonoml_dense_copy(d);
+	zonoml_dense_activation_t args;
+	args.src = res;
+	zonoml_dense_activation(pr, &args, res, res->num_var, zonoml_dense_relu_chunk);
+	record_timing(zonoml_relu_time);
+	return res;
+}
+
+
+zonoml_dense_t * sigmoid_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonoml_dense_t *res = destructive ? d : zonoml_dense_copy(d);
+	zonoml_dense_activation_t args;
+	args.src = res;
+	args.is_sigmoid = true;
+	zonoml_dense_activation(pr, &args, res, res->num_var, zonoml_dense_s_curve_chunk);
+	record_timing(zonoml_sigmoid_time);
+	return res;
+}
+
+
+zonoml_dense_t * tanh_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonoml_dense_t *res = destructive ? d : zonoml_dense_copy(d);
+	zonoml_dense_activation_t args;
+	args.src = res;
+	args.is_sigmoid = false;
+	zonoml_dense_activation(pr, &args, res, res->num_var, zonoml_dense_s_curve_chunk);
+	record_timing(zonoml_tanh_time);
+	return res;
+}
+
+
+zonoml_dense_t * maxpool_zono_dense(elina_manager_t *man, bool destructive, zonoml_dense_t *d,
+				    size_t *pool_size, size_t *input_size, size_t *strides, bool is_valid_padding){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	size_t output_size[3];
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, pool_size, input_size[2]/pool_size[2], strides, is_valid_padding);
+	size_t num_out = output_size[0]*output_size[1]*output_size[2];
+	zonoml_dense_t *res = zonoml_dense_alloc(num_out, d->num_gen, d->num_gen + num_out);
+	memcpy(res->nsym, d->nsym, d->num_gen*sizeof(zonotope_noise_symbol_t *));
+	zonoml_dense_activation_t args;
+	args.src = d;
+	args.pool_size = pool_size;
+	args.input_size = input_size;
+	args.output_size = output_size;
+	args.strides = strides;
+	args.pad_top = pad_top;
+	args.pad_left = pad_left;
+	zonoml_dense_activation(pr, &args, res, num_out, zonoml_dense_maxpool_chunk);
+	if(destructive){
+		zonoml_dense_free(d);
+	}
+	record_timing(zonoml_maxpool_time);
+	return res;
+}
+
+
+/* Girard's score |g|_1 - |g|_oo of the columns start to end-1, the generators with a small
+   score are the ones whose boxing loses the least */
+static void zonoml_dense_score_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_reduce_t *data = (zonoml_dense_reduce_t *)args;
+	zonoml_dense_t *d = data->src;
+	size_t i, k;
+	for(k=start; k < end; k++){
+		data->score[k].score = 0;
+		data->score[k].col = k;
+		data->max_mag[k] = 0;
+	}
+	for(i=0; i < d->num_var; i++){
+		double *g_inf = d->gen_inf + i*d->ld;
+		double *g_sup = d->gen_sup + i*d->ld;
+		for(k=start; k < end; k++){
+			double mag = fmax(fabs(g_inf[k]), fabs(g_sup[k]));
+			data->score[k].score += mag;
+			data->max_mag[k] = fmax(data->max_mag[k], mag);
+		}
+	}
+	for(k=start; k < end; k++){
+		data->score[k].score -= data->max_mag[k];
+	}
+}
+
+
+static int zonoml_dense_score_cmp(const void *a, const void *b){
+	const zonoml_dense_score_t *sa = (const zonoml_dense_score_t *)a;
+	const zonoml_dense_score_t *sb = (const zonoml_dense_score_t *)b;
+	if(sa->score!=sb->score){
+		return sa->score < sb->score ? -1 : 1;
+	}
+	return sa->col < sb->col ? -1 : (sa->col > sb->col);
+}
+
+
+/* copies the kept generators of the rows start to end-1 and sums the magnitudes of the others */
+static void zonoml_dense_reduce_chunk(void *args, size_t start, size_t end){
+	zonoml_dense_reduce_t *data = (zonoml_dense_reduce_t *)args;
+	zonoml_dense_t *src = data->src;
+	zonoml_dense_t *dst = data->dst;
+	size_t i, k;
+	for(i=start; i < end; i++){
+		double *g_inf = src->gen_inf + i*src->ld;
+		double *g_sup = src->gen_sup + i*src->ld;
+		double *r_inf = dst->gen_inf + i*dst->ld;
+		double *r_sup = dst->gen_sup + i*dst->ld;
+		double mass = 0;
+		for(k=0; k < src->num_gen; k++){
+			size_t pos = data->pos[k];
+			if(pos==SIZE_MAX){
+				mass += fmax(fabs(g_inf[k]), fabs(g_sup[k]));
+			}
+			else{
+				r_inf[pos] = g_inf[k];
+				r_sup[pos] = g_sup[k];
+			}
+		}
+		data->mass[i] = mass;
+	}
+}
+
+
+/* Keeps the max_gen-num_var generators with the largest score and replaces the others of
+   each row by a fresh noise symbol, d has at most max(max_gen,num_var) generators after.
+   The centers and the boxes do not change. The columns stay in the order of the indices
+   of their noise symbols. */
+void zonoml_dense_reduce(zonotope_internal_t *pr, zonoml_dense_t *d, size_t max_gen){
+	if(d->num_gen <= max_gen){
+		return;
+	}
+	start_timing();
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t num_var = d->num_var, num_gen = d->num_gen;
+	size_t num_keep = max_gen > num_var ? max_gen - num_var : 0;
+	size_t gen_chunk = num_gen/(4*num_threads), var_chunk = num_var/(4*num_threads);
+	size_t i, k, num_col = 0;
+	zonoml_dense_reduce_t args;
+	args.src = d;
+	args.score = (zonoml_dense_score_t *)malloc(num_gen*sizeof(zonoml_dense_score_t));
+	args.max_mag = (double *)malloc(num_gen*sizeof(double));
+	args.pos = (size_t *)malloc(num_gen*sizeof(size_t));
+	args.mass = (double *)malloc(num_var*sizeof(double));
+	elina_thread_pool_for(pr->pool, zonoml_dense_score_chunk, &args, num_gen, gen_chunk==0 ? 1 : gen_chunk);
+	qsort(args.score, num_gen, sizeof(zonoml_dense_score_t), zonoml_dense_score_cmp);
+	for(k=0; k < num_gen; k++){
+		args.pos[args.score[k].col] = k < num_gen - num_keep ? SIZE_MAX : 0;
+	}
+	zonoml_dense_t *res = zonoml_dense_alloc(num_var, num_keep, num_keep + 2*num_var);
+	for(k=0; k < num_gen; k++){
+		if(args.pos[k]!=SIZE_MAX){
+			args.pos[k] = num_col;
+			res->nsym[num_col++] = d->nsym[k];
+		}
+	}
+	memcpy(res->c_inf, d->c_inf, num_var*sizeof(double));
+	memcpy(res->c_sup, d->c_sup, num_var*sizeof(double));
+	memcpy(res->box_inf, d->box_inf, num_var*sizeof(double));
+	memcpy(res->box_sup, d->box_sup, num_var*sizeof(double));
+	args.dst = res;
+	elina_thread_pool_for(pr->pool, zonoml_dense_reduce_chunk, &args, num_var, var_chunk==0 ? 1 : var_chunk);
+	num_col = 0;
+	for(i=0; i < num_var; i++){
+		if(args.mass[i]>0){
+			num_col++;
+		}
+	}
+	num_col = zonoml_dense_add_columns(pr, res, num_col);
+	for(i=0; i < num_var; i++){
+		if(args.mass[i]>0){
+			res->gen_inf[i*res->ld + num_col] = -args.mass[i];
+			res->gen_sup[i*res->ld + num_col] = args.mass[i];
+			num_col++;
+		}
+	}
+	free(args.score);
+	free(args.max_mag);
+	free(args.pos);
+	free(args.mass);
+	zonoml_dense_t tmp = *d;
+	*d = *res;
+	*res = tmp;
+	zonoml_dense_free(res);
+	record_timing(zonoml_reduce_order_time);
+}
+
+
+zonoml_dense_t * zonoml_dense_reduce_order(elina_manager_t *man, bool destructive, zonoml_dense_t *d, size_t max_gen){
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonoml_dense_t *res = destructive ? d : zonoml_dense_copy(d);
+	zonoml_dense_reduce(pr, res, max_gen);
+	return res;
+}
+
+
+/* the reduction of the dimensions offset to offset+num_var-1 of z, the dimensions are
+   left unchanged if they have at most max_gen noise symbols */
+void zonoml_reduce_order_zonotope(zonotope_internal_t *pr, zonotope_t *z, size_t offset, size_t num_var, size_t max_gen){
+	zonoml_dense_t *d = zonoml_dense_of_zonotope(z, offset, num_var);
+	size_t i;
+	if(d->num_gen > max_gen){
+		zonoml_dense_reduce(pr, d, max_gen);
+		for(i=0; i < num_var; i++){
+			zonotope_aff_check_free(pr, z->paf[offset+i]);
+			z->paf[offset+i] = zonoml_dense_row_to_aff(pr, d, i);
+			z->paf[offset+i]->pby++;
+		}
+	}
+	zonoml_dense_free(d);
+}
+
+
+elina_abstract0_t * zono_reduce_order(elina_manager_t *man, bool destructive, elina_abstract0_t *abs,
+				      elina_dim_t start_offset, elina_dim_t num_dim, size_t max_gen){
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	elina_abstract0_t *res = destructive ? abs : elina_abstract0_copy(man, abs);
+	zonotope_t *z = zonotope_of_abstract0(res);
+	zonoml_reduce_order_zonotope(pr, z, start_offset, num_dim, max_gen);
+	return res;
+}
+
+
+bool is_greater_zono_dense(elina_manager_t *man, zonoml_dense_t *d, elina_dim_t y, elina_dim_t x){
+	if(-d->box_inf[y]>d->box_sup[x]){
+		return true;
+	}
+	return zonoml_dense_diff_inf(d, y, x) < 0;
+}
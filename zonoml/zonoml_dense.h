@@ -0,0 +1,120 @@
+/*
+ *
+ *  This source file is part of ELINA (ETH LIbrary for Numerical Analysis).
+ *  ELINA is Copyright © 2019 Department of Computer Science, ETH Zurich
+ *  This software is distributed under GNU Lesser General Public License Version 3.0.
+ *  For more information, see the ELINA project website at:
+ *  http://elina.ethz.ch
+ *
+ *  THE SOFTWARE IS PROVIDED "AS-IS" WITHOUT ANY WARRANTY OF ANY KIND, EITHER
+ *  EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO ANY WARRANTY
+ *  THAT THE SOFTWARE WILL CONFORM TO SPECIFICATIONS OR BE ERROR-FREE AND ANY
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE,
+ *  TITLE, OR NON-INFRINGEMENT.  IN NO EVENT SHALL ETH ZURICH BE LIABLE FOR ANY     
+ *  DAMAGES, INCLUDING BUT NOT LIMITED TO DIRECT, INDIRECT,
+ *  SPECIAL OR CONSEQUENTIAL DAMAGES, ARISING OUT OF, RESULTING FROM, OR IN
+ *  ANY WAY CONNECTED WITH THIS SOFTWARE (WHETHER OR NOT BASED UPON WARRANTY,
+ *  CONTRACT, TORT OR OTHERWISE).
+ *
+ */
+
+
+
+#ifndef _ZONOML_DENSE_H_
+#define _ZONOML_DENSE_H_
+
+#include "zonoml.h"
+#include "zonoml_internal.h"
+#include "zonoml_reduced_product.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The neurons of one layer as a zonotope with a dense generator matrix: neuron i is
+   c[i] + sum_k gen[i][k]*nsym[k] with the coefficients stored contiguously, row i starting
+   at i*ld. Columns num_gen to ld-1 are zero, they are filled by the activations without
+   moving the rows. Intervals store their negated lower bound in *_inf. */
+struct _zonoml_dense_t{
+	size_t num_var;
+	size_t num_gen;
+	size_t ld;
+	double *c_inf;
+	double *c_sup;
+	double *box_inf;
+	double *box_sup;
+	double *gen_inf;
+	double *gen_sup;
+	zonotope_noise_symbol_t **nsym;
+};
+
+/* number of rows and of columns of the generator matrix handled together by the matrix product */
+#define ZONOML_DENSE_ROW_BLOCK 4
+#define ZONOML_DENSE_COL_BLOCK 256
+
+typedef struct zonoml_dense_matmult_t{
+	zonoml_dense_t *src;
+	zonoml_dense_t *dst;
+	double **weights;
+	double *bias;
+	elina_nn_layer_t *layer;
+}zonoml_dense_matmult_t;
+
+typedef enum zonoml_dense_kind_t{
+	ZONOML_DENSE_KEEP,
+	ZONOML_DENSE_BOX,
+	ZONOML_DENSE_LINEAR,
+	ZONOML_DENSE_RELU_REFINED,
+	ZONOML_DENSE_COPY,
+}zonoml_dense_kind_t;
+
+/* transformer of one neuron, computed before the new columns are allocated */
+typedef struct zonoml_dense_neuron_t{
+	zonoml_dense_kind_t kind;
+	size_t num_col;
+	size_t col;
+	size_t src;
+	double lambda_l, lambda_u;
+	double lo, hi;
+	double alpha_l, alpha_u;
+	double beta_l, beta_u;
+}zonoml_dense_neuron_t;
+
+typedef struct zonoml_dense_activation_t{
+	zonoml_dense_t *src;
+	zonoml_dense_t *dst;
+	zonoml_dense_neuron_t *neurons;
+	size_t num_gen;
+	bool is_sigmoid;
+	size_t *pool_size;
+	size_t *input_size;
+	size_t *output_size;
+	size_t *strides;
+	long int pad_top;
+	long int pad_left;
+}zonoml_dense_activation_t;
+
+typedef struct zonoml_dense_score_t{
+	double score;
+	size_t col;
+}zonoml_dense_score_t;
+
+typedef struct zonoml_dense_reduce_t{
+	zonoml_dense_t *src;
+	zonoml_dense_t *dst;
+	zonoml_dense_score_t *score;
+	double *max_mag;
+	size_t *pos;	/* column of dst of the kept columns of src, SIZE_MAX for the removed ones */
+	double *mass;	/* sum of the magnitudes of the removed generators of each row */
+}zonoml_dense_reduce_t;
+
+void zonoml_dense_reduce(zonotope_internal_t *pr, zonoml_dense_t *d, size_t max_gen);
+
+void zonoml_reduce_order_zonotope(zonotope_internal_t *pr, zonotope_t *z, size_t offset, size_t num_var, size_t max_gen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -79,32 +79,14 @@ zonotope_aff_t* zonotope_aff_mul_weight(zonotope_internal_t* pr, zonotope_aff_t*
          
         zonotope_aff_t* dst = NULL;
         zonotope_aaterm_t *p,*q;
-        q = NULL;
         dst = zonotope_aff_alloc_init(pr);
         
         elina_double_interval_mul(&dst->c_inf,&dst->c_sup, -lambda, lambda, src->c_inf,src->c_sup);
         
-        if (src->q) {
-            
-            dst->q = q = zonotope_aaterm_alloc_init();
-            for (p=src->q; p; p=p->n) {
-		
-                double tmp_inf = 0.0;
-		double tmp_sup = 0.0;
-                elina_double_interval_mul(&tmp_inf, &tmp_sup, -lambda, lambda, p->inf, p->sup);
-		q->inf = tmp_inf;
-		q->sup = tmp_sup;
-                q->pnsym = p->pnsym;
-                if (p->n) {
-                    /* continue */
-                    q->n = zonotope_aaterm_alloc_init();
-                    q = q->n;
-                } else {
-                    /* the last iteration */
-                    dst->end = q; 
-                }
-            }
-            
+        zonotope_aff_reserve(dst, src->l);
+        for (p=src->q, q=dst->q; p < src->q + src->l; p++, q++) {
+            elina_double_interval_mul(&q->inf, &q->sup, -lambda, lambda, p->inf, p->sup);
+            q->pnsym = p->pnsym;
         }
         
         dst->l = src->l;
@@ -183,6 +165,29 @@ zonotope_aff_t * zonotope_aff_from_sparse_weights_bias(zonotope_internal_t* pr,
 }
 
 
+zonotope_aff_t * zonotope_aff_from_sparse_row_bias(zonotope_internal_t* pr, double * weights, double bias, uint32_t *dim, size_t offset, size_t size, zonotope_t *z){
+    zonotope_aff_t *res = zonotope_aff_alloc_init(pr);
+    res->c_inf = -bias;
+    res->c_sup = bias;
+    res->itv_inf = -bias;
+    res->itv_sup = bias;
+   
+    size_t i;
+	
+    for(i=0; i < size; i++){
+	zonotope_aff_t *tmp;
+	zonotope_aff_t *aff = z->paf[offset+dim[i]];
+	tmp = zonotope_aff_mul_weight(pr,aff,weights[i]);
+	zonotope_aff_t *tmp1 = res;
+	res = zonotope_aff_add(pr,tmp1,tmp,z);	
+        zonotope_aff_free(pr,tmp);
+        zonotope_aff_free(pr,tmp1);
+    }
+   
+    return res;
+}
+
+
 void * handle_ffn_matmult_zono_parallel(void *args){
 	zonoml_ffn_matmult_thread_t * data = (zonoml_ffn_matmult_thread_t *)args;
 	zonotope_internal_t * pr = data->pr;
@@ -226,11 +231,7 @@ elina_abstract0_t* ffn_matmult_zono(elina_manager_t * man, bool destructive, eli
    zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
    zonotope_t *z = zonotope_of_abstract0(element);
    zonotope_t* res = zonotope_copy(man, z);
-   size_t i = 0;
-   for (i=0; i<res->dims; i++) {
-	res->paf[i]->itv_inf = res->box_inf[i];
-	res->paf[i]->itv_sup = res->box_sup[i];
-    }
+   zonoml_bound_layer(pr, res, expr_offset, expr_size);
     ffn_matmult_zono_parallel(pr, res, start_offset, weights, bias,  num_var, expr_offset, expr_size, handle_ffn_matmult_zono_parallel, true);
     man->result.flag_best = false;
     man->result.flag_exact = false;
@@ -245,11 +246,7 @@ elina_abstract0_t* ffn_matmult_without_bias_zono(elina_manager_t * man, bool des
    zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
    zonotope_t *z = zonotope_of_abstract0(element);
    zonotope_t* res = zonotope_copy(man, z);
-   size_t i = 0;
-   for (i=0; i<res->dims; i++) {
-	res->paf[i]->itv_inf = res->box_inf[i];
-	res->paf[i]->itv_sup = res->box_sup[i];
-    }
+   zonoml_bound_layer(pr, res, expr_offset, expr_size);
     ffn_matmult_zono_parallel(pr, res, start_offset, weights, NULL,  num_var, expr_offset, expr_size, handle_ffn_matmult_zono_parallel, false);
     man->result.flag_best = false;
     man->result.flag_exact = false;
@@ -377,6 +374,66 @@ void * handle_conv_matmult_zono_parallel(void *args){
 }
 
 
+static void handle_model_matmult_zono_chunk(void *args, size_t start, size_t end){
+	zonoml_model_matmult_thread_t * data = (zonoml_model_matmult_thread_t *)args;
+	zonotope_internal_t * pr = data->pr;
+	zonotope_t * z = data->z;
+	elina_nn_layer_t *layer = data->layer;
+	size_t expr_offset = data->expr_offset;
+	size_t offset = data->start_offset + start;
+	size_t i;
+	for (i=start; i< end; i++) {
+		size_t row = layer->row_start[i];
+		size_t size = layer->row_start[i+1] - row;
+		zonotope_aff_check_free(pr, z->paf[offset]);
+		z->paf[offset] = layer->dim==NULL ? zonotope_aff_from_dense_weights_bias(pr, layer->weights + row, layer->bias[i], expr_offset, size, z) :
+						    zonotope_aff_from_sparse_row_bias(pr, layer->weights + row, layer->bias[i], layer->dim + row, expr_offset, size, z);
+		if (zonotope_aff_is_top(pr, z->paf[offset])) {
+	    	     zonotope_aff_check_free(pr, z->paf[offset]);
+	    	     z->paf[offset] = pr->top;
+		} 
+		else if (zonotope_aff_is_bottom(pr, z->paf[offset])) {
+	    	     zonotope_aff_check_free(pr, z->paf[offset]);
+	    	     z->paf[offset] = pr->bot;
+		}
+		z->box_inf[offset] = z->paf[offset]->itv_inf;
+		z->box_sup[offset] = z->paf[offset]->itv_sup;
+		z->paf[offset]->pby++;
+		offset++;
+	}
+}
+
+
+// assumes that the variables for the layer have already been added, the first assignment is from start_offset
+elina_abstract0_t* model_matmult_zono(elina_manager_t* man, bool destructive, elina_abstract0_t* element, elina_dim_t start_offset,
+				      elina_nn_model_t *model, size_t layerno, size_t expr_offset){
+	start_timing();
+	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	zonotope_t *z = zonotope_of_abstract0(element);
+	zonotope_t* res = zonotope_copy(man, z);
+	elina_nn_layer_t *layer = model->layers + layerno;
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	zonoml_bound_layer(pr, res, expr_offset, layer->num_in);
+	zonoml_model_matmult_thread_t args;
+	args.pr = pr;
+	args.z = res;
+	args.start_offset = start_offset;
+	args.layer = layer;
+	args.expr_offset = expr_offset;
+	size_t chunk_size = layer->num_out/(4*num_threads);
+	elina_thread_pool_for(pr->pool, handle_model_matmult_zono_chunk, &args, layer->num_out, chunk_size==0 ? 1 : chunk_size);
+	man->result.flag_best = false;
+	man->result.flag_exact = false;
+	if(layer->type==ELINA_NN_CONV){
+		record_timing(zonoml_conv_matmult_time);
+	}
+	else{
+		record_timing(zonoml_ffn_matmult_time);
+	}
+	return abstract0_of_zonotope(man,res);
+}
+
+
 // assumes that the variables for the convolutional matmult have already been added, two dimensional filter, the first assignment is from start_offset
 elina_abstract0_t* conv_matmult_zono(elina_manager_t* man, bool destructive, elina_abstract0_t* element, elina_dim_t start_offset, double *filter_weights, double * filter_bias,  
 				      size_t * input_size, size_t expr_offset, size_t *filter_size, size_t num_filters, size_t *strides, bool is_valid_padding, bool has_bias){
@@ -389,42 +446,9 @@ elina_abstract0_t* conv_matmult_zono(elina_manager_t* man, bool destructive, eli
 	size_t i, j;
 	size_t num_pixels = input_size[0]*input_size[1]*input_size[2];
 	size_t output_size[3];
-        if(is_valid_padding){
-		output_size[0] = ceil((double)(input_size[0] - filter_size[0]+1) / (double)strides[0]);
-		output_size[1] = ceil((double)(input_size[1] - filter_size[1]+1) / (double)strides[1]);
-	}
-	else{
-		output_size[0] = ceil((double)input_size[0] / (double)strides[0]);
-		output_size[1] = ceil((double)input_size[1] / (double)strides[1]);
-	}
-	
-	output_size[2] = num_filters;
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, filter_size, num_filters, strides, is_valid_padding);
 	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
-	long int pad_along_height=0, pad_along_width=0;
-	long int pad_top=0,  pad_left=0,  tmp=0;
-	if(!is_valid_padding){
-		if (input_size[0] % strides[0] == 0){
-			long int tmp = filter_size[0] - strides[0];
-	  		pad_along_height = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[0] - (input_size[0] % strides[0]);
-	  		pad_along_height = max(tmp, 0);
-		}
-		if (input_size[1] % strides[1] == 0){
-			tmp = filter_size[1] - strides[1];
-	  		pad_along_width = max(tmp, 0);
-		}
-		else{
-			tmp = filter_size[1] - (input_size[1] % strides[1]);
-	  		pad_along_width = max(tmp, 0);
-		}
-		pad_top = pad_along_height / 2;
-		
-		pad_left = pad_along_width / 2;
-		
-	}
-	
 
 	conv_matmult_zono_parallel(pr, res, start_offset, filter_weights, filter_bias, num_out_neurons,
 				   expr_offset, input_size, filter_size, num_filters, strides, output_size, 
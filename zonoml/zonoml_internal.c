@@ -38,8 +38,86 @@ double zonoml_maxpool_time=0;
 double zonoml_network_input_time=0;
 double zonoml_conv_matmult_time=0;
 double zonoml_ffn_matmult_time=0;
+double zonoml_reduce_order_time=0;
 
 
 elina_manager_t* zonoml_manager_alloc(void){
-	return zonotope_manager_alloc();
+	elina_manager_t *man = zonotope_manager_alloc();
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	pr->pool = elina_thread_pool_alloc(0);
+	return man;
+}
+
+
+/* 0 selects the number of online processors */
+void zonoml_manager_set_num_threads(elina_manager_t* man, size_t num_threads){
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	elina_thread_pool_free(pr->pool);
+	pr->pool = elina_thread_pool_alloc(num_threads);
+}
+
+
+size_t zonoml_manager_get_num_threads(elina_manager_t* man){
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	return elina_thread_pool_get_num_threads(pr->pool);
+}
+
+
+/* seconds each thread spent in the parallel transformers since the last reset, busy_time has zonoml_manager_get_num_threads entries */
+void zonoml_manager_get_busy_time(elina_manager_t* man, double *busy_time){
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	elina_thread_pool_get_busy_time(pr->pool, busy_time);
+}
+
+
+void zonoml_manager_reset_busy_time(elina_manager_t* man){
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	elina_thread_pool_reset_busy_time(pr->pool);
+}
+
+
+/* 0 disables the reduction */
+void zonoml_manager_set_max_generators(elina_manager_t* man, size_t max_gen){
+	zonotope_internal_t *pr = (zonotope_internal_t *)man->internal;
+	pr->max_gen = max_gen;
+}
+
+
+static void handle_bound_layer_chunk(void *args, size_t start, size_t end){
+	zonoml_bound_thread_t * data = (zonoml_bound_thread_t *)args;
+	zonotope_internal_t * pr = data->pr;
+	zonotope_t * z = data->z;
+	size_t i;
+	for(i=data->offset+start; i < data->offset+end; i++){
+		zonotope_aff_t *aff = z->paf[i];
+		double inf, sup;
+		if(aff==pr->top || aff==pr->bot){
+			continue;
+		}
+		zonotope_aff_bound(pr, &inf, &sup, aff, z);
+		z->box_inf[i] = fmin(z->box_inf[i], inf);
+		z->box_sup[i] = fmin(z->box_sup[i], sup);
+		aff->itv_inf = z->box_inf[i];
+		aff->itv_sup = z->box_sup[i];
+	}
+}
+
+
+/* meets the box of the variables offset to offset+num_var-1 with the concretization of their
+   affine forms and copies it to the itv of the forms. This is a tightening pass: the box was
+   accumulated while the forms were built and can be looser than the concretization of the
+   final forms by a few ulps, the result is never wider than the box. The bounds are computed on
+   the thread pool unless the noise symbols are constrained */
+void zonoml_bound_layer(zonotope_internal_t* pr, zonotope_t *z, size_t offset, size_t num_var){
+	zonoml_bound_thread_t args;
+	args.pr = pr;
+	args.z = z;
+	args.offset = offset;
+	if(!z->hypercube){
+		handle_bound_layer_chunk(&args, 0, num_var);
+		return;
+	}
+	size_t num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	size_t chunk_size = num_var/(4*num_threads);
+	elina_thread_pool_for(pr->pool, handle_bound_layer_chunk, &args, num_var, chunk_size==0 ? 1 : chunk_size);
 }
@@ -58,6 +58,7 @@ counter += cycles
     extern double zonoml_network_input_time;
     extern double zonoml_conv_matmult_time;
     extern double zonoml_ffn_matmult_time;
+    extern double zonoml_reduce_order_time;
 
 
 
@@ -78,14 +79,30 @@ typedef struct zonoml_ffn_matmult_thread_t{
 }zonoml_ffn_matmult_thread_t;
 
 
+typedef struct zonoml_model_matmult_thread_t{
+	zonotope_internal_t* pr;
+	zonotope_t *z;
+	elina_dim_t start_offset;
+	elina_nn_layer_t *layer;
+	size_t expr_offset;
+}zonoml_model_matmult_thread_t;
+
+
+typedef struct zonoml_bound_thread_t{
+	zonotope_internal_t* pr;
+	zonotope_t *z;
+	size_t offset;
+}zonoml_bound_thread_t;
+
+
 typedef struct zonoml_relu_thread_t{
 	size_t start;
 	size_t end;
 	size_t start_offset;
     	zonotope_t *z;
 	elina_manager_t *man;
-	zonotope_noise_symbol_t ** epsilon_map;
-	zonotope_noise_symbol_t ** epsilon_map_extra;
+	uint_t num_nsym;	/* number of noise symbols the neurons start to end-1 need */
+	uint_t nsym_first;	/* their symbols are nsym_first to nsym_first+num_nsym-1, in the order of the neurons */
 }zonoml_relu_thread_t;
 
 typedef struct zonoml_s_curve_thread_t{
@@ -94,9 +111,9 @@ typedef struct zonoml_s_curve_thread_t{
 	size_t start_offset;
     	zonotope_t *z;
 	elina_manager_t *man;
-	zonotope_noise_symbol_t ** epsilon_map;
+	uint_t num_nsym;	/* number of noise symbols the neurons start to end-1 need */
+	uint_t nsym_first;	/* their symbols are nsym_first to nsym_first+num_nsym-1, in the order of the neurons */
 	bool is_sigmoid;
-	char * is_used;
 }zonoml_s_curve_thread_t;
 
 typedef struct zonoml_conv_matmult_thread_t{
@@ -132,8 +149,6 @@ typedef struct zonoml_maxpool_thread_t{
 	long int pad_top;
 	long int pad_left;
 	size_t *output_size;
-	zonotope_noise_symbol_t ** epsilon_map;
-	char * is_used;
 }zonoml_maxpool_thread_t;
 
 
@@ -151,37 +166,14 @@ static inline elina_abstract0_t* abstract0_of_zonotope(elina_manager_t* man, zon
   return r;
 }
 
-static inline zonotope_noise_symbol_t* zonotope_noise_symbol_add_with_index(zonotope_internal_t *pr, noise_symbol_t type, size_t index)
-    /* increment the global index of used noise symbols and add the noise symbol in pr->eps */
-{
-    uint_t dim = pr->dim;
-    zonotope_noise_symbol_t* res;
-	
-    /* resize epsilon array */
-    if (dim % 1024 == 0){ pr->epsilon = (zonotope_noise_symbol_t**)realloc(pr->epsilon, (dim+1024)*sizeof(zonotope_noise_symbol_t*));
-}
-    res = pr->epsilon[dim] = (zonotope_noise_symbol_t*)malloc(sizeof(zonotope_noise_symbol_t));
-    if (type == IN) {
-	if (pr->epssize % 1024 == 0) pr->inputns = (uint_t*)realloc(pr->inputns, (pr->epssize+1024)*sizeof(uint_t));
-	pr->inputns[pr->epssize] = dim; pr->epssize++;
-    }
-    res->index = dim;
-    res->type = type;
-    pr->dim++;
-    return res;
-}
+void zonoml_bound_layer(zonotope_internal_t* pr, zonotope_t *z, size_t offset, size_t num_var);
 
 static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t *z, elina_dim_t start_offset,
 			       			    double **weights, double * bias,  size_t num_out_neurons,
 						    size_t expr_offset, size_t expr_size, void *(*function)(void *), bool has_bias){
-	//int num_threads = get_nprocs();
-	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-	if(num_threads <1){
-		num_threads = 1;
-	}
+	int num_threads = elina_thread_pool_get_num_threads(pr->pool);
 	
 	zonoml_ffn_matmult_thread_t args[num_threads];
-	pthread_t threads[num_threads];
 	int i;
 	//printf("start %zu\n",num_out_neurons);
 	//fflush(stdout);
@@ -197,12 +189,8 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			args[i].expr_offset = expr_offset;
 			args[i].expr_size = expr_size;   
 			args[i].has_bias = has_bias;			
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
-			
 	  	}
-		for (i = 0; i < (int)num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_ffn_matmult_thread_t), num_out_neurons);
 	}
 	else{
 		size_t idx_start = 0;
@@ -221,7 +209,6 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			args[i].expr_offset = expr_offset;
 			args[i].expr_size = expr_size;   
 			args[i].has_bias = has_bias;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
 	    		if(idx_end>num_out_neurons){
@@ -233,61 +220,21 @@ static inline void ffn_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_t
 			}
 	  	}
 
-		for (i = 0; i < num_threads; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_ffn_matmult_thread_t), num_threads);
 	}
 	
 }
 
-static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina_dim_t start_offset, elina_dim_t num_out_neurons, void *(*function)(void *)){
-	//int num_threads = get_nprocs();
-	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-	if(num_threads <1){
-		num_threads = 1;
-	}
-	int i;
-	
+static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina_dim_t start_offset, elina_dim_t num_out_neurons,
+				      void *(*count_function)(void *), void *(*function)(void *)){
 	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
-	size_t offset = start_offset;
-	
-	
-	zonotope_noise_symbol_t ** epsilon_map = (zonotope_noise_symbol_t **)malloc(num_out_neurons*sizeof(zonotope_noise_symbol_t*));
-	zonotope_noise_symbol_t ** epsilon_map_extra = (zonotope_noise_symbol_t **)malloc(num_out_neurons*sizeof(zonotope_noise_symbol_t*));
-	for(i=0; i < (int)num_out_neurons; i++){
-		elina_interval_t *itv = zonotope_bound_dimension(man,z,offset);
-		double inf = itv->inf->val.dbl;
-		double sup = itv->sup->val.dbl;
-		double inf_l = -inf;
-		double inf_u = inf;
-		double sup_l = -sup;
-		double sup_u = sup;
-		
-			
-		double width_l = sup_l + inf_u;
-		double width_u = sup_u + inf_l;
-		
-		double bound_l, bound_u;
-		elina_double_interval_mul(&bound_l, &bound_u, inf_l, inf_u, sup_l, sup_u);
-		double tmp = bound_l;
-		bound_l = bound_u;
-		bound_u = tmp;
-		elina_double_interval_div(&bound_l, &bound_u, bound_l, bound_u, width_l, width_u);
-		if((inf<0) && (sup>0)){
-			epsilon_map[i] = zonotope_noise_symbol_add(pr, IN);
-			if((-inf>sup) && (-bound_l>1)){
-				epsilon_map_extra[i] = zonotope_noise_symbol_add(pr, IN);
-			}	
-		}
-		else{
-			epsilon_map[i] = NULL;
-		}
-		elina_interval_free(itv);
-		offset++;
-	}
+	int num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	int i, num_tasks;
+	uint_t nsym_first;
+	/* the handlers read the bounds of the neurons from the box */
+	zonoml_bound_layer(pr, z, start_offset, num_out_neurons);
 	
 	zonoml_relu_thread_t args[num_threads];
-	pthread_t threads[num_threads];
 	
 	//printf("start %zu\n",num_out_neurons);
 	//fflush(stdout);
@@ -298,14 +245,8 @@ static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina
 			args[i].man = man;
 			args[i].z = z;
             		args[i].start_offset = start_offset;
-			args[i].epsilon_map = epsilon_map;	
-			args[i].epsilon_map_extra = epsilon_map_extra;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
-			
 	  	}
-		for (i = 0; i < (int)num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		num_tasks = num_out_neurons;
 	}
 	else{
 		size_t idx_start = 0;
@@ -319,9 +260,6 @@ static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina
 			args[i].man = man;
 			args[i].z = z;
 			args[i].start_offset = start_offset;
-			args[i].epsilon_map = epsilon_map;
-			args[i].epsilon_map_extra = epsilon_map_extra;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
 	    		if(idx_end>num_out_neurons){
@@ -332,36 +270,35 @@ static inline void relu_zono_parallel(elina_manager_t* man, zonotope_t *z, elina
 				
 			}
 	  	}
-
-		for (i = 0; i < num_threads; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		num_tasks = num_threads;
 	}
-	
-	free(epsilon_map);
-	free(epsilon_map_extra);
+	/* every chunk counts the symbols its neurons need, the chunks then get consecutive ranges of
+	   one reservation of the exact total, so that the symbols follow the order of the neurons */
+	elina_thread_pool_run(pr->pool, count_function, args, sizeof(zonoml_relu_thread_t), num_tasks);
+	nsym_first = 0;
+	for (i = 0; i < num_tasks; i++){
+		args[i].nsym_first = nsym_first;
+		nsym_first += args[i].num_nsym;
+	}
+	nsym_first = zonotope_noise_symbol_reserve(pr, nsym_first);
+	for (i = 0; i < num_tasks; i++){
+		args[i].nsym_first += nsym_first;
+	}
+	elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_relu_thread_t), num_tasks);
 	
 }
 	
 
-static inline void s_curve_zono_parallel(elina_manager_t* man, zonotope_t *z, elina_dim_t start_offset, elina_dim_t num_out_neurons, void *(*function)(void *), bool is_sigmoid){
-	//int num_threads = get_nprocs();
-	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-	if(num_threads <1){
-		num_threads = 1;
-	}
-	int i;
-	
+static inline void s_curve_zono_parallel(elina_manager_t* man, zonotope_t *z, elina_dim_t start_offset, elina_dim_t num_out_neurons,
+					 void *(*count_function)(void *), void *(*function)(void *), bool is_sigmoid){
 	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
+	int num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	int i, num_tasks;
+	uint_t nsym_first;
 	
-	zonotope_noise_symbol_t ** epsilon_map = (zonotope_noise_symbol_t **)malloc(num_out_neurons*sizeof(zonotope_noise_symbol_t*));
-	char *is_used = (char*)calloc(num_out_neurons,sizeof(char));
-	for(i=0; i < (int)num_out_neurons; i++){
-	    epsilon_map[i] = zonotope_noise_symbol_add(pr, IN);
-	}
+	zonoml_bound_layer(pr, z, start_offset, num_out_neurons);
 	
 	zonoml_s_curve_thread_t args[num_threads];
-	pthread_t threads[num_threads];
 	
 	
 	if((int)num_out_neurons < num_threads){
@@ -371,15 +308,9 @@ static inline void s_curve_zono_parallel(elina_manager_t* man, zonotope_t *z, el
 			args[i].man = man;
 			args[i].z = z;
             		args[i].start_offset = start_offset;
-			args[i].epsilon_map = epsilon_map;	
 			args[i].is_sigmoid = is_sigmoid;
-			args[i].is_used = is_used;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
-			
 	  	}
-		for (i = 0; i < (int)num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		num_tasks = num_out_neurons;
 	}
 	else{
 		size_t idx_start = 0;
@@ -393,10 +324,7 @@ static inline void s_curve_zono_parallel(elina_manager_t* man, zonotope_t *z, el
 			args[i].man = man;
 			args[i].z = z;
 			args[i].start_offset = start_offset;
-			args[i].epsilon_map = epsilon_map;
 			args[i].is_sigmoid = is_sigmoid;
-			args[i].is_used = is_used;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
 	    		if(idx_end>num_out_neurons){
@@ -407,18 +335,20 @@ static inline void s_curve_zono_parallel(elina_manager_t* man, zonotope_t *z, el
 				
 			}
 	  	}
-
-		for (i = 0; i < num_threads; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		num_tasks = num_threads;
 	}
-	for(i=0; i < (int)num_out_neurons; i++){
-		if(!is_used[i]){
-			zonotope_delete_constrained_noise_symbol(pr, epsilon_map[i]->index, z);
-		}
+	/* as for the ReLU, one reservation of the number of symbols the chunks count */
+	elina_thread_pool_run(pr->pool, count_function, args, sizeof(zonoml_s_curve_thread_t), num_tasks);
+	nsym_first = 0;
+	for (i = 0; i < num_tasks; i++){
+		args[i].nsym_first = nsym_first;
+		nsym_first += args[i].num_nsym;
+	}
+	nsym_first = zonotope_noise_symbol_reserve(pr, nsym_first);
+	for (i = 0; i < num_tasks; i++){
+		args[i].nsym_first += nsym_first;
 	}
-	free(epsilon_map);
-	free(is_used);
+	elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_s_curve_thread_t), num_tasks);
 	
 }
 
@@ -429,14 +359,9 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 						    size_t expr_offset, size_t *input_size, size_t *filter_size, size_t num_filters,
 						    size_t *strides, size_t *output_size, long int pad_top,
 						    long int pad_left, void *(*function)(void *), bool has_bias){
-	//int num_threads = get_nprocs();
-	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-	if(num_threads <1){
-		num_threads = 1;
-	}
+	int num_threads = elina_thread_pool_get_num_threads(pr->pool);
 	
 	zonoml_conv_matmult_thread_t args[num_threads];
-	pthread_t threads[num_threads];
 	int i;
 	//printf("start %zu\n",num_out_neurons);
 	//fflush(stdout);
@@ -458,12 +383,8 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;   
 			args[i].has_bias = has_bias;			
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
-			
 	  	}
-		for (i = 0; i < (int)num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_conv_matmult_thread_t), num_out_neurons);
 	}
 	else{
 		size_t idx_start = 0;
@@ -488,7 +409,6 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;   
 			args[i].has_bias = has_bias;
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
 	    		if(idx_end>num_out_neurons){
@@ -500,9 +420,7 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 			}
 	  	}
 
-		for (i = 0; i < num_threads; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_conv_matmult_thread_t), num_threads);
 	}
 	
 }
@@ -511,23 +429,16 @@ static inline void conv_matmult_zono_parallel(zonotope_internal_t* pr, zonotope_
 static inline void maxpool_zono_parallel(zonotope_internal_t* pr, zonotope_t *z, size_t src_offset, size_t *pool_size,
 			       	           size_t num_out_neurons, size_t dst_offset, size_t *input_size, size_t *strides,
 					  size_t *output_size, long int pad_top, long int pad_left, void *(*function)(void *)){
-	//int num_threads = get_nprocs();
-	int num_threads = sysconf(_SC_NPROCESSORS_ONLN);
-	if(num_threads <1){
-		num_threads = 1;
-	}
+	int num_threads = elina_thread_pool_get_num_threads(pr->pool);
+	zonoml_bound_layer(pr, z, src_offset, input_size[0]*input_size[1]*input_size[2]);
 	
 	zonoml_maxpool_thread_t args[num_threads];
-	pthread_t threads[num_threads];
 	int i;
-	zonotope_noise_symbol_t ** epsilon_map = (zonotope_noise_symbol_t **)malloc(num_out_neurons*sizeof(zonotope_noise_symbol_t*));
 	elina_dimchange_t dimadd;
     	elina_dimchange_init(&dimadd, 0, num_out_neurons);
 	//elina_dimension_t dims = zonotope_dimension(pr->man,z);
         //elina_dim_t num_var = dims.intdim + dims.realdim;
-	char * is_used = (char*)calloc(num_out_neurons,sizeof(char));
 	for(i=0; i < (int)num_out_neurons; i++){
-		epsilon_map[i] = zonotope_noise_symbol_add(pr, IN);
 		dimadd.dim[i] = dst_offset;		
 		
 	}
@@ -549,14 +460,8 @@ static inline void maxpool_zono_parallel(zonotope_internal_t* pr, zonotope_t *z,
 			args[i].output_size = output_size;
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;
-			args[i].epsilon_map = epsilon_map;
-			args[i].is_used = is_used;   
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
-			
 	  	}
-		for (i = 0; i < (int)num_out_neurons; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_maxpool_thread_t), num_out_neurons);
 	}
 	else{
 		size_t idx_start = 0;
@@ -577,9 +482,6 @@ static inline void maxpool_zono_parallel(zonotope_internal_t* pr, zonotope_t *z,
 			args[i].output_size = output_size;
 			args[i].pad_top = pad_top;
 			args[i].pad_left = pad_left;  
-			args[i].epsilon_map = epsilon_map;
-			args[i].is_used = is_used;  
-	    		pthread_create(&threads[i], NULL,function, (void*)&args[i]);
 			idx_start = idx_end;
 			idx_end = idx_start + idx_n;
 	    		if(idx_end>num_out_neurons){
@@ -591,20 +493,27 @@ static inline void maxpool_zono_parallel(zonotope_internal_t* pr, zonotope_t *z,
 			}
 	  	}
 
-		for (i = 0; i < num_threads; i = i + 1){
-			pthread_join(threads[i], NULL);
-		}
+		elina_thread_pool_run(pr->pool, function, args, sizeof(zonoml_maxpool_thread_t), num_threads);
 	}
+	/* whether an output needs a symbol is only known once its window is compared, so the threads leave the
+	   symbol of the last term of the boxes unset and the symbols are reserved and set here, in the order of
+	   the neurons */
+	uint_t num_nsym = 0;
 	for(i=0; i < (int)num_out_neurons; i++){
-		
-		if(!is_used[i]){
-			
-			zonotope_delete_constrained_noise_symbol(pr, epsilon_map[i]->index, z);
-			
+		zonotope_aff_t *aff = z->paf[dst_offset+i];
+		zonotope_aaterm_t *ptr = aff->l ? aff->q + aff->l - 1 : NULL;
+		if(ptr && ptr->pnsym==NULL){
+			num_nsym++;
+		}
+	}
+	uint_t nsym = zonotope_noise_symbol_reserve(pr, num_nsym);
+	for(i=0; i < (int)num_out_neurons && num_nsym; i++){
+		zonotope_aff_t *aff = z->paf[dst_offset+i];
+		zonotope_aaterm_t *ptr = aff->l ? aff->q + aff->l - 1 : NULL;
+		if(ptr && ptr->pnsym==NULL){
+			ptr->pnsym = zonotope_noise_symbol_add_with_index(pr, IN, nsym++);
 		}
 	}
-	free(epsilon_map);
-	free(is_used);
 	
 }
 
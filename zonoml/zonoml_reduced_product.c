@@ -19,6 +19,7 @@
  */
 
 #include "zonoml_reduced_product.h"
+#include "zonoml_dense.h"
 
 /* transfer information from zonotope to octagon */
 elina_lincons0_array_t get_meet_lincons_array(elina_dim_t y, double inf_l, double inf_u, double sup_l, double sup_u){
@@ -43,7 +44,7 @@ elina_lincons0_array_t get_meet_lincons_array(elina_dim_t y, double inf_l, doubl
 }
 
 
-zonotope_aff_t * create_affine_form_for_box(zonotope_internal_t *pr, double inf, double sup, zonotope_noise_symbol_t *epsilon, char *is_used){
+zonotope_aff_t * create_affine_form_for_box(zonotope_internal_t *pr, double inf, double sup, uint_t nsym_index){
 	double mid_inf = 0.0;
     	double mid_sup = 0.0;
     	double dev_inf = 0.0;
@@ -56,15 +57,7 @@ zonotope_aff_t * create_affine_form_for_box(zonotope_internal_t *pr, double inf,
 	res_box->itv_sup = sup;
 				
    	if (dev_inf!=0 || dev_sup!=0) {
-	    zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-	    ptr->inf = dev_inf;
-	    ptr->sup = dev_sup;
-	    ptr->pnsym = epsilon;
-	    *is_used = 1;
-            if (res_box->end) res_box->end->n = ptr;
-	    else res_box->q = ptr;
-	    res_box->end = ptr;
-	    res_box->l++;
+	    zonotope_aff_push_term(res_box, zonotope_noise_symbol_add_with_index(pr, IN, nsym_index), dev_inf, dev_sup);
         }
 	return res_box;
 }
@@ -224,6 +217,70 @@ elina_abstract0_t *relu_zono(elina_manager_t* man, bool destructive, elina_abstr
 	}
 }		
 	
+/* coefficients of the approximation lambda*x + [0,bound] of a ReLU on [inf,sup] with inf < 0 < sup, as in
+   relu_zono. Returns true if the approximation is refined with a second noise symbol into
+   beta*[0,sup] + alpha*(lambda*x + [0,bound]). All intervals are stored with their negated lower bound. */
+bool zonoml_relu_coeffs(double inf, double sup, double *lambda_l, double *lambda_u, double *bound_l, double *bound_u,
+			double *alpha_l, double *alpha_u, double *beta_l, double *beta_u){
+	double inf_l = -inf;
+	double inf_u = inf;
+	double sup_l = -sup;
+	double sup_u = sup;
+	double width_l = sup_l + inf_u;
+	double width_u = sup_u + inf_l;
+	double tmp;
+	elina_double_interval_mul(bound_l, bound_u, inf_l, inf_u, sup_l, sup_u);
+	tmp = *bound_l;
+	*bound_l = *bound_u;
+	*bound_u = tmp;
+	elina_double_interval_div(bound_l, bound_u, *bound_l, *bound_u, width_l, width_u);
+	elina_double_interval_div(lambda_l, lambda_u, sup_l, sup_u, width_l, width_u);
+	if((-inf>sup) && -*bound_l>1){
+		elina_double_interval_div(alpha_l, alpha_u, -1, 1, *bound_l, *bound_u);
+		*beta_l = -1 + *alpha_u;
+		*beta_u = 1 + *alpha_l;
+		return true;
+	}
+	return false;
+}
+
+/* number of noise symbols added by handle_relu_zono_parallel for a neuron with bounds [inf,sup],
+   the first one for the approximation of the ReLU and the second one for its refinement */
+static uint_t zonoml_relu_num_nsym(double inf, double sup){
+	double lambda_l, lambda_u, bound_l, bound_u, alpha_l, alpha_u, beta_l, beta_u;
+	double mid_inf, mid_sup, dev_inf, dev_sup;
+	uint_t res = 0;
+	if(sup<=0 || inf>=0){
+		return 0;
+	}
+	if(zonoml_relu_coeffs(inf, sup, &lambda_l, &lambda_u, &bound_l, &bound_u, &alpha_l, &alpha_u, &beta_l, &beta_u)){
+		elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, 0, sup);
+		if(dev_inf!=0 || dev_sup!=0){
+			res++;
+		}
+	}
+	elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, 0, bound_u);
+	if(dev_inf!=0 || dev_sup!=0){
+		res++;
+	}
+	return res;
+}
+
+
+void * count_relu_nsym_zono_parallel(void *args){
+	zonoml_relu_thread_t * data = (zonoml_relu_thread_t *)args;
+	zonotope_t * zo = data->z;
+	size_t offset = data->start_offset + data->start;
+	size_t i;
+	data->num_nsym = 0;
+	for (i=data->start; i< data->end; i++) {
+		data->num_nsym += zonoml_relu_num_nsym(-zo->box_inf[offset], zo->box_sup[offset]);
+		offset++;
+	}
+	return NULL;
+}
+
+
 void * handle_relu_zono_parallel(void *args){
 	zonoml_relu_thread_t * data = (zonoml_relu_thread_t *)args;
 	elina_manager_t * man = data->man;
@@ -236,17 +293,15 @@ void * handle_relu_zono_parallel(void *args){
 	size_t idx_start = data->start;
 	size_t idx_end = data->end;
 	
-	zonotope_noise_symbol_t **epsilon_map = data->epsilon_map;
-	zonotope_noise_symbol_t **epsilon_map_extra = data->epsilon_map_extra;
+	uint_t nsym = data->nsym_first;
 	size_t offset = start_offset + idx_start;
 	size_t i;
 	for (i=idx_start; i< idx_end; i++) {
         //printf("i: %zu\n",i);
         //fflush(stdout);
-		elina_interval_t * bound_x = zonotope_bound_dimension(man,zo,offset);
-		double sup = bound_x->sup->val.dbl;
-		double inf = bound_x->inf->val.dbl;
-		elina_interval_free(bound_x);
+		double sup = zo->box_sup[offset];
+		double inf = -zo->box_inf[offset];
+		uint_t num_nsym = zonoml_relu_num_nsym(inf, sup);
 		if(sup<=0){
 			zonotope_aff_check_free(pr, zo->paf[offset]);
 			zonotope_aff_t * res = zonotope_aff_alloc_init(pr);
@@ -264,35 +319,11 @@ void * handle_relu_zono_parallel(void *args){
 		}
 		else{
 			//zonotope_aff_check_free(pr, zo->paf[offset]);
-			double inf_l = -inf;
-			double inf_u = inf;
-			double sup_l = -sup;
 			double sup_u = sup;
-		
-			
-			double width_l = sup_l + inf_u;
-			double width_u = sup_u + inf_l;
-		
-			
-			double bound_l, bound_u;
-			elina_double_interval_mul(&bound_l, &bound_u, inf_l, inf_u, sup_l, sup_u);
-			double tmp = bound_l;
-			bound_l = bound_u;
-			bound_u = tmp;
-			elina_double_interval_div(&bound_l, &bound_u, bound_l, bound_u, width_l, width_u);
-		
-			double lambda_l, lambda_u;
-			elina_double_interval_div(&lambda_l, &lambda_u, sup_l, sup_u, width_l, width_u);
-			
-			
-			
-			if((-inf>sup)&&-bound_l>1){
-				
-				double alpha_l, alpha_u;
-				elina_double_interval_div(&alpha_l,&alpha_u,-1,1,bound_l,bound_u);
+			double lambda_l, lambda_u, bound_l, bound_u;
+			double alpha_l, alpha_u, beta_l, beta_u;
+			if(zonoml_relu_coeffs(inf, sup, &lambda_l, &lambda_u, &bound_l, &bound_u, &alpha_l, &alpha_u, &beta_l, &beta_u)){
 				
-				double beta_l = -1 + alpha_u;
-				double beta_u = 1 + alpha_l;
 				
 				double mid_inf = 0.0;
     				double mid_sup = 0.0;
@@ -306,14 +337,7 @@ void * handle_relu_zono_parallel(void *args){
 				res_box->itv_sup = sup_u;
 				
    				 if (dev_inf!=0 || dev_sup!=0) {
-					zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-					ptr->inf = dev_inf;
-					ptr->sup = dev_sup;
-					ptr->pnsym = epsilon_map_extra[i];
-                     			if (res_box->end) res_box->end->n = ptr;
-					else res_box->q = ptr;
-					res_box->end = ptr;
-					res_box->l++;
+					zonotope_aff_push_term(res_box, zonotope_noise_symbol_add_with_index(pr, IN, nsym + num_nsym - 1), dev_inf, dev_sup);
     				}
 				
 				elina_interval_t *beta = elina_interval_alloc();
@@ -336,14 +360,7 @@ void * handle_relu_zono_parallel(void *args){
 				
 				
    				 if (dev_inf!=0 || dev_sup!=0) {
-					zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-					ptr->inf = dev_inf;
-					ptr->sup = dev_sup;
-					ptr->pnsym = epsilon_map[i];
-                     			if (res_zono->end) res_zono->end->n = ptr;
-					else res_zono->q = ptr;
-					res_zono->end = ptr;
-					res_zono->l++;
+					zonotope_aff_push_term(res_zono, zonotope_noise_symbol_add_with_index(pr, IN, nsym), dev_inf, dev_sup);
     				}
 								
 				res_zono->itv_sup+= bound_u;
@@ -382,14 +399,7 @@ void * handle_relu_zono_parallel(void *args){
 				res->c_sup = res->c_sup + mid_sup;
 				
    				if (dev_inf!=0 || dev_sup!=0) {
-					zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-					ptr->inf = dev_inf;
-					ptr->sup = dev_sup;
-					ptr->pnsym = epsilon_map[i];
-                     			if (res->end) res->end->n = ptr;
-					else res->q = ptr;
-					res->end = ptr;
-					res->l++;
+					zonotope_aff_push_term(res, zonotope_noise_symbol_add_with_index(pr, IN, nsym), dev_inf, dev_sup);
     				}				           
 
 				//res->itv_inf+= ;
@@ -402,6 +412,7 @@ void * handle_relu_zono_parallel(void *args){
 			zo->paf[offset]->pby++;
 			
 		}
+		nsym += num_nsym;
 		offset++;
     	}
 	return NULL; 
@@ -573,6 +584,15 @@ elina_abstract0_t *maxpool_zono_refined(elina_manager_t* man, bool destructive,
 	return abstract0_of_zonotope(man,zo);
 }
 
+/* the automatic order reduction of the layer computed by a layerwise transformer */
+static void zonoml_reduce_order_layer(elina_manager_t *man, zonotope_t *zo, elina_dim_t start_offset, elina_dim_t num_dim){
+	zonotope_internal_t* pr = (zonotope_internal_t *)man->internal;
+	if(pr->max_gen){
+		zonoml_reduce_order_zonotope(pr, zo, start_offset, num_dim, pr->max_gen);
+	}
+}
+
+
 elina_abstract0_t * relu_zono_layerwise(elina_manager_t* man, bool destructive, elina_abstract0_t * abs,  elina_dim_t start_offset, elina_dim_t num_dim){
 	//elina_dim_t i;
 	//elina_dim_t end = start_offset + num_dim;
@@ -584,8 +604,8 @@ elina_abstract0_t * relu_zono_layerwise(elina_manager_t* man, bool destructive,
 	//	res= relu_zono(man,true,res,i);
 	//}
         zonotope_t *zo = zonotope_of_abstract0(res);
-        relu_zono_parallel(man, zo, start_offset, num_dim, handle_relu_zono_parallel);
-        res = abstract0_of_zonotope(man,zo);
+        relu_zono_parallel(man, zo, start_offset, num_dim, count_relu_nsym_zono_parallel, handle_relu_zono_parallel);
+        zonoml_reduce_order_layer(man, zo, start_offset, num_dim);
        
     return res;
 }
@@ -664,6 +684,162 @@ elina_abstract0_t * relu_zono_layerwise_split(elina_manager_t* man, bool destruc
 
 
 
+/* approximation of a sigmoid (is_sigmoid) or tanh on [inf,sup], as in s_curve_zono. Returns true for the
+   approximation lambda*x + [lo,hi] and false for the box [lo,hi]; intervals are stored with their negated
+   lower bound. */
+bool zonoml_s_curve_coeffs(double inf, double sup, bool is_sigmoid, double *lambda_l, double *lambda_u, double *lo, double *hi){
+	double inf_l = -inf;
+	double inf_u = inf;
+	double sup_l = -sup;
+	double sup_u = sup;
+	if(inf==sup){
+		fesetround(FE_DOWNWARD);
+		double val_inf = is_sigmoid ? exp(inf) : tanh(inf);
+		if(is_sigmoid){
+			val_inf = val_inf/(1+val_inf);
+		}
+		fesetround(FE_UPWARD);
+		double val_sup = is_sigmoid ? exp(inf) : tanh(inf);
+		if(is_sigmoid){
+			val_sup = val_sup/(1+val_sup);
+		}
+		*lo = -val_inf;
+		*hi = val_sup;
+		return false;
+	}
+	fesetround(FE_DOWNWARD);
+	double e_sup_l = is_sigmoid ? -exp(sup) : -tanh(sup);
+	double e_inf_l = is_sigmoid ? -exp(inf) : -tanh(inf);
+	fesetround(FE_UPWARD);
+	double e_sup_u = is_sigmoid ? exp(sup) : tanh(sup);
+	double e_inf_u = is_sigmoid ? exp(inf) : tanh(inf);
+	double f_sup_l, f_sup_u;
+	double f_inf_l, f_inf_u;
+	double den_sup_l, den_sup_u;
+	double den_inf_l, den_inf_u;
+	if(is_sigmoid){
+		den_sup_l = -1 + e_sup_l;
+		den_sup_u = 1 + e_sup_u;
+		den_inf_l = -1 + e_inf_l;
+		den_inf_u = 1 + e_inf_u;
+		elina_double_interval_div(&f_sup_l, &f_sup_u, e_sup_l, e_sup_u, den_sup_l, den_sup_u);
+		elina_double_interval_div(&f_inf_l, &f_inf_u, e_inf_l, e_inf_u, den_inf_l, den_inf_u);
+	}
+	else{
+		f_inf_l = e_inf_l;
+		f_inf_u = e_inf_u;
+		f_sup_l = e_sup_l;
+		f_sup_u = e_sup_u;
+		den_inf_l = e_inf_l;
+		den_inf_u = e_inf_u;
+		den_sup_l = e_sup_l;
+		den_sup_u = e_sup_u;
+	}
+	double slope_l, slope_u;
+	if(inf>0){
+		double sq_den_sup_l, sq_den_sup_u;
+		elina_double_interval_mul(&sq_den_sup_l, &sq_den_sup_u, den_sup_l, den_sup_u, den_sup_l, den_sup_u);
+		if(is_sigmoid){
+			elina_double_interval_div(&slope_l, &slope_u, e_sup_l, e_sup_u, sq_den_sup_l, sq_den_sup_u);
+		}
+		else{
+			slope_l = -1 + sq_den_sup_u;
+			slope_u = 1 + sq_den_sup_l;
+		}
+	}
+	else if(sup<0){
+		double sq_den_inf_l, sq_den_inf_u;
+		elina_double_interval_mul(&sq_den_inf_l, &sq_den_inf_u, den_inf_l, den_inf_u, den_inf_l, den_inf_u);
+		if(is_sigmoid){
+			elina_double_interval_div(&slope_l, &slope_u, e_inf_l, e_inf_u, sq_den_inf_l, sq_den_inf_u);
+		}
+		else{
+			slope_l = -1 + sq_den_inf_u;
+			slope_u = 1 + sq_den_inf_l;
+		}
+	}
+	else{
+		double sq_den_sup_l, sq_den_sup_u;
+		double slope1_l, slope1_u;
+		elina_double_interval_mul(&sq_den_sup_l, &sq_den_sup_u, den_sup_l, den_sup_u, den_sup_l, den_sup_u);
+		if(is_sigmoid){
+			elina_double_interval_div(&slope1_l, &slope1_u, e_sup_l, e_sup_u, sq_den_sup_l, sq_den_sup_u);
+		}
+		else{
+			slope1_l = -1 + sq_den_sup_u;
+			slope1_u = 1 + sq_den_sup_l;
+		}
+		double sq_den_inf_l, sq_den_inf_u;
+		double slope2_l, slope2_u;
+		elina_double_interval_mul(&sq_den_inf_l, &sq_den_inf_u, den_inf_l, den_inf_u, den_inf_l, den_inf_u);
+		if(is_sigmoid){
+			elina_double_interval_div(&slope2_l, &slope2_u, e_inf_l, e_inf_u, sq_den_inf_l, sq_den_inf_u);
+		}
+		else{
+			slope2_l = -1 + sq_den_inf_u;
+			slope2_u = 1 + sq_den_inf_l;
+		}
+		if(slope1_u < -slope2_l){
+			slope_l = slope1_l;
+			slope_u = slope1_u;
+		}
+		else if(slope2_u < -slope1_l){
+			slope_l = slope2_l;
+			slope_u = slope2_u;
+		}
+		else{
+			*lo = f_inf_l;
+			*hi = f_sup_u;
+			return false;
+		}
+	}
+	double tmp_l, tmp_u;
+	elina_double_interval_mul(&tmp_l, &tmp_u, sup_l, sup_u, slope_l, slope_u);
+	double bound1_l = f_sup_l + tmp_u;
+	double bound1_u = f_sup_u + tmp_l;
+	elina_double_interval_mul(&tmp_l, &tmp_u, inf_l, inf_u, slope_l, slope_u);
+	double bound2_l = f_inf_l + tmp_u;
+	double bound2_u = f_inf_u + tmp_l;
+	if(-bound1_l > bound2_u){
+		*lambda_l = slope_l;
+		*lambda_u = slope_u;
+		*lo = bound2_l;
+		*hi = bound1_u;
+		return true;
+	}
+	*lo = f_inf_l;
+	*hi = f_sup_u;
+	return false;
+}
+
+
+/* number of noise symbols the approximation of zonoml_s_curve_coeffs on [inf,sup] needs */
+static uint_t zonoml_s_curve_num_nsym(double inf, double sup, bool is_sigmoid){
+	double lambda_l, lambda_u, lo, hi;
+	double mid_inf = 0.0;
+	double mid_sup = 0.0;
+	double dev_inf = 0.0;
+	double dev_sup = 0.0;
+	zonoml_s_curve_coeffs(inf, sup, is_sigmoid, &lambda_l, &lambda_u, &lo, &hi);
+	elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, lo, hi);
+	return (dev_inf!=0 || dev_sup!=0) ? 1 : 0;
+}
+
+
+void * count_s_curve_nsym_zono_parallel(void *args){
+	zonoml_s_curve_thread_t * data = (zonoml_s_curve_thread_t *)args;
+	zonotope_t * zo = data->z;
+	size_t offset = data->start_offset + data->start;
+	size_t i;
+	data->num_nsym = 0;
+	for (i=data->start; i< data->end; i++) {
+		data->num_nsym += zonoml_s_curve_num_nsym(-zo->box_inf[offset], zo->box_sup[offset], data->is_sigmoid);
+		offset++;
+	}
+	return NULL;
+}
+
+
 void * handle_s_curve_zono_parallel(void *args){
 	zonoml_s_curve_thread_t * data = (zonoml_s_curve_thread_t *)args;
 	elina_manager_t * man = data->man;
@@ -676,204 +852,47 @@ void * handle_s_curve_zono_parallel(void *args){
 	size_t idx_start = data->start;
 	size_t idx_end = data->end;
 	
-	zonotope_noise_symbol_t **epsilon_map = data->epsilon_map;
+	uint_t nsym = data->nsym_first;
 	bool is_sigmoid = data->is_sigmoid;
-	char *is_used = data->is_used;
 	size_t offset = start_offset + idx_start;
 	size_t i;
 	for (i=idx_start; i< idx_end; i++) {
         	
-		elina_interval_t * bound_x = zonotope_bound_dimension(man,zo,offset);
-		double sup = bound_x->sup->val.dbl;
-		double inf = bound_x->inf->val.dbl;
-		elina_interval_free(bound_x);
-		double inf_l = -inf;
-		double inf_u = inf;
-		double sup_l = -sup;
-		double sup_u = sup;
-		if(inf ==sup){
-		   fesetround(FE_DOWNWARD);
-		   double val_inf = is_sigmoid ? exp(inf) : tanh(inf);
-		   if(is_sigmoid){
-		      val_inf = val_inf/(1+val_inf);
-		   }
-		   fesetround(FE_UPWARD);
-		   double val_sup = is_sigmoid ? exp(inf) : tanh(inf);
-		   if(is_sigmoid){
-			val_sup = val_sup/(1+val_sup);
-		   }
-		   zonotope_aff_check_free(pr,zo->paf[offset]);
-		   zonotope_aff_t *res = create_affine_form_for_box(pr,-val_inf,val_sup,epsilon_map[i],&is_used[i]);
-		   zo->paf[offset] = res;
-		   zo->box_inf[offset] = -val_inf;
-		   zo->box_sup[offset] = val_sup;
-		   zo->paf[offset]->pby++;
-	 	}
-		else{
-			fesetround(FE_DOWNWARD);
-			double e_sup_l = is_sigmoid ? -exp(sup) : -tanh(sup);
-			double e_inf_l = is_sigmoid ? -exp(inf) : -tanh(inf);
-			fesetround(FE_UPWARD); 
-			double e_sup_u = is_sigmoid ? exp(sup) : tanh(sup);
-			double e_inf_u = is_sigmoid ? exp(inf) : tanh(inf);
-			double f_sup_l, f_sup_u;
-			double f_inf_l, f_inf_u;
-			double den_sup_l, den_sup_u;
-			double den_inf_l, den_inf_u;
-			double connecting_slope_l, connecting_slope_u;
-		
-			if(is_sigmoid){
-				den_sup_l = -1 + e_sup_l;
-				den_sup_u = 1 + e_sup_u;				
-				den_inf_l = -1 + e_inf_l;
-				den_inf_u = 1 + e_inf_u;		
-				elina_double_interval_div(&f_sup_l, &f_sup_u, e_sup_l, e_sup_u, den_sup_l, den_sup_u);
-				elina_double_interval_div(&f_inf_l, &f_inf_u, e_inf_l, e_inf_u, den_inf_l, den_inf_u);
-			}
-			else{
-				f_inf_l = e_inf_l;
-				f_inf_u = e_inf_u;
-				f_sup_l = e_sup_l;
-				f_sup_u = e_sup_u;
-				den_inf_l = e_inf_l;
-				den_inf_u = e_inf_u;
-				den_sup_l = e_sup_l;
-				den_sup_u = e_sup_u;
-			}
-		
-			double slope_l, slope_u;
-			bool boxify = false;
-			if(inf>0){
-				double sq_den_sup_l, sq_den_sup_u;
-				elina_double_interval_mul(&sq_den_sup_l, &sq_den_sup_u, den_sup_l, den_sup_u, den_sup_l, den_sup_u);
-				if(is_sigmoid){
-					elina_double_interval_div(&slope_l, &slope_u, e_sup_l, e_sup_u, sq_den_sup_l, sq_den_sup_u);
-				}
-				else{
-					slope_l = -1 + sq_den_sup_u;
-					slope_u = 1 + sq_den_sup_l; 
-				}
-
-			}
-			else if(sup<0){
-				double sq_den_inf_l, sq_den_inf_u;
-				elina_double_interval_mul(&sq_den_inf_l, &sq_den_inf_u, den_inf_l, den_inf_u, den_inf_l, den_inf_u);	
-				if(is_sigmoid){
-						
-					elina_double_interval_div(&slope_l, & slope_u, e_inf_l, e_inf_u, sq_den_inf_l, sq_den_inf_u);
-				}
-				else{
-				
-					slope_l = -1 + sq_den_inf_u;
-					slope_u = 1 + sq_den_inf_l; 
-				}
-			}
-			else{
-				double sq_den_sup_l, sq_den_sup_u;
-				double slope1_l, slope1_u;
-				elina_double_interval_mul(&sq_den_sup_l, &sq_den_sup_u, den_sup_l, den_sup_u, den_sup_l, den_sup_u);
-				if(is_sigmoid){
-					elina_double_interval_div(&slope1_l, &slope1_u, e_sup_l, e_sup_u, sq_den_sup_l, sq_den_sup_u);
-				}
-
-				else{
-					slope1_l = -1 + sq_den_sup_u;
-					slope1_u = 1 + sq_den_sup_l; 
-				}
-
-				double sq_den_inf_l, sq_den_inf_u;
-				double slope2_l, slope2_u;
-				elina_double_interval_mul(&sq_den_inf_l, &sq_den_inf_u, den_inf_l, den_inf_u, den_inf_l, den_inf_u);
-				if(is_sigmoid){
-					elina_double_interval_div(&slope2_l, & slope2_u, e_inf_l, e_inf_u, sq_den_inf_l, sq_den_inf_u);
-				}
-				else{
-					slope2_l = -1 + sq_den_inf_u;
-					slope2_u = 1 + sq_den_inf_l; 
-				}
-				if(slope1_u < -slope2_l){
-					slope_l = slope1_l;
-					slope_u = slope1_u;
-				}
-				else if(slope2_u < -slope1_l){
-					slope_l = slope2_l;
-					slope_u = slope2_u;				
-				}
-				else{
-					boxify = true;
-					
-				}	
-			}
-		
-			if(boxify){
-				// meet with linear constraint
-				
-				zonotope_aff_check_free(pr,zo->paf[offset]);
-				zonotope_aff_t *res = create_affine_form_for_box(pr,f_inf_l,f_sup_u,epsilon_map[i],&is_used[i]);
-		   		zo->paf[offset] = res;
-		   		zo->box_inf[offset] = f_inf_l;
-		   		zo->box_sup[offset] = f_sup_u;
-		   		zo->paf[offset]->pby++;
-				
-			}
-			else{
-				double tmp_l, tmp_u;
-				elina_double_interval_mul(&tmp_l, &tmp_u, sup_l, sup_u, slope_l, slope_u);
-				double bound1_l, bound1_u;
-				bound1_l = f_sup_l + tmp_u;			
-				bound1_u = f_sup_u + tmp_l;			
-
-				elina_double_interval_mul(&tmp_l, &tmp_u, inf_l, inf_u, slope_l, slope_u);
-				double bound2_l, bound2_u;
-				bound2_l = f_inf_l + tmp_u;
-				bound2_u = f_inf_u + tmp_l;
-				
-				if(-bound1_l > bound2_u){	
-					elina_interval_t *lambda = elina_interval_alloc();
-					elina_interval_set_double(lambda,-slope_l,slope_u);
-            		
-					zonotope_aff_t * res = zonotope_aff_mul_itv(pr, zo->paf[offset], lambda);
-					zonotope_aff_check_free(pr,zo->paf[offset]);
-					elina_interval_free(lambda);
-
-					double mid_inf = 0.0;
-    					double mid_sup = 0.0;
-    					double dev_inf = 0.0;
-    					double dev_sup = 0.0;
-					elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, bound2_l,bound1_u);
-					res->c_inf = res->c_inf + mid_inf;
-					res->c_sup = res->c_sup + mid_sup;
-				
-   					if (dev_inf!=0 || dev_sup!=0) {
-						zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-						ptr->inf = dev_inf;
-						ptr->sup = dev_sup;
-						ptr->pnsym = epsilon_map[i];
-						is_used[i] = 1;
-                     				if (res->end) res->end->n = ptr;
-						else res->q = ptr;
-						res->end = ptr;
-						res->l++;
-    					}				           
-
-					res->itv_inf+= bound2_l;
-					res->itv_sup+= bound1_u;
-					zo->paf[offset] = res;
-					zo->box_inf[offset] = zo->paf[offset]->itv_inf;
-					zo->box_sup[offset] = zo->paf[offset]->itv_sup;
-					
-				}	
-				else{
-					//printf("boxify2\n");
-					//fflush(stdout);
-					zonotope_aff_check_free(pr,zo->paf[offset]);
-					zonotope_aff_t *res = create_affine_form_for_box(pr,f_inf_l,f_sup_u,epsilon_map[i],&is_used[i]);
-		   			zo->paf[offset] = res;
-		   			zo->box_inf[offset] = f_inf_l;
-		   			zo->box_sup[offset] = f_sup_u;
-		   			zo->paf[offset]->pby++;
-				}
+		double sup = zo->box_sup[offset];
+		double inf = -zo->box_inf[offset];
+		double lambda_l, lambda_u, lo, hi;
+		if(zonoml_s_curve_coeffs(inf, sup, is_sigmoid, &lambda_l, &lambda_u, &lo, &hi)){
+			elina_interval_t *lambda = elina_interval_alloc();
+			elina_interval_set_double(lambda,-lambda_l,lambda_u);
+			zonotope_aff_t * res = zonotope_aff_mul_itv(pr, zo->paf[offset], lambda);
+			zonotope_aff_check_free(pr,zo->paf[offset]);
+			elina_interval_free(lambda);
+
+			double mid_inf = 0.0;
+			double mid_sup = 0.0;
+			double dev_inf = 0.0;
+			double dev_sup = 0.0;
+			elina_interval_middev(&mid_inf, &mid_sup, &dev_inf, &dev_sup, lo, hi);
+			res->c_inf = res->c_inf + mid_inf;
+			res->c_sup = res->c_sup + mid_sup;
+			if (dev_inf!=0 || dev_sup!=0) {
+				zonotope_aff_push_term(res, zonotope_noise_symbol_add_with_index(pr, IN, nsym++), dev_inf, dev_sup);
 			}
+			res->itv_inf+= lo;
+			res->itv_sup+= hi;
+			zo->paf[offset] = res;
+			zo->box_inf[offset] = zo->paf[offset]->itv_inf;
+			zo->box_sup[offset] = zo->paf[offset]->itv_sup;
+		}
+		else{
+			zonotope_aff_check_free(pr,zo->paf[offset]);
+			zonotope_aff_t *res = create_affine_form_for_box(pr,lo,hi,nsym);
+			/* the box has a term only if it uses the symbol */
+			nsym += res->l;
+			zo->paf[offset] = res;
+			zo->box_inf[offset] = lo;
+			zo->box_sup[offset] = hi;
+			zo->paf[offset]->pby++;
 		}
 		offset++;
     	}
@@ -1117,8 +1136,8 @@ elina_abstract0_t * sigmoid_zono_layerwise(elina_manager_t* man, bool destructiv
 	//	res= sigmoid_zono(man,true,res,i);
 	//}
 	zonotope_t *zo = zonotope_of_abstract0(res);
-        s_curve_zono_parallel(man, zo, start_offset, num_dim, handle_s_curve_zono_parallel,true);
-        res = abstract0_of_zonotope(man,zo);
+        s_curve_zono_parallel(man, zo, start_offset, num_dim, count_s_curve_nsym_zono_parallel, handle_s_curve_zono_parallel,true);
+        zonoml_reduce_order_layer(man, zo, start_offset, num_dim);
 	
 	return res;
 }
@@ -1138,8 +1157,8 @@ elina_abstract0_t * tanh_zono_layerwise(elina_manager_t* man, bool destructive,
 	//}
 	
 	zonotope_t *zo = zonotope_of_abstract0(res);
-        s_curve_zono_parallel(man, zo, start_offset, num_dim, handle_s_curve_zono_parallel,false);
-        res = abstract0_of_zonotope(man,zo);
+        s_curve_zono_parallel(man, zo, start_offset, num_dim, count_s_curve_nsym_zono_parallel, handle_s_curve_zono_parallel,false);
+        zonoml_reduce_order_layer(man, zo, start_offset, num_dim);
 	
 	return res;
 }
@@ -1194,9 +1213,6 @@ void * handle_maxpool_zono_parallel(void *args){
 	size_t *output_size = data->output_size;		
 	long int pad_top = data->pad_top;
 	long int pad_left = data->pad_left;  
-	
-	zonotope_noise_symbol_t ** epsilon_map = data->epsilon_map;
-	char * is_used = data->is_used;	
 
 	size_t o12 = output_size[1]*output_size[2];
    	size_t i12 = input_size[1]*input_size[2];
@@ -1247,10 +1263,8 @@ void * handle_maxpool_zono_parallel(void *args){
 		    size_t  pool_cur_dim = src_offset + mat_offset;
 				
 		    pool_map[l] = pool_cur_dim;
-		    elina_interval_t * bound = zonotope_bound_dimension(pr->man,z,pool_cur_dim);
-		    inf[l] = bound->inf->val.dbl;
-		    sup[l] = bound->sup->val.dbl;
-		    elina_interval_free(bound);
+		    inf[l] = -z->box_inf[pool_cur_dim];
+		    sup[l] = z->box_sup[pool_cur_dim];
 		    sum_u = sum_u + sup[l];
 		    sum_l = sum_l - inf[l];
 		    if(sup[l]>max_u){
@@ -1321,9 +1335,6 @@ void * handle_maxpool_zono_parallel(void *args){
 	  else{
 	     //max_l<= x_new <= max_u
 		
-	     size_t noise_index = out_pos - dst_offset;
-	     
-	     is_used[noise_index] = 1;
 	     double mid_inf = 0.0;
     	     double mid_sup = 0.0;
     	     double dev_inf = 0.0;
@@ -1336,14 +1347,8 @@ void * handle_maxpool_zono_parallel(void *args){
 	     res_box->itv_sup = max_u;
 				
    	     if (dev_inf!=0 || dev_sup!=0) {
-		 zonotope_aaterm_t* ptr = zonotope_aaterm_alloc_init();
-		 ptr->inf = dev_inf;
-		 ptr->sup = dev_sup;
-		 ptr->pnsym = epsilon_map[noise_index];
-                 if (res_box->end) res_box->end->n = ptr;
-		     else res_box->q = ptr;
-		     res_box->end = ptr;
-		     res_box->l++;
+		 /* the symbol is set by maxpool_zono_parallel */
+		 zonotope_aff_push_term(res_box, NULL, dev_inf, dev_sup);
     		 }
 	     z->paf[out_pos] = res_box;
              z->box_inf[out_pos] = -max_l;
@@ -1369,48 +1374,10 @@ elina_abstract0_t* maxpool_zono(elina_manager_t *man, bool destructive, elina_ab
 	
 	zonotope_internal_t* pr = zonotope_init_from_manager(man, ELINA_FUNID_ASSIGN_LINEXPR_ARRAY);
 
-	size_t * output_size = (size_t *)malloc(dimensionality*sizeof(size_t));
-	//for(i=0; i < dimensionality; i++){
-	//	output_size[i] = input_size[i]/pool_size[i];
-	//}
-	
-    if(is_valid_padding){
-        output_size[0] = ceil((double)(input_size[0] - pool_size[0]+1) / (double)strides[0]);
-        output_size[1] = ceil((double)(input_size[1] - pool_size[1]+1) / (double)strides[1]);
-    }
-    else{
-        output_size[0] = ceil((double)input_size[0] / (double)strides[0]);
-        output_size[1] = ceil((double)input_size[1] / (double)strides[1]);
-    }
-    output_size[2] = input_size[2]/pool_size[2];
-
-	
+	size_t output_size[3];
+	long int pad_top, pad_left;
+	elina_nn_conv_geometry(output_size, &pad_top, &pad_left, input_size, pool_size, input_size[2]/pool_size[2], strides, is_valid_padding);
 	size_t num_out_neurons = output_size[0]*output_size[1]*output_size[2];
-
-    	
-	long int pad_along_height=0, pad_along_width=0;
-	long int pad_top=0,  pad_left=0,  tmp=0;
-	if(!is_valid_padding){
-		if (input_size[0] % strides[0] == 0){
-			long int tmp = pool_size[0] - strides[0];
-	  		pad_along_height = max(tmp, 0);
-		}
-		else{
-			tmp = pool_size[0] - (input_size[0] % strides[0]);
-	  		pad_along_height = max(tmp, 0);
-		}
-		if (input_size[1] % strides[1] == 0){
-			tmp = pool_size[1] - strides[1];
-	  		pad_along_width = max(tmp, 0);
-		}
-		else{
-			tmp = pool_size[1] - (input_size[1] % strides[1]);
-	  		pad_along_width = max(tmp, 0);
-		}
-		pad_top = pad_along_height / 2;
-		pad_left = pad_along_width / 2;
-		
-	}
         //printf("pad top: %ld %ld\n",output_size[0],output_size[1]);
 	//fflush(stdout);
 	zonotope_t * input = zonotope_of_abstract0(abs);
@@ -1422,11 +1389,11 @@ elina_abstract0_t* maxpool_zono(elina_manager_t *man, bool destructive, elina_ab
 	
 	//fflush(stdout);
         maxpool_zono_parallel(pr, res, src_offset, pool_size, num_out_neurons, dst_offset, input_size, strides, output_size, pad_top, pad_left, handle_maxpool_zono_parallel);
+        zonoml_reduce_order_layer(man, res, dst_offset, num_out_neurons);
 	//dims = zonotope_dimension(pr->man,res);
 	//num_var = dims.intdim + dims.realdim;
 	//printf("end %u\n",num_var);
 	//fflush(stdout);
-	free(output_size);
 	return abstract0_of_zonotope(man,res);
 }
 
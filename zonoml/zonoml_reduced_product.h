@@ -44,6 +44,11 @@ elina_abstract0_t * tanh_zono(elina_manager_t *man, bool destructive,
 elina_abstract0_t* maxpool_zono(elina_manager_t *man, bool destructive, elina_abstract0_t *abs, 
 			   size_t *pool_size, size_t *input_size, size_t src_offset, size_t* strides, 
 			   size_t dimensionality, size_t dst_offset, bool is_valid_padding);
+
+bool zonoml_relu_coeffs(double inf, double sup, double *lambda_l, double *lambda_u, double *bound_l, double *bound_u,
+			double *alpha_l, double *alpha_u, double *beta_l, double *beta_u);
+
+bool zonoml_s_curve_coeffs(double inf, double sup, bool is_sigmoid, double *lambda_l, double *lambda_u, double *lo, double *hi);
 //void reduced_product_zono_to_oct(elina_manager_t* man, zonoml_t *zo, elina_dim_t *tdim,elina_linexpr0_t ** lexpr_arr, size_t size, elina_abstract0_t* dest);
 
 //void reduced_product_oct_to_zono(elina_manager_t *man, zonoml_t *zo, elina_dim_t y, elina_dim_t x);